@@ -17,6 +17,7 @@
 
 #include "SRepInterpolation.h"
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <functional>
 #include <sstream>
@@ -61,6 +62,178 @@ T MinValue(const std::array<T,N>& arr) {
   return minT;
 }
 
+//----------------------------------------------------------------------------
+double InnerProduct(const srep::Vector3d& a, const srep::Vector3d& b) {
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+//----------------------------------------------------------------------------
+/// @param u value between 0 and 1 that is kind of a weighting between the two vectors
+srep::Vector3d Slerp(const srep::Vector3d& v1, const srep::Vector3d& v2, const double u) {
+  const double v1Tv2 = Clamp(InnerProduct(v1, v2), -1, 1);
+  const double phi = acos(v1Tv2);
+  // parallel vectors have no arc to follow, and sin(phi) below would divide by zero
+  if (sin(phi) < 1e-12) {
+    return v1 * (1 - u) + v2 * u;
+  }
+  const auto theComputation = [&](double val1, double val2) {
+    return (sin((1-u)*phi) / sin(phi)) * val1 + (sin(u*phi) / sin(phi)) * val2;
+  };
+  return srep::Vector3d (
+    theComputation(v1[0], v2[0]),
+    theComputation(v1[1], v2[1]),
+    theComputation(v1[2], v2[2])
+  );
+}
+
+//----------------------------------------------------------------------------
+srep::Vector3d Compute2ndDerivative(
+  const srep::Vector3d& startVector,
+  const srep::Vector3d& endVector,
+  const srep::Vector3d& targetVector,
+  const double d)
+{
+  constexpr double del = 1e-5;
+  const auto Upv1 = Slerp(startVector.Unit(), endVector.Unit(), d + 2*del);
+  const auto Upv5 = Slerp(startVector.Unit(), endVector.Unit(), d - 2*del);
+  const auto unitTargetVector = targetVector.Unit();
+  return srep::Vector3d(
+    0.25 * (Upv5[0] + Upv1[0] - 2.0 * unitTargetVector[0]),
+    0.25 * (Upv5[1] + Upv1[1] - 2.0 * unitTargetVector[1]),
+    0.25 * (Upv5[2] + Upv1[2] - 2.0 * unitTargetVector[2])
+  );
+}
+
+//----------------------------------------------------------------------------
+srep::Vector3d InterpolateMiddleSpokeDirection(
+  const srep::Point3d& startSkeletalPoint,
+  const srep::Vector3d& startDirection,
+  const srep::Point3d& endSkeletalPoint,
+  const srep::Vector3d& endDirection,
+  const double lambda)
+{
+  //if startSpoke == endSpoke then interpolated spoke == both
+  //I don't think this should ever really happen
+  if (startSkeletalPoint == endSkeletalPoint && startDirection == endDirection) {
+    return startDirection;
+  }
+  const auto startUnitDirection = startDirection.Unit();
+  const auto endUnitDirection = endDirection.Unit();
+  const auto start2ndDerivative = Compute2ndDerivative(startUnitDirection, endUnitDirection, startUnitDirection, 0);
+  const auto end2ndDerivative = Compute2ndDerivative(startUnitDirection, endUnitDirection, endUnitDirection, lambda);
+  const auto avgSpokeDirection = (startDirection + endDirection) / 2;
+  const double halfDist = lambda / 2;
+  const auto middleUnitDirection = Slerp(startUnitDirection, endUnitDirection, halfDist);
+  const double innerProd1 = InnerProduct(middleUnitDirection, avgSpokeDirection);
+  const double innerProd2 = InnerProduct(startUnitDirection, start2ndDerivative);
+  const double innerProd3 = InnerProduct(endUnitDirection, end2ndDerivative);
+  const double interpolatedRadius = innerProd1 - (halfDist * halfDist * 0.25 * (innerProd2 + innerProd3));
+  return middleUnitDirection * interpolatedRadius;
+}
+
+//----------------------------------------------------------------------------
+// I don't know the purpose or reasoning behind these functions
+double h1(double s) { return 2*(s * s * s) - 3*(s * s) + 1; }
+double h2(double s) { return -2*(s * s * s) + 3*(s * s); }
+double h3(double s) { return (s * s * s) - 2*(s * s) + s; }
+double h4(double s) { return (s * s * s) - (s * s); }
+
+//----------------------------------------------------------------------------
+/// Bicubic Hermite patch over a quad of skeletal points.
+///
+/// Corners are in the order from GetOrientedQuads: (u=0,v=0), (u=1,v=0), (u=0,v=1), (u=1,v=1)
+struct HermitePatch {
+  std::array<srep::Point3d, 4> x;
+  std::array<sreplogic::detail::UVDerivative, 4> dx;
+
+  srep::Point3d Evaluate(double u, double v) const;
+};
+
+//----------------------------------------------------------------------------
+srep::Point3d HermitePatch::Evaluate(double u, double v) const {
+  const auto& x11 = this->x[0];
+  const auto& x21 = this->x[1];
+  const auto& x12 = this->x[2];
+  const auto& x22 = this->x[3];
+  const auto& dxdu11 = this->dx[0].u;
+  const auto& dxdv11 = this->dx[0].v;
+  const auto& dxdu21 = this->dx[1].u;
+  const auto& dxdv21 = this->dx[1].v;
+  const auto& dxdu12 = this->dx[2].u;
+  const auto& dxdv12 = this->dx[2].v;
+  const auto& dxdu22 = this->dx[3].u;
+  const auto& dxdv22 = this->dx[3].v;
+
+  // this was pulled as is from original implementation
+  double hx[4][4];
+  double hy[4][4];
+  double hz[4][4];
+
+  hx[0][0] = x11[0];          hx[0][1] = x12[0];
+  hx[1][0] = x21[0];          hx[1][1] = x22[0];
+  hx[2][0] = dxdu11[0];       hx[2][1] = dxdu12[0];
+  hx[3][0] = dxdu21[0];       hx[3][1] = dxdu22[0];
+  hx[0][2] = dxdv11[0];       hx[0][3] = dxdv12[0];
+  hx[1][2] = dxdv21[0];       hx[1][3] = dxdv22[0];
+  hx[2][2] = 0;               hx[2][3] = 0;
+  hx[3][2] = 0;               hx[3][3] = 0;
+
+  hy[0][0] = x11[1];          hy[0][1] = x12[1];
+  hy[1][0] = x21[1];          hy[1][1] = x22[1];
+  hy[2][0] = dxdu11[1];       hy[2][1] = dxdu12[1];
+  hy[3][0] = dxdu21[1];       hy[3][1] = dxdu22[1];
+  hy[0][2] = dxdv11[1];       hy[0][3] = dxdv12[1];
+  hy[1][2] = dxdv21[1];       hy[1][3] = dxdv22[1];
+  hy[2][2] = 0;               hy[2][3] = 0;
+  hy[3][2] = 0;               hy[3][3] = 0;
+
+  hz[0][0] = x11[2];       hz[0][1] = x12[2];
+  hz[1][0] = x21[2];       hz[1][1] = x22[2];
+  hz[2][0] = dxdu11[2];    hz[2][1] = dxdu12[2];
+  hz[3][0] = dxdu21[2];    hz[3][1] = dxdu22[2];
+  hz[0][2] = dxdv11[2];    hz[0][3] = dxdv12[2];
+  hz[1][2] = dxdv21[2];    hz[1][3] = dxdv22[2];
+  hz[2][2] = 0;            hz[2][3] = 0;
+  hz[3][2] = 0;            hz[3][3] = 0;
+
+  double hu[4], hv[4];
+  hu[0] = h1(u);
+  hu[1] = h2(u);
+  hu[2] = h3(u);
+  hu[3] = h4(u);
+  hv[0] = h1(v);
+  hv[1] = h2(v);
+  hv[2] = h3(v);
+  hv[3] = h4(v);
+
+  // supposed computation is these
+  //    vnl_double_1x1 xn = hu.transpose() * hx * hv;
+  //    vnl_double_1x1 yn = hu.transpose() * hy * hv;
+  //    vnl_double_1x1 zn = hu.transpose() * hz * hv;
+  double huThx[4], huThy[4], huThz[4];
+  huThx[0] = hu[0] * hx[0][0] + hu[1] * hx[1][0] + hu[2] * hx[2][0] + hu[3] * hx[3][0];
+  huThx[1] = hu[0] * hx[0][1] + hu[1] * hx[1][1] + hu[2] * hx[2][1] + hu[3] * hx[3][1];
+  huThx[2] = hu[0] * hx[0][2] + hu[1] * hx[1][2] + hu[2] * hx[2][2] + hu[3] * hx[3][2];
+  huThx[3] = hu[0] * hx[0][3] + hu[1] * hx[1][3] + hu[2] * hx[2][3] + hu[3] * hx[3][3];
+
+  huThy[0] = hu[0] * hy[0][0] + hu[1] * hy[1][0] + hu[2] * hy[2][0] + hu[3] * hy[3][0];
+  huThy[1] = hu[0] * hy[0][1] + hu[1] * hy[1][1] + hu[2] * hy[2][1] + hu[3] * hy[3][1];
+  huThy[2] = hu[0] * hy[0][2] + hu[1] * hy[1][2] + hu[2] * hy[2][2] + hu[3] * hy[3][2];
+  huThy[3] = hu[0] * hy[0][3] + hu[1] * hy[1][3] + hu[2] * hy[2][3] + hu[3] * hy[3][3];
+
+  huThz[0] = hu[0] * hz[0][0] + hu[1] * hz[1][0] + hu[2] * hz[2][0] + hu[3] * hz[3][0];
+  huThz[1] = hu[0] * hz[0][1] + hu[1] * hz[1][1] + hu[2] * hz[2][1] + hu[3] * hz[3][1];
+  huThz[2] = hu[0] * hz[0][2] + hu[1] * hz[1][2] + hu[2] * hz[2][2] + hu[3] * hz[3][2];
+  huThz[3] = hu[0] * hz[0][3] + hu[1] * hz[1][3] + hu[2] * hz[2][3] + hu[3] * hz[3][3];
+
+  double output[3];
+  output[0] = huThx[0] * hv[0] + huThx[1] * hv[1] + huThx[2] * hv[2] + huThx[3] * hv[3];
+  output[1] = huThy[0] * hv[0] + huThy[1] * hv[1] + huThy[2] * hv[2] + huThy[3] * hv[3];
+  output[2] = huThz[0] * hv[0] + huThz[1] * hv[1] + huThz[2] * hv[2] + huThz[3] * hv[3];
+
+  return srep::Point3d(output);
+}
+
 } // namespace {}
 
 namespace sreplogic {
@@ -137,6 +310,15 @@ vtkSRepSpoke& SRepInterpolateHelper::GetSpoke(const Grid& grid, const LineStep&
     + std::to_string(loc.line) + ", " + std::to_string(loc.step) + ")");
 }
 
+//----------------------------------------------------------------------------
+const vtkSRepSpoke& SRepInterpolateHelper::GetSpoke(const GridView& grid, const LineStep& loc, SpokeType spokeType) {
+  if (grid[loc.line][loc.step]->GetSpoke(spokeType)) {
+    return *(grid[loc.line][loc.step]->GetSpoke(spokeType));
+  }
+  throw std::runtime_error("Nullptr found for grid at ("
+    + std::to_string(loc.line) + ", " + std::to_string(loc.step) + ")");
+}
+
 //----------------------------------------------------------------------------
 vtkSRepSpoke& SRepInterpolateHelper::GetInterpolatedSpoke(const LineStep& loc, SpokeType spokeType) {
   return this->GetSpoke(this->InterpolatedGrid, loc, spokeType);
@@ -152,7 +334,7 @@ vtkSRepSkeletalPoint& SRepInterpolateHelper::GetInterpolatedSkeletalPoint(const
 }
 
 //----------------------------------------------------------------------------
-srep::Vector3d SRepInterpolateHelper::ComputeLinewiseDerivative(const Grid& grid, const LineStep& loc, SpokeType spokeType) {
+srep::Vector3d SRepInterpolateHelper::ComputeLinewiseDerivative(const GridView& grid, const LineStep& loc, SpokeType spokeType) {
   const auto prevLine = (loc.line + grid.size() - 1) % grid.size();
   const auto nextLine = (loc.line + grid.size() + 1) % grid.size();
 
@@ -165,7 +347,7 @@ srep::Vector3d SRepInterpolateHelper::ComputeLinewiseDerivative(const Grid& grid
 }
 
 //----------------------------------------------------------------------------
-srep::Vector3d SRepInterpolateHelper::ComputeStepwiseDerivative(const Grid& grid, const LineStep& loc, SpokeType spokeType) {
+srep::Vector3d SRepInterpolateHelper::ComputeStepwiseDerivative(const GridView& grid, const LineStep& loc, SpokeType spokeType) {
   const auto prevOptLineStep = [&](){
     if (loc.step == 0) {
       return std::make_pair(LineStep(), false);
@@ -184,7 +366,7 @@ srep::Vector3d SRepInterpolateHelper::ComputeStepwiseDerivative(const Grid& grid
 
 //----------------------------------------------------------------------------
 srep::Vector3d SRepInterpolateHelper::ComputeDerivative(
-  const Grid& grid,
+  const GridView& grid,
   const LineStep& loc,
   const OptionalLineStep& lesserNeighbor,
   const OptionalLineStep& greaterNeighbor,
@@ -219,7 +401,7 @@ srep::Vector3d SRepInterpolateHelper::ComputeDerivative(
 
 //----------------------------------------------------------------------------
 SRepInterpolateHelper::SkeletalPointDerivative
-SRepInterpolateHelper::ComputeDerivative(const Grid& grid, const LineStep& loc) {
+SRepInterpolateHelper::ComputeDerivative(const GridView& grid, const LineStep& loc) {
   SkeletalPointDerivative d;
   d.up.u = SRepInterpolateHelper::ComputeLinewiseDerivative(grid, loc, SpokeType::UpOrientation);
   d.down.u = SRepInterpolateHelper::ComputeLinewiseDerivative(grid, loc, SpokeType::DownOrientation);
@@ -231,7 +413,7 @@ SRepInterpolateHelper::ComputeDerivative(const Grid& grid, const LineStep& loc)
 
 //----------------------------------------------------------------------------
 SRepInterpolateHelper::DerivativeGridType
-SRepInterpolateHelper::ComputeDerivatives(const Grid& grid) {
+SRepInterpolateHelper::ComputeDerivatives(const GridView& grid) {
   DerivativeGridType d;
   d.reserve(grid.size());
   for (size_t line = 0; line < grid.size(); ++line) {
@@ -244,38 +426,6 @@ SRepInterpolateHelper::ComputeDerivatives(const Grid& grid) {
   return d;
 }
 
-//----------------------------------------------------------------------------
-srep::Vector3d SRepInterpolateHelper::Slerp(const srep::Vector3d& v1, const srep::Vector3d& v2, const double u) {
-  const double v1Tv2 = Clamp(v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2], -1, 1);
-  const double phi = acos(v1Tv2);
-  const auto theComputation = [&](double val1, double val2) {
-    return (sin((1-u)*phi) / sin(phi)) * val1 + (sin(u*phi) / sin(phi)) * val2;
-  };
-  return srep::Vector3d (
-    theComputation(v1[0], v2[0]),
-    theComputation(v1[1], v2[1]),
-    theComputation(v1[2], v2[2])
-  );
-}
-
-//----------------------------------------------------------------------------
-srep::Vector3d SRepInterpolateHelper::Compute2ndDerivative(
-  const srep::Vector3d& startVector,
-  const srep::Vector3d& endVector,
-  const srep::Vector3d& targetVector,
-  const double d)
-{
-  constexpr double del = 1e-5;
-  const auto Upv1 = Slerp(startVector.Unit(), endVector.Unit(), d + 2*del);
-  const auto Upv5 = Slerp(startVector.Unit(), endVector.Unit(), d - 2*del);
-  const auto unitTargetVector = targetVector.Unit();
-  return srep::Vector3d(
-    0.25 * (Upv5[0] + Upv1[0] - 2.0 * unitTargetVector[0]),
-    0.25 * (Upv5[1] + Upv1[1] - 2.0 * unitTargetVector[1]),
-    0.25 * (Upv5[2] + Upv1[2] - 2.0 * unitTargetVector[2])
-  );
-}
-
 //----------------------------------------------------------------------------
 LineStep SRepInterpolateHelper::OriginalLineStepToInterpolatedLineStep(const LineStep& ols) {
   return LineStep(ols.line * this->Density, ols.step * this->Density);
@@ -439,7 +589,7 @@ LineStep SRepInterpolateHelper::MiddleLineStep(const LineStep& a, const LineStep
 }
 
 //----------------------------------------------------------------------------
-SRepInterpolateHelper::UVDerivative SRepInterpolateHelper::Average(const UVDerivative& uv1, const UVDerivative& uv2) {
+UVDerivative SRepInterpolateHelper::Average(const UVDerivative& uv1, const UVDerivative& uv2) {
   UVDerivative avg;
   avg.u = Average(uv1.u, uv2.u);
   avg.v = Average(uv1.v, uv2.v);
@@ -481,7 +631,7 @@ srep::Point3d SRepInterpolateHelper::Average(const srep::Point3d& pt1, const sre
 }
 
 //----------------------------------------------------------------------------
-std::vector<SRepInterpolateHelper::Quad> SRepInterpolateHelper::GetOrientedQuads(const Grid& grid) {
+std::vector<SRepInterpolateHelper::Quad> SRepInterpolateHelper::GetOrientedQuads(const GridView& grid) {
   //Quad orientation: (smaller-line, smaller-step)(larger-line, smaller-step)(smaller-line, larger-step)(larger-line, larger-step)
   // i.e. clockwise from the inside out
 
@@ -548,30 +698,14 @@ srep::Vector3d SRepInterpolateHelper::InterpolateMiddleSpokeDirection(
   const vtkSRepSpoke& endSpoke,
   const double lambda)
 {
-  const auto startUnitDirection = startSpoke.GetDirection().Unit();
-  const auto endUnitDirection = endSpoke.GetDirection().Unit();
-  const auto start2ndDerivative = Compute2ndDerivative(startUnitDirection, endUnitDirection, startUnitDirection, 0);
-  const auto end2ndDerivative = Compute2ndDerivative(startUnitDirection, endUnitDirection, endUnitDirection, lambda);
-  const auto avgSpokeDirection = Average(startSpoke.GetDirection(), endSpoke.GetDirection());
-  const double halfDist = lambda / 2;
-  //if startSpoke == endSpoke then interpolated spoke == both
-  //I don't think this should ever really happen
-  if (startSpoke.GetSkeletalPoint() == endSpoke.GetSkeletalPoint() && startSpoke.GetDirection() == endSpoke.GetDirection()) {
-    return startSpoke.GetDirection();
-  }
-  const auto middleUnitDirection = Slerp(startUnitDirection, endUnitDirection, halfDist);
-  const auto innerProd = [](const srep::Vector3d& a, const srep::Vector3d b) {
-    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
-  };
-  const double innerProd1 = innerProd(middleUnitDirection, avgSpokeDirection);
-  const double innerProd2 = innerProd(startUnitDirection, start2ndDerivative);
-  const double innerProd3 = innerProd(endUnitDirection, end2ndDerivative);
-  const double interpolatedRadius = innerProd1 - (halfDist * halfDist * 0.25 * (innerProd2 + innerProd3));
-  return middleUnitDirection * interpolatedRadius;
+  return ::InterpolateMiddleSpokeDirection(
+    startSpoke.GetSkeletalPoint(), startSpoke.GetDirection(),
+    endSpoke.GetSkeletalPoint(), endSpoke.GetDirection(),
+    lambda);
 }
 
 //----------------------------------------------------------------------------
-SRepInterpolateHelper::UVDerivative
+UVDerivative
 SRepInterpolateHelper::GetUVDerivativeFromOriginalLineStep(const LineStep& ols, SpokeType spokeType) {
   const auto& d = this->DerivativeOriginalGrid[ols.line][ols.step];
   if (spokeType == SpokeType::UpOrientation) {
@@ -585,12 +719,6 @@ SRepInterpolateHelper::GetUVDerivativeFromOriginalLineStep(const LineStep& ols,
   throw std::invalid_argument("Unknown spoke type");
 }
 
-//----------------------------------------------------------------------------
-double SRepInterpolateHelper::h1(double s) { return 2*(s * s * s) - 3*(s * s) + 1; }
-double SRepInterpolateHelper::h2(double s) { return -2*(s * s * s) + 3*(s * s); }
-double SRepInterpolateHelper::h3(double s) { return (s * s * s) - 2*(s * s) + s; }
-double SRepInterpolateHelper::h4(double s) { return (s * s * s) - (s * s); }
-
 //----------------------------------------------------------------------------
 srep::Point3d SRepInterpolateHelper::InterpolateMiddleSkeletalPointSkeletonPoint(
   const LineStep& start,
@@ -636,15 +764,6 @@ srep::Point3d SRepInterpolateHelper::InterpolateSkeletalPointSkeletonPoint(
   const auto dx12 = GetUVDerivativeFromOriginalLineStep(originalEnclosingQuad[2], spokeType);
   const auto dx22 = GetUVDerivativeFromOriginalLineStep(originalEnclosingQuad[3], spokeType);
 
-  const auto dxdu11 = dx11.u;
-  const auto dxdv11 = dx11.v;
-  const auto dxdu12 = dx12.u;
-  const auto dxdv12 = dx12.v;
-  const auto dxdu21 = dx21.u;
-  const auto dxdv21 = dx21.v;
-  const auto dxdu22 = dx22.u;
-  const auto dxdv22 = dx22.v;
-
   const auto oQuadLineLength = this->LinewiseDistance(interpolatedEnclosingQuad, this->InterpolatedGrid);
   const auto oQuadStepLength = this->StepwiseDistance(interpolatedEnclosingQuad, this->InterpolatedGrid);
 
@@ -654,86 +773,17 @@ srep::Point3d SRepInterpolateHelper::InterpolateSkeletalPointSkeletonPoint(
   const double u = oQuadLineLength > 0 ? static_cast<double>(startQuadToLocLineLength) / oQuadLineLength : 0.0;
   const double v = oQuadStepLength > 0 ? static_cast<double>(startQuadToLocStepLength) / oQuadStepLength : 0.0;
 
-  // this was pulled as is from original implementation
-  double hx[4][4];
-  double hy[4][4];
-  double hz[4][4];
-
-  hx[0][0] = x11[0];          hx[0][1] = x12[0];
-  hx[1][0] = x21[0];          hx[1][1] = x22[0];
-  hx[2][0] = dxdu11[0];       hx[2][1] = dxdu12[0];
-  hx[3][0] = dxdu21[0];       hx[3][1] = dxdu22[0];
-  hx[0][2] = dxdv11[0];       hx[0][3] = dxdv12[0];
-  hx[1][2] = dxdv21[0];       hx[1][3] = dxdv22[0];
-  hx[2][2] = 0;               hx[2][3] = 0;
-  hx[3][2] = 0;               hx[3][3] = 0;
-
-  hy[0][0] = x11[1];          hy[0][1] = x12[1];
-  hy[1][0] = x21[1];          hy[1][1] = x22[1];
-  hy[2][0] = dxdu11[1];       hy[2][1] = dxdu12[1];
-  hy[3][0] = dxdu21[1];       hy[3][1] = dxdu22[1];
-  hy[0][2] = dxdv11[1];       hy[0][3] = dxdv12[1];
-  hy[1][2] = dxdv21[1];       hy[1][3] = dxdv22[1];
-  hy[2][2] = 0;               hy[2][3] = 0;
-  hy[3][2] = 0;               hy[3][3] = 0;
-
-  hz[0][0] = x11[2];       hz[0][1] = x12[2];
-  hz[1][0] = x21[2];       hz[1][1] = x22[2];
-  hz[2][0] = dxdu11[2];    hz[2][1] = dxdu12[2];
-  hz[3][0] = dxdu21[2];    hz[3][1] = dxdu22[2];
-  hz[0][2] = dxdv11[2];    hz[0][3] = dxdv12[2];
-  hz[1][2] = dxdv21[2];    hz[1][3] = dxdv22[2];
-  hz[2][2] = 0;            hz[2][3] = 0;
-  hz[3][2] = 0;            hz[3][3] = 0;
-
-  double hu[4], hv[4];
-  hu[0] = h1(u);
-  hu[1] = h2(u);
-  hu[2] = h3(u);
-  hu[3] = h4(u);
-  hv[0] = h1(v);
-  hv[1] = h2(v);
-  hv[2] = h3(v);
-  hv[3] = h4(v);
-
-  // supposed computation is these
-  //    vnl_double_1x1 xn = hu.transpose() * hx * hv;
-  //    vnl_double_1x1 yn = hu.transpose() * hy * hv;
-  //    vnl_double_1x1 zn = hu.transpose() * hz * hv;
-  double huThx[4], huThy[4], huThz[4];
-  huThx[0] = hu[0] * hx[0][0] + hu[1] * hx[1][0] + hu[2] * hx[2][0] + hu[3] * hx[3][0];
-  huThx[1] = hu[0] * hx[0][1] + hu[1] * hx[1][1] + hu[2] * hx[2][1] + hu[3] * hx[3][1];
-  huThx[2] = hu[0] * hx[0][2] + hu[1] * hx[1][2] + hu[2] * hx[2][2] + hu[3] * hx[3][2];
-  huThx[3] = hu[0] * hx[0][3] + hu[1] * hx[1][3] + hu[2] * hx[2][3] + hu[3] * hx[3][3];
-
-  huThy[0] = hu[0] * hy[0][0] + hu[1] * hy[1][0] + hu[2] * hy[2][0] + hu[3] * hy[3][0];
-  huThy[1] = hu[0] * hy[0][1] + hu[1] * hy[1][1] + hu[2] * hy[2][1] + hu[3] * hy[3][1];
-  huThy[2] = hu[0] * hy[0][2] + hu[1] * hy[1][2] + hu[2] * hy[2][2] + hu[3] * hy[3][2];
-  huThy[3] = hu[0] * hy[0][3] + hu[1] * hy[1][3] + hu[2] * hy[2][3] + hu[3] * hy[3][3];
-
-  huThz[0] = hu[0] * hz[0][0] + hu[1] * hz[1][0] + hu[2] * hz[2][0] + hu[3] * hz[3][0];
-  huThz[1] = hu[0] * hz[0][1] + hu[1] * hz[1][1] + hu[2] * hz[2][1] + hu[3] * hz[3][1];
-  huThz[2] = hu[0] * hz[0][2] + hu[1] * hz[1][2] + hu[2] * hz[2][2] + hu[3] * hz[3][2];
-  huThz[3] = hu[0] * hz[0][3] + hu[1] * hz[1][3] + hu[2] * hz[2][3] + hu[3] * hz[3][3];
-
-  double output[3];
-  output[0] = huThx[0] * hv[0] + huThx[1] * hv[1] + huThx[2] * hv[2] + huThx[3] * hv[3];
-  output[1] = huThy[0] * hv[0] + huThy[1] * hv[1] + huThy[2] * hv[2] + huThy[3] * hv[3];
-  output[2] = huThz[0] * hv[0] + huThz[1] * hv[1] + huThz[2] * hv[2] + huThz[3] * hv[3];
-
-  return srep::Point3d(output);
+  return HermitePatch{{x11, x21, x12, x22}, {dx11, dx21, dx12, dx22}}.Evaluate(u, v);
 }
 
 //----------------------------------------------------------------------------
-SRepInterpolateHelper::Grid SRepInterpolateHelper::ToGrid(const vtkEllipticalSRep& srep) {
+SRepInterpolateHelper::GridView SRepInterpolateHelper::ToGridView(const vtkEllipticalSRep& srep) {
   using IndexType = vtkEllipticalSRep::IndexType;
 
-  Grid grid(srep.GetNumberOfLines(), std::vector<vtkSmartPointer<vtkSRepSkeletalPoint>>(srep.GetNumberOfSteps(), nullptr));
+  GridView grid(srep.GetNumberOfLines(), std::vector<const vtkSRepSkeletalPoint*>(srep.GetNumberOfSteps(), nullptr));
   for (IndexType l = 0; l < srep.GetNumberOfLines(); ++l) {
     for (IndexType s = 0; s < srep.GetNumberOfSteps(); ++s) {
-      // it would be better if we didn't deep copy the input, but that would require more refactoring
-      // this should be done sometime
-      grid[l][s] = srep.GetSkeletalPoint(l, s)->SmartClone();
+      grid[l][s] = srep.GetSkeletalPoint(l, s);
     }
   }
   return grid;
@@ -741,26 +791,9 @@ SRepInterpolateHelper::Grid SRepInterpolateHelper::ToGrid(const vtkEllipticalSRe
 
 //----------------------------------------------------------------------------
 vtkSmartPointer<vtkEllipticalSRep> SRepInterpolateHelper::FromGrid(Grid grid) {
-  using IndexType = vtkEllipticalSRep::IndexType;
-
-  auto srep = vtkSmartPointer<vtkEllipticalSRep>::New();
-  if (grid.size() == 0) {
-    return srep;
-  }
-
-  srep->Resize(grid.size(), grid.front().size());
-  for (IndexType l = 0; l < srep->GetNumberOfLines(); ++l) {
-    for (IndexType s = 0; s < srep->GetNumberOfSteps(); ++s) {
-      // it would be better if we didn't deep copy the input, but that would require more refactoring
-      // which should be done sometime
-      srep->SetSkeletalPoint(l, s, grid[l][s]);
-    }
-  }
-
-  return srep;
+  return vtkEllipticalSRep::SmartCreate(std::move(grid));
 }
 
-
 //----------------------------------------------------------------------------
 // Public functions
 //----------------------------------------------------------------------------
@@ -769,7 +802,7 @@ vtkSmartPointer<vtkEllipticalSRep> SRepInterpolateHelper::FromGrid(Grid grid) {
 SRepInterpolateHelper::SRepInterpolateHelper(size_t interpolationLevel, const vtkEllipticalSRep& srep)
   : InterpolationLevel(interpolationLevel)
   , Density(IntegerPower(2, InterpolationLevel))
-  , OriginalGrid(ToGrid(srep))
+  , OriginalGrid(ToGridView(srep))
   , InterpolatedGrid()
   , DerivativeOriginalGrid(this->ComputeDerivatives(this->OriginalGrid))
 {
@@ -802,14 +835,15 @@ vtkSmartPointer<vtkEllipticalSRep> SRepInterpolateHelper::interpolate() {
   const auto originalQuads = GetOrientedQuads(this->OriginalGrid);
 
   ///////////////////////////////////////////////
-  // Copy original quads
+  // Copy original points
   ///////////////////////////////////////////////
   // copy over the actual skeletal points that don't need to be
-  // interpolated
-  for (const auto& quad : originalQuads) {
-    for (const auto& ols : quad) {
-      const auto ils = this->OriginalLineStepToInterpolatedLineStep(ols);
-      this->InterpolatedGrid[ils.line][ils.step] = this->OriginalGrid[ols.line][ols.step];
+  // interpolated. This is the only copy made of the input, and it is needed
+  // because the output can't share skeletal points with the input.
+  for (size_t line = 0; line < this->OriginalGrid.size(); ++line) {
+    for (size_t step = 0; step < this->OriginalGrid[line].size(); ++step) {
+      const auto ils = this->OriginalLineStepToInterpolatedLineStep(LineStep(line, step));
+      this->InterpolatedGrid[ils.line][ils.step] = this->OriginalGrid[line][step]->SmartClone();
     }
   }
 
@@ -826,4 +860,399 @@ vtkSmartPointer<vtkEllipticalSRep> SRepInterpolateHelper::interpolate() {
 
 
 } //namespace detail
+
+namespace {
+//----------------------------------------------------------------------------
+// Spoke at a corner of a cell while descending through the subdivision in SRepEvaluator.
+// u and v are the location of the spoke within the original quad.
+struct EvaluatorNode {
+  srep::Point3d skeletalPoint;
+  srep::Vector3d direction;
+  double u;
+  double v;
+};
+
+//----------------------------------------------------------------------------
+EvaluatorNode MiddleNode(const HermitePatch& patch, const EvaluatorNode& start, const EvaluatorNode& end, double lambda) {
+  const double u = (start.u + end.u) / 2;
+  const double v = (start.v + end.v) / 2;
+  return EvaluatorNode{
+    patch.Evaluate(u, v),
+    InterpolateMiddleSpokeDirection(start.skeletalPoint, start.direction, end.skeletalPoint, end.direction, lambda),
+    u,
+    v
+  };
+}
+
+//----------------------------------------------------------------------------
+// Blends spoke directions by blending the unit directions and the radii separately so
+// the radius doesn't shrink between two spokes pointing different ways.
+srep::Vector3d BlendDirections(const std::vector<std::pair<srep::Vector3d, double>>& weightedDirections) {
+  srep::Vector3d unitSum;
+  double radius = 0.0;
+  for (const auto& wd : weightedDirections) {
+    const double length = wd.first.GetLength();
+    if (length > 0) {
+      unitSum = unitSum + wd.first.Unit() * wd.second;
+    }
+    radius += length * wd.second;
+  }
+  if (unitSum.GetLength() == 0) {
+    return unitSum;
+  }
+  return unitSum.Unit() * radius;
+}
+
+//----------------------------------------------------------------------------
+// Follows the subdivision along the edge from start to end. The subdivision of an edge only
+// depends on the two ends of the edge, so this is the same regardless of which quad the edge is in.
+// s is the location along the edge in [0, 1].
+srep::Vector3d RefineEdgeDirection(
+  const HermitePatch& patch,
+  EvaluatorNode start,
+  EvaluatorNode end,
+  double s,
+  double lambda,
+  size_t levels)
+{
+  while (true) {
+    if (s == 0.0) {
+      return start.direction;
+    }
+    if (s == 1.0) {
+      return end.direction;
+    }
+    if (levels == 0) {
+      return BlendDirections({{start.direction, 1.0 - s}, {end.direction, s}});
+    }
+    auto middle = MiddleNode(patch, start, end, lambda);
+    // multiplying by 2 is exact, so locations that are on the interpolation grid stay on it
+    if (s < 0.5) {
+      end = std::move(middle);
+      s = s * 2;
+    } else {
+      start = std::move(middle);
+      s = s * 2 - 1;
+    }
+    lambda /= 2;
+    --levels;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Follows the subdivision from SRepInterpolateHelper::InterpolateQuad down to the cell containing (s, t).
+// Quad corners and connectivity are as from GetOrientedQuads
+// 0 - 1
+// |   |
+// 2 - 3
+srep::Vector3d RefineQuadDirection(
+  const HermitePatch& patch,
+  std::array<EvaluatorNode, 4> quad,
+  double s,
+  double t,
+  size_t levels)
+{
+  double lambda = 1.0;
+  while (true) {
+    // on an edge of the cell, only the edge matters
+    if (t == 0.0) {
+      return RefineEdgeDirection(patch, quad[0], quad[1], s, lambda, levels);
+    }
+    if (t == 1.0) {
+      return RefineEdgeDirection(patch, quad[2], quad[3], s, lambda, levels);
+    }
+    if (s == 0.0) {
+      return RefineEdgeDirection(patch, quad[0], quad[2], t, lambda, levels);
+    }
+    if (s == 1.0) {
+      return RefineEdgeDirection(patch, quad[1], quad[3], t, lambda, levels);
+    }
+    if (levels == 0) {
+      return BlendDirections({
+        {quad[0].direction, (1.0 - s) * (1.0 - t)},
+        {quad[1].direction, s * (1.0 - t)},
+        {quad[2].direction, (1.0 - s) * t},
+        {quad[3].direction, s * t}});
+    }
+
+    const auto tm = MiddleNode(patch, quad[0], quad[1], lambda);
+    const auto lm = MiddleNode(patch, quad[0], quad[2], lambda);
+    const auto rm = MiddleNode(patch, quad[1], quad[3], lambda);
+    const auto bm = MiddleNode(patch, quad[2], quad[3], lambda);
+    // for the very center interpolate off of two directions and average
+    const auto mmLeftRight = MiddleNode(patch, lm, rm, lambda);
+    const auto mmTopBottom = MiddleNode(patch, tm, bm, lambda);
+    const EvaluatorNode mm{
+      mmLeftRight.skeletalPoint,
+      (mmLeftRight.direction + mmTopBottom.direction) / 2,
+      mmLeftRight.u,
+      mmLeftRight.v
+    };
+
+    const bool left = s < 0.5;
+    const bool top = t < 0.5;
+    if (top && left) {
+      quad = {quad[0], tm, lm, mm};
+    } else if (top) {
+      quad = {tm, quad[1], mm, rm};
+    } else if (left) {
+      quad = {lm, mm, quad[2], bm};
+    } else {
+      quad = {mm, rm, bm, quad[3]};
+    }
+    s = left ? s * 2 : s * 2 - 1;
+    t = top ? t * 2 : t * 2 - 1;
+    lambda /= 2;
+    --levels;
+  }
+}
+
+} // namespace {}
+
+//----------------------------------------------------------------------------
+SRepEvaluator::SRepEvaluator(const vtkEllipticalSRep& srep, size_t maxSubdivisionLevel)
+  : NumberOfLines(srep.GetNumberOfLines())
+  , NumberOfSteps(srep.GetNumberOfSteps())
+  , MaxSubdivisionLevel(maxSubdivisionLevel)
+  , UpSpokes()
+  , DownSpokes()
+  , CrestSpokes()
+{
+  if (srep.IsEmpty()) {
+    throw std::invalid_argument("Can't evaluate empty srep");
+  }
+  if (this->NumberOfSteps < 2) {
+    throw std::invalid_argument("Can't evaluate srep with fewer than 2 steps");
+  }
+
+  const auto numberOfPoints = static_cast<size_t>(this->NumberOfLines * this->NumberOfSteps);
+  this->UpSpokes.reserve(numberOfPoints);
+  this->DownSpokes.reserve(numberOfPoints);
+  this->CrestSpokes.reserve(this->NumberOfLines);
+  for (IndexType line = 0; line < this->NumberOfLines; ++line) {
+    for (IndexType step = 0; step < this->NumberOfSteps; ++step) {
+      const auto* skeletalPoint = srep.GetSkeletalPoint(line, step);
+      const auto* up = skeletalPoint->GetUpSpoke();
+      const auto* down = skeletalPoint->GetDownSpoke();
+      this->UpSpokes.push_back(OriginalSpoke{up->GetSkeletalPoint(), up->GetDirection(), detail::UVDerivative{}});
+      this->DownSpokes.push_back(OriginalSpoke{down->GetSkeletalPoint(), down->GetDirection(), detail::UVDerivative{}});
+    }
+  }
+
+  // same finite differences as SRepInterpolateHelper::ComputeDerivative
+  const auto computeDerivatives = [this](std::vector<OriginalSpoke>& spokes) {
+    const auto at = [&](IndexType line, IndexType step) -> const srep::Point3d& {
+      return spokes[line * this->NumberOfSteps + step].skeletalPoint;
+    };
+    for (IndexType line = 0; line < this->NumberOfLines; ++line) {
+      const auto prevLine = (line + this->NumberOfLines - 1) % this->NumberOfLines;
+      const auto nextLine = (line + 1) % this->NumberOfLines;
+      for (IndexType step = 0; step < this->NumberOfSteps; ++step) {
+        auto& d = spokes[line * this->NumberOfSteps + step].derivative;
+        d.u = srep::Vector3d(at(prevLine, step), at(nextLine, step)) / 2;
+        if (step == 0) {
+          d.v = srep::Vector3d(at(line, step), at(line, step + 1));
+        } else if (step == this->NumberOfSteps - 1) {
+          d.v = srep::Vector3d(at(line, step - 1), at(line, step));
+        } else {
+          d.v = srep::Vector3d(at(line, step - 1), at(line, step + 1)) / 2;
+        }
+      }
+    }
+  };
+  computeDerivatives(this->UpSpokes);
+  computeDerivatives(this->DownSpokes);
+
+  const auto crestStep = this->NumberOfSteps - 1;
+  for (IndexType line = 0; line < this->NumberOfLines; ++line) {
+    const auto* crest = srep.GetSkeletalPoint(line, crestStep)->GetCrestSpoke();
+    const auto& up = this->GetOriginalSpoke(line, crestStep, SpokeType::UpOrientation);
+    const auto& down = this->GetOriginalSpoke(line, crestStep, SpokeType::DownOrientation);
+    //average of up and down
+    detail::UVDerivative d;
+    d.u = (up.derivative.u + down.derivative.u) / 2;
+    d.v = (up.derivative.v + down.derivative.v) / 2;
+    this->CrestSpokes.push_back(OriginalSpoke{crest->GetSkeletalPoint(), crest->GetDirection(), d});
+  }
+}
+
+//----------------------------------------------------------------------------
+SRepEvaluator::IndexType SRepEvaluator::GetNumberOfLines() const {
+  return this->NumberOfLines;
+}
+
+//----------------------------------------------------------------------------
+SRepEvaluator::IndexType SRepEvaluator::GetNumberOfSteps() const {
+  return this->NumberOfSteps;
+}
+
+//----------------------------------------------------------------------------
+size_t SRepEvaluator::GetMaxSubdivisionLevel() const {
+  return this->MaxSubdivisionLevel;
+}
+
+//----------------------------------------------------------------------------
+bool SRepEvaluator::IsCrestStep(double step) const {
+  return step == static_cast<double>(this->NumberOfSteps - 1);
+}
+
+//----------------------------------------------------------------------------
+const SRepEvaluator::OriginalSpoke&
+SRepEvaluator::GetOriginalSpoke(IndexType line, IndexType step, SpokeType spokeType) const {
+  if (spokeType == SpokeType::UpOrientation) {
+    return this->UpSpokes[line * this->NumberOfSteps + step];
+  } else if (spokeType == SpokeType::DownOrientation) {
+    return this->DownSpokes[line * this->NumberOfSteps + step];
+  } else if (spokeType == SpokeType::CrestOrientation) {
+    return this->CrestSpokes[line];
+  }
+  throw std::invalid_argument("Unknown spoke type");
+}
+
+//----------------------------------------------------------------------------
+SRepEvaluator::SpokeValue
+SRepEvaluator::EvaluateSpokeInQuad(IndexType line, IndexType step, double u, double v, SpokeType spokeType) const {
+  const auto nextLine = (line + 1) % this->NumberOfLines;
+  const auto makeNode = [](const OriginalSpoke& spoke, double nodeU, double nodeV) {
+    return EvaluatorNode{spoke.skeletalPoint, spoke.direction, nodeU, nodeV};
+  };
+
+  if (spokeType == SpokeType::CrestOrientation) {
+    // same degenerate quad as SRepInterpolateHelper uses, the crest is just a line
+    const auto& c0 = this->GetOriginalSpoke(line, step, spokeType);
+    const auto& c1 = this->GetOriginalSpoke(nextLine, step, spokeType);
+    const HermitePatch patch{
+      {c0.skeletalPoint, c1.skeletalPoint, c0.skeletalPoint, c1.skeletalPoint},
+      {c0.derivative, c1.derivative, c0.derivative, c1.derivative}};
+    return SpokeValue{
+      patch.Evaluate(u, 0.0),
+      RefineEdgeDirection(patch, makeNode(c0, 0.0, 0.0), makeNode(c1, 1.0, 0.0), u, 1.0, this->MaxSubdivisionLevel)
+    };
+  }
+
+  const auto& x11 = this->GetOriginalSpoke(line, step, spokeType);
+  const auto& x21 = this->GetOriginalSpoke(nextLine, step, spokeType);
+  const auto& x12 = this->GetOriginalSpoke(line, step + 1, spokeType);
+  const auto& x22 = this->GetOriginalSpoke(nextLine, step + 1, spokeType);
+  const HermitePatch patch{
+    {x11.skeletalPoint, x21.skeletalPoint, x12.skeletalPoint, x22.skeletalPoint},
+    {x11.derivative, x21.derivative, x12.derivative, x22.derivative}};
+  const std::array<EvaluatorNode, 4> quad{{
+    makeNode(x11, 0.0, 0.0),
+    makeNode(x21, 1.0, 0.0),
+    makeNode(x12, 0.0, 1.0),
+    makeNode(x22, 1.0, 1.0)}};
+  return SpokeValue{
+    patch.Evaluate(u, v),
+    RefineQuadDirection(patch, quad, u, v, this->MaxSubdivisionLevel)
+  };
+}
+
+//----------------------------------------------------------------------------
+SRepEvaluator::SpokeValue SRepEvaluator::EvaluateSpoke(double line, double step, SpokeType spokeType) const {
+  if (!(0.0 <= step && step <= static_cast<double>(this->NumberOfSteps - 1))) {
+    throw std::out_of_range("Step " + std::to_string(step) + " is outside of range [0, "
+      + std::to_string(this->NumberOfSteps - 1) + "]");
+  }
+  if (spokeType == SpokeType::CrestOrientation && !this->IsCrestStep(step)) {
+    throw std::invalid_argument("Cannot evaluate a crest spoke at non-crest step " + std::to_string(step));
+  }
+  if (!std::isfinite(line)) {
+    throw std::invalid_argument("Line must be finite");
+  }
+
+  // lines wrap around
+  double wrappedLine = std::fmod(line, static_cast<double>(this->NumberOfLines));
+  if (wrappedLine < 0) {
+    wrappedLine += this->NumberOfLines;
+  }
+  auto lineIndex = static_cast<IndexType>(std::floor(wrappedLine));
+  const double u = wrappedLine - lineIndex;
+  lineIndex = lineIndex % this->NumberOfLines;
+
+  if (spokeType == SpokeType::CrestOrientation) {
+    return this->EvaluateSpokeInQuad(lineIndex, this->NumberOfSteps - 1, u, 0.0, spokeType);
+  }
+
+  // the last step belongs to the last quad
+  const auto stepIndex = std::min(static_cast<IndexType>(std::floor(step)), this->NumberOfSteps - 2);
+  const double v = step - stepIndex;
+  return this->EvaluateSpokeInQuad(lineIndex, stepIndex, u, v, spokeType);
+}
+
+//----------------------------------------------------------------------------
+std::vector<SRepEvaluator::SpokeValue>
+SRepEvaluator::EvaluateSpokes(const std::vector<Location>& locations, SpokeType spokeType) const {
+  std::vector<SpokeValue> spokes;
+  this->EvaluateSpokes(locations, spokeType, spokes);
+  return spokes;
+}
+
+//----------------------------------------------------------------------------
+void SRepEvaluator::EvaluateSpokes(
+  const std::vector<Location>& locations,
+  SpokeType spokeType,
+  std::vector<SpokeValue>& spokes) const
+{
+  spokes.clear();
+  spokes.reserve(locations.size());
+  for (const auto& location : locations) {
+    spokes.push_back(this->EvaluateSpoke(location.line, location.step, spokeType));
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkSRepSkeletalPoint* SRepEvaluator::EvaluateSkeletalPoint(double line, double step) const {
+  auto ret = this->SmartEvaluateSkeletalPoint(line, step);
+  if (ret) {
+    ret->Register(nullptr);
+  }
+  return ret;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkSRepSkeletalPoint> SRepEvaluator::SmartEvaluateSkeletalPoint(double line, double step) const {
+  const auto toSpoke = [](const SpokeValue& value) {
+    return vtkSRepSpoke::SmartCreate(value.skeletalPoint, value.direction);
+  };
+  const auto up = toSpoke(this->EvaluateSpoke(line, step, SpokeType::UpOrientation));
+  const auto down = toSpoke(this->EvaluateSpoke(line, step, SpokeType::DownOrientation));
+  if (this->IsCrestStep(step)) {
+    return vtkSRepSkeletalPoint::SmartCreate(up, down, toSpoke(this->EvaluateSpoke(line, step, SpokeType::CrestOrientation)));
+  }
+  return vtkSRepSkeletalPoint::SmartCreate(up, down);
+}
+
+//----------------------------------------------------------------------------
+vtkEllipticalSRep* SRepEvaluator::Sample(IndexType numberOfLines, IndexType numberOfSteps) const {
+  auto ret = this->SmartSample(numberOfLines, numberOfSteps);
+  if (ret) {
+    ret->Register(nullptr);
+  }
+  return ret;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkEllipticalSRep> SRepEvaluator::SmartSample(IndexType numberOfLines, IndexType numberOfSteps) const {
+  if (numberOfLines < 1) {
+    throw std::invalid_argument("Sampled srep must have at least 1 line");
+  }
+  if (numberOfSteps < 2) {
+    throw std::invalid_argument("Sampled srep must have at least 2 steps");
+  }
+
+  const double lineScale = static_cast<double>(this->NumberOfLines) / numberOfLines;
+  const double stepScale = static_cast<double>(this->NumberOfSteps - 1) / (numberOfSteps - 1);
+  vtkEllipticalSRep::UnrolledEllipticalGrid skeleton(numberOfLines);
+  for (IndexType l = 0; l < numberOfLines; ++l) {
+    skeleton[l].reserve(numberOfSteps);
+    for (IndexType s = 0; s < numberOfSteps; ++s) {
+      // make sure the last step lands exactly on the crest
+      const double step = s == numberOfSteps - 1 ? static_cast<double>(this->NumberOfSteps - 1) : s * stepScale;
+      skeleton[l].push_back(this->SmartEvaluateSkeletalPoint(l * lineScale, step));
+    }
+  }
+  return vtkEllipticalSRep::SmartCreate(std::move(skeleton));
+}
+
 } //namespace sreplogic
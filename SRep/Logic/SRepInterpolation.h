@@ -20,12 +20,20 @@
 
 #include <cstdlib>
 #include <memory>
+#include <vector>
 #include <vtkEllipticalSRep.h>
 
+#include "vtkSlicerSRepModuleLogicExport.h"
+
 namespace sreplogic {
 
 namespace detail {
 
+struct UVDerivative {
+  srep::Vector3d u;
+  srep::Vector3d v;
+};
+
 struct LineStep {
   size_t line;
   size_t step;
@@ -57,16 +65,13 @@ public:
   vtkSmartPointer<vtkEllipticalSRep> interpolate();
 
 private:
-  using Grid = std::vector<std::vector<vtkSmartPointer<vtkSRepSkeletalPoint>>>;
+  using Grid = vtkEllipticalSRep::UnrolledEllipticalGrid;
+  /// Read-only view of the skeletal points of the srep being interpolated. No copies are made.
+  using GridView = std::vector<std::vector<const vtkSRepSkeletalPoint*>>;
   using Quad = std::array<LineStep, 4>;
   using OptionalLineStep = std::pair<LineStep, bool>;
   using SpokeType = vtkSRepSkeletalPoint::SpokeOrientation;
 
-  struct UVDerivative {
-    srep::Vector3d u;
-    srep::Vector3d v;
-  };
-
   struct SkeletalPointDerivative {
     UVDerivative up;
     UVDerivative down;
@@ -74,39 +79,32 @@ private:
 
   using DerivativeGridType = std::vector<std::vector<SkeletalPointDerivative>>;
 
-  static Grid ToGrid(const vtkEllipticalSRep& srep);
+  static GridView ToGridView(const vtkEllipticalSRep& srep);
   static vtkSmartPointer<vtkEllipticalSRep> FromGrid(Grid grid);
 
-  static std::vector<Quad> GetOrientedQuads(const Grid& grid);
+  static std::vector<Quad> GetOrientedQuads(const GridView& grid);
 
   static vtkSRepSpoke& GetSpoke(const Grid& grid, const LineStep& loc, SpokeType spokeType);
+  static const vtkSRepSpoke& GetSpoke(const GridView& grid, const LineStep& loc, SpokeType spokeType);
   vtkSRepSpoke& GetInterpolatedSpoke(const LineStep& loc, SpokeType spokeType);
   vtkSRepSkeletalPoint& GetInterpolatedSkeletalPoint(const LineStep& loc);
 
   //----------------------------------------------------------------------------
   // Computing grid derivatives
-  static srep::Vector3d ComputeLinewiseDerivative(const Grid& grid, const LineStep& loc, SpokeType spokeType);
-  static srep::Vector3d ComputeStepwiseDerivative(const Grid& grid, const LineStep& loc, SpokeType spokeType);
+  static srep::Vector3d ComputeLinewiseDerivative(const GridView& grid, const LineStep& loc, SpokeType spokeType);
+  static srep::Vector3d ComputeStepwiseDerivative(const GridView& grid, const LineStep& loc, SpokeType spokeType);
   static srep::Vector3d ComputeDerivative(
-    const Grid& grid,
+    const GridView& grid,
     const LineStep& loc,
     const OptionalLineStep& lesserNeighbor,
     const OptionalLineStep& greaterNeighbor,
     SpokeType spokeType);
 
-  static SkeletalPointDerivative ComputeDerivative(const Grid& grid, const LineStep& loc);
-  static DerivativeGridType ComputeDerivatives(const Grid& grid);
+  static SkeletalPointDerivative ComputeDerivative(const GridView& grid, const LineStep& loc);
+  static DerivativeGridType ComputeDerivatives(const GridView& grid);
 
   //----------------------------------------------------------------------------
   // Interpolation
-  /// @param u value between 0 and 1 that is kind of a weighting between the two vectors
-  static srep::Vector3d Slerp(const srep::Vector3d& v1, const srep::Vector3d& v2, const double u);
-  static srep::Vector3d Compute2ndDerivative(
-    const srep::Vector3d& startVector,
-    const srep::Vector3d& endVector,
-    const srep::Vector3d& targetVector,
-    const double d);
-
   LineStep OriginalLineStepToInterpolatedLineStep(const LineStep& ols);
   Quad OriginalQuadToInterpolatedQuad(const Quad& oQuad);
   static size_t LinewiseDistance(const Quad& quad, const Grid& grid);
@@ -156,13 +154,6 @@ private:
 
   //----------------------------------------------------------------------------
   // Interpolation of Skeletal point Skeleton point
-
-  // I don't know the purpose or reasoning behind these functions
-  static double h1(double s);
-  static double h2(double s);
-  static double h3(double s);
-  static double h4(double s);
-
   srep::Point3d InterpolateMiddleSkeletalPointSkeletonPoint(
     const LineStep& start,
     const LineStep& end,
@@ -179,7 +170,7 @@ private:
   // Members
   const size_t InterpolationLevel;
   const size_t Density;
-  const Grid OriginalGrid;
+  const GridView OriginalGrid;
   Grid InterpolatedGrid;
   DerivativeGridType DerivativeOriginalGrid;
 };
@@ -188,6 +179,106 @@ private:
 VTK_NEWINSTANCE vtkEllipticalSRep* InterpolateSRep(size_t interpolationLevel, const vtkEllipticalSRep& srep);
 vtkSmartPointer<vtkEllipticalSRep> SmartInterpolateSRep(size_t interpolationLevel, const vtkEllipticalSRep& srep);
 
+/// Evaluates the interpolated s-rep at arbitrary continuous (line, step) locations
+/// without building the dense interpolated grid.
+///
+/// Locations are in the coordinates of the original s-rep. A line of 2.5 is halfway between
+/// lines 2 and 3 (lines wrap around) and a step of 1.25 is a quarter of the way from step 1 to
+/// step 2. At the locations SmartInterpolateSRep produces (multiples of 1/2^level) the results
+/// match it. The skeletal point is the same Hermite patch everywhere, and the spoke direction is
+/// refined along the same subdivision down to the max subdivision level, then blended bilinearly.
+///
+/// The evaluator takes a copy of the s-rep's values on construction. Later changes to the s-rep
+/// are not seen, and the s-rep is free to go away.
+class VTK_SLICER_SREP_MODULE_LOGIC_EXPORT SRepEvaluator {
+public:
+  using IndexType = vtkEllipticalSRep::IndexType;
+  using SpokeType = vtkSRepSkeletalPoint::SpokeOrientation;
+
+  /// A continuous location on the original s-rep.
+  struct Location {
+    double line;
+    double step;
+  };
+
+  /// An evaluated spoke.
+  struct SpokeValue {
+    srep::Point3d skeletalPoint;
+    srep::Vector3d direction;
+  };
+
+  static constexpr size_t DefaultMaxSubdivisionLevel = 6;
+
+  /// \param srep The s-rep to evaluate.
+  /// \param maxSubdivisionLevel How many levels of subdivision to follow before blending spoke directions.
+  ///        Locations that are multiples of 1/2^maxSubdivisionLevel are exact.
+  /// \throws std::invalid_argument if the srep is empty or has fewer than two steps.
+  explicit SRepEvaluator(const vtkEllipticalSRep& srep, size_t maxSubdivisionLevel = DefaultMaxSubdivisionLevel);
+
+  SRepEvaluator(const SRepEvaluator&) = default;
+  SRepEvaluator& operator=(const SRepEvaluator&) = default;
+  SRepEvaluator(SRepEvaluator&&) = default;
+  SRepEvaluator& operator=(SRepEvaluator&&) = default;
+  ~SRepEvaluator() = default;
+
+  /// Gets the number of lines in the original s-rep.
+  IndexType GetNumberOfLines() const;
+  /// Gets the number of steps in the original s-rep.
+  IndexType GetNumberOfSteps() const;
+  size_t GetMaxSubdivisionLevel() const;
+
+  /// Returns true if the step is on the crest. Only a step of GetNumberOfSteps()-1 is on the crest.
+  bool IsCrestStep(double step) const;
+
+  /// Evaluates a single spoke.
+  /// \throws std::out_of_range if step is outside of [0, GetNumberOfSteps()-1].
+  /// \throws std::invalid_argument if a crest spoke is requested off of the crest.
+  SpokeValue EvaluateSpoke(double line, double step, SpokeType spokeType) const;
+
+  /// @{
+  /// Evaluates a batch of spokes of the same orientation.
+  /// \throws Same as EvaluateSpoke.
+  std::vector<SpokeValue> EvaluateSpokes(const std::vector<Location>& locations, SpokeType spokeType) const;
+  void EvaluateSpokes(const std::vector<Location>& locations, SpokeType spokeType, std::vector<SpokeValue>& spokes) const;
+  /// @}
+
+  /// @{
+  /// Evaluates the skeletal point at the location. It has a crest spoke if and only if IsCrestStep(step).
+  /// \throws std::out_of_range if step is outside of [0, GetNumberOfSteps()-1].
+  VTK_NEWINSTANCE vtkSRepSkeletalPoint* EvaluateSkeletalPoint(double line, double step) const;
+  vtkSmartPointer<vtkSRepSkeletalPoint> SmartEvaluateSkeletalPoint(double line, double step) const;
+  /// @}
+
+  /// @{
+  /// Samples a new s-rep with evenly spaced lines and steps. Unlike InterpolateSRep, the
+  /// density does not need to be a power of two.
+  /// \param numberOfLines Number of lines in the result. Must be positive.
+  /// \param numberOfSteps Number of steps in the result, spine and crest included. Must be at least 2.
+  /// \throws std::invalid_argument if numberOfLines or numberOfSteps is too small.
+  VTK_NEWINSTANCE vtkEllipticalSRep* Sample(IndexType numberOfLines, IndexType numberOfSteps) const;
+  vtkSmartPointer<vtkEllipticalSRep> SmartSample(IndexType numberOfLines, IndexType numberOfSteps) const;
+  /// @}
+
+private:
+  struct OriginalSpoke {
+    srep::Point3d skeletalPoint;
+    srep::Vector3d direction;
+    detail::UVDerivative derivative;
+  };
+
+  const OriginalSpoke& GetOriginalSpoke(IndexType line, IndexType step, SpokeType spokeType) const;
+  SpokeValue EvaluateSpokeInQuad(IndexType line, IndexType step, double u, double v, SpokeType spokeType) const;
+
+  IndexType NumberOfLines;
+  IndexType NumberOfSteps;
+  size_t MaxSubdivisionLevel;
+  // [line * NumberOfSteps + step]
+  std::vector<OriginalSpoke> UpSpokes;
+  std::vector<OriginalSpoke> DownSpokes;
+  // [line]
+  std::vector<OriginalSpoke> CrestSpokes;
+};
+
 }
 
 #endif
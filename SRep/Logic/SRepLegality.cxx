@@ -0,0 +1,242 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "SRepLegality.h"
+
+#include <vtkNew.h>
+#include <vtkSMPTools.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+namespace {
+
+using IndexType = sreplogic::SRepLegalityReport::IndexType;
+using SpokeId = sreplogic::SRepLegalityReport::SpokeId;
+using SpokeType = sreplogic::SRepLegalityReport::SpokeType;
+using SpokeCrossing = sreplogic::SRepLegalityReport::SpokeCrossing;
+using Vec = std::array<double, 3>;
+
+const std::array<SpokeType, 3> AllSpokeTypes{
+  vtkSRepSkeletalPoint::UpOrientation,
+  vtkSRepSkeletalPoint::DownOrientation,
+  vtkSRepSkeletalPoint::CrestOrientation
+};
+
+//----------------------------------------------------------------------------
+bool IdLess(const SpokeId& a, const SpokeId& b) {
+  return std::tie(a.Orientation, a.Index) < std::tie(b.Orientation, b.Index);
+}
+
+//----------------------------------------------------------------------------
+double Dot(const Vec& a, const Vec& b) {
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+//----------------------------------------------------------------------------
+Vec At(const std::vector<double>& packed, size_t i) {
+  return Vec{packed[3 * i], packed[3 * i + 1], packed[3 * i + 2]};
+}
+
+//----------------------------------------------------------------------------
+// Finds every spoke after `query` in id order that crosses it
+void FindCrossings(
+  const vtkSRepSpatialIndex& index,
+  const vtkSRepSpoke& spoke,
+  const SpokeId& query,
+  const std::array<const vtkSRepSpokeMesh*, 3>& meshes,
+  double tolerance,
+  std::vector<SpokeCrossing>& crossings)
+{
+  const auto hits = index.FindSpokesNearSegment(spoke.GetSkeletalPoint(), spoke.GetBoundaryPoint(), tolerance);
+  for (const auto& hit : hits) {
+    if (!IdLess(query, hit.Spoke)) {
+      continue;
+    }
+    const auto& other = *meshes[hit.Spoke.Orientation]->At(hit.Spoke.Index);
+
+    // spokes of the same skeletal point (up/down/crest) always touch
+    if (srep::Vector3d(spoke.GetSkeletalPoint(), other.GetSkeletalPoint()).GetLength() <= tolerance) {
+      continue;
+    }
+    // spokes that only come together at their skeletal points or at their boundary points touch, but don't cross
+    const bool atSkeleton = hit.QueryParameter * spoke.GetRadius() <= tolerance
+      && hit.SpokeParameter * other.GetRadius() <= tolerance;
+    const bool atBoundary = (1 - hit.QueryParameter) * spoke.GetRadius() <= tolerance
+      && (1 - hit.SpokeParameter) * other.GetRadius() <= tolerance;
+    if (atSkeleton || atBoundary) {
+      continue;
+    }
+    crossings.push_back(SpokeCrossing{query, hit.Spoke, hit.Distance, hit.QueryParameter, hit.SpokeParameter});
+  }
+}
+
+//----------------------------------------------------------------------------
+// Largest eigenvalue of the rSrad matrix for the spoke at (line, step), or nan if it can't be computed.
+//
+// With S = rU, p the skeletal point, and derivatives d/du (across lines) and d/dv (across steps), the rows
+// of L = dS - dr U and Q = dp (I - UU^T) are related by L = -rSrad Q. Solving in the least squares sense gives
+// rSrad = -L Q^T (QQ^T)^-1. The finite difference step sizes cancel out, so they are left out.
+double MaxRSradEigenvalue(
+  const vtkEllipticalSRep::SpokeArrays& spokes,
+  IndexType numLines,
+  IndexType numSteps,
+  IndexType line,
+  IndexType step)
+{
+  const auto index = [numSteps](IndexType l, IndexType s) { return static_cast<size_t>(l * numSteps + s); };
+
+  const auto i = index(line, step);
+  const Vec U = At(spokes.Directions, i);
+
+  const auto rows = [&](size_t before, size_t after, Vec& L, Vec& Q) {
+    const Vec p1 = At(spokes.SkeletalPoints, before);
+    const Vec p2 = At(spokes.SkeletalPoints, after);
+    const Vec u1 = At(spokes.Directions, before);
+    const Vec u2 = At(spokes.Directions, after);
+    const double r1 = spokes.Radii[before];
+    const double r2 = spokes.Radii[after];
+    const double dr = r2 - r1;
+
+    Vec dp;
+    for (int k = 0; k < 3; ++k) {
+      dp[k] = p2[k] - p1[k];
+      L[k] = (r2 * u2[k] - r1 * u1[k]) - dr * U[k];
+    }
+    const double dpU = Dot(dp, U);
+    for (int k = 0; k < 3; ++k) {
+      Q[k] = dp[k] - dpU * U[k];
+    }
+  };
+
+  Vec Lu, Qu, Lv, Qv;
+  rows(index((line + numLines - 1) % numLines, step), index((line + 1) % numLines, step), Lu, Qu);
+  rows(index(line, step == 0 ? 0 : step - 1), index(line, step == numSteps - 1 ? step : step + 1), Lv, Qv);
+
+  // (QQ^T)^-1
+  const double a = Dot(Qu, Qu);
+  const double b = Dot(Qu, Qv);
+  const double d = Dot(Qv, Qv);
+  const double det = a * d - b * b;
+  if (!(det > 1e-12 * a * d) || a == 0 || d == 0) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+
+  // LQ^T
+  const double m00 = Dot(Lu, Qu);
+  const double m01 = Dot(Lu, Qv);
+  const double m10 = Dot(Lv, Qu);
+  const double m11 = Dot(Lv, Qv);
+
+  // rSrad = -(LQ^T)(QQ^T)^-1
+  const double r00 = -(m00 * d - m01 * b) / det;
+  const double r01 = -(m01 * a - m00 * b) / det;
+  const double r10 = -(m10 * d - m11 * b) / det;
+  const double r11 = -(m11 * a - m10 * b) / det;
+
+  const double halfTrace = (r00 + r11) / 2;
+  const double discriminant = halfTrace * halfTrace - (r00 * r11 - r01 * r10);
+  return discriminant > 0 ? halfTrace + std::sqrt(discriminant) : halfTrace;
+}
+
+} // namespace {}
+
+namespace sreplogic {
+
+//----------------------------------------------------------------------------
+bool SRepLegalityReport::IsLegal() const {
+  return this->crossings.empty() && this->rSradViolations.empty();
+}
+
+//----------------------------------------------------------------------------
+SRepLegalityReport CheckSRepLegality(const vtkEllipticalSRep& srep, double crossingTolerance, double rSradThreshold) {
+  if (!(crossingTolerance >= 0)) {
+    throw std::invalid_argument("Crossing tolerance must be non-negative, got " + std::to_string(crossingTolerance));
+  }
+  if (std::isnan(rSradThreshold)) {
+    throw std::invalid_argument("rSrad threshold must not be nan");
+  }
+
+  SRepLegalityReport report;
+  if (srep.IsEmpty()) {
+    return report;
+  }
+
+  // crossings
+  {
+    vtkNew<vtkSRepSpatialIndex> index;
+    index->SetSRep(&srep);
+    // build before going parallel so the queries only ever read
+    index->BuildIfNeeded();
+
+    // indexed by spoke type
+    const std::array<const vtkSRepSpokeMesh*, 3> meshes{srep.GetUpSpokes(), srep.GetDownSpokes(), srep.GetCrestSpokes()};
+    for (const auto spokeType : AllSpokeTypes) {
+      const auto& mesh = *meshes[spokeType];
+      // one list per spoke so the lists can be filled in parallel and concatenated in order
+      std::vector<std::vector<SpokeCrossing>> perSpoke(mesh.GetNumberOfSpokes());
+      vtkSMPTools::For(0, static_cast<vtkIdType>(perSpoke.size()), [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType i = begin; i < end; ++i) {
+          const SpokeId query{spokeType, static_cast<vtkSRepSpatialIndex::IndexType>(i)};
+          FindCrossings(*index, *mesh.At(query.Index), query, meshes, crossingTolerance, perSpoke[i]);
+          std::sort(perSpoke[i].begin(), perSpoke[i].end(), [](const SpokeCrossing& a, const SpokeCrossing& b) {
+            return IdLess(a.second, b.second);
+          });
+        }
+      });
+      for (auto& crossings : perSpoke) {
+        report.crossings.insert(report.crossings.end(), crossings.begin(), crossings.end());
+      }
+    }
+  }
+
+  // rSrad
+  {
+    const auto numLines = srep.GetNumberOfLines();
+    const auto numSteps = srep.GetNumberOfSteps();
+    for (const auto spokeType : {vtkSRepSkeletalPoint::UpOrientation, vtkSRepSkeletalPoint::DownOrientation}) {
+      const auto spokes = srep.GetSpokeArrays(spokeType);
+      std::vector<double> maxEigenvalues(static_cast<size_t>(numLines * numSteps));
+      vtkSMPTools::For(0, static_cast<vtkIdType>(maxEigenvalues.size()), [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType i = begin; i < end; ++i) {
+          maxEigenvalues[i] = MaxRSradEigenvalue(spokes, numLines, numSteps, i / numSteps, i % numSteps);
+        }
+      });
+
+      for (size_t i = 0; i < maxEigenvalues.size(); ++i) {
+        if (std::isnan(maxEigenvalues[i])) {
+          ++report.rSradSkipped;
+        } else if (maxEigenvalues[i] > rSradThreshold) {
+          report.rSradViolations.push_back(SRepLegalityReport::RSradViolation{
+            spokeType,
+            static_cast<IndexType>(i) / numSteps,
+            static_cast<IndexType>(i) % numSteps,
+            maxEigenvalues[i]});
+        }
+      }
+    }
+  }
+
+  return report;
+}
+
+}
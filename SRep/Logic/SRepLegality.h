@@ -0,0 +1,88 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkSlicerSRepLogic_SRepLegality_h
+#define __vtkSlicerSRepLogic_SRepLegality_h
+
+#include <vector>
+#include <vtkEllipticalSRep.h>
+#include <vtkSRepSpatialIndex.h>
+
+#include "vtkSlicerSRepModuleLogicExport.h"
+
+namespace sreplogic {
+
+/// Everything found to be wrong with an s-rep by CheckSRepLegality.
+struct VTK_SLICER_SREP_MODULE_LOGIC_EXPORT SRepLegalityReport {
+  using IndexType = vtkEllipticalSRep::IndexType;
+  using SpokeId = vtkSRepSpatialIndex::SpokeId;
+  using SpokeType = vtkSRepSkeletalPoint::SpokeOrientation;
+
+  /// Two spokes that pass within the crossing tolerance of each other.
+  ///
+  /// The spoke ids index into the spoke meshes of the checked s-rep (GetUpSpokes, GetDownSpokes,
+  /// GetCrestSpokes). first always comes before second in (orientation, index) order.
+  struct SpokeCrossing {
+    SpokeId first;
+    SpokeId second;
+    double distance;
+    /// Where the spokes are closest. 0 is the skeletal point, 1 is the boundary point.
+    double firstParameter;
+    double secondParameter;
+  };
+
+  /// A spoke whose rSrad matrix has an eigenvalue above the threshold.
+  struct RSradViolation {
+    SpokeType spokeType;
+    IndexType line;
+    IndexType step;
+    double maxEigenvalue;
+  };
+
+  /// Sorted by first then second.
+  std::vector<SpokeCrossing> crossings;
+  /// Sorted by spoke type, line, then step.
+  std::vector<RSradViolation> rSradViolations;
+  /// Number of up and down spokes where the rSrad matrix could not be computed because the
+  /// skeleton is degenerate there (e.g. the ends of the spine).
+  size_t rSradSkipped = 0;
+
+  bool IsLegal() const;
+};
+
+/// Checks an s-rep for crossing spokes and for local rSrad violations.
+///
+/// Crossings are found by querying every spoke against a vtkSRepSpatialIndex of all spokes, so each spoke is only
+/// tested against the spokes near it instead of every other spoke. Spokes that share a skeletal point, or that only
+/// come together at their skeletal points or at their boundary points, are not crossings.
+///
+/// The rSrad matrix is estimated with finite differences over the (line, step) grid for every up and down spoke.
+/// A spoke violates the condition when the largest (real part of an) eigenvalue is greater than rSradThreshold.
+/// Crest spokes are only checked for crossings.
+///
+/// Both checks run in parallel with vtkSMPTools. Run this on an interpolated s-rep to check the implied boundary
+/// between the original spokes.
+///
+/// \param crossingTolerance How close two spokes need to be to count as crossing. Should be well below the
+///        distance between neighboring skeletal points.
+/// \param rSradThreshold The largest allowed rSrad eigenvalue. Spokes can't locally cross for values below 1.
+/// \throws std::invalid_argument if crossingTolerance is negative or nan or rSradThreshold is nan.
+VTK_SLICER_SREP_MODULE_LOGIC_EXPORT SRepLegalityReport CheckSRepLegality(const vtkEllipticalSRep& srep, double crossingTolerance, double rSradThreshold = 1.0);
+
+}
+
+#endif
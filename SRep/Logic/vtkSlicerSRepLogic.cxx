@@ -24,16 +24,25 @@
 #include <vtkMRMLSRepStorageNode.h>
 
 // VTK includes
+#include <vtkCellArray.h>
 #include <vtkCellData.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
 #include <vtkIntArray.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
 #include <vtkPoints.h>
 #include <vtkPolyData.h>
+#include <vtkSMPTools.h>
+#include <vtksys/Directory.hxx>
+#include <vtksys/SystemTools.hxx>
 
 // STD includes
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <numeric>
 
 #include "vtkMRMLSRepNode.h"
 #include "SRepInterpolation.h"
@@ -173,6 +182,86 @@ const char* vtkSlicerSRepLogic::LoadSRep(const char* fileName, const char* nodeN
 
 }
 
+//----------------------------------------------------------------------------
+std::vector<vtkSlicerSRepLogic::SRepLoadResult> vtkSlicerSRepLogic::LoadSReps(const std::vector<std::string>& fileNames) {
+  std::vector<SRepLoadResult> results(fileNames.size());
+  for (size_t i = 0; i < fileNames.size(); ++i) {
+    results[i].FileName = fileNames[i];
+  }
+
+  auto* scene = this->GetMRMLScene();
+  if (!scene) {
+    vtkErrorMacro("LoadSReps: no scene to add srep nodes to");
+    for (auto& result : results) {
+      result.ErrorMessage = "no scene to add srep nodes to";
+    }
+    return results;
+  }
+
+  // Reading is most of the work and touches neither the scene nor any node, so the files are read in
+  // parallel. Each file is its own work item, they are far too expensive to be worth batching.
+  std::vector<vtkMRMLSRepStorageNode::SRepFileData> data(fileNames.size());
+  vtkSMPTools::For(0, static_cast<vtkIdType>(fileNames.size()), 1, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType i = begin; i < end; ++i) {
+      vtkMRMLSRepStorageNode::ReadSRepFile(fileNames[i], data[i], results[i].ErrorMessage);
+    }
+  });
+
+  // one batch process, so scene observers update once for all the nodes instead of once per node
+  scene->StartState(vtkMRMLScene::BatchProcessState);
+  for (size_t i = 0; i < fileNames.size(); ++i) {
+    if (!data[i].EllipticalSRep) {
+      vtkErrorMacro("LoadSReps: failed to read " << fileNames[i] << ": " << results[i].ErrorMessage);
+      continue;
+    }
+
+    vtkMRMLSRepStorageNode* storageNode = vtkMRMLSRepStorageNode::SafeDownCast(
+      scene->AddNewNodeByClass("vtkMRMLSRepStorageNode"));
+    if (!storageNode) {
+      results[i].ErrorMessage = "failed to instantiate srep storage node by class vtkMRMLSRepStorageNode";
+      vtkErrorMacro("LoadSReps: " << results[i].ErrorMessage);
+      continue;
+    }
+    storageNode->SetFileName(fileNames[i].c_str());
+    vtkMRMLSRepNode* srepNode = storageNode->CreateSRepNode(nullptr, data[i]);
+    if (!srepNode) {
+      results[i].ErrorMessage = "failed to create srep node";
+      continue;
+    }
+    results[i].NodeID = srepNode->GetID();
+    // the node has its own reference to the srep, nothing else needs to be kept alive
+    data[i] = vtkMRMLSRepStorageNode::SRepFileData();
+  }
+  scene->EndState(vtkMRMLScene::BatchProcessState);
+  return results;
+}
+
+//----------------------------------------------------------------------------
+std::vector<vtkSlicerSRepLogic::SRepLoadResult> vtkSlicerSRepLogic::LoadSRepDirectory(const std::string& directory) {
+  vtksys::Directory dir;
+  if (!dir.Load(directory)) {
+    vtkErrorMacro("LoadSRepDirectory: unable to read directory " << directory);
+    return {};
+  }
+
+  std::vector<std::string> fileNames;
+  for (unsigned long i = 0; i < dir.GetNumberOfFiles(); ++i) {
+    const std::string name = dir.GetFile(i);
+    const std::string lowerName = vtksys::SystemTools::LowerCase(name);
+    if (!vtksys::SystemTools::StringEndsWith(lowerName, ".srep.json")
+      && !vtksys::SystemTools::StringEndsWith(lowerName, ".srep.bin"))
+    {
+      continue;
+    }
+    const std::string path = vtksys::SystemTools::CollapseFullPath(name, directory);
+    if (!vtksys::SystemTools::FileIsDirectory(path)) {
+      fileNames.push_back(path);
+    }
+  }
+  std::sort(fileNames.begin(), fileNames.end());
+  return this->LoadSReps(fileNames);
+}
+
 //----------------------------------------------------------------------------
 std::string vtkSlicerSRepLogic::InterpolateSRep(vtkMRMLEllipticalSRepNode* srepNode, size_t interpolationlevel, const std::string& newNodeName) {
   auto scene = this->GetMRMLScene();
@@ -213,25 +302,55 @@ bool vtkSlicerSRepLogic::InterpolateSRep(vtkMRMLEllipticalSRepNode* srepNode, si
     return false;
   }
 
-  auto srep = srepNode->GetEllipticalSRep();
-  if (!srep) {
+  if (!srepNode->GetEllipticalSRep()) {
     vtkErrorMacro("InterpolateSRep: input node does not have an SRep");
     return false;
   }
 
+  const auto interpolatedSRep = this->GetInterpolatedSRep(srepNode, interpolationlevel);
+  if (!interpolatedSRep) {
+    vtkErrorMacro("InterpolateSRep: Unable to interpolate SRep");
+    return false;
+  }
+
+  // clone because the destination owns its srep and is free to modify it, while the
+  // interpolated srep is shared through the cache
+  destination->SetEllipticalSRep(interpolatedSRep->SmartClone());
+  return true;
+}
+
+//----------------------------------------------------------------------------
+const vtkEllipticalSRep* vtkSlicerSRepLogic::GetInterpolatedSRep(vtkMRMLEllipticalSRepNode* srepNode, size_t interpolationlevel) {
+  if (!srepNode) {
+    vtkErrorMacro("GetInterpolatedSRep: input node is nullptr");
+    return nullptr;
+  }
+
+  auto srep = srepNode->GetEllipticalSRep();
+  if (!srep) {
+    vtkErrorMacro("GetInterpolatedSRep: input node does not have an SRep");
+    return nullptr;
+  }
+
   if (interpolationlevel == 0) {
-    destination->SetEllipticalSRep(srep->SmartClone());
-    return true;
-  } else {
+    return srep;
+  }
 
+  if (const auto cached = srepNode->GetCachedInterpolatedSRep(interpolationlevel)) {
+    return cached;
+  }
+
+  try {
     auto interpolatedSRep = this->SmartInterpolateSRep(*srep, interpolationlevel);
     if (!interpolatedSRep) {
-      vtkErrorMacro("InterpolateSRep: Unable to interpolate SRep");
-      return false;
+      vtkErrorMacro("GetInterpolatedSRep: Unable to interpolate SRep");
+      return nullptr;
     }
-
-    destination->SetEllipticalSRep(interpolatedSRep);
-    return true;
+    srepNode->SetCachedInterpolatedSRep(interpolationlevel, interpolatedSRep);
+    return interpolatedSRep;
+  } catch (const std::exception& e) {
+    vtkErrorMacro("GetInterpolatedSRep: Unable to interpolate SRep: " << e.what());
+    return nullptr;
   }
 }
 
@@ -252,22 +371,266 @@ vtkSmartPointer<vtkEllipticalSRep> vtkSlicerSRepLogic::SmartInterpolateSRep(cons
   return sreplogic::SmartInterpolateSRep(interpolationlevel, srep);
 }
 
+//----------------------------------------------------------------------------
+bool vtkSlicerSRepLogic::CheckSRepLegality(vtkMRMLEllipticalSRepNode* srepNode, size_t interpolationlevel, double crossingTolerance,
+  double rSradThreshold, sreplogic::SRepLegalityReport& report)
+{
+  const auto srep = this->GetInterpolatedSRep(srepNode, interpolationlevel);
+  if (!srep) {
+    vtkErrorMacro("CheckSRepLegality: Unable to get the interpolated SRep");
+    return false;
+  }
+
+  try {
+    report = this->CheckSRepLegality(*srep, crossingTolerance, rSradThreshold);
+    return true;
+  } catch (const std::exception& e) {
+    vtkErrorMacro("CheckSRepLegality: " << e.what());
+    return false;
+  }
+}
+
+//----------------------------------------------------------------------------
+sreplogic::SRepLegalityReport vtkSlicerSRepLogic::CheckSRepLegality(const vtkEllipticalSRep& srep, double crossingTolerance, double rSradThreshold) {
+  return sreplogic::CheckSRepLegality(srep, crossingTolerance, rSradThreshold);
+}
+
 namespace {
-struct vtkSpokeIds {
-  vtkIdType boundaryId;
-  vtkIdType skeletonId;
+using MeshIndex = vtkSRepSpokeMesh::IndexType;
+using MeshIndexPair = std::pair<MeshIndex, MeshIndex>;
+
+/// Everything needed to export one spoke mesh, worked out before any points or lines are written.
+struct vtkSpokeMeshExport {
+  const vtkSRepSpokeMesh* mesh;
+  int skeletalPointType;
+  int boundaryPointType;
+  bool addSpokes;
+  int spokeLineType;
+  int connectionLineType;
+  // point id for each spoke, -1 if the point isn't exported
+  std::vector<vtkIdType> skeletonIds;
+  std::vector<vtkIdType> boundaryIds;
+  // spoke index pairs, sorted with no duplicates
+  std::vector<MeshIndexPair> spineConnections;
+  std::vector<MeshIndexPair> connections;
+
+  vtkIdType GetNumberOfLines() const {
+    return (this->addSpokes ? this->mesh->GetNumberOfSpokes() : 0)
+      + static_cast<vtkIdType>(this->spineConnections.size() + this->connections.size());
+  }
 };
+
+//----------------------------------------------------------------------------
+std::vector<char> MakeMembership(MeshIndex size, const std::vector<MeshIndex>& members) {
+  std::vector<char> isMember(size, 0);
+  for (const auto member : members) {
+    isMember[member] = 1;
+  }
+  return isMember;
+}
+
+//----------------------------------------------------------------------------
+MeshIndexPair MakeSortedPair(MeshIndex a, MeshIndex b) {
+  return a < b ? std::make_pair(a, b) : std::make_pair(b, a);
+}
+
+//----------------------------------------------------------------------------
+std::vector<MeshIndexPair> GetSpineConnections(const std::vector<MeshIndex>& spine) {
+  std::vector<MeshIndexPair> connections;
+  connections.reserve(spine.size());
+  for (size_t i = 1; i < spine.size(); ++i) {
+    connections.push_back(MakeSortedPair(spine[i-1], spine[i]));
+  }
+  std::sort(connections.begin(), connections.end());
+  connections.erase(std::unique(connections.begin(), connections.end()), connections.end());
+  return connections;
+}
+
+//----------------------------------------------------------------------------
+// The neighbors are essentially a bidirectional graph, so each connection only shows up once even if it is
+// listed "once in each direction". Connections are bucketed by their lower index so this is linear in the
+// number of connections. excluded must be sorted.
+std::vector<MeshIndexPair> GetConnections(const vtkSRepSpokeMesh& mesh, const std::vector<MeshIndexPair>& excluded) {
+  const auto numberOfSpokes = mesh.GetNumberOfSpokes();
+  std::vector<size_t> bucketStarts(numberOfSpokes + 1, 0);
+  for (MeshIndex i = 0; i < numberOfSpokes; ++i) {
+    for (const auto neighbor : mesh.GetNeighbors(i)) {
+      ++bucketStarts[std::min(i, neighbor) + 1];
+    }
+  }
+  std::partial_sum(bucketStarts.begin(), bucketStarts.end(), bucketStarts.begin());
+
+  std::vector<MeshIndex> upperIndexes(bucketStarts.back());
+  auto nextInBucket = bucketStarts;
+  for (MeshIndex i = 0; i < numberOfSpokes; ++i) {
+    for (const auto neighbor : mesh.GetNeighbors(i)) {
+      upperIndexes[nextInBucket[std::min(i, neighbor)]++] = std::max(i, neighbor);
+    }
+  }
+
+  std::vector<MeshIndexPair> connections;
+  connections.reserve(upperIndexes.size() / 2);
+  auto nextExcluded = excluded.begin();
+  for (MeshIndex lower = 0; lower < numberOfSpokes; ++lower) {
+    const auto begin = upperIndexes.begin() + bucketStarts[lower];
+    auto end = upperIndexes.begin() + bucketStarts[lower + 1];
+    std::sort(begin, end);
+    end = std::unique(begin, end);
+    for (auto upper = begin; upper != end; ++upper) {
+      const auto connection = std::make_pair(lower, *upper);
+      while (nextExcluded != excluded.end() && *nextExcluded < connection) {
+        ++nextExcluded;
+      }
+      if (nextExcluded == excluded.end() || *nextExcluded != connection) {
+        connections.push_back(connection);
+      }
+    }
+  }
+  return connections;
+}
+
+//----------------------------------------------------------------------------
+void SetCoordinates(float* coordinates, vtkIdType id, const srep::Point3d& point) {
+  coordinates[3 * id] = static_cast<float>(point[0]);
+  coordinates[3 * id + 1] = static_cast<float>(point[1]);
+  coordinates[3 * id + 2] = static_cast<float>(point[2]);
+}
+
+//----------------------------------------------------------------------------
+vtkSpokeMeshExport PlanSpokeMeshExport(
+  const vtkSRepSpokeMesh& mesh,
+  int skeletalPointType,
+  int boundaryPointType,
+  bool addSpokes,
+  int spokeLineType,
+  bool addConnections,
+  int connectionLineType,
+  const std::vector<MeshIndex>& spine,
+  const std::vector<char>& forceAddSkeletalPoint,
+  bool planLines,
+  vtkIdType& numberOfPoints)
+{
+  vtkSpokeMeshExport plan{&mesh, skeletalPointType, boundaryPointType, addSpokes, spokeLineType, connectionLineType, {}, {}, {}, {}};
+
+  const auto numberOfSpokes = mesh.GetNumberOfSpokes();
+  const auto isSpine = MakeMembership(numberOfSpokes, spine);
+  plan.skeletonIds.resize(numberOfSpokes, -1);
+  plan.boundaryIds.resize(numberOfSpokes, -1);
+  for (MeshIndex i = 0; i < numberOfSpokes; ++i) {
+    if (addSpokes || addConnections || isSpine[i] || forceAddSkeletalPoint[i]) {
+      plan.skeletonIds[i] = numberOfPoints++;
+    }
+    if (addSpokes) {
+      plan.boundaryIds[i] = numberOfPoints++;
+    }
+  }
+
+  if (planLines) {
+    plan.spineConnections = GetSpineConnections(spine);
+    if (addConnections) {
+      plan.connections = GetConnections(mesh, plan.spineConnections);
+    }
+  }
+  return plan;
+}
+
+//----------------------------------------------------------------------------
+// Plans the up, down, and crest spoke meshes in that order. The connections are only worked out if planLines is true.
+std::array<vtkSpokeMeshExport, 3> PlanSRepExport(
+  const vtkMeshSRepInterface& srep,
+  const vtkSRepExportPolyDataProperties& properties,
+  bool planLines,
+  vtkIdType& numberOfPoints)
+{
+  const bool includeCrestConnections = properties.GetIncludeSkeletonToCrestConnection();
+  const auto crestConnectionMembership = [includeCrestConnections](const vtkSRepSpokeMesh& mesh, const std::vector<MeshIndex>& crestConnections) {
+    return includeCrestConnections
+      ? MakeMembership(mesh.GetNumberOfSpokes(), crestConnections)
+      : std::vector<char>(mesh.GetNumberOfSpokes(), 0);
+  };
+
+  const std::vector<MeshIndex> noSpine;
+  return std::array<vtkSpokeMeshExport, 3>{
+    PlanSpokeMeshExport(
+      *srep.GetUpSpokes(),
+      vtkSRepExportPolyDataProperties::UpSkeletalPointType, vtkSRepExportPolyDataProperties::UpBoundaryPointType,
+      properties.GetIncludeUpSpokes(), vtkSRepExportPolyDataProperties::UpSpokeLineType,
+      properties.GetIncludeSkeletalSheet(), vtkSRepExportPolyDataProperties::SkeletalSheetLineType,
+      properties.GetIncludeSpine() ? srep.GetUpSpine() : noSpine,
+      crestConnectionMembership(*srep.GetUpSpokes(), srep.GetCrestToUpSpokeConnections()),
+      planLines, numberOfPoints),
+    PlanSpokeMeshExport(
+      *srep.GetDownSpokes(),
+      vtkSRepExportPolyDataProperties::DownSkeletalPointType, vtkSRepExportPolyDataProperties::DownBoundaryPointType,
+      properties.GetIncludeDownSpokes(), vtkSRepExportPolyDataProperties::DownSpokeLineType,
+      properties.GetIncludeSkeletalSheet(), vtkSRepExportPolyDataProperties::SkeletalSheetLineType,
+      properties.GetIncludeSpine() ? srep.GetDownSpine() : noSpine,
+      crestConnectionMembership(*srep.GetDownSpokes(), srep.GetCrestToDownSpokeConnections()),
+      planLines, numberOfPoints),
+    PlanSpokeMeshExport(
+      *srep.GetCrestSpokes(),
+      vtkSRepExportPolyDataProperties::CrestSkeletalPointType, vtkSRepExportPolyDataProperties::CrestBoundaryPointType,
+      properties.GetIncludeCrestSpokes(), vtkSRepExportPolyDataProperties::CrestSpokeLineType,
+      properties.GetIncludeCrestCurve(), vtkSRepExportPolyDataProperties::CrestCurveLineType,
+      noSpine,
+      std::vector<char>(srep.GetCrestSpokes()->GetNumberOfSpokes(), includeCrestConnections ? 1 : 0),
+      planLines, numberOfPoints)
+  };
+}
+
+//----------------------------------------------------------------------------
+void ExportPoints(const std::array<vtkSpokeMeshExport, 3>& plans, float* xyz) {
+  for (const auto& plan : plans) {
+    vtkSMPTools::For(0, plan.mesh->GetNumberOfSpokes(), [&plan, xyz](vtkIdType begin, vtkIdType end) {
+      for (vtkIdType i = begin; i < end; ++i) {
+        const auto& spoke = *(*plan.mesh)[i];
+        if (plan.skeletonIds[i] >= 0) {
+          SetCoordinates(xyz, plan.skeletonIds[i], spoke.GetSkeletalPoint());
+        }
+        if (plan.boundaryIds[i] >= 0) {
+          SetCoordinates(xyz, plan.boundaryIds[i], spoke.GetBoundaryPoint());
+        }
+      }
+    });
+  }
+}
 }
 
 //----------------------------------------------------------------------------
 vtkSmartPointer<vtkPolyData> vtkSlicerSRepLogic::SmartExportSRepToPolyData(const vtkMeshSRepInterface& srep, const vtkSRepExportPolyDataProperties& properties) {
+  // Points are exported mesh by mesh (up, down, crest), spoke by spoke, skeletal point before boundary point.
+  // Lines are exported mesh by mesh as the spokes, then the spine, then the rest of the connections, and
+  // the skeleton to crest connections come last. Everything is counted first so it can be written straight
+  // into preallocated arrays.
+  const bool includeCrestConnections = properties.GetIncludeSkeletonToCrestConnection();
+  vtkIdType numberOfPoints = 0;
+  const auto plans = PlanSRepExport(srep, properties, true, numberOfPoints);
+  const auto& upPlan = plans[0];
+  const auto& downPlan = plans[1];
+  const auto& crestPlan = plans[2];
+
+  vtkIdType numberOfLines = 0;
+  for (const auto& plan : plans) {
+    numberOfLines += plan.GetNumberOfLines();
+  }
+  if (includeCrestConnections) {
+    numberOfLines += static_cast<vtkIdType>(srep.GetCrestToUpSpokeConnections().size() + srep.GetCrestToDownSpokeConnections().size());
+  }
+
+  ///////////////////////////////////////
+  // Allocate
+  ///////////////////////////////////////
   auto polyData = vtkSmartPointer<vtkPolyData>::New();
 
+  vtkNew<vtkFloatArray> coordinates;
+  coordinates->SetNumberOfComponents(3);
+  coordinates->SetNumberOfTuples(numberOfPoints);
   vtkNew<vtkPoints> points;
+  points->SetData(coordinates);
   polyData->SetPoints(points);
 
-  vtkNew<vtkCellArray> lines;
-  polyData->SetLines(lines);
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfValues(2 * numberOfLines);
 
   auto srepArray = properties.GetSRepDataArray();
   vtkSmartPointer<vtkDataArray> pointDataArray;
@@ -275,180 +638,103 @@ vtkSmartPointer<vtkPolyData> vtkSlicerSRepLogic::SmartExportSRepToPolyData(const
   if (srepArray) {
     pointDataArray = vtkSmartPointer<vtkDataArray>::Take(srepArray->NewInstance());
     pointDataArray->SetNumberOfComponents(srepArray->GetNumberOfComponents());
+    pointDataArray->SetNumberOfTuples(numberOfPoints);
     pointDataArray->SetName(properties.GetPointTypeArrayName().c_str());
     polyData->GetPointData()->SetScalars(pointDataArray);
 
     lineDataArray = vtkSmartPointer<vtkDataArray>::Take(srepArray->NewInstance());
     lineDataArray->SetNumberOfComponents(srepArray->GetNumberOfComponents());
+    lineDataArray->SetNumberOfTuples(numberOfLines);
     lineDataArray->SetName(properties.GetLineTypeArrayName().c_str());
     polyData->GetCellData()->SetScalars(lineDataArray);
   }
 
-  //-------------------------------
-  const auto insertNextScalarData = [&srepArray](vtkDataArray* dest, int srepDataType) {
-    if (srepArray) {
-      dest->InsertNextTuple(srepDataType, srepArray);
-    }
-  };
-
-  //-------------------------------
-  const auto insertNextPoint = [&points, &pointDataArray, insertNextScalarData](const srep::Point3d& point, int pointType) {
-    const auto id = points->InsertNextPoint(point.AsArray().data());
-    insertNextScalarData(pointDataArray, pointType);
-    return id;
-  };
-
-  //-------------------------------
-  const auto insertNextLine = [&lines, &lineDataArray, insertNextScalarData](const vtkIdType start, const vtkIdType end, int lineType) {
-    lines->InsertNextCell(2);
-    lines->InsertCellPoint(start);
-    lines->InsertCellPoint(end);
-    insertNextScalarData(lineDataArray, lineType);
-  };
-
-  //-------------------------------
-  const auto addSpokeMesh = [insertNextPoint, insertNextLine]
-    (const vtkSRepSpokeMesh& mesh,
-     int skeletonPointType,
-     int boundaryPointType,
-     bool addSpokes,
-     int spokeType,
-     bool addConnections,
-     int connectionType,
-     const std::vector<vtkMeshSRepInterface::IndexType> spine,
-     std::function<bool(long i)> forceAddSkeletalPoint) -> std::vector<vtkSpokeIds>
-  {
-    std::vector<vtkSpokeIds> spokesToVTKPointIds;
-
-    const auto isSpine = [&spine](long i) {
-      return std::find(spine.begin(), spine.end(), i) != spine.end();
-    };
-
-    // add all the points and the spoke lines
-    for (long i = 0; i < mesh.GetNumberOfSpokes(); ++i) {
-      vtkSpokeIds ids;
-      if (addSpokes || addConnections || isSpine(i) || forceAddSkeletalPoint(i)) {
-        ids.skeletonId = insertNextPoint(mesh[i]->GetSkeletalPoint(), skeletonPointType);
-      } else {
-        ids.skeletonId = -1;
-      }
-      if (addSpokes) {
-        ids.boundaryId = insertNextPoint(mesh[i]->GetBoundaryPoint(), boundaryPointType);
-        insertNextLine(ids.skeletonId, ids.boundaryId, spokeType);
-      } else {
-        ids.boundaryId = -1;
-      }
-      spokesToVTKPointIds.push_back(ids);
-    }
-
-    // add the connection lines. It is essentially a bidirectional graph, so only add one line between two points, even if
-    // it shows up twice "once in each direction"
-    std::set<std::pair<vtkIdType, vtkIdType>> spineConnections;
-    for (size_t i = 1; i < spine.size(); ++i) {
-      //insert a sorted pair
-      vtkIdType point1 = spokesToVTKPointIds[spine[i-1]].skeletonId;
-      vtkIdType point2 = spokesToVTKPointIds[spine[i]].skeletonId;
-      //sort the points
-      if (point1 > point2) {
-        std::swap(point1, point2);
+  ///////////////////////////////////////
+  // Points
+  ///////////////////////////////////////
+  ExportPoints(plans, coordinates->GetPointer(0));
+  if (pointDataArray) {
+    for (const auto& plan : plans) {
+      for (MeshIndex i = 0; i < plan.mesh->GetNumberOfSpokes(); ++i) {
+        if (plan.skeletonIds[i] >= 0) {
+          pointDataArray->SetTuple(plan.skeletonIds[i], plan.skeletalPointType, srepArray);
+        }
+        if (plan.boundaryIds[i] >= 0) {
+          pointDataArray->SetTuple(plan.boundaryIds[i], plan.boundaryPointType, srepArray);
+        }
       }
-      spineConnections.insert(std::make_pair(point1, point2));
     }
+  }
 
-    for (const auto& spineConnection : spineConnections) {
-      insertNextLine(
-        spineConnection.first,
-        spineConnection.second,
-        vtkSRepExportPolyDataProperties::SpineLineType);
+  ///////////////////////////////////////
+  // Lines
+  ///////////////////////////////////////
+  vtkIdType* const lineIds = connectivity->GetPointer(0);
+  vtkIdType nextLine = 0;
+  const auto setNextLine = [lineIds, &nextLine, &lineDataArray, srepArray](vtkIdType start, vtkIdType end, int lineType) {
+    lineIds[2 * nextLine] = start;
+    lineIds[2 * nextLine + 1] = end;
+    if (lineDataArray) {
+      lineDataArray->SetTuple(nextLine, lineType, srepArray);
     }
+    ++nextLine;
+  };
 
-    if (addConnections) {
-      std::set<std::pair<vtkIdType, vtkIdType>> connections;
-      for (long i = 0; i < mesh.GetNumberOfSpokes(); ++i) {
-        const auto neighbors = mesh.GetNeighbors(i);
-        for (size_t neighbor : neighbors) {
-          vtkIdType point1 = spokesToVTKPointIds[i].skeletonId;
-          vtkIdType point2 = spokesToVTKPointIds[neighbor].skeletonId;
-          //sort the points
-          if (point1 > point2) {
-            std::swap(point1, point2);
-          }
-          connections.insert(std::make_pair(point1, point2));
-        }
-      }
-
-      std::set<std::pair<vtkIdType, vtkIdType>> spinelessConnections;
-      std::set_difference(
-        connections.begin(), connections.end(),
-        spineConnections.begin(), spineConnections.end(),
-        std::inserter(spinelessConnections, spinelessConnections.begin()));
-
-      for (const auto& connection : spinelessConnections) {
-        insertNextLine(connection.first, connection.second, connectionType);
+  for (const auto& plan : plans) {
+    if (plan.addSpokes) {
+      for (MeshIndex i = 0; i < plan.mesh->GetNumberOfSpokes(); ++i) {
+        setNextLine(plan.skeletonIds[i], plan.boundaryIds[i], plan.spokeLineType);
       }
     }
-
-    return spokesToVTKPointIds;
-  };
-
-  ///////////////////////////////////////
-  // Start
-  ///////////////////////////////////////
-  const auto visibleUpSpineIndexes = properties.GetIncludeSpine() ? srep.GetUpSpine() : vtkSRepSpokeMesh::NeighborList{};
-  const auto visibleDownSpineIndexes = properties.GetIncludeSpine() ? srep.GetDownSpine() : vtkSRepSpokeMesh::NeighborList{};
-
-  const auto upSpokeToPointIds = addSpokeMesh(
-    *srep.GetUpSpokes(),
-    vtkSRepExportPolyDataProperties::UpSkeletalPointType, vtkSRepExportPolyDataProperties::UpBoundaryPointType,
-    properties.GetIncludeUpSpokes(), vtkSRepExportPolyDataProperties::UpSpokeLineType,
-    properties.GetIncludeSkeletalSheet(), vtkSRepExportPolyDataProperties::SkeletalSheetLineType,
-    visibleUpSpineIndexes,
-    [&](long i) {
-      const auto crestSkeletonConnections = srep.GetCrestToUpSpokeConnections();
-      return properties.GetIncludeSkeletonToCrestConnection()
-        && crestSkeletonConnections.end() != std::find(crestSkeletonConnections.begin(), crestSkeletonConnections.end(), i);
+    for (const auto& connection : plan.spineConnections) {
+      setNextLine(plan.skeletonIds[connection.first], plan.skeletonIds[connection.second], vtkSRepExportPolyDataProperties::SpineLineType);
     }
-  );
-
-  const auto downSpokeToPointIds = addSpokeMesh(
-    *srep.GetDownSpokes(),
-    vtkSRepExportPolyDataProperties::DownSkeletalPointType, vtkSRepExportPolyDataProperties::DownBoundaryPointType,
-    properties.GetIncludeDownSpokes(), vtkSRepExportPolyDataProperties::DownSpokeLineType,
-    properties.GetIncludeSkeletalSheet(), vtkSRepExportPolyDataProperties::SkeletalSheetLineType,
-    visibleDownSpineIndexes,
-    [&](long i) {
-      const auto crestSkeletonConnections = srep.GetCrestToDownSpokeConnections();
-      return properties.GetIncludeSkeletonToCrestConnection()
-        && crestSkeletonConnections.end() != std::find(crestSkeletonConnections.begin(), crestSkeletonConnections.end(), i);
+    for (const auto& connection : plan.connections) {
+      setNextLine(plan.skeletonIds[connection.first], plan.skeletonIds[connection.second], plan.connectionLineType);
     }
-  );
-
-  const auto crestSpokeToPointIds = addSpokeMesh(
-    *srep.GetCrestSpokes(),
-    vtkSRepExportPolyDataProperties::CrestSkeletalPointType, vtkSRepExportPolyDataProperties::CrestBoundaryPointType,
-    properties.GetIncludeCrestSpokes(), vtkSRepExportPolyDataProperties::CrestSpokeLineType,
-    properties.GetIncludeCrestCurve(), vtkSRepExportPolyDataProperties::CrestCurveLineType,
-    {},
-    [&](long){ return properties.GetIncludeSkeletonToCrestConnection(); }
-  );
+  }
 
   // connect the crest to skeleton
-  if (properties.GetIncludeSkeletonToCrestConnection()) {
+  if (includeCrestConnections) {
     for (size_t crestIndex = 0; crestIndex < srep.GetCrestToUpSpokeConnections().size(); ++crestIndex) {
       const auto skeletonIndex = srep.GetCrestToUpSpokeConnections()[crestIndex];
-      insertNextLine(crestSpokeToPointIds[crestIndex].skeletonId, upSpokeToPointIds[skeletonIndex].skeletonId,
+      setNextLine(crestPlan.skeletonIds[crestIndex], upPlan.skeletonIds[skeletonIndex],
         vtkSRepExportPolyDataProperties::SkeletonToCrestConnectionLineType);
     }
     for (size_t crestIndex = 0; crestIndex < srep.GetCrestToDownSpokeConnections().size(); ++crestIndex) {
       const auto skeletonIndex = srep.GetCrestToDownSpokeConnections()[crestIndex];
-      insertNextLine(crestSpokeToPointIds[crestIndex].skeletonId, downSpokeToPointIds[skeletonIndex].skeletonId,
+      setNextLine(crestPlan.skeletonIds[crestIndex], downPlan.skeletonIds[skeletonIndex],
         vtkSRepExportPolyDataProperties::SkeletonToCrestConnectionLineType);
     }
   }
+  assert(nextLine == numberOfLines);
+
+  vtkNew<vtkCellArray> lines;
+  lines->SetData(2, connectivity);
+  polyData->SetLines(lines);
 
   return polyData;
 }
 
+//----------------------------------------------------------------------------
+bool vtkSlicerSRepLogic::UpdateExportedSRepPoints(const vtkMeshSRepInterface& srep, const vtkSRepExportPolyDataProperties& properties, vtkPolyData& polyData) {
+  auto coordinates = polyData.GetPoints() ? vtkFloatArray::SafeDownCast(polyData.GetPoints()->GetData()) : nullptr;
+  if (!coordinates || coordinates->GetNumberOfComponents() != 3) {
+    return false;
+  }
+
+  vtkIdType numberOfPoints = 0;
+  const auto plans = PlanSRepExport(srep, properties, false, numberOfPoints);
+  if (numberOfPoints != coordinates->GetNumberOfTuples()) {
+    return false;
+  }
+
+  ExportPoints(plans, coordinates->GetPointer(0));
+  coordinates->Modified();
+  polyData.GetPoints()->Modified();
+  return true;
+}
+
 //----------------------------------------------------------------------------
 vtkPolyData* vtkSlicerSRepLogic::ExportSRepToPolyData(const vtkMeshSRepInterface* srep, const vtkSRepExportPolyDataProperties* properties) {
   if (srep && properties) {
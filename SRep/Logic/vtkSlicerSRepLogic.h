@@ -33,10 +33,15 @@
 #include "vtkMRMLEllipticalSRepNode.h"
 #include "vtkSRepExportPolyDataProperties.h"
 
+// SRep Logic includes
+#include "SRepLegality.h"
+
 
 // STD includes
 #include <cstdlib>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "vtkSlicerSRepModuleLogicExport.h"
 
@@ -62,6 +67,26 @@ public:
   /// as well.
   const char* LoadSRep(const char* fileName, const char* nodeName=nullptr);
 
+  /// Result of loading one file with LoadSReps.
+  struct SRepLoadResult {
+    std::string FileName;
+    /// ID of the new srep node, empty if the file wasn't loaded.
+    std::string NodeID;
+    /// Why the file wasn't loaded, empty if it was.
+    std::string ErrorMessage;
+  };
+
+  /// Loads many srep files, adding the same nodes to the scene LoadSRep would for each.
+  ///
+  /// The files are read in parallel, without touching the scene, and then all the nodes are added inside
+  /// one scene batch process. A file that can't be loaded doesn't stop the others, it is reported in its result.
+  /// @returns one result per file name, in the same order.
+  std::vector<SRepLoadResult> LoadSReps(const std::vector<std::string>& fileNames);
+
+  /// Loads every .srep.json and .srep.bin file in directory with LoadSReps, in file name order.
+  /// Subdirectories are not searched.
+  std::vector<SRepLoadResult> LoadSRepDirectory(const std::string& directory);
+
   /// Creates a new SRep from srepNode with interpolated spokes
   /// @param srepNode The srep to interpolate.
   /// @param interpolationlevel How much denser to make the spokes as a power to 2. An interpolation level of 3 would
@@ -69,14 +94,52 @@ public:
   /// @returns The id of the newly created interpolated SRep node
   std::string InterpolateSRep(vtkMRMLEllipticalSRepNode* srepNode, size_t interpolationlevel, const std::string& newNodeName = "");
 
+  /// Sets the SRep of destination to the interpolated SRep of srepNode.
+  ///
+  /// The interpolation itself comes from the cache (see GetInterpolatedSRep), but destination gets its own
+  /// copy of it. vtkMRMLEllipticalSRepNode::SetEllipticalSRep takes sole ownership and destination is free
+  /// to modify its SRep, while cached SReps must stay unmodified. Use GetInterpolatedSRep to read the
+  /// interpolated SRep without a copy.
+  /// @returns false on error, in which case destination is unchanged.
   bool InterpolateSRep(vtkMRMLEllipticalSRepNode* srepNode, size_t interpolationlevel, vtkMRMLEllipticalSRepNode* destination);
 
+  /// Gets the interpolated SRep for srepNode, interpolating only if the node doesn't already have
+  /// one cached for this level.
+  /// @param srepNode The srep to interpolate.
+  /// @param interpolationlevel How much denser to make the spokes as a power to 2. Level 0 is the SRep itself.
+  /// @returns The interpolated SRep, owned by srepNode. Must not be modified. nullptr on error.
+  /// \sa vtkMRMLEllipticalSRepNode::GetCachedInterpolatedSRep
+  const vtkEllipticalSRep* GetInterpolatedSRep(vtkMRMLEllipticalSRepNode* srepNode, size_t interpolationlevel);
+
   VTK_NEWINSTANCE vtkEllipticalSRep* InterpolateSRep(const vtkEllipticalSRep* srep, size_t interpolationlevel);
   vtkSmartPointer<vtkEllipticalSRep> SmartInterpolateSRep(const vtkEllipticalSRep& srep, size_t interpolationlevel);
 
+  /// Checks the interpolated SRep of srepNode for crossing spokes and local rSrad violations.
+  ///
+  /// The check is done on the SRep in node coordinates, so any transform on the node is ignored.
+  /// @param srepNode The srep to check.
+  /// @param interpolationlevel Interpolation level to check at, as in GetInterpolatedSRep. Uses the cached interpolation if there is one.
+  /// @param crossingTolerance How close two spokes need to be to count as crossing.
+  /// @param rSradThreshold The largest allowed rSrad eigenvalue.
+  /// @param report Filled in with the results.
+  /// @returns false on error, in which case report is unchanged.
+  /// \sa sreplogic::CheckSRepLegality
+  bool CheckSRepLegality(vtkMRMLEllipticalSRepNode* srepNode, size_t interpolationlevel, double crossingTolerance,
+    double rSradThreshold, sreplogic::SRepLegalityReport& report);
+  /// \throws std::invalid_argument if sreplogic::CheckSRepLegality would throw.
+  sreplogic::SRepLegalityReport CheckSRepLegality(const vtkEllipticalSRep& srep, double crossingTolerance, double rSradThreshold = 1.0);
+
   VTK_NEWINSTANCE vtkPolyData* ExportSRepToPolyData(const vtkMeshSRepInterface* srep, const vtkSRepExportPolyDataProperties* properties);
   vtkSmartPointer<vtkPolyData> SmartExportSRepToPolyData(const vtkMeshSRepInterface& srep, const vtkSRepExportPolyDataProperties& properties);
 
+  /// Rewrites the point coordinates of polyData from srep, leaving the lines and scalars alone.
+  ///
+  /// polyData must have come from SmartExportSRepToPolyData with the same properties and an SRep with the
+  /// same topology (same spokes, spine, and crest connections), only the spoke positions may differ.
+  /// @returns false without changing anything if polyData doesn't have the number of points expected,
+  ///          in which case the SRep should be exported again.
+  bool UpdateExportedSRepPoints(const vtkMeshSRepInterface& srep, const vtkSRepExportPolyDataProperties& properties, vtkPolyData& polyData);
+
 protected:
   vtkSlicerSRepLogic();
   virtual ~vtkSlicerSRepLogic();
@@ -0,0 +1,324 @@
+#include "srepBinaryIO.h"
+#include "srepUtil.h"
+
+#include "vtkMRMLStorageNode.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+# ifndef WIN32_LEAN_AND_MEAN
+#  define WIN32_LEAN_AND_MEAN
+# endif
+# ifndef NOMINMAX
+#  define NOMINMAX
+# endif
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+using srep::util::finally;
+
+namespace srep {
+
+std::array<double, 3> fromRASToCoord(const std::array<double, 3>& arr, int coordinateSystem) {
+  if (coordinateSystem == vtkMRMLStorageNode::CoordinateSystemLPS) {
+    return std::array<double, 3>{-arr[0], -arr[1], arr[2]};
+  } else if (coordinateSystem == vtkMRMLStorageNode::CoordinateSystemRAS) {
+    return arr;
+  } else {
+    throw std::invalid_argument("Unknown coordinate system type: " + std::to_string(coordinateSystem));
+  }
+}
+
+std::array<double, 3> fromCoordToRAS(const std::array<double, 3>& arr, int coordinateSystem) {
+  // same transformation both ways, but two functions helps keep things straight.
+  return fromRASToCoord(arr, coordinateSystem);
+}
+
+}
+
+namespace srep {
+namespace binary {
+
+#ifdef _WIN32
+MappedFile::MappedFile(const char* filePath) {
+  HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error(std::string("Error opening file: ") + filePath);
+  }
+  const auto closeFile = finally([file](){
+    CloseHandle(file);
+  });
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    throw std::runtime_error(std::string("Error getting size of file: ") + filePath);
+  }
+  this->Size = static_cast<size_t>(size.QuadPart);
+  if (this->Size == 0) {
+    return;
+  }
+
+  // the view keeps the mapping alive, so neither handle is needed once it exists
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) {
+    throw std::runtime_error(std::string("Error mapping file: ") + filePath);
+  }
+  const auto closeMapping = finally([mapping](){
+    CloseHandle(mapping);
+  });
+
+  const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!view) {
+    throw std::runtime_error(std::string("Error mapping file: ") + filePath);
+  }
+  this->Data = static_cast<const unsigned char*>(view);
+}
+
+MappedFile::~MappedFile() {
+  if (this->Data) {
+    UnmapViewOfFile(this->Data);
+  }
+}
+#else
+MappedFile::MappedFile(const char* filePath) {
+  const int fd = open(filePath, O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error(std::string("Error opening file: ") + filePath);
+  }
+  // the mapping stays valid after the descriptor is closed
+  const auto closeFd = finally([fd](){
+    close(fd);
+  });
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0) {
+    throw std::runtime_error(std::string("Error getting size of file: ") + filePath);
+  }
+  this->Size = static_cast<size_t>(fileStat.st_size);
+  if (this->Size == 0) {
+    return;
+  }
+
+  void* mapped = mmap(nullptr, this->Size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (mapped == MAP_FAILED) {
+    throw std::runtime_error(std::string("Error mapping file: ") + filePath);
+  }
+  this->Data = static_cast<const unsigned char*>(mapped);
+}
+
+MappedFile::~MappedFile() {
+  if (this->Data) {
+    munmap(const_cast<unsigned char*>(this->Data), this->Size);
+  }
+}
+#endif
+
+void appendUint32(std::vector<unsigned char>& buffer, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    buffer.push_back(static_cast<unsigned char>(value >> (8 * i)));
+  }
+}
+
+void appendUint64(std::vector<unsigned char>& buffer, uint64_t value) {
+  for (int i = 0; i < 8; ++i) {
+    buffer.push_back(static_cast<unsigned char>(value >> (8 * i)));
+  }
+}
+
+void appendDouble(std::vector<unsigned char>& buffer, double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  for (int i = 0; i < 8; ++i) {
+    buffer.push_back(static_cast<unsigned char>(bits >> (8 * i)));
+  }
+}
+
+uint32_t readUint32(const unsigned char* data) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i) {
+    value |= static_cast<uint32_t>(data[i]) << (8 * i);
+  }
+  return value;
+}
+
+uint64_t readUint64(const unsigned char* data) {
+  uint64_t value = 0;
+  for (int i = 0; i < 8; ++i) {
+    value |= static_cast<uint64_t>(data[i]) << (8 * i);
+  }
+  return value;
+}
+
+double readDouble(const unsigned char* data) {
+  uint64_t bits = 0;
+  for (int i = 0; i < 8; ++i) {
+    bits |= static_cast<uint64_t>(data[i]) << (8 * i);
+  }
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+namespace {
+
+void append3dArray(std::vector<unsigned char>& buffer, const std::array<double, 3>& arr) {
+  for (const auto d : arr) {
+    appendDouble(buffer, d);
+  }
+}
+
+std::array<double, 3> read3dArray(const unsigned char* data) {
+  return std::array<double, 3>{readDouble(data), readDouble(data + 8), readDouble(data + 16)};
+}
+
+}
+
+bool hasExtension(const std::string& fileName) {
+  const std::string extension = FileExtension;
+  if (fileName.size() < extension.size()) {
+    return false;
+  }
+  std::string end = fileName.substr(fileName.size() - extension.size());
+  std::transform(end.begin(), end.end(), end.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return end == extension;
+}
+
+bool hasMagic(const char* filePath) {
+  FILE* fp = fopen(filePath, "rb");
+  if (!fp) {
+    throw std::runtime_error(std::string("Error opening file: ") + filePath);
+  }
+  const auto closeFp = finally([fp](){
+    fclose(fp);
+  });
+
+  std::array<char, 8> magic;
+  return fread(magic.data(), 1, magic.size(), fp) == magic.size() && magic == Magic;
+}
+
+Header readHeader(const unsigned char* data, size_t size) {
+  if (size < HeaderSize || std::memcmp(data, Magic.data(), Magic.size()) != 0) {
+    throw std::invalid_argument("Not a binary srep file");
+  }
+
+  Header header;
+  header.Version = readUint32(data + 8);
+  if (header.Version > Version) {
+    throw std::invalid_argument("Unsupported binary srep version: " + std::to_string(header.Version));
+  }
+  header.Type = readUint32(data + 12);
+  const auto coordinateSystem = readUint32(data + 16);
+  if (coordinateSystem == LPS) {
+    header.CoordinateSystem = vtkMRMLStorageNode::CoordinateSystemLPS;
+  } else if (coordinateSystem == RAS) {
+    header.CoordinateSystem = vtkMRMLStorageNode::CoordinateSystemRAS;
+  } else {
+    throw std::invalid_argument("Unknown srep coordinate system type: " + std::to_string(coordinateSystem));
+  }
+  header.Lines = readUint32(data + 20);
+  header.Steps = readUint32(data + 24);
+  return header;
+}
+
+std::vector<unsigned char> writeEllipticalSRep(const vtkEllipticalSRep& srep, int coordinateSystem) {
+  using IndexType = vtkEllipticalSRep::IndexType;
+  const auto lines = srep.GetNumberOfLines();
+  const auto steps = srep.GetNumberOfSteps();
+
+  std::vector<const vtkSRepSpoke*> upSpokes;
+  std::vector<const vtkSRepSpoke*> downSpokes;
+  std::vector<const vtkSRepSpoke*> crestSpokes;
+  upSpokes.reserve(lines * steps);
+  downSpokes.reserve(lines * steps);
+  crestSpokes.reserve(lines);
+  for (IndexType l = 0; l < lines; ++l) {
+    for (IndexType s = 0; s < steps; ++s) {
+      const auto* skeletalPoint = srep.GetSkeletalPoint(l, s);
+      upSpokes.push_back(skeletalPoint->GetUpSpoke());
+      downSpokes.push_back(skeletalPoint->GetDownSpoke());
+      if (skeletalPoint->IsCrest()) {
+        crestSpokes.push_back(skeletalPoint->GetCrestSpoke());
+      }
+    }
+  }
+
+  std::vector<unsigned char> buffer;
+  buffer.reserve(HeaderSize + 6 * sizeof(double) * (upSpokes.size() + downSpokes.size() + crestSpokes.size()));
+  buffer.insert(buffer.end(), Magic.begin(), Magic.end());
+  appendUint32(buffer, Version);
+  appendUint32(buffer, EllipticalSRepType);
+  if (coordinateSystem == vtkMRMLStorageNode::CoordinateSystemLPS) {
+    appendUint32(buffer, LPS);
+  } else if (coordinateSystem == vtkMRMLStorageNode::CoordinateSystemRAS) {
+    appendUint32(buffer, RAS);
+  } else {
+    throw std::invalid_argument("Unknown storage node coordinate system type: " + std::to_string(coordinateSystem));
+  }
+  appendUint32(buffer, static_cast<uint32_t>(lines));
+  appendUint32(buffer, static_cast<uint32_t>(steps));
+  appendUint32(buffer, 0);
+
+  for (const auto* spokes : {&upSpokes, &downSpokes, &crestSpokes}) {
+    for (const auto* spoke : *spokes) {
+      append3dArray(buffer, fromRASToCoord(spoke->GetSkeletalPoint().AsArray(), coordinateSystem));
+    }
+    for (const auto* spoke : *spokes) {
+      append3dArray(buffer, fromRASToCoord(spoke->GetDirection().AsArray(), coordinateSystem));
+    }
+  }
+  return buffer;
+}
+
+vtkSmartPointer<vtkEllipticalSRep> readEllipticalSRep(const unsigned char* data, size_t size) {
+  const auto header = readHeader(data, size);
+  if (header.Type != EllipticalSRepType) {
+    throw std::invalid_argument("Binary srep file is not an elliptical srep");
+  }
+
+  // 64 bit so the size check can't overflow on any header
+  const uint64_t lines = header.Lines;
+  const uint64_t steps = header.Steps;
+  const uint64_t arraysBytes = 6 * sizeof(double) * (2 * lines * steps + lines);
+  if (size - HeaderSize != arraysBytes) {
+    throw std::invalid_argument("Binary srep file has " + std::to_string(size - HeaderSize)
+      + " bytes of spokes, expected " + std::to_string(arraysBytes));
+  }
+
+  const int coordinateSystem = header.CoordinateSystem;
+  const auto spokeAt = [coordinateSystem](const unsigned char* spokes, uint64_t numberOfSpokes, uint64_t index) {
+    const auto* point = spokes + 3 * sizeof(double) * index;
+    const auto* direction = spokes + 3 * sizeof(double) * (numberOfSpokes + index);
+    return vtkSRepSpoke::SmartCreate(
+      srep::Point3d(fromCoordToRAS(read3dArray(point), coordinateSystem)),
+      srep::Vector3d(fromCoordToRAS(read3dArray(direction), coordinateSystem)));
+  };
+
+  const auto* upSpokes = data + HeaderSize;
+  const auto* downSpokes = upSpokes + 6 * sizeof(double) * lines * steps;
+  const auto* crestSpokes = downSpokes + 6 * sizeof(double) * lines * steps;
+
+  vtkEllipticalSRep::UnrolledEllipticalGrid skeleton(lines);
+  for (uint64_t l = 0; l < lines; ++l) {
+    skeleton[l].reserve(steps);
+    for (uint64_t s = 0; s < steps; ++s) {
+      const auto i = l * steps + s;
+      skeleton[l].push_back(vtkSRepSkeletalPoint::SmartCreate(
+        spokeAt(upSpokes, lines * steps, i),
+        spokeAt(downSpokes, lines * steps, i),
+        s == steps - 1 ? spokeAt(crestSpokes, lines, l) : nullptr));
+    }
+  }
+  return vtkEllipticalSRep::SmartCreate(std::move(skeleton));
+}
+
+}
+}
@@ -0,0 +1,113 @@
+#ifndef __srep_BinaryIO_h
+#define __srep_BinaryIO_h
+
+#include "vtkEllipticalSRep.h"
+
+#include <vtkSmartPointer.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace srep {
+
+/// @{
+/// Converts a point or vector between RAS and the coordinate system an SRep is stored in. It is the same
+/// flip both ways, but two functions help keep things straight.
+/// \param coordinateSystem vtkMRMLStorageNode::CoordinateSystemRAS or vtkMRMLStorageNode::CoordinateSystemLPS
+/// \throws std::invalid_argument on an unknown coordinate system
+std::array<double, 3> fromRASToCoord(const std::array<double, 3>& arr, int coordinateSystem);
+std::array<double, 3> fromCoordToRAS(const std::array<double, 3>& arr, int coordinateSystem);
+/// @}
+
+/// Binary SRep serialization, shared by the .srep.bin files of vtkMRMLSRepStorageNode and the entries
+/// of vtkSRepCohortFile.
+///
+/// Everything is little-endian and at a fixed offset, so reading is just copying doubles out of the
+/// (usually memory mapped) data.
+///
+///   char[8]  magic, "SREPBIN\0"
+///   uint32   format version
+///   uint32   srep type, 1 is elliptical
+///   uint32   coordinate system, 0 is RAS and 1 is LPS
+///   uint32   number of lines
+///   uint32   number of steps, including the spine
+///   uint32   reserved, 0
+///   float64  up, down, then crest spokes. For each orientation every skeletal point (x, y, z) comes first,
+///            then every direction (x, y, z) with the radius as its length. Up and down spokes are indexed
+///            by line * steps + step, crest spokes by line.
+///
+/// Only the geometry is stored, there is no display information.
+namespace binary {
+
+constexpr std::array<char, 8> Magic{{'S', 'R', 'E', 'P', 'B', 'I', 'N', '\0'}};
+constexpr uint32_t Version = 1;
+constexpr size_t HeaderSize = 32;
+constexpr uint32_t EllipticalSRepType = 1;
+constexpr uint32_t RAS = 0;
+constexpr uint32_t LPS = 1;
+constexpr const char* FileExtension = ".srep.bin";
+
+struct Header {
+  uint32_t Version;
+  uint32_t Type;
+  /// vtkMRMLStorageNode::CoordinateSystemRAS or vtkMRMLStorageNode::CoordinateSystemLPS
+  int CoordinateSystem;
+  uint32_t Lines;
+  uint32_t Steps;
+};
+
+/// Read only view of a whole file. The file is memory mapped, so only the pages actually read are loaded.
+class MappedFile {
+public:
+  /// \throws std::runtime_error if the file can't be opened or mapped
+  explicit MappedFile(const char* filePath);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile(MappedFile&&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile& operator=(MappedFile&&) = delete;
+
+  /// nullptr if the file is empty.
+  const unsigned char* GetData() const { return this->Data; }
+  size_t GetSize() const { return this->Size; }
+
+private:
+  const unsigned char* Data = nullptr;
+  size_t Size = 0;
+};
+
+/// @{
+/// Little-endian integers and doubles.
+void appendUint32(std::vector<unsigned char>& buffer, uint32_t value);
+void appendUint64(std::vector<unsigned char>& buffer, uint64_t value);
+void appendDouble(std::vector<unsigned char>& buffer, double value);
+uint32_t readUint32(const unsigned char* data);
+uint64_t readUint64(const unsigned char* data);
+double readDouble(const unsigned char* data);
+/// @}
+
+/// Whether fileName ends in FileExtension, ignoring case.
+bool hasExtension(const std::string& fileName);
+
+/// Whether the file starts with Magic.
+/// \throws std::runtime_error if the file can't be opened
+bool hasMagic(const char* filePath);
+
+/// \throws std::invalid_argument if data doesn't start with a header this can read
+Header readHeader(const unsigned char* data, size_t size);
+
+/// \param coordinateSystem vtkMRMLStorageNode::CoordinateSystemRAS or vtkMRMLStorageNode::CoordinateSystemLPS
+/// \throws std::invalid_argument on an unknown coordinate system
+std::vector<unsigned char> writeEllipticalSRep(const vtkEllipticalSRep& srep, int coordinateSystem);
+
+/// Reads an srep written by writeEllipticalSRep. data must hold exactly the one srep.
+/// \throws std::invalid_argument if data isn't a valid binary elliptical srep
+vtkSmartPointer<vtkEllipticalSRep> readEllipticalSRep(const unsigned char* data, size_t size);
+
+}
+}
+
+#endif
@@ -1,7 +1,9 @@
 #include "vtkEllipticalSRep.h"
 
 #include <algorithm>
+#include <cmath>
 #include <sstream>
+#include <utility>
 
 #include <vtkCommand.h>
 #include <vtkObjectFactory.h>
@@ -27,7 +29,13 @@ vtkEllipticalSRep::ModifiedBlocker::~ModifiedBlocker()
 vtkStandardNewMacro(vtkEllipticalSRep);
 
 //----------------------------------------------------------------------
-vtkEllipticalSRep::vtkEllipticalSRep() = default;
+vtkEllipticalSRep::vtkEllipticalSRep()
+  : Skeleton()
+  , SkeletonObservationTags()
+  , ModifiedBlocks(0)
+  , WasModifiedDuringBlock(false)
+  , SkeletonAsMesh()
+{}
 
 //----------------------------------------------------------------------
 vtkEllipticalSRep::~vtkEllipticalSRep() {
@@ -309,6 +317,158 @@ void vtkEllipticalSRep::Resize(IndexType lines, IndexType steps) {
   this->Modified();
 }
 
+//----------------------------------------------------------------------
+void vtkEllipticalSRep::SetSkeleton(UnrolledEllipticalGrid skeleton) {
+  // validate everything before touching anything so a throw leaves this unchanged
+  const IndexType steps = skeleton.empty() ? 0 : skeleton.front().size();
+  if (!skeleton.empty() && steps == 0) {
+    throw std::invalid_argument("Cannot set a skeleton with lines but no steps");
+  }
+  for (IndexType l = 0; l < static_cast<IndexType>(skeleton.size()); ++l) {
+    if (static_cast<IndexType>(skeleton[l].size()) != steps) {
+      throw std::invalid_argument("Line " + std::to_string(l) + " has " + std::to_string(skeleton[l].size())
+        + " steps, expected " + std::to_string(steps));
+    }
+    for (IndexType s = 0; s < steps; ++s) {
+      if (!skeleton[l][s]) {
+        throw std::invalid_argument("Cannot set a nullptr skeletal point at (" + std::to_string(l) + ", " + std::to_string(s) + ")");
+      }
+      if (skeleton[l][s]->IsCrest() != (s == steps - 1)) {
+        std::stringstream ss;
+        ss << "Cannot set " << (s == steps - 1 ? std::string("") : std::string("non-")) << "crest location "
+           << "(" << l << ", " << s << ") "
+           << "to a " << (skeleton[l][s]->IsCrest() ? std::string("") : std::string("non-")) << "crest skeletal point";
+        throw std::invalid_argument(ss.str());
+      }
+    }
+  }
+
+  for (IndexType l = 0; l < GetNumberOfLines(); ++l) {
+    for (IndexType s = 0; s < GetNumberOfSteps(); ++s) {
+      this->Skeleton[l][s]->RemoveObserver(this->SkeletonObservationTags[l][s]);
+    }
+  }
+
+  this->Skeleton = std::move(skeleton);
+  this->SkeletonObservationTags.assign(this->Skeleton.size(), std::vector<unsigned long>(steps, 0));
+  for (IndexType l = 0; l < GetNumberOfLines(); ++l) {
+    for (IndexType s = 0; s < GetNumberOfSteps(); ++s) {
+      this->SkeletonObservationTags[l][s] =
+        this->Skeleton[l][s]->AddObserver(vtkCommand::ModifiedEvent, this, &vtkEllipticalSRep::onSkeletalPointModified);
+    }
+  }
+
+  this->CreateMeshRepresentation();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------
+vtkEllipticalSRep::IndexType vtkEllipticalSRep::GetNumberOfSpokes(vtkSRepSkeletalPoint::SpokeOrientation orientation) const {
+  if (orientation == vtkSRepSkeletalPoint::CrestOrientation) {
+    return this->GetNumberOfLines();
+  } else if (orientation == vtkSRepSkeletalPoint::UpOrientation || orientation == vtkSRepSkeletalPoint::DownOrientation) {
+    return this->GetNumberOfLines() * this->GetNumberOfSteps();
+  } else {
+    throw std::invalid_argument("Unknown spoke type: " + std::to_string(static_cast<int>(orientation)));
+  }
+}
+
+//----------------------------------------------------------------------
+const vtkSRepSpoke* vtkEllipticalSRep::GetSpokeByArrayIndex(vtkSRepSkeletalPoint::SpokeOrientation orientation, IndexType index) const {
+  if (orientation == vtkSRepSkeletalPoint::CrestOrientation) {
+    return this->Skeleton[index].back()->GetCrestSpoke();
+  }
+  const auto steps = this->GetNumberOfSteps();
+  return this->Skeleton[index / steps][index % steps]->GetSpoke(orientation);
+}
+
+//----------------------------------------------------------------------
+vtkSRepSpoke* vtkEllipticalSRep::GetSpokeByArrayIndex(vtkSRepSkeletalPoint::SpokeOrientation orientation, IndexType index) {
+  return const_cast<vtkSRepSpoke*>(const_cast<const vtkEllipticalSRep*>(this)->GetSpokeByArrayIndex(orientation, index));
+}
+
+//----------------------------------------------------------------------
+vtkEllipticalSRep::SpokeArrays vtkEllipticalSRep::GetSpokeArrays(vtkSRepSkeletalPoint::SpokeOrientation orientation) const {
+  const auto numberOfSpokes = this->GetNumberOfSpokes(orientation);
+  SpokeArrays arrays;
+  arrays.SkeletalPoints.reserve(3 * numberOfSpokes);
+  arrays.Directions.reserve(3 * numberOfSpokes);
+  arrays.Radii.reserve(numberOfSpokes);
+
+  for (IndexType i = 0; i < numberOfSpokes; ++i) {
+    const auto* spoke = this->GetSpokeByArrayIndex(orientation, i);
+    const auto point = spoke->GetSkeletalPoint();
+    const auto direction = spoke->GetDirection();
+    const auto radius = direction.GetLength();
+    const auto unit = radius == 0.0 ? direction : direction / radius;
+    arrays.SkeletalPoints.insert(arrays.SkeletalPoints.end(), {point.GetX(), point.GetY(), point.GetZ()});
+    arrays.Directions.insert(arrays.Directions.end(), {unit.GetX(), unit.GetY(), unit.GetZ()});
+    arrays.Radii.push_back(radius);
+  }
+  return arrays;
+}
+
+//----------------------------------------------------------------------
+void vtkEllipticalSRep::SetSpokeArrays(vtkSRepSkeletalPoint::SpokeOrientation orientation, const SpokeArrays& spokes) {
+  const auto numberOfSpokes = this->GetNumberOfSpokes(orientation);
+  if (static_cast<IndexType>(spokes.SkeletalPoints.size()) != 3 * numberOfSpokes
+    || static_cast<IndexType>(spokes.Directions.size()) != 3 * numberOfSpokes
+    || static_cast<IndexType>(spokes.Radii.size()) != numberOfSpokes)
+  {
+    std::stringstream ss;
+    ss << "Expected " << numberOfSpokes << " spokes (" << 3 * numberOfSpokes << " point and direction values, "
+       << numberOfSpokes << " radii), got " << spokes.SkeletalPoints.size() << " point values, "
+       << spokes.Directions.size() << " direction values, and " << spokes.Radii.size() << " radii";
+    throw std::invalid_argument(ss.str());
+  }
+
+  // convert and validate everything before touching anything so a throw leaves this unchanged
+  for (IndexType i = 0; i < 3 * numberOfSpokes; ++i) {
+    if (std::isnan(spokes.SkeletalPoints[i]) || std::isnan(spokes.Directions[i])) {
+      throw std::invalid_argument("Spoke " + std::to_string(i / 3) + " has a nan point or direction component");
+    }
+  }
+  std::vector<std::pair<srep::Point3d, srep::Vector3d>> converted;
+  converted.reserve(numberOfSpokes);
+  for (IndexType i = 0; i < numberOfSpokes; ++i) {
+    const double radius = spokes.Radii[i];
+    if (std::isnan(radius) || radius < 0) {
+      throw std::invalid_argument("Invalid radius for spoke " + std::to_string(i) + ": " + std::to_string(radius));
+    }
+    const srep::Point3d point(&spokes.SkeletalPoints[3 * i]);
+    const srep::Vector3d direction(&spokes.Directions[3 * i]);
+    if (radius == 0.0) {
+      converted.emplace_back(point, srep::Vector3d());
+    } else if (direction.GetLength() == 0.0) {
+      throw std::invalid_argument("Spoke " + std::to_string(i) + " has a non-zero radius but a zero length direction");
+    } else {
+      converted.emplace_back(point, srep::Vector3d::Resize(direction, radius));
+    }
+  }
+
+  ModifiedBlocker block(this);
+  for (IndexType i = 0; i < numberOfSpokes; ++i) {
+    this->GetSpokeByArrayIndex(orientation, i)->SetSkeletalPointAndDirection(converted[i].first, converted[i].second);
+  }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------
+vtkEllipticalSRep* vtkEllipticalSRep::Create(UnrolledEllipticalGrid skeleton) {
+  auto srep = SmartCreate(std::move(skeleton));
+  if (srep) {
+    srep->Register(nullptr);
+  }
+  return srep;
+}
+
+//----------------------------------------------------------------------
+vtkSmartPointer<vtkEllipticalSRep> vtkEllipticalSRep::SmartCreate(UnrolledEllipticalGrid skeleton) {
+  auto srep = vtkSmartPointer<vtkEllipticalSRep>::New();
+  srep->SetSkeleton(std::move(skeleton));
+  return srep;
+}
+
 //----------------------------------------------------------------------
 void vtkEllipticalSRep::onSkeletalPointModified(vtkObject* /*caller*/, unsigned long /*event*/, void* /*callData*/) {
   this->Modified();
@@ -318,14 +478,14 @@ void vtkEllipticalSRep::onSkeletalPointModified(vtkObject* /*caller*/, unsigned
 vtkEllipticalSRep* vtkEllipticalSRep::Clone() const {
   vtkNew<vtkEllipticalSRep> clone;
 
-  clone->Resize(this->GetNumberOfLines(), this->GetNumberOfSteps());
-
+  UnrolledEllipticalGrid skeleton(this->GetNumberOfLines());
   for (IndexType l = 0; l < this->GetNumberOfLines(); ++l) {
+    skeleton[l].reserve(this->GetNumberOfSteps());
     for (IndexType s = 0; s < this->GetNumberOfSteps(); ++s) {
-      // Note use of take because Clone returns an owning pointer
-      clone->TakeSkeletalPoint(l, s, this->GetSkeletalPoint(l, s)->Clone());
+      skeleton[l].push_back(this->Skeleton[l][s]->SmartClone());
     }
   }
+  clone->SetSkeleton(std::move(skeleton));
 
   // update refcount so it doesn't go away after this function ends
   clone->Register(nullptr);
@@ -338,6 +498,40 @@ vtkSmartPointer<vtkEllipticalSRep> vtkEllipticalSRep::SmartClone() const {
   return vtkSmartPointer<vtkEllipticalSRep>::Take(this->Clone());
 }
 
+//----------------------------------------------------------------------
+vtkSmartPointer<vtkEllipticalSRep> vtkEllipticalSRep::SmartCloneSharingSpokes() const {
+  UnrolledEllipticalGrid skeleton(this->GetNumberOfLines());
+  for (IndexType l = 0; l < this->GetNumberOfLines(); ++l) {
+    skeleton[l].reserve(this->GetNumberOfSteps());
+    for (IndexType s = 0; s < this->GetNumberOfSteps(); ++s) {
+      // the const_cast is fine, sharing the spokes is the documented contract of this function
+      auto& point = const_cast<vtkSRepSkeletalPoint&>(*this->Skeleton[l][s]);
+      skeleton[l].push_back(vtkSRepSkeletalPoint::SmartCreate(point.GetUpSpoke(), point.GetDownSpoke(), point.GetCrestSpoke()));
+    }
+  }
+  return SmartCreate(std::move(skeleton));
+}
+
+//----------------------------------------------------------------------
+void vtkEllipticalSRep::DetachSpokes(vtkSRepSkeletalPoint::SpokeOrientation orientation) {
+  if (this->IsEmpty()) {
+    return;
+  }
+
+  ModifiedBlocker block(this);
+  for (IndexType l = 0; l < this->GetNumberOfLines(); ++l) {
+    for (IndexType s = 0; s < this->GetNumberOfSteps(); ++s) {
+      auto& point = *this->Skeleton[l][s];
+      if (const auto* spoke = point.GetSpoke(orientation)) {
+        point.SetSpoke(orientation, spoke->SmartClone());
+      }
+    }
+  }
+  // the mesh holds pointers to the old spokes
+  this->CreateMeshRepresentation();
+  this->Modified();
+}
+
 //----------------------------------------------------------------------
 vtkEllipticalSRep::IndexType vtkEllipticalSRep::NumberOfSpinePointsWithoutDuplicates() const {
   // +1 because we need the rightmost line
@@ -43,7 +43,34 @@ public:
   /////////////////////////////////////////////////////////
   // vtkEllipticalSRep methods
   /////////////////////////////////////////////////////////
+  /// Skeletal points of a single line going out from the spine, indexed by step.
+  using LineOutFromSpine = std::vector<vtkSmartPointer<vtkSRepSkeletalPoint>>;
+  /// Skeletal points of a whole SRep, indexed by [line][step].
+  using UnrolledEllipticalGrid = std::vector<LineOutFromSpine>;
+
+  /// @{
+  /// Creates a new SRep from all of its skeletal points at once. Shallow copy.
+  /// \throws std::invalid_argument if SetSkeleton would throw.
+  /// \sa SetSkeleton
+  static VTK_NEWINSTANCE vtkEllipticalSRep* Create(UnrolledEllipticalGrid skeleton);
+  static vtkSmartPointer<vtkEllipticalSRep> SmartCreate(UnrolledEllipticalGrid skeleton);
+  /// @}
+
   vtkSmartPointer<vtkEllipticalSRep> SmartClone() const;
+
+  /// Creates a clone that shares its spokes with this SRep.
+  ///
+  /// Only the skeletal points are new objects, so this is much cheaper than SmartClone. Because
+  /// the spokes are shared, a change to a spoke through either SRep is seen by both. Call DetachSpokes
+  /// on the clone for each orientation it is going to write to before writing.
+  /// \sa DetachSpokes
+  vtkSmartPointer<vtkEllipticalSRep> SmartCloneSharingSpokes() const;
+
+  /// Replaces every spoke of the orientation with a deep copy of itself so those spokes are no longer
+  /// shared with any other SRep. Spokes of other orientations are untouched. There is only one Modified.
+  /// \sa SmartCloneSharingSpokes
+  void DetachSpokes(vtkSRepSkeletalPoint::SpokeOrientation orientation);
+
   /// @{
   /// Gets/sets the skeletal point. Shallow copy on the set.
   /// \throws std::out_of_range if InBounds(line, step) returns false
@@ -63,6 +90,41 @@ public:
   /// SkeletalPoints
   void Resize(IndexType lines, IndexType steps);
 
+  /// Replaces all skeletal points in the SRep at once. Shallow copy.
+  ///
+  /// This is the same as a Resize followed by SetSkeletalPoint for every point, but the mesh representation
+  /// is only built once and there is only one Modified.
+  /// \throws std::invalid_argument if the lines are not all the same length, any skeletal point is nullptr,
+  ///         or a skeletal point is a crest point when not in the last step (or vice versa). The SRep is unchanged if this throws.
+  void SetSkeleton(UnrolledEllipticalGrid skeleton);
+
+  /// All spokes of one orientation packed into contiguous arrays.
+  ///
+  /// Up and down spokes are ordered by [line][step] (index line * steps + step) and crest spokes
+  /// are ordered by line. Points and directions are packed as x0, y0, z0, x1, y1, z1, ...
+  struct SpokeArrays {
+    std::vector<double> SkeletalPoints;
+    /// Unit directions. A spoke with a radius of 0 has a direction of (0, 0, 0).
+    std::vector<double> Directions;
+    std::vector<double> Radii;
+  };
+
+  /// Gets the number of spokes of the given orientation. This is the size of the arrays used
+  /// by GetSpokeArrays and SetSpokeArrays.
+  IndexType GetNumberOfSpokes(vtkSRepSkeletalPoint::SpokeOrientation orientation) const;
+
+  /// Gets all spokes of one orientation at once.
+  SpokeArrays GetSpokeArrays(vtkSRepSkeletalPoint::SpokeOrientation orientation) const;
+
+  /// Sets all spokes of one orientation at once.
+  ///
+  /// This is the same as setting every spoke individually inside of a ModifiedBlocker, but each spoke
+  /// is only modified once and there is only one Modified on the SRep.
+  /// \throws std::invalid_argument if the array sizes don't match GetNumberOfSpokes(orientation), any value is nan,
+  ///         any radius is negative, or any spoke with a non-zero radius has a zero length direction.
+  ///         The SRep is unchanged if this throws.
+  void SetSpokeArrays(vtkSRepSkeletalPoint::SpokeOrientation orientation, const SpokeArrays& spokes);
+
   /// Clears the SRep down to 0 lines, 0 steps
   void Clear();
 
@@ -119,8 +181,6 @@ protected:
   vtkEllipticalSRep& operator=(const vtkEllipticalSRep&) = delete;
   vtkEllipticalSRep& operator=(vtkEllipticalSRep&&) = delete;
 private:
-  using LineOutFromSpine = std::vector<vtkSmartPointer<vtkSRepSkeletalPoint>>;
-  using UnrolledEllipticalGrid = std::vector<LineOutFromSpine>;
   struct MeshRepresentation {
       vtkNew<vtkSRepSpokeMesh> UpSpokes;
       vtkNew<vtkSRepSpokeMesh> DownSpokes;
@@ -141,6 +201,10 @@ private:
   void CheckCanSet(IndexType line, IndexType step, vtkSRepSkeletalPoint* skeletalPoint) const;
   void onSkeletalPointModified(vtkObject *caller, unsigned long event, void* callData);
 
+  // index is the same as the index into the SpokeArrays for the orientation
+  const vtkSRepSpoke* GetSpokeByArrayIndex(vtkSRepSkeletalPoint::SpokeOrientation orientation, IndexType index) const;
+  vtkSRepSpoke* GetSpokeByArrayIndex(vtkSRepSkeletalPoint::SpokeOrientation orientation, IndexType index);
+
   IndexType NumberOfSpinePointsWithoutDuplicates() const;
   vtkSRepSpokeMesh::IndexType LineStepToUpDownMeshIndex(IndexType line, IndexType step) const;
   std::vector<vtkSRepSpokeMesh::IndexType> GetNeighbors(IndexType line, IndexType step) const;
@@ -1,6 +1,88 @@
 #include "vtkMRMLEllipticalSRepNode.h"
 #include <vtkAbstractTransform.h>
 #include <vtkCommand.h>
+#include <vtkLinearTransform.h>
+#include <vtkMatrix4x4.h>
+#include <vtkSMPTools.h>
+
+#include <exception>
+
+namespace {
+
+//----------------------------------------------------------------------------
+bool IsIdentity(const vtkMatrix4x4& matrix) {
+  for (int r = 0; r < 4; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      if (matrix.Element[r][c] != (r == c ? 1.0 : 0.0)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// points are packed x0, y0, z0, x1, y1, z1, ...
+void TransformPointsInPlace(const vtkMatrix4x4& matrix, std::vector<double>& points) {
+  const auto& m = matrix.Element;
+  for (size_t i = 0; i < points.size(); i += 3) {
+    double* p = &points[i];
+    const double x = p[0];
+    const double y = p[1];
+    const double z = p[2];
+    const double w = m[3][0] * x + m[3][1] * y + m[3][2] * z + m[3][3];
+    for (int r = 0; r < 3; ++r) {
+      p[r] = (m[r][0] * x + m[r][1] * y + m[r][2] * z + m[r][3]) / w;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+// points are packed x0, y0, z0, x1, y1, z1, ...
+void TransformPointsInPlace(vtkAbstractTransform& transform, std::vector<double>& points) {
+  // update once up front so InternalTransformPoint can be called from multiple threads
+  transform.Update();
+  vtkSMPTools::For(0, static_cast<vtkIdType>(points.size() / 3), [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType i = begin; i < end; ++i) {
+      double* p = &points[3 * i];
+      const double in[3] = {p[0], p[1], p[2]};
+      transform.InternalTransformPoint(in, p);
+    }
+  });
+}
+
+//----------------------------------------------------------------------------
+// Transforms the skeletal and boundary points of every spoke with transformPoints(std::vector<double>&)
+// and updates the spokes from them.
+template <class TransformPoints>
+void TransformSpokes(vtkEllipticalSRep& srep, TransformPoints transformPoints) {
+  vtkEllipticalSRep::ModifiedBlocker block(&srep);
+  for (const auto orientation : {vtkSRepSkeletalPoint::UpOrientation, vtkSRepSkeletalPoint::DownOrientation, vtkSRepSkeletalPoint::CrestOrientation}) {
+    auto spokes = srep.GetSpokeArrays(orientation);
+    const auto numberOfSpokes = spokes.Radii.size();
+
+    std::vector<double> boundaryPoints(3 * numberOfSpokes);
+    for (size_t i = 0; i < 3 * numberOfSpokes; ++i) {
+      boundaryPoints[i] = spokes.SkeletalPoints[i] + spokes.Radii[i / 3] * spokes.Directions[i];
+    }
+
+    transformPoints(spokes.SkeletalPoints);
+    transformPoints(boundaryPoints);
+
+    for (size_t i = 0; i < numberOfSpokes; ++i) {
+      const srep::Vector3d direction(srep::Point3d(&spokes.SkeletalPoints[3 * i]), srep::Point3d(&boundaryPoints[3 * i]));
+      const double radius = direction.GetLength();
+      const auto unit = radius == 0.0 ? direction : direction / radius;
+      spokes.Directions[3 * i] = unit.GetX();
+      spokes.Directions[3 * i + 1] = unit.GetY();
+      spokes.Directions[3 * i + 2] = unit.GetZ();
+      spokes.Radii[i] = radius;
+    }
+    srep.SetSpokeArrays(orientation, spokes);
+  }
+}
+
+} // namespace {}
 
 //----------------------------------------------------------------------------
 vtkEllipticalSRep* TransformSRep(vtkEllipticalSRep* srep, vtkAbstractTransform* transform) {
@@ -17,34 +99,40 @@ vtkSmartPointer<vtkEllipticalSRep> SmartTransformSRep(vtkEllipticalSRep* srep, v
     return nullptr;
   }
 
-  auto transformed = vtkSmartPointer<vtkEllipticalSRep>::Take(srep->Clone());
+  if (auto* linearTransform = vtkLinearTransform::SafeDownCast(transform)) {
+    return SmartTransformSRep(srep, linearTransform->GetMatrix());
+  }
+
+  auto transformed = srep->SmartClone();
   if (transform) {
-    using IndexType = vtkEllipticalSRep::IndexType;
-
-    for (IndexType l = 0; l < transformed->GetNumberOfLines(); ++l) {
-      for (IndexType s = 0; s < transformed->GetNumberOfSteps(); ++s) {
-        auto* skeletalPoint = transformed->GetSkeletalPoint(l, s);
-        std::vector<vtkSRepSpoke*> spokes;
-        spokes.push_back(skeletalPoint->GetUpSpoke());
-        spokes.push_back(skeletalPoint->GetDownSpoke());
-        if (skeletalPoint->IsCrest()) {
-          spokes.push_back(skeletalPoint->GetCrestSpoke());
-        }
-
-        for (auto* spoke : spokes) {
-          double transformedBoundary[3];
-          double transformedSkeletal[3];
-
-          transform->TransformPoint(spoke->GetSkeletalPoint().AsArray().data(), transformedSkeletal);
-          transform->TransformPoint(spoke->GetBoundaryPoint().AsArray().data(), transformedBoundary);
-
-          spoke->SetSkeletalPoint(srep::Point3d(transformedSkeletal));
-          spoke->SetDirectionAndMagnitude(srep::Vector3d(srep::Point3d(transformedSkeletal), srep::Point3d(transformedBoundary)));
-        }
-      }
-    }
+    TransformSpokes(*transformed, [transform](std::vector<double>& points) {
+      TransformPointsInPlace(*transform, points);
+    });
   }
+  return transformed;
+}
 
+//----------------------------------------------------------------------------
+vtkEllipticalSRep* TransformSRep(vtkEllipticalSRep* srep, const vtkMatrix4x4* matrix) {
+  auto transformed = SmartTransformSRep(srep, matrix);
+  if (transformed) {
+    transformed->Register(nullptr);
+  }
+  return transformed;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkEllipticalSRep> SmartTransformSRep(vtkEllipticalSRep* srep, const vtkMatrix4x4* matrix) {
+  if (!srep) {
+    return nullptr;
+  }
+
+  auto transformed = srep->SmartClone();
+  if (matrix && !IsIdentity(*matrix)) {
+    TransformSpokes(*transformed, [matrix](std::vector<double>& points) {
+      TransformPointsInPlace(*matrix, points);
+    });
+  }
   return transformed;
 }
 
@@ -57,6 +145,8 @@ vtkMRMLEllipticalSRepNode::vtkMRMLEllipticalSRepNode()
   , SRep()
   , SRepObservationTag()
   , SRepWorld()
+  , SRepWorldOutdated(true)
+  , InterpolatedSRepCache()
 {}
 
 //----------------------------------------------------------------------------
@@ -78,19 +168,48 @@ vtkEllipticalSRep* vtkMRMLEllipticalSRepNode::GetEllipticalSRep() {
 
 //----------------------------------------------------------------------------
 const vtkEllipticalSRep* vtkMRMLEllipticalSRepNode::GetEllipticalSRepWorld() const {
+  if (this->SRepWorldOutdated) {
+    const auto* matrix = this->GetSRepToWorldMatrix();
+    if (!this->SRep) {
+      this->SRepWorld = nullptr;
+    } else if (matrix && IsIdentity(*matrix)) {
+      // nothing to transform, so no need for a copy
+      this->SRepWorld = this->SRep;
+    } else {
+      try {
+        this->SRepWorld = matrix
+          ? SmartTransformSRep(this->SRep, matrix)
+          : SmartTransformSRep(this->SRep, this->GetSRepToWorldTransform());
+      } catch (const std::exception& e) {
+        // a transform that sends a spoke to nan or infinity can't make a valid srep
+        // (the error macros need a non-const object)
+        vtkErrorWithObjectMacro(const_cast<vtkMRMLEllipticalSRepNode*>(this),
+          "GetEllipticalSRepWorld: unable to transform the SRep to world: " << e.what());
+        this->SRepWorld = nullptr;
+      }
+    }
+    this->SRepWorldOutdated = false;
+  }
   return this->SRepWorld;
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLEllipticalSRepNode::InvalidateSRepWorld() {
+  this->SRepWorldOutdated = true;
+  this->SRepWorld = nullptr;
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLEllipticalSRepNode::SetEllipticalSRep(vtkEllipticalSRep* srep) {
   if (this->SRep) {
     this->SRep->RemoveObserver(this->SRepObservationTag);
   }
   this->SRep = srep;
+  this->ClearInterpolatedSRepCache();
   if (this->SRep) {
     this->SRepObservationTag = this->SRep->AddObserver(vtkCommand::ModifiedEvent, this, &vtkMRMLEllipticalSRepNode::onSRepModified);
   }
-  this->UpdateSRepWorld();
+  this->InvalidateSRepWorld();
   this->Modified();
 }
 
@@ -101,16 +220,33 @@ const vtkMeshSRepInterface* vtkMRMLEllipticalSRepNode::GetSRep() const {
 
 //----------------------------------------------------------------------------
 const vtkMeshSRepInterface* vtkMRMLEllipticalSRepNode::GetSRepWorld() const {
-  return this->SRepWorld;
+  return this->GetEllipticalSRepWorld();
 }
 
-//---------------------------------------------------------------------------
-void vtkMRMLEllipticalSRepNode::DoUpdateSRepWorld(vtkAbstractTransform* transform) {
+//----------------------------------------------------------------------------
+const vtkEllipticalSRep* vtkMRMLEllipticalSRepNode::GetCachedInterpolatedSRep(size_t interpolationLevel) const {
   if (!this->SRep) {
+    return nullptr;
+  }
+  const auto it = this->InterpolatedSRepCache.find(interpolationLevel);
+  if (it == this->InterpolatedSRepCache.end() || it->second.SourceMTime != this->SRep->GetMTime()) {
+    return nullptr;
+  }
+  return it->second.SRep;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLEllipticalSRepNode::SetCachedInterpolatedSRep(size_t interpolationLevel, vtkEllipticalSRep* interpolatedSRep) {
+  if (!this->SRep || !interpolatedSRep) {
+    this->InterpolatedSRepCache.erase(interpolationLevel);
     return;
   }
+  this->InterpolatedSRepCache[interpolationLevel] = CachedInterpolatedSRep{interpolatedSRep, this->SRep->GetMTime()};
+}
 
-  this->SRepWorld = SmartTransformSRep(this->SRep, transform);
+//----------------------------------------------------------------------------
+void vtkMRMLEllipticalSRepNode::ClearInterpolatedSRepCache() {
+  this->InterpolatedSRepCache.clear();
 }
 
 //---------------------------------------------------------------------------
@@ -120,8 +256,7 @@ void vtkMRMLEllipticalSRepNode::ApplyTransform(vtkAbstractTransform* transform)
     return;
   }
 
-  this->DoUpdateSRepWorld(transform);
-  this->SetEllipticalSRep(vtkSmartPointer<vtkEllipticalSRep>::Take(this->SRepWorld->Clone()));
+  this->SetEllipticalSRep(SmartTransformSRep(this->SRep, transform));
   // SetEllipticalSRep will call modified
 }
 
@@ -148,6 +283,7 @@ void vtkMRMLEllipticalSRepNode::CopyContent(vtkMRMLNode* anode, bool deepCopy/*=
 
 //----------------------------------------------------------------------------
 void vtkMRMLEllipticalSRepNode::onSRepModified(vtkObject* /*caller*/, unsigned long /*event*/, void* /*callData*/) {
-  this->UpdateSRepWorld();
+  this->ClearInterpolatedSRepCache();
+  this->InvalidateSRepWorld();
   this->Modified();
 }
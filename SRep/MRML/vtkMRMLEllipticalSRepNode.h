@@ -4,8 +4,21 @@
 #include "vtkMRMLSRepNode.h"
 #include "vtkEllipticalSRep.h"
 
+#include <map>
+
+class vtkMatrix4x4;
+
+/// @{
+/// Creates a transformed copy of the SRep.
+///
+/// Linear transforms (including a vtkAbstractTransform that is a vtkLinearTransform) are applied as a
+/// single matrix over all spokes. Non-linear transforms are evaluated in parallel.
+/// \returns nullptr if srep is nullptr. A plain clone if transform is nullptr.
 vtkEllipticalSRep* TransformSRep(vtkEllipticalSRep* srep, vtkAbstractTransform* transform);
 vtkSmartPointer<vtkEllipticalSRep> SmartTransformSRep(vtkEllipticalSRep* srep, vtkAbstractTransform* transform);
+vtkEllipticalSRep* TransformSRep(vtkEllipticalSRep* srep, const vtkMatrix4x4* matrix);
+vtkSmartPointer<vtkEllipticalSRep> SmartTransformSRep(vtkEllipticalSRep* srep, const vtkMatrix4x4* matrix);
+/// @}
 
 class VTK_SLICER_SREP_MODULE_MRML_EXPORT vtkMRMLEllipticalSRepNode
   : public vtkMRMLSRepNode
@@ -46,7 +59,11 @@ public:
   /// @}
 
   /// Gets the SRep, if any, after all transforms are applied.
-  /// If there are no transforms, this will be the same as GetEllipticalSRep
+  ///
+  /// The SRep world is only computed when this is called after the SRep or its transform changed.
+  /// If the transform is the identity, this returns the same object as GetEllipticalSRep.
+  /// \returns nullptr if there is no SRep, or if the transform can't be applied to it (for example it sends
+  ///          a spoke to infinity). The latter is reported as an error.
   /// \sa GetSRep, HasSRep
   const vtkEllipticalSRep* GetEllipticalSRepWorld() const;
 
@@ -59,15 +76,36 @@ public:
   /// Gets the SRep after all non-hardened transforms are applied.
   const vtkMeshSRepInterface* GetSRepWorld() const override;
 
+  /// @{
+  /// Cache of interpolated versions of the SRep, one per interpolation level.
+  ///
+  /// The cache is filled by whoever does the interpolation (see vtkSlicerSRepLogic::GetInterpolatedSRep)
+  /// so it can be shared by everyone who needs the same level. Entries are only valid for the
+  /// modification time of the SRep they were made from, and the whole cache is cleared any time the
+  /// SRep is modified or replaced. Cached SReps must not be modified, clone them if needed.
+  /// \returns nullptr if there is no valid interpolated SRep cached for the level.
+  const vtkEllipticalSRep* GetCachedInterpolatedSRep(size_t interpolationLevel) const;
+  void SetCachedInterpolatedSRep(size_t interpolationLevel, vtkEllipticalSRep* interpolatedSRep);
+  void ClearInterpolatedSRepCache();
+  /// @}
+
 protected:
   vtkMRMLEllipticalSRepNode();
-  void DoUpdateSRepWorld(vtkAbstractTransform* transform) override;
+  void InvalidateSRepWorld() override;
 
 private:
   // using shared_ptr to allow easy shallow copy in CopyContent
   vtkSmartPointer<vtkEllipticalSRep> SRep;
   unsigned long SRepObservationTag;
-  vtkSmartPointer<vtkEllipticalSRep> SRepWorld;
+  // computed lazily by GetEllipticalSRepWorld
+  mutable vtkSmartPointer<vtkEllipticalSRep> SRepWorld;
+  mutable bool SRepWorldOutdated;
+
+  struct CachedInterpolatedSRep {
+    vtkSmartPointer<vtkEllipticalSRep> SRep;
+    vtkMTimeType SourceMTime;
+  };
+  std::map<size_t, CachedInterpolatedSRep> InterpolatedSRepCache;
 
   void onSRepModified(vtkObject *caller, unsigned long event, void* callData);
 };
@@ -33,6 +33,11 @@ vtkMRMLSRepDisplayNode::vtkMRMLSRepDisplayNode()
     , RelativeThickness(0.001)
     , AbsoluteThickness(0.25)
     , UseAbsoluteThickness(false)
+    , PopulationDisplay(false)
+    , LowDetailSpokeThreshold(10000)
+    , LowDetailWhileInteracting(true)
+    , SphereResolution(8)
+    , TubeResolution(10)
 {}
 
 vtkMRMLSRepDisplayNode::~vtkMRMLSRepDisplayNode() = default;
@@ -135,6 +140,80 @@ void vtkMRMLSRepDisplayNode::UseAbsoluteThicknessOff() {
     this->SetUseAbsoluteThickness(false);
 }
 
+bool vtkMRMLSRepDisplayNode::GetPopulationDisplay() const {
+    return this->PopulationDisplay;
+}
+void vtkMRMLSRepDisplayNode::SetPopulationDisplay(bool population) {
+    if (this->PopulationDisplay != population) {
+        this->PopulationDisplay = population;
+        this->Modified();
+    }
+}
+void vtkMRMLSRepDisplayNode::PopulationDisplayOn() {
+    this->SetPopulationDisplay(true);
+}
+void vtkMRMLSRepDisplayNode::PopulationDisplayOff() {
+    this->SetPopulationDisplay(false);
+}
+
+void vtkMRMLSRepDisplayNode::SetLowDetailSpokeThreshold(int threshold) {
+    if (threshold < 0) {
+        vtkErrorMacro("Low detail spoke threshold must not be negative. Found " << threshold);
+        return;
+    }
+    if (this->LowDetailSpokeThreshold != threshold) {
+        this->LowDetailSpokeThreshold = threshold;
+        this->Modified();
+    }
+}
+int vtkMRMLSRepDisplayNode::GetLowDetailSpokeThreshold() const {
+    return this->LowDetailSpokeThreshold;
+}
+
+void vtkMRMLSRepDisplayNode::SetLowDetailWhileInteracting(bool lowDetail) {
+    if (this->LowDetailWhileInteracting != lowDetail) {
+        this->LowDetailWhileInteracting = lowDetail;
+        this->Modified();
+    }
+}
+bool vtkMRMLSRepDisplayNode::GetLowDetailWhileInteracting() const {
+    return this->LowDetailWhileInteracting;
+}
+void vtkMRMLSRepDisplayNode::LowDetailWhileInteractingOn() {
+    this->SetLowDetailWhileInteracting(true);
+}
+void vtkMRMLSRepDisplayNode::LowDetailWhileInteractingOff() {
+    this->SetLowDetailWhileInteracting(false);
+}
+
+void vtkMRMLSRepDisplayNode::SetSphereResolution(int resolution) {
+    if (resolution < 3) {
+        vtkErrorMacro("Sphere resolution must be at least 3. Found " << resolution);
+        return;
+    }
+    if (this->SphereResolution != resolution) {
+        this->SphereResolution = resolution;
+        this->Modified();
+    }
+}
+int vtkMRMLSRepDisplayNode::GetSphereResolution() const {
+    return this->SphereResolution;
+}
+
+void vtkMRMLSRepDisplayNode::SetTubeResolution(int resolution) {
+    if (resolution < 3) {
+        vtkErrorMacro("Tube resolution must be at least 3. Found " << resolution);
+        return;
+    }
+    if (this->TubeResolution != resolution) {
+        this->TubeResolution = resolution;
+        this->Modified();
+    }
+}
+int vtkMRMLSRepDisplayNode::GetTubeResolution() const {
+    return this->TubeResolution;
+}
+
 vtkSRepExportPolyDataProperties* vtkMRMLSRepDisplayNode::GetSRepExportPolyDataProperties() const {
     auto ret = this->SmartGetSRepExportPolyDataProperties();
     if (ret) {
@@ -95,6 +95,35 @@ public:
   void UseAbsoluteThicknessOn();
   void UseAbsoluteThicknessOff();
 
+  /// Draw this srep as one member of a population instead of on its own.
+  ///
+  /// All the sreps in a view with this on are merged and drawn together with a couple of actors, which
+  /// is what makes showing hundreds of them at once possible. Members are drawn with plain lines and
+  /// low resolution points, and opacity is ignored. Off by default.
+  void SetPopulationDisplay(bool population);
+  bool GetPopulationDisplay() const;
+  void PopulationDisplayOn();
+  void PopulationDisplayOff();
+
+  /// Level of detail. In low detail the srep is drawn with plain lines and points, which is fast enough to redraw
+  /// for very dense sreps. Otherwise the points are spheres and the lines are tubes.
+  /// @{
+  /// SReps with more spokes than this are always drawn in low detail. Defaults to 10000.
+  void SetLowDetailSpokeThreshold(int threshold);
+  int GetLowDetailSpokeThreshold() const;
+  /// Use low detail while the camera is being moved around. On by default.
+  void SetLowDetailWhileInteracting(bool lowDetail);
+  bool GetLowDetailWhileInteracting() const;
+  void LowDetailWhileInteractingOn();
+  void LowDetailWhileInteractingOff();
+  /// Number of subdivisions around and from pole to pole of the point spheres. At least 3, defaults to 8.
+  void SetSphereResolution(int resolution);
+  int GetSphereResolution() const;
+  /// Number of sides of the line tubes. At least 3, defaults to 10.
+  void SetTubeResolution(int resolution);
+  int GetTubeResolution() const;
+  /// @}
+
   VTK_NEWINSTANCE vtkSRepExportPolyDataProperties* GetSRepExportPolyDataProperties() const;
   vtkSmartPointer<vtkSRepExportPolyDataProperties> SmartGetSRepExportPolyDataProperties() const;
 
@@ -129,6 +158,11 @@ private:
   double RelativeThickness;
   double AbsoluteThickness;
   bool UseAbsoluteThickness;
+  bool PopulationDisplay;
+  int LowDetailSpokeThreshold;
+  bool LowDetailWhileInteracting;
+  int SphereResolution;
+  int TubeResolution;
 };
 
 #endif
@@ -2,6 +2,7 @@
 #include "vtkMRMLSRepStorageNode.h"
 #include <vtkAbstractTransform.h>
 #include <vtkGeneralTransform.h>
+#include <vtkMatrix4x4.h>
 #include <vtkMRMLScene.h>
 #include <vtkMRMLTransformNode.h>
 #include <vtkBoundingBox.h>
@@ -10,6 +11,8 @@
 vtkMRMLSRepNode::vtkMRMLSRepNode()
   : vtkMRMLDisplayableNode()
   , SRepTransform()
+  , SRepTransformMatrix()
+  , SRepTransformIsLinear(true)
 {
   this->SRepTransform->Identity();
 }
@@ -124,10 +127,7 @@ void vtkMRMLSRepNode::CopyContent(vtkMRMLNode* anode, bool deepCopy/*=true*/) {
 
 //---------------------------------------------------------------------------
 void vtkMRMLSRepNode::OnTransformNodeReferenceChanged(vtkMRMLTransformNode* transformNode) {
-
-  //this next line is a GetTransformToWorld one-liner that works even if this->GetParentTransformNode is nullptr
-  vtkMRMLTransformNode::GetTransformBetweenNodes(this->GetParentTransformNode(), nullptr, this->SRepTransform);
-  this->UpdateSRepWorld();
+  this->UpdateSRepTransform();
   Superclass::OnTransformNodeReferenceChanged(transformNode);
   this->Modified();
 }
@@ -138,15 +138,27 @@ void vtkMRMLSRepNode::ProcessMRMLEvents (vtkObject* caller,
                                          void* callData)
 {
   if (caller != nullptr && event == vtkMRMLTransformableNode::TransformModifiedEvent) {
-    //this next line is a GetTransformToWorld one-liner that works even if this->GetParentTransformNode is nullptr
-    vtkMRMLTransformNode::GetTransformBetweenNodes(this->GetParentTransformNode(), nullptr, this->SRepTransform);
-    this->UpdateSRepWorld();
+    this->UpdateSRepTransform();
   }
 
   Superclass::ProcessMRMLEvents(caller, event, callData);
 }
 
 //---------------------------------------------------------------------------
-void vtkMRMLSRepNode::UpdateSRepWorld() {
-  this->DoUpdateSRepWorld(this->SRepTransform);
+void vtkMRMLSRepNode::UpdateSRepTransform() {
+  //these next lines are GetTransformToWorld one-liners that work even if this->GetParentTransformNode is nullptr
+  vtkMRMLTransformNode::GetTransformBetweenNodes(this->GetParentTransformNode(), nullptr, this->SRepTransform);
+  this->SRepTransformIsLinear =
+    vtkMRMLTransformNode::GetMatrixTransformBetweenNodes(this->GetParentTransformNode(), nullptr, this->SRepTransformMatrix);
+  this->InvalidateSRepWorld();
+}
+
+//---------------------------------------------------------------------------
+vtkAbstractTransform* vtkMRMLSRepNode::GetSRepToWorldTransform() const {
+  return this->SRepTransform;
+}
+
+//---------------------------------------------------------------------------
+const vtkMatrix4x4* vtkMRMLSRepNode::GetSRepToWorldMatrix() const {
+  return this->SRepTransformIsLinear ? this->SRepTransformMatrix.GetPointer() : nullptr;
 }
@@ -15,6 +15,7 @@
 
 class vtkAbstractTransform;
 class vtkGeneralTransform;
+class vtkMatrix4x4;
 class vtkMRMLTransformNode;
 
 class VTK_SLICER_SREP_MODULE_MRML_EXPORT vtkMRMLSRepNode : public vtkMRMLDisplayableNode
@@ -96,16 +97,26 @@ public:
 protected:
   vtkMRMLSRepNode();
 
-  /// Call this to update the srep world with the stored transform.
-  void UpdateSRepWorld();
+  /// Called whenever the SRep world is out of date because the SRep or its transform changed.
+  ///
+  /// Subclasses should not do any expensive work here, just remember to recompute the SRep world the
+  /// next time GetSRepWorld is called.
+  virtual void InvalidateSRepWorld() = 0;
+
+  /// Gets the transform from the SRep to world. Never nullptr.
+  vtkAbstractTransform* GetSRepToWorldTransform() const;
 
-  /// Transform the SRep.
+  /// Gets the transform from the SRep to world as a matrix.
   ///
-  /// \param transform The transform to use. If nullptr, same as identity (i.e. no transform).
-  virtual void DoUpdateSRepWorld(vtkAbstractTransform* transform) = 0;
+  /// \returns nullptr if the transform is not linear.
+  const vtkMatrix4x4* GetSRepToWorldMatrix() const;
 
 private:
-  vtkNew<vtkGeneralTransform> SRepTransform; // nullptr means no transform.
+  vtkNew<vtkGeneralTransform> SRepTransform;
+  vtkNew<vtkMatrix4x4> SRepTransformMatrix;
+  bool SRepTransformIsLinear;
+
+  void UpdateSRepTransform();
 };
 
 #endif
@@ -4,8 +4,12 @@
 #include "vtkMRMLScene.h"
 #include "vtkStringArray.h"
 
+#include "srepBinaryIO.h"
 #include "srepUtil.h"
 
+#include <algorithm>
+#include <iterator>
+
 // Relax JSON standard and allow reading/writing of nan and inf
 // values. Such values should not normally occur, but if they do then
 // it is easier to troubleshoot problems if numerical values are the
@@ -17,10 +21,16 @@
 
 #include "rapidjson/document.h"     // rapidjson's DOM-style API
 #include "rapidjson/prettywriter.h" // for stringify JSON
+#include "rapidjson/writer.h"
 #include "rapidjson/filereadstream.h"
 #include "rapidjson/filewritestream.h"
+#include "rapidjson/memorystream.h"
+#include "rapidjson/ostreamwrapper.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/reader.h"       // rapidjson's SAX-style API
 
 using srep::util::finally;
+namespace binary = srep::binary;
 
 namespace {
 
@@ -51,9 +61,30 @@ namespace keys {
   const char * const UseAbsoluteThickness = "UseAbsoluteThickness";
 
   const char * const CoordinateSystem = "CoordinateSystem";
+
+  // schema version 2
+  const char * const FormatVersion = "FormatVersion";
+  const char * const UpSpokes = "UpSpokes";
+  const char * const DownSpokes = "DownSpokes";
+  const char * const CrestSpokes = "CrestSpokes";
+  const char * const SkeletalPoints = "SkeletalPoints";
+  const char * const Directions = "Directions";
+  const char * const Radii = "Radii";
+}
+
+/// Newest JSON schema version this can read and write. Files without a FormatVersion are version 1.
+constexpr unsigned LatestJsonFormatVersion = 2;
+
+/// Arrays are always on one line with a compact writer
+template <class OutputStream>
+void setSingleLineArrays(rapidjson::PrettyWriter<OutputStream>& writer, bool singleLine) {
+  writer.SetFormatOptions(singleLine ? rapidjson::kFormatSingleLineArray : rapidjson::kFormatDefault);
 }
+template <class OutputStream>
+void setSingleLineArrays(rapidjson::Writer<OutputStream>&, bool) {}
 
-void writeCoordinateSystem(rapidjson::PrettyWriter<rapidjson::FileWriteStream>& writer, int storageCoord) {
+template <class Writer>
+void writeCoordinateSystem(Writer& writer, int storageCoord) {
   if (storageCoord == vtkMRMLStorageNode::CoordinateSystemLPS) {
     writer.String("LPS");
   } else if (storageCoord == vtkMRMLStorageNode::CoordinateSystemRAS) {
@@ -63,12 +94,7 @@ void writeCoordinateSystem(rapidjson::PrettyWriter<rapidjson::FileWriteStream>&
   }
 }
 
-int readCoordinateSystem(rapidjson::Value& json) {
-  if (!json.IsString()) {
-    throw std::invalid_argument("Expect string for coordinate system");
-  }
-
-  const std::string value = json.GetString();
+int readCoordinateSystem(const std::string& value) {
   if (value == "LPS") {
     return vtkMRMLStorageNode::CoordinateSystemLPS;
   } else if (value == "RAS") {
@@ -78,31 +104,8 @@ int readCoordinateSystem(rapidjson::Value& json) {
   }
 }
 
-std::array<double, 3> FromRASToCoord(const std::array<double, 3>& arr, int storageCoord) {
-  if (storageCoord == vtkMRMLStorageNode::CoordinateSystemLPS) {
-    return std::array<double, 3>{-arr[0], -arr[1], arr[2]};
-  } else if (storageCoord == vtkMRMLStorageNode::CoordinateSystemRAS) {
-    return arr;
-  } else {
-    throw std::invalid_argument("Unknown coordinate system type: " + std::to_string(storageCoord));
-  }
-}
-
-std::array<double, 3> FromCoordToRAS(const std::array<double, 3>& arr, int storageCoord) {
-  // same transformation both ways, but two functions helps keep things straight.
-  return FromRASToCoord(arr, storageCoord);
-}
-
 constexpr size_t BufferSize = 65535;
 
-rapidjson::Value::MemberIterator SafeFindMember(rapidjson::Value& json, const char* name) {
-  auto iter = json.FindMember(name);
-  if (iter == json.MemberEnd()) {
-    throw std::invalid_argument(std::string("Error finding json member '") + name + "'");
-  }
-  return iter;
-}
-
 double readDouble(rapidjson::Value& json) {
   if (!json.IsDouble()) {
     throw std::invalid_argument("Expected a JSON double.");
@@ -124,15 +127,8 @@ int readInt(rapidjson::Value& json) {
   return json.GetInt();
 }
 
-int readUint(rapidjson::Value& json) {
-  if (!json.IsUint()) {
-    throw std::invalid_argument("Expected a JSON uint.");
-  }
-  return json.GetUint();
-}
-
-template<size_t N>
-void writeSingleLineArray(rapidjson::PrettyWriter<rapidjson::FileWriteStream>& writer, const std::array<double, N>& arr) {
+template<class OutputStream, size_t N>
+void writeSingleLineArray(rapidjson::PrettyWriter<OutputStream>& writer, const std::array<double, N>& arr) {
   writer.SetFormatOptions(rapidjson::kFormatSingleLineArray);
   writer.StartArray();
   for (const auto d : arr) {
@@ -142,56 +138,26 @@ void writeSingleLineArray(rapidjson::PrettyWriter<rapidjson::FileWriteStream>& w
   writer.SetFormatOptions(rapidjson::kFormatDefault);
 }
 
-void write(rapidjson::PrettyWriter<rapidjson::FileWriteStream>& writer, const srep::Point3d& point, int coordinateSystem) {
+template <class OutputStream>
+void write(rapidjson::PrettyWriter<OutputStream>& writer, const srep::Point3d& point, int coordinateSystem) {
   writer.StartObject();
   writer.Key(keys::CoordinateSystem); writeCoordinateSystem(writer, coordinateSystem);
   writer.Key(keys::Value);
-  writeSingleLineArray(writer, FromRASToCoord(point.AsArray(), coordinateSystem));
+  writeSingleLineArray(writer, srep::fromRASToCoord(point.AsArray(), coordinateSystem));
   writer.EndObject();
 }
 
-std::array<double, 3> read3dArray(rapidjson::Value& json) {
-  if (!json.IsArray()) {
-    throw std::invalid_argument("Attempting to read an array that is not a json array");
-  }
-  auto jsonArray = json.GetArray();
-
-  if (jsonArray.Size() != 3) {
-    throw std::invalid_argument("Attempting to read a 3D array that doesn't have 3 dimensions");
-  }
-
-  std::array<double, 3> array;
-  std::transform(jsonArray.Begin(), jsonArray.End(), array.begin(), readDouble);
-  return array;
-}
-
-srep::Point3d readPoint3d(rapidjson::Value& json) {
-  if (!json.IsObject()) {
-    throw std::invalid_argument("Expected a json object for srep::Point3d");
-  }
-  return srep::Point3d(FromCoordToRAS(
-    read3dArray(SafeFindMember(json, keys::Value)->value),
-    readCoordinateSystem(SafeFindMember(json, keys::CoordinateSystem)->value)));
-}
-
-void write(rapidjson::PrettyWriter<rapidjson::FileWriteStream>& writer, const srep::Vector3d& vector, int coordinateSystem) {
+template <class OutputStream>
+void write(rapidjson::PrettyWriter<OutputStream>& writer, const srep::Vector3d& vector, int coordinateSystem) {
   writer.StartObject();
   writer.Key(keys::CoordinateSystem); writeCoordinateSystem(writer, coordinateSystem);
   writer.Key(keys::Value);
-  writeSingleLineArray(writer, FromRASToCoord(vector.AsArray(), coordinateSystem));
+  writeSingleLineArray(writer, srep::fromRASToCoord(vector.AsArray(), coordinateSystem));
   writer.EndObject();
 }
 
-srep::Vector3d readVector3d(rapidjson::Value& json) {
-  if (!json.IsObject()) {
-    throw std::invalid_argument("Expected a json object for srep::Point3d");
-  }
-  return srep::Vector3d(FromCoordToRAS(
-    read3dArray(SafeFindMember(json, keys::Value)->value),
-    readCoordinateSystem(SafeFindMember(json, keys::CoordinateSystem)->value)));
-}
-
-void write(rapidjson::PrettyWriter<rapidjson::FileWriteStream>& writer, const vtkSRepSpoke& spoke, int coordinateSystem) {
+template <class OutputStream>
+void write(rapidjson::PrettyWriter<OutputStream>& writer, const vtkSRepSpoke& spoke, int coordinateSystem) {
   writer.StartObject();
   writer.Key(keys::SkeletalPoint);
   write(writer, spoke.GetSkeletalPoint(), coordinateSystem);
@@ -200,23 +166,17 @@ void write(rapidjson::PrettyWriter<rapidjson::FileWriteStream>& writer, const vt
   writer.EndObject();
 }
 
-vtkSmartPointer<vtkSRepSpoke> readSpoke(rapidjson::Value& json) {
-  auto skeletalIter = SafeFindMember(json, keys::SkeletalPoint);
-  auto directionIter = SafeFindMember(json, keys::Direction);
-  return vtkSRepSpoke::SmartCreate(readPoint3d(skeletalIter->value), readVector3d(directionIter->value));
-}
-
 // raw write, no concept of what the rows and cols mean
 
-void write(rapidjson::PrettyWriter<rapidjson::FileWriteStream>& writer, vtkMRMLEllipticalSRepNode& mrmlSRep, int coordinateSystem) {
+template <class OutputStream>
+void write(rapidjson::PrettyWriter<OutputStream>& writer, const vtkEllipticalSRep* srep, int coordinateSystem) {
   using IndexType = vtkEllipticalSRep::IndexType;
-  const auto srep = mrmlSRep.GetEllipticalSRep();
 
   writer.Key(keys::EllipticalSRep);
   writer.StartObject();
   {
-    writer.Key(keys::CrestPoints); writer.Uint(srep->GetNumberOfLines());
-    writer.Key(keys::Steps); writer.Uint(srep->GetNumberOfSteps() - 1);
+    writer.Key(keys::CrestPoints); writer.Uint(srep ? srep->GetNumberOfLines() : 0);
+    writer.Key(keys::Steps); writer.Uint(srep ? srep->GetNumberOfSteps() - 1 : 0);
     writer.Key(keys::Skeleton);
     writer.StartArray();
     if (srep) {
@@ -243,57 +203,57 @@ void write(rapidjson::PrettyWriter<rapidjson::FileWriteStream>& writer, vtkMRMLE
   writer.EndObject();
 }
 
-void read(rapidjson::Value& json, vtkMRMLEllipticalSRepNode* ellipticalSRep) {
-  if (!ellipticalSRep) {
-    throw std::invalid_argument("Node is not a vtkMRMLEllipticalSRepNode");
-  }
-
-  const auto numFoldPoints = readUint(SafeFindMember(json, keys::CrestPoints)->value);
-  const auto numSteps = readUint(SafeFindMember(json, keys::Steps)->value);
-
-  vtkNew<vtkEllipticalSRep> srep;
-  srep->Resize(numFoldPoints, numSteps + 1);
-
-  auto& skeleton = SafeFindMember(json, keys::Skeleton)->value;
-  if (!skeleton.IsArray()) {
-    throw std::invalid_argument("Expected a JSON array.");
-  }
-
-  vtkEllipticalSRep::IndexType line = 0;
-  for (auto& row : skeleton.GetArray()) { //row is the line
-    vtkEllipticalSRep::IndexType step = 0;
-    if (!row.IsArray()) {
-      throw std::runtime_error("Error parsing in vtkMRMLEllipticalSRepNode. Row is not array.");
+// Schema version 2. Every spoke of an orientation is packed into flat arrays, in the same order as
+// vtkEllipticalSRep::GetSpokeArrays. The coordinate system is written once, for the whole file, by the caller.
+template <class OutputStream>
+void writeV2(rapidjson::Writer<OutputStream>& writer, const vtkEllipticalSRep& srep, int coordinateSystem) {
+  const auto writeValues = [&writer](const std::vector<double>& values) {
+    writer.StartArray();
+    for (const auto d : values) {
+      writer.Double(d);
     }
-    for (auto& object : row.GetArray()) {
-      auto upIter = SafeFindMember(object, keys::UpSpoke);
-      auto downIter = SafeFindMember(object, keys::DownSpoke);
-
-      auto upSpoke = readSpoke(upIter->value);
-      auto downSpoke = readSpoke(downIter->value);
-
-      auto crestIter = object.FindMember(keys::CrestSpoke);
-      vtkSmartPointer<vtkSRepSpoke> crestSpoke = nullptr;
-      if (crestIter != object.MemberEnd()) {
-        crestSpoke = readSpoke(crestIter->value);
+    writer.EndArray();
+  };
+  const auto writePoints = [&writer, coordinateSystem](const std::vector<double>& values) {
+    writer.StartArray();
+    for (size_t i = 0; i + 2 < values.size(); i += 3) {
+      for (const auto d : srep::fromRASToCoord({values[i], values[i + 1], values[i + 2]}, coordinateSystem)) {
+        writer.Double(d);
       }
-      srep->SetSkeletalPoint(line, step, vtkSRepSkeletalPoint::SmartCreate(upSpoke, downSpoke, crestSpoke));
-      ++step;
     }
-    ++line;
-  }
+    writer.EndArray();
+  };
 
-  ellipticalSRep->SetEllipticalSRep(srep);
+  writer.Key(keys::EllipticalSRep);
+  writer.StartObject();
+  writer.Key(keys::CrestPoints); writer.Uint(srep.GetNumberOfLines());
+  writer.Key(keys::Steps); writer.Uint(srep.GetNumberOfSteps() > 0 ? srep.GetNumberOfSteps() - 1 : 0);
+  const std::array<std::pair<const char*, vtkSRepSkeletalPoint::SpokeOrientation>, 3> orientations{{
+    {keys::UpSpokes, vtkSRepSkeletalPoint::UpOrientation},
+    {keys::DownSpokes, vtkSRepSkeletalPoint::DownOrientation},
+    {keys::CrestSpokes, vtkSRepSkeletalPoint::CrestOrientation},
+  }};
+  for (const auto& orientation : orientations) {
+    const auto spokes = srep.GetSpokeArrays(orientation.second);
+    writer.Key(orientation.first);
+    writer.StartObject();
+    writer.Key(keys::SkeletalPoints); writePoints(spokes.SkeletalPoints);
+    writer.Key(keys::Directions); writePoints(spokes.Directions);
+    writer.Key(keys::Radii); writeValues(spokes.Radii);
+    writer.EndObject();
+  }
+  writer.EndObject();
 }
 
-void write(rapidjson::PrettyWriter<rapidjson::FileWriteStream>& writer, const vtkColor3ub& color) {
-  writer.SetFormatOptions(rapidjson::kFormatSingleLineArray);
+template <class Writer>
+void write(Writer& writer, const vtkColor3ub& color) {
+  setSingleLineArrays(writer, true);
   writer.StartArray();
   writer.Int(color[0]);
   writer.Int(color[1]);
   writer.Int(color[2]);
   writer.EndArray();
-  writer.SetFormatOptions(rapidjson::kFormatDefault);
+  setSingleLineArrays(writer, false);
 }
 
 vtkColor3ub readVTKColor3ub(rapidjson::Value& json) {
@@ -311,7 +271,8 @@ vtkColor3ub readVTKColor3ub(rapidjson::Value& json) {
   return vtkColor3ub(array[0], array[1], array[2]);
 }
 
-void writeDisplayNodeColors(rapidjson::PrettyWriter<rapidjson::FileWriteStream>& writer, vtkMRMLSRepDisplayNode& displayNode) {
+template <class Writer>
+void writeDisplayNodeColors(Writer& writer, vtkMRMLSRepDisplayNode& displayNode) {
   writer.StartObject();
   writer.Key(keys::UpSpoke);
   write(writer, displayNode.GetUpSpokeColor());
@@ -348,7 +309,8 @@ void readDisplayNodeColors(rapidjson::Value& json, vtkMRMLSRepDisplayNode& displ
   readAndSetIfExists(keys::SkeletonToCrestConnection, &vtkMRMLSRepDisplayNode::SetSkeletonToCrestConnectionColor);
 }
 
-void writeDisplayNodePiecewiseVisibilities(rapidjson::PrettyWriter<rapidjson::FileWriteStream>& writer, vtkMRMLSRepDisplayNode& displayNode) {
+template <class Writer>
+void writeDisplayNodePiecewiseVisibilities(Writer& writer, vtkMRMLSRepDisplayNode& displayNode) {
   writer.StartObject();
   writer.Key(keys::UpSpoke);
   writer.Bool(displayNode.GetUpSpokeVisibility());
@@ -385,7 +347,8 @@ void readDisplayNodePiecewiseVisibilities(rapidjson::Value& json, vtkMRMLSRepDis
   readAndSetIfExists(keys::SkeletonToCrestConnection, &vtkMRMLSRepDisplayNode::SetSkeletonToCrestConnectionVisibility);
 }
 
-void write(rapidjson::PrettyWriter<rapidjson::FileWriteStream>& writer, vtkMRMLSRepDisplayNode& displayNode) {
+template <class Writer>
+void write(Writer& writer, vtkMRMLSRepDisplayNode& displayNode) {
   writer.Key(keys::Display);
   writer.StartObject();
   writer.Key(keys::Visibility);
@@ -441,8 +404,588 @@ void read(rapidjson::Value& json, vtkMRMLSRepDisplayNode& displayNode) {
   }
 }
 
-// must not return nullptr. Throws on error.
-std::unique_ptr<rapidjson::Document> CreateJsonDocumentFromFile(const char* filePath) {
+/// Copies everything write(writer, displayNode) stores.
+void copyStoredProperties(vtkMRMLSRepDisplayNode& from, vtkMRMLSRepDisplayNode& to) {
+  const int wasModifying = to.StartModify();
+  to.SetVisibility(from.GetVisibility());
+  to.SetOpacity(from.GetOpacity());
+  to.SetRelativeThickness(from.GetRelativeThickness());
+  to.SetAbsoluteThickness(from.GetAbsoluteThickness());
+  to.SetUseAbsoluteThickness(from.GetUseAbsoluteThickness());
+  to.SetUpSpokeColor(from.GetUpSpokeColor());
+  to.SetDownSpokeColor(from.GetDownSpokeColor());
+  to.SetCrestSpokeColor(from.GetCrestSpokeColor());
+  to.SetSkeletalSheetColor(from.GetSkeletalSheetColor());
+  to.SetCrestCurveColor(from.GetCrestCurveColor());
+  to.SetSkeletonToCrestConnectionColor(from.GetSkeletonToCrestConnectionColor());
+  to.SetUpSpokeVisibility(from.GetUpSpokeVisibility());
+  to.SetDownSpokeVisibility(from.GetDownSpokeVisibility());
+  to.SetCrestSpokeVisibility(from.GetCrestSpokeVisibility());
+  to.SetSkeletalSheetVisibility(from.GetSkeletalSheetVisibility());
+  to.SetCrestCurveVisibility(from.GetCrestCurveVisibility());
+  to.SetSkeletonToCrestConnectionVisibility(from.GetSkeletonToCrestConnectionVisibility());
+  to.EndModify(wasModifying);
+}
+
+/// Reads a .srep.json file from rapidjson's SAX events, without building a DOM for it.
+///
+/// Spoke values are written into SkeletalPoints (version 1) or PackedSpokes (version 2) as they arrive and the
+/// vtkEllipticalSRep is only built at the end, in one step, by CreateEllipticalSRep. Anything other than the srep,
+/// like the display properties, is small, so it is collected into a rapidjson::Value and read the same way as it
+/// would be from a full document. Unknown members are skipped.
+///
+/// As a probe (SetProbe), the spokes are checked but not kept and parsing stops as soon as everything asked for
+/// is known.
+class SRepJsonHandler
+  : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, SRepJsonHandler>
+{
+public:
+  SRepJsonHandler() = default;
+  SRepJsonHandler(const SRepJsonHandler&) = delete;
+  SRepJsonHandler(SRepJsonHandler&&) = delete;
+  SRepJsonHandler& operator=(const SRepJsonHandler&) = delete;
+  SRepJsonHandler& operator=(SRepJsonHandler&&) = delete;
+
+  /// @{
+  /// rapidjson handler interface. Returning false stops the parse, GetError says why.
+  bool Null() { return this->Scalar(rapidjson::Value()); }
+  bool Bool(bool b) { return this->Scalar(rapidjson::Value(b)); }
+  bool Int(int i) { return this->Scalar(rapidjson::Value(i)); }
+  bool Uint(unsigned u) { return this->Scalar(rapidjson::Value(u)); }
+  bool Int64(int64_t i) { return this->Scalar(rapidjson::Value(i)); }
+  bool Uint64(uint64_t u) { return this->Scalar(rapidjson::Value(u)); }
+  bool Double(double d) { return this->Scalar(rapidjson::Value(d)); }
+  bool String(const char* str, rapidjson::SizeType length, bool copy);
+  bool StartObject();
+  bool Key(const char* str, rapidjson::SizeType length, bool copy);
+  bool EndObject(rapidjson::SizeType memberCount);
+  bool StartArray();
+  bool EndArray(rapidjson::SizeType elementCount);
+  /// @}
+
+  /// Why the parse was stopped, empty if it wasn't stopped by this handler.
+  const std::string& GetError() const { return this->Error; }
+  /// Whether the parse was stopped because a probe had everything it wanted.
+  bool IsProbeDone() const { return this->ProbeDone; }
+
+  /// Only reads the type, size and coordinate system, and the display properties if readDisplay is true.
+  void SetProbe(bool readDisplay) {
+    this->Probe = true;
+    this->ProbeDisplay = readDisplay;
+  }
+
+  bool HasEllipticalSRep() const { return this->FoundEllipticalSRep; }
+  /// Number of lines and steps (including the spine) from CrestPoints and Steps, 0 if either is missing.
+  vtkEllipticalSRep::IndexType GetNumberOfLines() const {
+    return this->HasCrestPoints && this->HasSteps ? this->CrestPoints : 0;
+  }
+  vtkEllipticalSRep::IndexType GetNumberOfSteps() const {
+    return this->HasCrestPoints && this->HasSteps ? this->Steps + 1u : 0;
+  }
+  /// Coordinate system of the file (version 2) or of its first point or direction (version 1), -1 if there isn't one.
+  int GetCoordinateSystem() const { return this->FirstCoordinateSystem; }
+  unsigned GetFormatVersion() const { return this->FormatVersion; }
+  /// Only call this once, version 2 spoke values are moved into the srep.
+  /// \throws std::invalid_argument if the srep read doesn't match its CrestPoints and Steps, or isn't a valid srep.
+  vtkSmartPointer<vtkEllipticalSRep> CreateEllipticalSRep();
+
+  /// The "Display" member, nullptr if there wasn't one.
+  rapidjson::Value* GetDisplay() { return this->FoundDisplay ? &this->Display : nullptr; }
+
+private:
+  /// What the value being read is part of.
+  enum class Level {
+    Root, EllipticalSRep, Collected,
+    // version 1
+    Skeleton, Line, SkeletalPoint, Spoke, Vector, VectorValue,
+    // version 2
+    PackedSpokes, PackedValues
+  };
+
+  struct Frame {
+    Level Type;
+    /// Last key read in an object
+    std::string Key;
+  };
+
+  struct SpokeValues {
+    std::array<double, 3> SkeletalPoint;
+    std::array<double, 3> Direction;
+    bool HasSkeletalPoint = false;
+    bool HasDirection = false;
+  };
+
+  struct SkeletalPointValues {
+    SpokeValues Up;
+    SpokeValues Down;
+    SpokeValues Crest;
+  };
+
+  bool Fail(const std::string& error) {
+    this->Error = error;
+    return false;
+  }
+
+  /// Returns false, stopping the parse, if this is a probe and it has everything it wants.
+  bool Continue() {
+    this->ProbeDone = this->Probe
+      && this->FoundEllipticalSRep && this->HasCrestPoints && this->HasSteps && this->FirstCoordinateSystem != -1
+      && (!this->ProbeDisplay || this->FoundDisplay);
+    return !this->ProbeDone;
+  }
+
+  /// Pushes the frame for an object or array that is starting, based on where it is.
+  bool StartContainer(bool isArray);
+  /// Pops the frame of an object or array that ended, finishing whatever it held.
+  bool EndContainer();
+  /// Moves the version 2 spoke arrays out, converted to RAS.
+  vtkEllipticalSRep::SpokeArrays TakePackedSpokes(vtkSRepSkeletalPoint::SpokeOrientation orientation);
+  bool Scalar(rapidjson::Value&& value);
+
+  /// If the value starting now should be collected rather than read, starts collecting it.
+  void MaybeStartCollecting();
+  /// Hands a finished collected value over, if it was one we want.
+  void FinishCollecting();
+
+  std::vector<Frame> Frames;
+  std::string Error;
+  bool Probe = false;
+  bool ProbeDisplay = false;
+  bool ProbeDone = false;
+
+  bool FoundEllipticalSRep = false;
+  bool HasCrestPoints = false;
+  bool HasSteps = false;
+  unsigned CrestPoints = 0;
+  unsigned Steps = 0;
+  std::vector<SkeletalPointValues> SkeletalPoints;
+  std::vector<size_t> LineLengths;
+  size_t LineStart = 0;
+  SpokeValues* CurrentSpoke = nullptr;
+  std::array<double, 3> VectorValue;
+  size_t VectorValueCount = 0;
+  int VectorCoordinateSystem = -1;
+  int FirstCoordinateSystem = -1;
+
+  unsigned FormatVersion = 1;
+  std::array<vtkEllipticalSRep::SpokeArrays, 3> PackedSpokes;
+  vtkSRepSkeletalPoint::SpokeOrientation CurrentOrientation = vtkSRepSkeletalPoint::UpOrientation;
+  std::vector<double>* CurrentPackedValues = nullptr;
+
+  // Values being collected, in the order they were read. Containers are built when they end.
+  rapidjson::Document::AllocatorType Allocator;
+  std::vector<rapidjson::Value> Collected;
+  size_t CollectingDepth = 0;
+  std::vector<std::string> CollectedKeys;
+  bool FoundDisplay = false;
+  rapidjson::Value Display;
+};
+
+void SRepJsonHandler::MaybeStartCollecting() {
+  if (this->CollectingDepth != 0 || this->Frames.empty()) {
+    return;
+  }
+  const auto& top = this->Frames.back();
+  bool read = false;
+  switch (top.Type) {
+    case Level::Root:
+      read = top.Key == keys::EllipticalSRep || top.Key == keys::FormatVersion || top.Key == keys::CoordinateSystem;
+      break;
+    case Level::EllipticalSRep:
+      read = top.Key == keys::CrestPoints || top.Key == keys::Steps || top.Key == keys::Skeleton
+        || top.Key == keys::UpSpokes || top.Key == keys::DownSpokes || top.Key == keys::CrestSpokes;
+      break;
+    case Level::Skeleton:
+    case Level::Line:
+    case Level::VectorValue:
+    case Level::PackedValues:
+      read = true;
+      break;
+    case Level::PackedSpokes:
+      read = top.Key == keys::SkeletalPoints || top.Key == keys::Directions || top.Key == keys::Radii;
+      break;
+    case Level::SkeletalPoint:
+      read = top.Key == keys::UpSpoke || top.Key == keys::DownSpoke || top.Key == keys::CrestSpoke;
+      break;
+    case Level::Spoke:
+      read = top.Key == keys::SkeletalPoint || top.Key == keys::Direction;
+      break;
+    case Level::Vector:
+      read = top.Key == keys::CoordinateSystem || top.Key == keys::Value;
+      break;
+    case Level::Collected:
+      break;
+  }
+  if (!read) {
+    this->CollectingDepth = this->Frames.size();
+  }
+}
+
+void SRepJsonHandler::FinishCollecting() {
+  if (this->CollectingDepth == this->Frames.size()) {
+    this->CollectingDepth = 0;
+    if (this->Frames.size() == 1 && this->Frames.back().Key == keys::Display) {
+      this->Display = std::move(this->Collected.back());
+      this->FoundDisplay = true;
+    }
+    this->Collected.clear();
+    this->CollectedKeys.clear();
+  }
+}
+
+bool SRepJsonHandler::Scalar(rapidjson::Value&& value) {
+  this->MaybeStartCollecting();
+  if (this->CollectingDepth != 0) {
+    this->Collected.push_back(std::move(value));
+    this->FinishCollecting();
+    return this->Continue();
+  }
+
+  if (this->Frames.empty()) {
+    return this->Fail("Expected a JSON object at the root of the file");
+  }
+  const auto& top = this->Frames.back();
+  if (top.Type == Level::PackedValues) {
+    if (!value.IsNumber()) {
+      return this->Fail("Expected a JSON number in a spoke array");
+    }
+    if (!this->Probe) {
+      this->CurrentPackedValues->push_back(value.GetDouble());
+    }
+    return true;
+  }
+  if (top.Type == Level::Root && top.Key == keys::FormatVersion) {
+    if (!value.IsUint()) {
+      return this->Fail(std::string("Expected a JSON uint for '") + keys::FormatVersion + "'");
+    }
+    this->FormatVersion = value.GetUint();
+    if (this->FormatVersion < 1 || this->FormatVersion > LatestJsonFormatVersion) {
+      return this->Fail("Unsupported srep JSON format version: " + std::to_string(this->FormatVersion));
+    }
+    return true;
+  }
+  if (top.Type == Level::Root && top.Key == keys::CoordinateSystem) {
+    if (!value.IsString()) {
+      return this->Fail("Expect string for coordinate system");
+    }
+    try {
+      this->FirstCoordinateSystem = readCoordinateSystem(std::string(value.GetString(), value.GetStringLength()));
+    } catch (const std::exception& e) {
+      return this->Fail(e.what());
+    }
+    return this->Continue();
+  }
+  if (top.Type == Level::EllipticalSRep && (top.Key == keys::CrestPoints || top.Key == keys::Steps)) {
+    if (!value.IsUint()) {
+      return this->Fail(std::string("Expected a JSON uint for '") + top.Key + "'");
+    }
+    if (top.Key == keys::CrestPoints) {
+      this->CrestPoints = value.GetUint();
+      this->HasCrestPoints = true;
+    } else {
+      this->Steps = value.GetUint();
+      this->HasSteps = true;
+    }
+    if (this->HasCrestPoints && this->HasSteps && !this->Probe) {
+      const auto lines = static_cast<size_t>(this->CrestPoints);
+      const auto steps = static_cast<size_t>(this->Steps) + 1;
+      if (this->FormatVersion >= 2) {
+        for (auto orientation : {vtkSRepSkeletalPoint::UpOrientation, vtkSRepSkeletalPoint::DownOrientation, vtkSRepSkeletalPoint::CrestOrientation}) {
+          const auto numberOfSpokes = orientation == vtkSRepSkeletalPoint::CrestOrientation ? lines : lines * steps;
+          auto& spokes = this->PackedSpokes[orientation];
+          spokes.SkeletalPoints.reserve(3 * numberOfSpokes);
+          spokes.Directions.reserve(3 * numberOfSpokes);
+          spokes.Radii.reserve(numberOfSpokes);
+        }
+      } else {
+        this->SkeletalPoints.reserve(lines * steps);
+      }
+    }
+    return this->Continue();
+  }
+  if (top.Type == Level::VectorValue) {
+    if (!value.IsNumber()) {
+      return this->Fail("Expected a JSON number in a 3D array");
+    }
+    if (this->VectorValueCount == this->VectorValue.size()) {
+      return this->Fail("Attempting to read a 3D array that doesn't have 3 dimensions");
+    }
+    this->VectorValue[this->VectorValueCount++] = value.GetDouble();
+    return true;
+  }
+  if (top.Type == Level::Vector && top.Key == keys::CoordinateSystem) {
+    if (!value.IsString()) {
+      return this->Fail("Expect string for coordinate system");
+    }
+    try {
+      this->VectorCoordinateSystem = readCoordinateSystem(std::string(value.GetString(), value.GetStringLength()));
+    } catch (const std::exception& e) {
+      return this->Fail(e.what());
+    }
+    if (this->FirstCoordinateSystem == -1) {
+      this->FirstCoordinateSystem = this->VectorCoordinateSystem;
+    }
+    return this->Continue();
+  }
+  return this->Fail("Unexpected JSON value in srep");
+}
+
+bool SRepJsonHandler::String(const char* str, rapidjson::SizeType length, bool) {
+  return this->Scalar(rapidjson::Value(str, length, this->Allocator));
+}
+
+bool SRepJsonHandler::StartObject() {
+  return this->StartContainer(false);
+}
+
+bool SRepJsonHandler::StartArray() {
+  return this->StartContainer(true);
+}
+
+bool SRepJsonHandler::StartContainer(bool isArray) {
+  this->MaybeStartCollecting();
+  if (this->CollectingDepth != 0) {
+    this->Frames.push_back(Frame{Level::Collected, std::string()});
+    return true;
+  }
+
+  const auto expected = [&](bool shouldBeArray, Level type) {
+    if (isArray != shouldBeArray) {
+      return this->Fail(std::string("Expected a JSON ") + (shouldBeArray ? "array" : "object") + " in srep");
+    }
+    this->Frames.push_back(Frame{type, std::string()});
+    return true;
+  };
+
+  if (this->Frames.empty()) {
+    return expected(false, Level::Root);
+  }
+  switch (this->Frames.back().Type) {
+    case Level::Root:
+      if (this->Frames.back().Key != keys::EllipticalSRep) {
+        return this->Fail(std::string("Unexpected JSON container for '") + this->Frames.back().Key + "'");
+      }
+      this->FoundEllipticalSRep = true;
+      return expected(false, Level::EllipticalSRep);
+    case Level::EllipticalSRep: {
+      const auto& key = this->Frames.back().Key;
+      if (key == keys::Skeleton) {
+        return expected(true, Level::Skeleton);
+      }
+      if (key == keys::UpSpokes || key == keys::DownSpokes || key == keys::CrestSpokes) {
+        this->CurrentOrientation = key == keys::UpSpokes ? vtkSRepSkeletalPoint::UpOrientation
+          : key == keys::DownSpokes ? vtkSRepSkeletalPoint::DownOrientation
+          : vtkSRepSkeletalPoint::CrestOrientation;
+        return expected(false, Level::PackedSpokes);
+      }
+      return this->Fail(std::string("Expected a JSON uint for '") + key + "'");
+    }
+    case Level::PackedSpokes: {
+      const auto& key = this->Frames.back().Key;
+      auto& spokes = this->PackedSpokes[this->CurrentOrientation];
+      this->CurrentPackedValues = key == keys::SkeletalPoints ? &spokes.SkeletalPoints
+        : key == keys::Directions ? &spokes.Directions
+        : &spokes.Radii;
+      return expected(true, Level::PackedValues);
+    }
+    case Level::Skeleton:
+      this->LineStart = this->SkeletalPoints.size();
+      return expected(true, Level::Line);
+    case Level::Line:
+      // a probe reuses one skeletal point for every one in the file
+      if (!this->Probe || this->SkeletalPoints.empty()) {
+        this->SkeletalPoints.emplace_back();
+      } else {
+        this->SkeletalPoints.back() = SkeletalPointValues();
+      }
+      return expected(false, Level::SkeletalPoint);
+    case Level::SkeletalPoint: {
+      auto& skeletalPoint = this->SkeletalPoints.back();
+      const auto& key = this->Frames.back().Key;
+      this->CurrentSpoke = key == keys::UpSpoke ? &skeletalPoint.Up
+        : key == keys::DownSpoke ? &skeletalPoint.Down
+        : &skeletalPoint.Crest;
+      return expected(false, Level::Spoke);
+    }
+    case Level::Spoke:
+      this->VectorValueCount = 0;
+      this->VectorCoordinateSystem = -1;
+      return expected(false, Level::Vector);
+    case Level::Vector:
+      if (this->Frames.back().Key != keys::Value) {
+        return this->Fail("Expect string for coordinate system");
+      }
+      return expected(true, Level::VectorValue);
+    default:
+      return this->Fail("Unexpected JSON container in srep");
+  }
+}
+
+bool SRepJsonHandler::Key(const char* str, rapidjson::SizeType length, bool) {
+  if (this->CollectingDepth != 0) {
+    this->CollectedKeys.emplace_back(str, length);
+    return true;
+  }
+  this->Frames.back().Key.assign(str, length);
+  return true;
+}
+
+bool SRepJsonHandler::EndObject(rapidjson::SizeType memberCount) {
+  if (this->CollectingDepth != 0) {
+    rapidjson::Value object(rapidjson::kObjectType);
+    const auto first = this->Collected.size() - memberCount;
+    const auto firstKey = this->CollectedKeys.size() - memberCount;
+    for (size_t i = 0; i < memberCount; ++i) {
+      const auto& name = this->CollectedKeys[firstKey + i];
+      rapidjson::Value key(name.data(), static_cast<rapidjson::SizeType>(name.size()), this->Allocator);
+      object.AddMember(key, this->Collected[first + i], this->Allocator);
+    }
+    this->Collected.resize(first);
+    this->CollectedKeys.resize(firstKey);
+    this->Collected.push_back(std::move(object));
+    this->Frames.pop_back();
+    this->FinishCollecting();
+    return this->Continue();
+  }
+  return this->EndContainer();
+}
+
+bool SRepJsonHandler::EndArray(rapidjson::SizeType elementCount) {
+  if (this->CollectingDepth != 0) {
+    rapidjson::Value array(rapidjson::kArrayType);
+    const auto first = this->Collected.size() - elementCount;
+    array.Reserve(elementCount, this->Allocator);
+    for (size_t i = first; i < this->Collected.size(); ++i) {
+      array.PushBack(this->Collected[i], this->Allocator);
+    }
+    this->Collected.resize(first);
+    this->Collected.push_back(std::move(array));
+    this->Frames.pop_back();
+    this->FinishCollecting();
+    return this->Continue();
+  }
+  return this->EndContainer();
+}
+
+bool SRepJsonHandler::EndContainer() {
+  const auto type = this->Frames.back().Type;
+  this->Frames.pop_back();
+  switch (type) {
+    case Level::Line:
+      this->LineLengths.push_back(this->SkeletalPoints.size() - this->LineStart);
+      break;
+    case Level::SkeletalPoint: {
+      const auto& skeletalPoint = this->SkeletalPoints.back();
+      if (!skeletalPoint.Up.HasSkeletalPoint || !skeletalPoint.Down.HasSkeletalPoint) {
+        return this->Fail(std::string("Error finding json member '")
+          + (skeletalPoint.Up.HasSkeletalPoint ? keys::DownSpoke : keys::UpSpoke) + "'");
+      }
+      break;
+    }
+    case Level::Spoke:
+      if (!this->CurrentSpoke->HasSkeletalPoint || !this->CurrentSpoke->HasDirection) {
+        return this->Fail(std::string("Error finding json member '")
+          + (this->CurrentSpoke->HasSkeletalPoint ? keys::Direction : keys::SkeletalPoint) + "'");
+      }
+      break;
+    case Level::Vector: {
+      if (this->VectorValueCount != this->VectorValue.size()) {
+        return this->Fail("Attempting to read a 3D array that doesn't have 3 dimensions");
+      }
+      if (this->VectorCoordinateSystem == -1) {
+        return this->Fail(std::string("Error finding json member '") + keys::CoordinateSystem + "'");
+      }
+      const auto ras = srep::fromCoordToRAS(this->VectorValue, this->VectorCoordinateSystem);
+      if (this->Frames.back().Key == keys::SkeletalPoint) {
+        this->CurrentSpoke->SkeletalPoint = ras;
+        this->CurrentSpoke->HasSkeletalPoint = true;
+      } else {
+        this->CurrentSpoke->Direction = ras;
+        this->CurrentSpoke->HasDirection = true;
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  return true;
+}
+
+vtkEllipticalSRep::SpokeArrays SRepJsonHandler::TakePackedSpokes(vtkSRepSkeletalPoint::SpokeOrientation orientation) {
+  auto spokes = std::move(this->PackedSpokes[orientation]);
+  if (this->FirstCoordinateSystem == vtkMRMLStorageNode::CoordinateSystemLPS) {
+    for (auto* values : {&spokes.SkeletalPoints, &spokes.Directions}) {
+      for (size_t i = 0; i + 2 < values->size(); i += 3) {
+        (*values)[i] = -(*values)[i];
+        (*values)[i + 1] = -(*values)[i + 1];
+      }
+    }
+  }
+  return spokes;
+}
+
+vtkSmartPointer<vtkEllipticalSRep> SRepJsonHandler::CreateEllipticalSRep() {
+  if (!this->HasCrestPoints || !this->HasSteps) {
+    throw std::invalid_argument(std::string("Error finding json member '")
+      + (this->HasCrestPoints ? keys::Steps : keys::CrestPoints) + "'");
+  }
+
+  if (this->FormatVersion >= 2) {
+    if (this->FirstCoordinateSystem == -1) {
+      throw std::invalid_argument(std::string("Error finding json member '") + keys::CoordinateSystem + "'");
+    }
+    auto srep = vtkSmartPointer<vtkEllipticalSRep>::New();
+    srep->Resize(this->CrestPoints, this->Steps + 1u);
+    // SetSpokeArrays checks the sizes
+    for (auto orientation : {vtkSRepSkeletalPoint::UpOrientation, vtkSRepSkeletalPoint::DownOrientation, vtkSRepSkeletalPoint::CrestOrientation}) {
+      srep->SetSpokeArrays(orientation, this->TakePackedSpokes(orientation));
+    }
+    return srep;
+  }
+
+  const auto lines = this->LineLengths.size();
+  if (lines != this->CrestPoints) {
+    throw std::invalid_argument("Expected " + std::to_string(this->CrestPoints) + " lines in the skeleton, found "
+      + std::to_string(lines));
+  }
+
+  vtkEllipticalSRep::UnrolledEllipticalGrid skeleton(lines);
+  const auto createSpoke = [](const SpokeValues& spoke) {
+    return vtkSRepSpoke::SmartCreate(srep::Point3d(spoke.SkeletalPoint), srep::Vector3d(spoke.Direction));
+  };
+  size_t index = 0;
+  for (size_t l = 0; l < lines; ++l) {
+    // Steps doesn't count the spine
+    if (this->LineLengths[l] != static_cast<size_t>(this->Steps) + 1) {
+      throw std::invalid_argument("Expected " + std::to_string(this->Steps + 1) + " steps in line " + std::to_string(l)
+        + ", found " + std::to_string(this->LineLengths[l]));
+    }
+    skeleton[l].reserve(this->LineLengths[l]);
+    for (size_t s = 0; s < this->LineLengths[l]; ++s, ++index) {
+      const auto& skeletalPoint = this->SkeletalPoints[index];
+      skeleton[l].push_back(vtkSRepSkeletalPoint::SmartCreate(
+        createSpoke(skeletalPoint.Up),
+        createSpoke(skeletalPoint.Down),
+        skeletalPoint.Crest.HasSkeletalPoint ? createSpoke(skeletalPoint.Crest) : nullptr));
+    }
+  }
+  return vtkEllipticalSRep::SmartCreate(std::move(skeleton));
+}
+
+/// Parses is through handler. Throws on error, a probe stopping early is not an error.
+template <class InputStream>
+void ParseJson(InputStream& is, SRepJsonHandler& handler) {
+  rapidjson::Reader reader;
+  if (reader.Parse(is, handler).IsError() && !handler.IsProbeDone()) {
+    if (!handler.GetError().empty()) {
+      throw std::invalid_argument(handler.GetError());
+    }
+    throw std::runtime_error("Error parsing srep JSON");
+  }
+}
+
+/// Streams filePath through handler. Throws on error, a probe stopping early is not an error.
+void ParseJsonFile(const char* filePath, SRepJsonHandler& handler) {
   FILE* fp = fopen(filePath, "r");
   if (!fp) {
     throw std::runtime_error("Error opening file");
@@ -453,17 +996,55 @@ std::unique_ptr<rapidjson::Document> CreateJsonDocumentFromFile(const char* file
 
   std::array<char, BufferSize> buffer;
   rapidjson::FileReadStream fs(fp, buffer.data(), buffer.size());
-  std::unique_ptr<rapidjson::Document> jsonRoot(new rapidjson::Document);
-
-  if (jsonRoot->ParseStream(fs).HasParseError()) {
+  try {
+    ParseJson(fs, handler);
+  } catch (const std::runtime_error&) {
     throw std::runtime_error(std::string("Error parsing file: ") + filePath);
   }
+}
 
-  //TODO: verify schema
-
-  return jsonRoot;
+/// Fills data from a handler that has parsed a whole file. Throws on error.
+void ReadJsonData(SRepJsonHandler& handler, vtkMRMLSRepStorageNode::SRepFileData& data) {
+  if (!handler.HasEllipticalSRep()) {
+    throw std::invalid_argument("no known srep found");
+  }
+  data.EllipticalSRep = handler.CreateEllipticalSRep();
+  if (auto* display = handler.GetDisplay()) {
+    data.Display = vtkSmartPointer<vtkMRMLSRepDisplayNode>::New();
+    read(*display, *data.Display);
+  }
 }
 
+/// Writes srep, and displayNode if not null, to os as JSON with the given schema version. Throws on error.
+template <class OutputStream>
+void WriteJson(OutputStream& os, const vtkEllipticalSRep* srep, vtkMRMLSRepDisplayNode* displayNode,
+  int coordinateSystem, int version)
+{
+  if (version == 1) {
+    rapidjson::PrettyWriter<OutputStream> writer(os);
+    writer.StartObject();
+    write(writer, srep, coordinateSystem);
+    if (displayNode) {
+      write(writer, *displayNode);
+    }
+    writer.EndObject();
+  } else {
+    // one line, rapidjson's Grisu based double formatting is exact and already fast
+    rapidjson::Writer<OutputStream> writer(os);
+    writer.StartObject();
+    writer.Key(keys::FormatVersion); writer.Uint(LatestJsonFormatVersion);
+    writer.Key(keys::CoordinateSystem); writeCoordinateSystem(writer, coordinateSystem);
+    if (srep) {
+      writeV2(writer, *srep, coordinateSystem);
+    } else {
+      writeV2(writer, *vtkSmartPointer<vtkEllipticalSRep>::New(), coordinateSystem);
+    }
+    if (displayNode) {
+      write(writer, *displayNode);
+    }
+    writer.EndObject();
+  }
+}
 }
 
 //------------------------------------------------------------------------------
@@ -473,6 +1054,8 @@ vtkMRMLNodeNewMacro(vtkMRMLSRepStorageNode);
 vtkMRMLSRepStorageNode::vtkMRMLSRepStorageNode()
   : vtkMRMLStorageNode()
   , CoordinateSystemWrite(vtkMRMLStorageNode::CoordinateSystemLPS)
+  , JsonFormatVersionWrite(LatestJsonFormatVersion)
+  , PreloadedData(nullptr)
 {
   this->DefaultWriteFileExtension = "srep.json";
 }
@@ -501,6 +1084,21 @@ vtkMRMLSRepStorageNode::SRepCoordinateSystemType vtkMRMLSRepStorageNode::GetCoor
   return this->CoordinateSystemWrite;
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLSRepStorageNode::SetJsonFormatVersionWrite(int version) {
+  if (version < 1 || version > static_cast<int>(LatestJsonFormatVersion)) {
+    vtkErrorMacro("vtkMRMLSRepStorageNode::SetJsonFormatVersionWrite failed: unknown version " << version);
+    return;
+  }
+  this->JsonFormatVersionWrite = version;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLSRepStorageNode::GetJsonFormatVersionWrite() const {
+  return this->JsonFormatVersionWrite;
+}
+
 //----------------------------------------------------------------------------
 bool vtkMRMLSRepStorageNode::CanReadInReferenceNode(vtkMRMLNode *refNode)
 {
@@ -509,28 +1107,122 @@ bool vtkMRMLSRepStorageNode::CanReadInReferenceNode(vtkMRMLNode *refNode)
 
 //----------------------------------------------------------------------------
 std::string vtkMRMLSRepStorageNode::GetSRepType() {
+  SRepFileInfo info;
+  if (!this->ReadSRepFileInfo(info)) {
+    return "";
+  }
+  if (info.SRepType.empty()) {
+    vtkErrorMacro("vtkMRMLSRepStorageNode::GetSRepType failed: unable to find valid srep type");
+  }
+  return info.SRepType;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSRepStorageNode::ReadSRepFileInfo(SRepFileInfo& info, bool readDisplay) {
+  info = SRepFileInfo();
   const char* filePath = this->GetFileName();
   if (!filePath)
     {
-    vtkErrorMacro("vtkMRMLSRepStorageNode::GetSRepType failed: invalid filename");
-    return "";
+    vtkErrorMacro("vtkMRMLSRepStorageNode::ReadSRepFileInfo failed: invalid filename");
+    return false;
     }
 
   try {
-    auto jsonRoot = CreateJsonDocumentFromFile(filePath);
+    if (binary::hasMagic(filePath)) {
+      // only the header is looked at, so only its page of the file is loaded
+      const binary::MappedFile file(filePath);
+      const auto header = binary::readHeader(file.GetData(), file.GetSize());
+      info.Binary = true;
+      info.FormatVersion = header.Version;
+      if (header.Type == binary::EllipticalSRepType) {
+        info.SRepType = "vtkMRMLEllipticalSRepNode";
+      }
+      info.NumberOfLines = header.Lines;
+      info.NumberOfSteps = header.Steps;
+      info.CoordinateSystem = header.CoordinateSystem;
+      return true;
+    }
 
-    if (jsonRoot->HasMember(keys::EllipticalSRep)) {
-      return "vtkMRMLEllipticalSRepNode";
-    } else {
-      vtkErrorMacro("vtkMRMLSRepStorageNode::GetSRepType failed: unable to find valid srep type");
-      return "";
+    SRepJsonHandler handler;
+    handler.SetProbe(readDisplay);
+    ParseJsonFile(filePath, handler);
+    info.FormatVersion = handler.GetFormatVersion();
+    if (handler.HasEllipticalSRep()) {
+      info.SRepType = "vtkMRMLEllipticalSRepNode";
+      info.NumberOfLines = handler.GetNumberOfLines();
+      info.NumberOfSteps = handler.GetNumberOfSteps();
+      info.CoordinateSystem = handler.GetCoordinateSystem();
+    }
+    if (auto* display = handler.GetDisplay()) {
+      info.Display = vtkSmartPointer<vtkMRMLSRepDisplayNode>::New();
+      read(*display, *info.Display);
     }
+    return true;
   } catch (const std::exception& e) {
-    vtkErrorMacro("vtkMRMLSRepStorageNode::GetSRepType failed: " << e.what());
-    return "";
+    vtkErrorMacro("vtkMRMLSRepStorageNode::ReadSRepFileInfo failed: " << e.what());
+    return false;
   }
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLSRepStorageNode::ReadSRepFile(const std::string& filePath, SRepFileData& data, std::string& errorMessage) {
+  data = SRepFileData();
+  try {
+    if (binary::hasMagic(filePath.c_str())) {
+      const binary::MappedFile file(filePath.c_str());
+      data.EllipticalSRep = binary::readEllipticalSRep(file.GetData(), file.GetSize());
+      return true;
+    }
+
+    SRepJsonHandler handler;
+    ParseJsonFile(filePath.c_str(), handler);
+    ReadJsonData(handler, data);
+    return true;
+  } catch (const std::exception& e) {
+    data = SRepFileData();
+    errorMessage = e.what();
+    return false;
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSRepStorageNode::ReadSRepFromMemory(const void* buffer, size_t size, SRepFileData& data, std::string& errorMessage) {
+  data = SRepFileData();
+  if (!buffer && size > 0) {
+    errorMessage = "null buffer";
+    return false;
+  }
+  try {
+    const auto* bytes = static_cast<const unsigned char*>(buffer);
+    if (size >= binary::Magic.size() && std::equal(binary::Magic.begin(), binary::Magic.end(), bytes)) {
+      data.EllipticalSRep = binary::readEllipticalSRep(bytes, size);
+      return true;
+    }
+
+    SRepJsonHandler handler;
+    rapidjson::MemoryStream ms(static_cast<const char*>(buffer), size);
+    ParseJson(ms, handler);
+    ReadJsonData(handler, data);
+    return true;
+  } catch (const std::exception& e) {
+    data = SRepFileData();
+    errorMessage = e.what();
+    return false;
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSRepStorageNode::ReadSRepFromStream(std::istream& stream, SRepFileData& data, std::string& errorMessage) {
+  // the format can only be told from the first bytes and binary sreps are read in one go anyway
+  const std::string contents((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+  if (stream.bad()) {
+    data = SRepFileData();
+    errorMessage = "Error reading stream";
+    return false;
+  }
+  return ReadSRepFromMemory(contents.data(), contents.size(), data, errorMessage);
+}
+
 //----------------------------------------------------------------------------
 int vtkMRMLSRepStorageNode::ReadDataInternal(vtkMRMLNode * refNode)
 {
@@ -557,29 +1249,30 @@ int vtkMRMLSRepStorageNode::ReadDataInternal(vtkMRMLNode * refNode)
     return failure;
     }
 
-  try {
-    auto jsonRootPtr = CreateJsonDocumentFromFile(filePath);
-    auto& jsonRoot = *jsonRootPtr;
+  SRepFileData fileData;
+  std::string errorMessage;
+  if (!this->PreloadedData && !ReadSRepFile(filePath, fileData, errorMessage)) {
+    vtkErrorMacro("vtkMRMLSRepStorageNode::ReadDataInternal failed: " << errorMessage);
+    return failure;
+  }
+  const auto& data = this->PreloadedData ? *this->PreloadedData : fileData;
 
-    if (jsonRoot.HasMember(keys::EllipticalSRep)) {
-      read(jsonRoot[keys::EllipticalSRep], vtkMRMLEllipticalSRepNode::SafeDownCast(srepNode));
-    } else {
-      vtkErrorMacro("vtkMRMLSRepStorageNode::ReadDataInternal failed because no known srep found");
-      return failure;
-    }
+  auto* ellipticalNode = vtkMRMLEllipticalSRepNode::SafeDownCast(srepNode);
+  if (!ellipticalNode) {
+    vtkErrorMacro("vtkMRMLSRepStorageNode::ReadDataInternal failed: Node is not a vtkMRMLEllipticalSRepNode");
+    return failure;
+  }
+  ellipticalNode->SetEllipticalSRep(data.EllipticalSRep);
 
-    auto displayIter = jsonRoot.FindMember(keys::Display);
-    if (displayIter != jsonRoot.MemberEnd()) {
-      if (!srepNode->GetDisplayNode()) {
-        srepNode->CreateDefaultDisplayNodes();
-      }
-      read(displayIter->value, *srepNode->GetSRepDisplayNode());
+  if (data.Display) {
+    if (!srepNode->GetDisplayNode()) {
+      srepNode->CreateDefaultDisplayNodes();
+    }
+    if (auto* displayNode = srepNode->GetSRepDisplayNode()) {
+      copyStoredProperties(*data.Display, *displayNode);
     }
-    return success;
-  } catch (const std::exception& e) {
-    vtkErrorMacro("vtkMRMLSRepStorageNode::ReadDataInternal failed: " << e.what());
-    return failure;
   }
+  return success;
 }
 
 //----------------------------------------------------------------------------
@@ -603,7 +1296,44 @@ int vtkMRMLSRepStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     return failure;
   }
 
+  if (binary::hasExtension(fullName)) {
+    auto* ellipticalNode = vtkMRMLEllipticalSRepNode::SafeDownCast(refNode);
+    if (!ellipticalNode || !ellipticalNode->GetEllipticalSRep()) {
+      vtkErrorMacro("vtkMRMLSRepJsonStorageNode::WriteDataInternal: Writing srep node file failed: unable to cast input node "
+        << refNode->GetID() << " to a known srep node.");
+      return failure;
+    }
+    try {
+      const auto buffer = binary::writeEllipticalSRep(*ellipticalNode->GetEllipticalSRep(), this->CoordinateSystemWrite);
+      FILE* fp = fopen(fullName.c_str(), "wb");
+      if (!fp) {
+        throw std::runtime_error("Error opening file: " + fullName);
+      }
+      const auto closeFp = finally([fp](){
+        fclose(fp);
+      });
+      if (fwrite(buffer.data(), 1, buffer.size(), fp) != buffer.size()) {
+        throw std::runtime_error("Error writing file: " + fullName);
+      }
+      return success;
+    } catch (const std::exception& e) {
+      vtkErrorMacro("vtkMRMLSRepStorageNode::WriteDataInternal failed: " << e.what());
+      return failure;
+    }
+  }
+
+  auto* ellipticalNode = vtkMRMLEllipticalSRepNode::SafeDownCast(refNode);
+  if (!ellipticalNode) {
+    vtkErrorMacro("vtkMRMLSRepJsonStorageNode::WriteDataInternal: Writing srep node file failed: unable to cast input node "
+      << refNode->GetID() << " to a known srep node.");
+    return failure;
+  }
+
   FILE* fp = fopen(fullName.c_str(), "wb");
+  if (!fp) {
+    vtkErrorMacro("vtkMRMLSRepStorageNode::WriteDataInternal failed: error opening file " << fullName);
+    return failure;
+  }
   const auto closeFp = finally([fp](){
     fclose(fp);
   });
@@ -611,48 +1341,77 @@ int vtkMRMLSRepStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
   // Prepare JSON writer and output stream.
   std::array<char, BufferSize> writeBuffer;
   rapidjson::FileWriteStream os(fp, writeBuffer.data(), writeBuffer.size());
-  rapidjson::PrettyWriter<rapidjson::FileWriteStream> writer(os);
-
-  //TODO:
-  // writer.StartObject();
-  // writer.Key("@schema"); writer.String(SREP_SCHEMA.c_str());
 
-  writer.StartObject();
-
-  // cast the input node
-  if (auto ellipticalNode = vtkMRMLEllipticalSRepNode::SafeDownCast(refNode)) {
-    write(writer, *ellipticalNode, this->CoordinateSystemWrite);
-  } else {
-    vtkErrorMacro("vtkMRMLSRepJsonStorageNode::WriteDataInternal: Writing srep node file failed: unable to cast input node "
-      << refNode->GetID() << " to a known srep node.");
+  try {
+    WriteJson(os, ellipticalNode->GetEllipticalSRep(), srepNode->GetSRepDisplayNode(), this->CoordinateSystemWrite,
+      this->JsonFormatVersionWrite);
+  } catch (const std::exception& e) {
+    vtkErrorMacro("vtkMRMLSRepStorageNode::WriteDataInternal failed: " << e.what());
     return failure;
   }
+  return success;
+}
 
-  auto* displayNode = srepNode->GetSRepDisplayNode();
-  if (displayNode) {
-    write(writer, *displayNode);
+//----------------------------------------------------------------------------
+bool vtkMRMLSRepStorageNode::WriteSRepToMemory(const vtkEllipticalSRep& srep, vtkMRMLSRepDisplayNode* displayNode,
+  SRepFileFormat format, std::string& buffer)
+{
+  try {
+    if (format == SRepFileFormatBinary) {
+      const auto bytes = binary::writeEllipticalSRep(srep, this->CoordinateSystemWrite);
+      buffer.assign(bytes.begin(), bytes.end());
+    } else {
+      rapidjson::StringBuffer sb;
+      WriteJson(sb, &srep, displayNode, this->CoordinateSystemWrite, this->JsonFormatVersionWrite);
+      buffer.assign(sb.GetString(), sb.GetSize());
+    }
+  } catch (const std::exception& e) {
+    vtkErrorMacro("vtkMRMLSRepStorageNode::WriteSRepToMemory failed: " << e.what());
+    return false;
   }
+  return true;
+}
 
-  writer.EndObject();
-  return success;
+//----------------------------------------------------------------------------
+bool vtkMRMLSRepStorageNode::WriteSRepToStream(const vtkEllipticalSRep& srep, vtkMRMLSRepDisplayNode* displayNode,
+  SRepFileFormat format, std::ostream& stream)
+{
+  try {
+    if (format == SRepFileFormatBinary) {
+      const auto bytes = binary::writeEllipticalSRep(srep, this->CoordinateSystemWrite);
+      stream.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    } else {
+      rapidjson::OStreamWrapper osw(stream);
+      WriteJson(osw, &srep, displayNode, this->CoordinateSystemWrite, this->JsonFormatVersionWrite);
+    }
+  } catch (const std::exception& e) {
+    vtkErrorMacro("vtkMRMLSRepStorageNode::WriteSRepToStream failed: " << e.what());
+    return false;
+  }
+  if (!stream) {
+    vtkErrorMacro("vtkMRMLSRepStorageNode::WriteSRepToStream failed: error writing stream");
+    return false;
+  }
+  return true;
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLSRepStorageNode::InitializeSupportedReadFileTypes()
 {
   this->SupportedReadFileTypes->InsertNextValue("SRep JSON (.srep.json)");
+  this->SupportedReadFileTypes->InsertNextValue("SRep Binary (.srep.bin)");
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLSRepStorageNode::InitializeSupportedWriteFileTypes()
 {
   this->SupportedWriteFileTypes->InsertNextValue("SRep JSON (.srep.json)");
+  this->SupportedWriteFileTypes->InsertNextValue("SRep Binary (.srep.bin)");
 }
 
 //----------------------------------------------------------------------------
 vtkMRMLSRepNode* vtkMRMLSRepStorageNode::CreateSRepNode(const char* nodeName) {
-  vtkMRMLScene* scene = this->GetScene();
-  if (!scene) {
+  if (!this->GetScene()) {
     vtkErrorMacro("vtkMRMLMarkupsJsonStorageNode::CreateSRepNode failed: invalid scene");
     return nullptr;
   }
@@ -661,6 +1420,30 @@ vtkMRMLSRepNode* vtkMRMLSRepStorageNode::CreateSRepNode(const char* nodeName) {
   if (srepType.empty()) {
     return nullptr;
   }
+  return this->CreateSRepNodeOfType(nodeName, srepType);
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLSRepNode* vtkMRMLSRepStorageNode::CreateSRepNode(const char* nodeName, const SRepFileData& data) {
+  if (!data.EllipticalSRep) {
+    vtkErrorMacro("vtkMRMLSRepStorageNode::CreateSRepNode failed: no srep was read");
+    return nullptr;
+  }
+
+  this->PreloadedData = &data;
+  const auto clearPreloadedData = finally([this](){
+    this->PreloadedData = nullptr;
+  });
+  return this->CreateSRepNodeOfType(nodeName, "vtkMRMLEllipticalSRepNode");
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLSRepNode* vtkMRMLSRepStorageNode::CreateSRepNodeOfType(const char* nodeName, const std::string& srepType) {
+  vtkMRMLScene* scene = this->GetScene();
+  if (!scene) {
+    vtkErrorMacro("vtkMRMLMarkupsJsonStorageNode::CreateSRepNode failed: invalid scene");
+    return nullptr;
+  }
 
   std::string newNodeName;
   if (nodeName && strlen(nodeName) > 0) {
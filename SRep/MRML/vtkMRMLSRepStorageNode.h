@@ -4,7 +4,26 @@
 #include "vtkSlicerSRepModuleMRMLExport.h"
 #include "vtkMRMLStorageNode.h"
 #include "vtkMRMLSRepNode.h"
+#include "vtkMRMLSRepDisplayNode.h"
+#include "vtkEllipticalSRep.h"
 
+#include <vtkSmartPointer.h>
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+
+/// Reads and writes SReps as JSON (.srep.json) or binary (.srep.bin).
+///
+/// Files are read as binary if they start with the binary magic number, whatever their extension. Files are
+/// written as binary if the file name ends in .srep.bin. The binary format is a fixed header followed by
+/// contiguous little-endian float64 spoke arrays, so reading it needs no parsing, and it is memory mapped so
+/// large files don't need to be read into a buffer first. It only holds the geometry, display properties are
+/// only stored in JSON files.
+///
+/// SReps can also be read from and written to memory buffers and streams, in either format, without a file
+/// or scene.
 class VTK_SLICER_SREP_MODULE_MRML_EXPORT vtkMRMLSRepStorageNode : public vtkMRMLStorageNode
 {
 public:
@@ -23,6 +42,34 @@ public:
   /// SRep is created in the same scene as this storage node.
   vtkMRMLSRepNode* CreateSRepNode(const char* nodeName);
 
+  /// The contents of an SRep file, read without a node or scene.
+  struct SRepFileData {
+    /// nullptr if nothing has been read.
+    vtkSmartPointer<vtkEllipticalSRep> EllipticalSRep;
+    /// Display properties. Not in any scene. nullptr if the file doesn't have any.
+    vtkSmartPointer<vtkMRMLSRepDisplayNode> Display;
+  };
+
+  /// Reads an SRep file without touching any node or scene.
+  ///
+  /// Safe to call from multiple threads at once, so many files can be read in parallel and then given to
+  /// CreateSRepNode on the main thread.
+  /// \returns false on error, with the reason in errorMessage.
+  static bool ReadSRepFile(const std::string& filePath, SRepFileData& data, std::string& errorMessage);
+
+  /// Reads an SRep from a buffer holding the contents of an SRep file, without touching any node or scene.
+  ///
+  /// The format is told from the contents, as for files. Safe to call from multiple threads at once.
+  /// \returns false on error, with the reason in errorMessage.
+  static bool ReadSRepFromMemory(const void* buffer, size_t size, SRepFileData& data, std::string& errorMessage);
+
+  /// Same as ReadSRepFromMemory, reading the rest of stream. The whole stream is read into memory first.
+  static bool ReadSRepFromStream(std::istream& stream, SRepFileData& data, std::string& errorMessage);
+
+  /// Same as CreateSRepNode(nodeName), but with the file set by SetFileName already read into data by
+  /// ReadSRepFile, so the file isn't read again.
+  vtkMRMLSRepNode* CreateSRepNode(const char* nodeName, const SRepFileData& data);
+
   /// Gets the MRML node type of the SRep with the given file name
   ///
   /// The return value, if not empty, is suitable to be passed into
@@ -31,6 +78,32 @@ public:
   /// \returns MRML node type of srep, empty string if no file name is set.
   std::string GetSRepType();
 
+  /// What can be known about an SRep file without reading its spokes.
+  struct SRepFileInfo {
+    /// MRML node type of the srep, as from GetSRepType. Empty if the file holds no known srep.
+    std::string SRepType;
+    bool Binary = false;
+    int FormatVersion = 0;
+    vtkMeshSRepInterface::IndexType NumberOfLines = 0;
+    /// Includes the spine.
+    vtkMeshSRepInterface::IndexType NumberOfSteps = 0;
+    /// vtkMRMLStorageNode::CoordinateSystemRAS or vtkMRMLStorageNode::CoordinateSystemLPS, -1 if the file
+    /// doesn't say (i.e. it has no spokes).
+    int CoordinateSystem = -1;
+    /// Display properties, including the colors. Not in any scene. nullptr if they weren't asked for or the
+    /// file doesn't have any.
+    vtkSmartPointer<vtkMRMLSRepDisplayNode> Display;
+  };
+
+  /// Reads what the file set by SetFileName holds, without reading its spokes.
+  ///
+  /// Reading stops as soon as everything asked for is known. For binary files only the header is read.
+  /// For JSON files the type, size and coordinate system are at the start of the file, but the display
+  /// properties are usually after the spokes, so asking for them scans the rest of the file (the spokes
+  /// are skipped, not stored).
+  /// \returns false on error, true otherwise, even if the file holds no known srep.
+  bool ReadSRepFileInfo(SRepFileInfo& info, bool readDisplay = false);
+
   using SRepCoordinateSystemType = int;
 
   /// @{
@@ -44,6 +117,34 @@ public:
   void CoordinateSystemWriteLPSOn();
   /// @}
 
+  enum SRepFileFormat {
+    SRepFileFormatJson,
+    SRepFileFormatBinary,
+  };
+
+  /// Writes srep, and displayNode if not null, exactly as WriteData would write a file in the given format.
+  ///
+  /// Uses the coordinate system and JSON schema version set on this node, nothing else. The node needn't be
+  /// in a scene. Binary never has display properties.
+  /// \returns false on error.
+  bool WriteSRepToMemory(const vtkEllipticalSRep& srep, vtkMRMLSRepDisplayNode* displayNode, SRepFileFormat format,
+    std::string& buffer);
+
+  /// Same as WriteSRepToMemory, writing to stream. Open streams in binary mode for the binary format.
+  /// \returns false on error, including if stream fails.
+  bool WriteSRepToStream(const vtkEllipticalSRep& srep, vtkMRMLSRepDisplayNode* displayNode, SRepFileFormat format,
+    std::ostream& stream);
+
+  /// @{
+  /// Get set the JSON schema version to write.
+  ///
+  /// Version 2, the default, writes one coordinate system per file and packs the spokes of each orientation
+  /// into flat numeric arrays, on one line. Version 1 writes every spoke as its own pretty printed object, for
+  /// readers that predate version 2. Both versions are always readable. Has no effect on binary files.
+  void SetJsonFormatVersionWrite(int version);
+  int GetJsonFormatVersionWrite() const;
+  /// @}
+
 protected:
   vtkMRMLSRepStorageNode();
   ~vtkMRMLSRepStorageNode() override;
@@ -64,7 +165,13 @@ protected:
   /// Write data from a  referenced node.
   int WriteDataInternal(vtkMRMLNode *refNode) override;
 private:
+  /// Creates the node and reads it from PreloadedData, if set, or the file.
+  vtkMRMLSRepNode* CreateSRepNodeOfType(const char* nodeName, const std::string& srepType);
+
   int CoordinateSystemWrite;
+  int JsonFormatVersionWrite;
+  /// Read by ReadDataInternal instead of the file while set. Only set during CreateSRepNode.
+  const SRepFileData* PreloadedData;
 };
 
 #endif
@@ -0,0 +1,353 @@
+#include "vtkSRepCohortFile.h"
+
+#include "srepBinaryIO.h"
+#include "srepUtil.h"
+
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_set>
+
+#include <vtkMRMLStorageNode.h>
+#include <vtkObjectFactory.h>
+
+using srep::util::finally;
+namespace binary = srep::binary;
+
+namespace {
+
+namespace cohort {
+  constexpr std::array<char, 8> Magic{{'S', 'R', 'E', 'P', 'C', 'O', 'H', '\0'}};
+  constexpr uint32_t Version = 1;
+  constexpr uint64_t HeaderSize = 32;
+  /// Where the table of contents offset and number of SReps are in the header.
+  constexpr uint64_t TableOfContentsFieldOffset = 16;
+  /// Table of contents bytes for an SRep, not counting its name.
+  constexpr uint64_t EntrySize = 20;
+}
+
+//----------------------------------------------------------------------
+void seek(FILE* fp, uint64_t offset) {
+#ifdef _WIN32
+  const int result = _fseeki64(fp, static_cast<__int64>(offset), SEEK_SET);
+#else
+  const int result = fseeko(fp, static_cast<off_t>(offset), SEEK_SET);
+#endif
+  if (result != 0) {
+    throw std::runtime_error("Error seeking to " + std::to_string(offset));
+  }
+}
+
+//----------------------------------------------------------------------
+void writeAll(FILE* fp, const std::vector<unsigned char>& buffer) {
+  if (fwrite(buffer.data(), 1, buffer.size(), fp) != buffer.size()) {
+    throw std::runtime_error("Error writing file");
+  }
+}
+
+//----------------------------------------------------------------------
+std::vector<unsigned char> headerTail(uint64_t tableOfContentsOffset, uint64_t numberOfSReps) {
+  std::vector<unsigned char> buffer;
+  binary::appendUint64(buffer, tableOfContentsOffset);
+  binary::appendUint64(buffer, numberOfSReps);
+  return buffer;
+}
+
+//----------------------------------------------------------------------
+void appendEntry(std::vector<unsigned char>& buffer, const std::string& name, uint64_t offset, uint64_t size) {
+  binary::appendUint64(buffer, offset);
+  binary::appendUint64(buffer, size);
+  binary::appendUint32(buffer, static_cast<uint32_t>(name.size()));
+  buffer.insert(buffer.end(), name.begin(), name.end());
+}
+
+}
+
+//----------------------------------------------------------------------
+vtkStandardNewMacro(vtkSRepCohortFile);
+
+//----------------------------------------------------------------------
+vtkSRepCohortFile::vtkSRepCohortFile()
+  : FilePath()
+  , CoordinateSystemWrite(vtkMRMLStorageNode::CoordinateSystemLPS)
+  , File()
+  , TableOfContentsOffset(0)
+  , TableOfContentsEnd(0)
+  , Names()
+  , Entries()
+{}
+
+//----------------------------------------------------------------------
+vtkSRepCohortFile::~vtkSRepCohortFile() = default;
+
+//----------------------------------------------------------------------
+void vtkSRepCohortFile::PrintSelf(ostream& os, vtkIndent indent) {
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "FilePath: " << this->FilePath << std::endl;
+  os << indent << "CoordinateSystemWrite: " << this->CoordinateSystemWrite << std::endl;
+  os << indent << "NumberOfSReps: " << this->GetNumberOfSReps() << std::endl;
+}
+
+//----------------------------------------------------------------------
+bool vtkSRepCohortFile::Create(const std::string& path) {
+  // copied, path may be this->FilePath
+  const std::string filePath = path;
+  this->Close();
+  try {
+    FILE* fp = fopen(filePath.c_str(), "wb");
+    if (!fp) {
+      throw std::runtime_error("Error opening file: " + filePath);
+    }
+    const auto closeFp = finally([fp](){
+      fclose(fp);
+    });
+
+    std::vector<unsigned char> header(cohort::Magic.begin(), cohort::Magic.end());
+    binary::appendUint32(header, cohort::Version);
+    binary::appendUint32(header, 0);
+    const auto tail = headerTail(cohort::HeaderSize, 0);
+    header.insert(header.end(), tail.begin(), tail.end());
+    writeAll(fp, header);
+  } catch (const std::exception& e) {
+    vtkErrorMacro("vtkSRepCohortFile::Create failed: " << e.what());
+    return false;
+  }
+  return this->Open(filePath);
+}
+
+//----------------------------------------------------------------------
+bool vtkSRepCohortFile::Open(const std::string& path) {
+  // copied, path may be this->FilePath
+  std::string filePath = path;
+  this->Close();
+  this->FilePath = std::move(filePath);
+  try {
+    this->ReadTableOfContents();
+  } catch (const std::exception& e) {
+    vtkErrorMacro("vtkSRepCohortFile::Open failed: " << e.what());
+    this->Close();
+    return false;
+  }
+  this->Modified();
+  return true;
+}
+
+//----------------------------------------------------------------------
+void vtkSRepCohortFile::Close() {
+  if (this->FilePath.empty() && !this->File) {
+    return;
+  }
+  this->FilePath.clear();
+  this->File.reset();
+  this->TableOfContentsOffset = 0;
+  this->TableOfContentsEnd = 0;
+  this->Names.clear();
+  this->Entries.clear();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------
+bool vtkSRepCohortFile::IsOpen() const {
+  return static_cast<bool>(this->File);
+}
+
+//----------------------------------------------------------------------
+const std::string& vtkSRepCohortFile::GetFilePath() const {
+  return this->FilePath;
+}
+
+//----------------------------------------------------------------------
+void vtkSRepCohortFile::SetCoordinateSystemWrite(int system) {
+  this->CoordinateSystemWrite = system;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------
+int vtkSRepCohortFile::GetCoordinateSystemWrite() const {
+  return this->CoordinateSystemWrite;
+}
+
+//----------------------------------------------------------------------
+vtkIdType vtkSRepCohortFile::GetNumberOfSReps() const {
+  return static_cast<vtkIdType>(this->Names.size());
+}
+
+//----------------------------------------------------------------------
+const std::vector<std::string>& vtkSRepCohortFile::GetSRepNames() const {
+  return this->Names;
+}
+
+//----------------------------------------------------------------------
+bool vtkSRepCohortFile::HasSRep(const std::string& name) const {
+  return this->Entries.count(name) != 0;
+}
+
+//----------------------------------------------------------------------
+vtkSmartPointer<vtkEllipticalSRep> vtkSRepCohortFile::ReadSRep(const std::string& name) const {
+  const auto it = this->Entries.find(name);
+  if (it == this->Entries.end()) {
+    vtkErrorMacro("vtkSRepCohortFile::ReadSRep failed: no srep named '" << name << "'");
+    return nullptr;
+  }
+  try {
+    // the table of contents was checked against the file size when it was read
+    return binary::readEllipticalSRep(this->File->GetData() + it->second.Offset, static_cast<size_t>(it->second.Size));
+  } catch (const std::exception& e) {
+    vtkErrorMacro("vtkSRepCohortFile::ReadSRep failed for '" << name << "': " << e.what());
+    return nullptr;
+  }
+}
+
+//----------------------------------------------------------------------
+bool vtkSRepCohortFile::AppendSRep(const std::string& name, const vtkEllipticalSRep& srep) {
+  return this->AppendSReps({{name, const_cast<vtkEllipticalSRep*>(&srep)}});
+}
+
+//----------------------------------------------------------------------
+bool vtkSRepCohortFile::AppendSReps(const std::vector<std::pair<std::string, vtkSmartPointer<vtkEllipticalSRep>>>& sreps) {
+  if (!this->IsOpen()) {
+    vtkErrorMacro("vtkSRepCohortFile::AppendSReps failed: no file is open");
+    return false;
+  }
+  if (sreps.empty()) {
+    return true;
+  }
+
+  // everything that can fail without touching the file is done first
+  std::vector<std::vector<unsigned char>> buffers;
+  std::vector<unsigned char> tableOfContents;
+  std::vector<Entry> newEntries;
+  try {
+    std::unordered_set<std::string> newNames;
+    buffers.reserve(sreps.size());
+    for (const auto& srep : sreps) {
+      if (srep.first.empty()) {
+        throw std::invalid_argument("srep name is empty");
+      }
+      if (this->HasSRep(srep.first) || !newNames.insert(srep.first).second) {
+        throw std::invalid_argument("there is already an srep named '" + srep.first + "'");
+      }
+      if (!srep.second) {
+        throw std::invalid_argument("srep '" + srep.first + "' is null");
+      }
+      buffers.push_back(binary::writeEllipticalSRep(*srep.second, this->CoordinateSystemWrite));
+    }
+
+    for (const auto& name : this->Names) {
+      const auto& entry = this->Entries.at(name);
+      appendEntry(tableOfContents, name, entry.Offset, entry.Size);
+    }
+    // the old table of contents is left alone, the header points at it until the very last write
+    uint64_t offset = this->TableOfContentsEnd;
+    for (size_t i = 0; i < sreps.size(); ++i) {
+      newEntries.push_back(Entry{offset, buffers[i].size()});
+      appendEntry(tableOfContents, sreps[i].first, offset, buffers[i].size());
+      offset += buffers[i].size();
+    }
+  } catch (const std::exception& e) {
+    vtkErrorMacro("vtkSRepCohortFile::AppendSReps failed: " << e.what());
+    return false;
+  }
+
+  // the file can't be written while it is mapped on every platform
+  this->File.reset();
+  try {
+    FILE* fp = fopen(this->FilePath.c_str(), "r+b");
+    if (!fp) {
+      throw std::runtime_error("Error opening file: " + this->FilePath);
+    }
+    const auto closeFp = finally([fp](){
+      fclose(fp);
+    });
+
+    seek(fp, this->TableOfContentsEnd);
+    for (const auto& buffer : buffers) {
+      writeAll(fp, buffer);
+    }
+    writeAll(fp, tableOfContents);
+    // everything the new header points at is written before the header is
+    if (fflush(fp) != 0) {
+      throw std::runtime_error("Error writing file");
+    }
+    const uint64_t newTableOfContentsOffset = newEntries.back().Offset + newEntries.back().Size;
+    seek(fp, cohort::TableOfContentsFieldOffset);
+    writeAll(fp, headerTail(newTableOfContentsOffset, this->Names.size() + sreps.size()));
+    if (fflush(fp) != 0) {
+      throw std::runtime_error("Error writing file");
+    }
+
+    this->File.reset(new binary::MappedFile(this->FilePath.c_str()));
+    this->TableOfContentsOffset = newTableOfContentsOffset;
+    this->TableOfContentsEnd = newTableOfContentsOffset + tableOfContents.size();
+    for (size_t i = 0; i < sreps.size(); ++i) {
+      this->Names.push_back(sreps[i].first);
+      this->Entries.emplace(sreps[i].first, newEntries[i]);
+    }
+  } catch (const std::exception& e) {
+    vtkErrorMacro("vtkSRepCohortFile::AppendSReps failed: " << e.what());
+    // whatever made it to disk is the truth now
+    this->Open(this->FilePath);
+    return false;
+  }
+  this->Modified();
+  return true;
+}
+
+//----------------------------------------------------------------------
+void vtkSRepCohortFile::ReadTableOfContents() {
+  std::unique_ptr<binary::MappedFile> file(new binary::MappedFile(this->FilePath.c_str()));
+  const auto* data = file->GetData();
+  const uint64_t size = file->GetSize();
+  if (size < cohort::HeaderSize || std::memcmp(data, cohort::Magic.data(), cohort::Magic.size()) != 0) {
+    throw std::invalid_argument("Not an srep cohort file: " + this->FilePath);
+  }
+  const auto version = binary::readUint32(data + 8);
+  if (version > cohort::Version) {
+    throw std::invalid_argument("Unsupported srep cohort file version: " + std::to_string(version));
+  }
+  const auto tableOfContentsOffset = binary::readUint64(data + cohort::TableOfContentsFieldOffset);
+  const auto numberOfSReps = binary::readUint64(data + cohort::TableOfContentsFieldOffset + 8);
+  if (tableOfContentsOffset < cohort::HeaderSize || tableOfContentsOffset > size) {
+    throw std::invalid_argument("srep cohort file table of contents is outside the file");
+  }
+
+  std::vector<std::string> names;
+  std::unordered_map<std::string, Entry> entries;
+  // every entry is at least EntrySize bytes, which also keeps a corrupt count from reserving too much
+  if (numberOfSReps > (size - tableOfContentsOffset) / cohort::EntrySize) {
+    throw std::invalid_argument("srep cohort file table of contents is truncated");
+  }
+  names.reserve(numberOfSReps);
+  entries.reserve(numberOfSReps);
+  uint64_t position = tableOfContentsOffset;
+  for (uint64_t i = 0; i < numberOfSReps; ++i) {
+    if (size - position < cohort::EntrySize) {
+      throw std::invalid_argument("srep cohort file table of contents is truncated");
+    }
+    const Entry entry{binary::readUint64(data + position), binary::readUint64(data + position + 8)};
+    const uint64_t nameLength = binary::readUint32(data + position + 16);
+    position += cohort::EntrySize;
+    if (size - position < nameLength) {
+      throw std::invalid_argument("srep cohort file table of contents is truncated");
+    }
+    std::string name(reinterpret_cast<const char*>(data + position), nameLength);
+    position += nameLength;
+
+    if (entry.Offset < cohort::HeaderSize || entry.Offset > tableOfContentsOffset
+      || entry.Size > tableOfContentsOffset - entry.Offset)
+    {
+      throw std::invalid_argument("srep '" + name + "' is outside the srep cohort file");
+    }
+    if (!entries.emplace(name, entry).second) {
+      throw std::invalid_argument("srep cohort file has more than one srep named '" + name + "'");
+    }
+    names.push_back(std::move(name));
+  }
+
+  this->File = std::move(file);
+  this->TableOfContentsOffset = tableOfContentsOffset;
+  this->TableOfContentsEnd = position;
+  this->Names = std::move(names);
+  this->Entries = std::move(entries);
+}
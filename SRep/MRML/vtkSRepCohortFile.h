@@ -0,0 +1,129 @@
+#ifndef __vtkSRepCohortFile_h
+#define __vtkSRepCohortFile_h
+
+#include "vtkEllipticalSRep.h"
+
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "vtkSlicerSRepModuleMRMLExport.h"
+
+namespace srep {
+namespace binary {
+class MappedFile;
+}
+}
+
+/// Many named SReps in one file (.srepc), e.g. one per subject of a population study.
+///
+/// The file is a header, the SReps, then a table of contents. Each SRep is stored exactly as a .srep.bin
+/// file would be (see vtkMRMLSRepStorageNode), and the table of contents maps each name to where its SRep
+/// is. Opening a file only reads the table of contents, and the file is memory mapped, so reading one SRep
+/// only touches that SRep's pages no matter how many are in the file. Appending writes the new SReps and a
+/// new table of contents after the end of the old table of contents, and only then rewrites the header to
+/// point at the new one. The existing SReps are never moved, and until that last write the header still
+/// points at the old, untouched table of contents, so a file whose append is interrupted opens with what it
+/// had before. Old tables of contents are left in the file as unused bytes, so appending many SReps with one
+/// AppendSReps call keeps the file smaller than appending them one at a time.
+///
+///   char[8]  magic, "SREPCOH\0"
+///   uint32   format version
+///   uint32   reserved, 0
+///   uint64   offset of the table of contents
+///   uint64   number of SReps
+///   ...      SReps, and the tables of contents of earlier appends
+///   for each SRep: uint64 offset, uint64 size in bytes, uint32 name length, then the name (UTF-8)
+///
+/// Everything is little-endian. Only the geometry is stored, there is no display information.
+class VTK_SLICER_SREP_MODULE_MRML_EXPORT vtkSRepCohortFile : public vtkObject {
+public:
+  static vtkSRepCohortFile* New();
+  ~vtkSRepCohortFile();
+
+  /// Standard methods for a VTK class.
+  vtkTypeMacro(vtkSRepCohortFile, vtkObject);
+
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Creates an empty cohort file, replacing any file already at filePath, and opens it.
+  /// \returns false on error.
+  bool Create(const std::string& filePath);
+
+  /// Opens an existing cohort file. Only the header and table of contents are read.
+  /// \returns false on error, in which case nothing is open.
+  bool Open(const std::string& filePath);
+
+  /// Closes the file. Does nothing if no file is open.
+  void Close();
+
+  bool IsOpen() const;
+
+  /// Empty if no file is open.
+  const std::string& GetFilePath() const;
+
+  /// @{
+  /// Get set the coordinate system SReps are appended in.
+  ///
+  /// Choose either vtkMRMLStorageNode::CoordinateSystemRAS or vtkMRMLStorageNode::CoordinateSystemLPS.
+  /// Default is LPS. Each SRep records its own coordinate system, so a file can hold both.
+  void SetCoordinateSystemWrite(int system);
+  int GetCoordinateSystemWrite() const;
+  /// @}
+
+  vtkIdType GetNumberOfSReps() const;
+
+  /// Names of every SRep, in the order they were appended.
+  const std::vector<std::string>& GetSRepNames() const;
+
+  bool HasSRep(const std::string& name) const;
+
+  /// Reads one SRep. Takes the same time whatever the number of SReps in the file.
+  ///
+  /// Safe to call from multiple threads at once, as long as nothing is appended at the same time.
+  /// \returns nullptr if there is no SRep with that name or it can't be read.
+  vtkSmartPointer<vtkEllipticalSRep> ReadSRep(const std::string& name) const;
+
+  /// Adds an SRep to the end of the file.
+  /// \returns false on error, including if name is empty or already in the file.
+  bool AppendSRep(const std::string& name, const vtkEllipticalSRep& srep);
+
+  /// Adds many SReps to the end of the file, rewriting the table of contents once.
+  ///
+  /// Either all of the SReps are added or, if any can't be (e.g. a repeated name), none are.
+  /// \returns false on error.
+  bool AppendSReps(const std::vector<std::pair<std::string, vtkSmartPointer<vtkEllipticalSRep>>>& sreps);
+
+protected:
+  vtkSRepCohortFile();
+  vtkSRepCohortFile(const vtkSRepCohortFile&) = delete;
+  vtkSRepCohortFile(vtkSRepCohortFile&&) = delete;
+  vtkSRepCohortFile& operator=(const vtkSRepCohortFile&) = delete;
+  vtkSRepCohortFile& operator=(vtkSRepCohortFile&&) = delete;
+
+private:
+  struct Entry {
+    uint64_t Offset;
+    uint64_t Size;
+  };
+
+  /// Maps the file and reads its table of contents. Throws on error.
+  void ReadTableOfContents();
+
+  std::string FilePath;
+  int CoordinateSystemWrite;
+  std::unique_ptr<srep::binary::MappedFile> File;
+  uint64_t TableOfContentsOffset;
+  /// One past the last byte of the table of contents. Appends are written from here.
+  uint64_t TableOfContentsEnd;
+  std::vector<std::string> Names;
+  std::unordered_map<std::string, Entry> Entries;
+};
+
+#endif
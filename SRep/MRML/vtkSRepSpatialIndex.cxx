@@ -0,0 +1,473 @@
+#include "vtkSRepSpatialIndex.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include <vtkObjectFactory.h>
+
+namespace {
+
+using Vec = std::array<double, 3>;
+
+//----------------------------------------------------------------------
+Vec Sub(const Vec& a, const Vec& b) {
+  return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+//----------------------------------------------------------------------
+Vec AddScaled(const Vec& a, const Vec& b, double scale) {
+  return {a[0] + scale * b[0], a[1] + scale * b[1], a[2] + scale * b[2]};
+}
+
+//----------------------------------------------------------------------
+double Dot(const Vec& a, const Vec& b) {
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+//----------------------------------------------------------------------
+double Clamp(double v, double lo, double hi) {
+  return std::max(lo, std::min(v, hi));
+}
+
+//----------------------------------------------------------------------
+Vec ToVec(const srep::Point3d& p) {
+  return {p.GetX(), p.GetY(), p.GetZ()};
+}
+
+//----------------------------------------------------------------------
+Vec ToVec(const srep::Vector3d& v) {
+  return {v.GetX(), v.GetY(), v.GetZ()};
+}
+
+//----------------------------------------------------------------------
+struct ClosestParameters {
+  double S; // along the first segment
+  double T; // along the second segment
+  double DistanceSquared;
+};
+
+//----------------------------------------------------------------------
+// Closest points between p1 + s*d1 for s in [0, sMax] and p2 + t*d2 for t in [0, 1].
+// sMax may be infinity to treat the first segment as a ray.
+//
+// Ericson, C. (2004). Real-Time Collision Detection. Section 5.1.9.
+ClosestParameters ClosestSegmentSegment(const Vec& p1, const Vec& d1, double sMax, const Vec& p2, const Vec& d2) {
+  constexpr double epsilon = 1e-12;
+  const Vec r = Sub(p1, p2);
+  const double a = Dot(d1, d1);
+  const double e = Dot(d2, d2);
+  const double f = Dot(d2, r);
+
+  double s = 0.0;
+  double t = 0.0;
+  if (a <= epsilon && e <= epsilon) {
+    // both degenerate to points
+  } else if (a <= epsilon) {
+    t = Clamp(f / e, 0.0, 1.0);
+  } else {
+    const double c = Dot(d1, r);
+    if (e <= epsilon) {
+      s = Clamp(-c / a, 0.0, sMax);
+    } else {
+      const double b = Dot(d1, d2);
+      const double denominator = a * e - b * b;
+      s = denominator > epsilon * a * e ? Clamp((b * f - c * e) / denominator, 0.0, sMax) : 0.0;
+      t = (b * s + f) / e;
+      if (t < 0.0) {
+        t = 0.0;
+        s = Clamp(-c / a, 0.0, sMax);
+      } else if (t > 1.0) {
+        t = 1.0;
+        s = Clamp((b - c) / a, 0.0, sMax);
+      }
+    }
+  }
+
+  const Vec diff = Sub(AddScaled(p1, d1, s), AddScaled(p2, d2, t));
+  return ClosestParameters{s, t, Dot(diff, diff)};
+}
+
+//----------------------------------------------------------------------
+struct Box {
+  Vec Min;
+  Vec Max;
+
+  static Box Empty() {
+    constexpr auto inf = std::numeric_limits<double>::infinity();
+    return Box{{inf, inf, inf}, {-inf, -inf, -inf}};
+  }
+
+  void Add(const Vec& p) {
+    for (int i = 0; i < 3; ++i) {
+      this->Min[i] = std::min(this->Min[i], p[i]);
+      this->Max[i] = std::max(this->Max[i], p[i]);
+    }
+  }
+
+  double DistanceSquared(const Vec& p) const {
+    double d2 = 0.0;
+    for (int i = 0; i < 3; ++i) {
+      const double d = std::max({this->Min[i] - p[i], 0.0, p[i] - this->Max[i]});
+      d2 += d * d;
+    }
+    return d2;
+  }
+
+  // Slab test of origin + s*direction for s in [0, sMax] against this box grown by margin.
+  // Returns false if there is no overlap, otherwise sets the entry parameter.
+  bool Intersect(const Vec& origin, const Vec& direction, double sMax, double margin, double& entry) const {
+    double lo = 0.0;
+    double hi = sMax;
+    for (int i = 0; i < 3; ++i) {
+      const double min = this->Min[i] - margin;
+      const double max = this->Max[i] + margin;
+      if (direction[i] == 0.0) {
+        if (origin[i] < min || origin[i] > max) {
+          return false;
+        }
+      } else {
+        double t0 = (min - origin[i]) / direction[i];
+        double t1 = (max - origin[i]) / direction[i];
+        if (t0 > t1) {
+          std::swap(t0, t1);
+        }
+        lo = std::max(lo, t0);
+        hi = std::min(hi, t1);
+        if (lo > hi) {
+          return false;
+        }
+      }
+    }
+    entry = lo;
+    return true;
+  }
+};
+
+} // namespace {}
+
+//----------------------------------------------------------------------
+// Binary tree of boxes over spoke segments. Skeletal points are indexed as zero length segments.
+class vtkSRepSpatialIndex::Hierarchy {
+public:
+  struct Segment {
+    Vec Start;
+    Vec Direction; // boundary - skeletal
+    SpokeId Spoke;
+  };
+
+  explicit Hierarchy(std::vector<Segment> segments)
+    : Segments(std::move(segments))
+  {
+    if (!this->Segments.empty()) {
+      this->Nodes.reserve(2 * this->Segments.size() / LeafSize + 1);
+      this->Build(0, this->Segments.size());
+    }
+  }
+
+  bool IsEmpty() const {
+    return this->Segments.empty();
+  }
+
+  // Finds the closest segment to the query segment/ray/point p + s*d for s in [0, sMax]
+  bool FindClosest(const Vec& p, const Vec& d, double sMax, SpokeHit& hit) const {
+    if (this->IsEmpty()) {
+      return false;
+    }
+    double bestDistanceSquared = std::numeric_limits<double>::infinity();
+    this->FindClosest(0, p, d, sMax, bestDistanceSquared, hit);
+    hit.Distance = std::sqrt(bestDistanceSquared);
+    return true;
+  }
+
+  // Finds the segment within margin of the ray p + s*d whose closest approach has the smallest s
+  bool Pick(const Vec& p, const Vec& d, double margin, SpokeHit& hit) const {
+    if (this->IsEmpty()) {
+      return false;
+    }
+    bool found = false;
+    this->Pick(0, p, d, margin, found, hit);
+    return found;
+  }
+
+  // Finds all segments within margin of the query segment/point p + s*d for s in [0, sMax]
+  void FindWithin(const Vec& p, const Vec& d, double sMax, double margin, std::vector<SpokeHit>& hits) const {
+    if (!this->IsEmpty()) {
+      this->FindWithin(0, p, d, sMax, margin, hits);
+    }
+  }
+
+private:
+  static constexpr size_t LeafSize = 4;
+
+  struct Node {
+    Box Bounds;
+    size_t Begin;
+    size_t End;
+    // children are only valid if End - Begin > LeafSize
+    size_t Left;
+    size_t Right;
+  };
+
+  std::vector<Segment> Segments;
+  std::vector<Node> Nodes;
+
+  //----------------------------------------------------------------------
+  size_t Build(size_t begin, size_t end) {
+    const size_t nodeIndex = this->Nodes.size();
+    this->Nodes.push_back(Node{Box::Empty(), begin, end, 0, 0});
+
+    Box bounds = Box::Empty();
+    Box centroids = Box::Empty();
+    for (size_t i = begin; i < end; ++i) {
+      const auto& segment = this->Segments[i];
+      const auto boundary = AddScaled(segment.Start, segment.Direction, 1.0);
+      bounds.Add(segment.Start);
+      bounds.Add(boundary);
+      centroids.Add(AddScaled(segment.Start, segment.Direction, 0.5));
+    }
+    this->Nodes[nodeIndex].Bounds = bounds;
+
+    if (end - begin > LeafSize) {
+      // median split along the longest axis of the centroids
+      int axis = 0;
+      for (int i = 1; i < 3; ++i) {
+        if (centroids.Max[i] - centroids.Min[i] > centroids.Max[axis] - centroids.Min[axis]) {
+          axis = i;
+        }
+      }
+      const size_t middle = begin + (end - begin) / 2;
+      std::nth_element(this->Segments.begin() + begin, this->Segments.begin() + middle, this->Segments.begin() + end,
+        [axis](const Segment& a, const Segment& b) {
+          return 2 * a.Start[axis] + a.Direction[axis] < 2 * b.Start[axis] + b.Direction[axis];
+        });
+      const auto left = this->Build(begin, middle);
+      const auto right = this->Build(middle, end);
+      this->Nodes[nodeIndex].Left = left;
+      this->Nodes[nodeIndex].Right = right;
+    }
+    return nodeIndex;
+  }
+
+  //----------------------------------------------------------------------
+  bool IsLeaf(const Node& node) const {
+    return node.End - node.Begin <= LeafSize;
+  }
+
+  //----------------------------------------------------------------------
+  // lower bound on the squared distance from the query to anything in the node
+  double LowerBoundSquared(const Node& node, const Vec& p, const Vec& d, double sMax) const {
+    if (sMax == 0.0 || Dot(d, d) == 0.0) {
+      return node.Bounds.DistanceSquared(p);
+    }
+    double entry = 0.0;
+    if (node.Bounds.Intersect(p, d, sMax, 0.0, entry)) {
+      return 0.0;
+    }
+    // the query misses the box, so use the gap between the box and the query's own bounding box
+    Box queryBounds = Box::Empty();
+    queryBounds.Add(p);
+    queryBounds.Add(AddScaled(p, d, sMax));
+    double d2 = 0.0;
+    for (int i = 0; i < 3; ++i) {
+      const double gap = std::max({queryBounds.Min[i] - node.Bounds.Max[i], 0.0, node.Bounds.Min[i] - queryBounds.Max[i]});
+      d2 += gap * gap;
+    }
+    return d2;
+  }
+
+  //----------------------------------------------------------------------
+  SpokeHit MakeHit(const Segment& segment, const ClosestParameters& closest) const {
+    return SpokeHit{segment.Spoke, std::sqrt(closest.DistanceSquared), closest.T, closest.S};
+  }
+
+  //----------------------------------------------------------------------
+  void FindClosest(size_t nodeIndex, const Vec& p, const Vec& d, double sMax, double& bestDistanceSquared, SpokeHit& hit) const {
+    const auto& node = this->Nodes[nodeIndex];
+    if (this->IsLeaf(node)) {
+      for (size_t i = node.Begin; i < node.End; ++i) {
+        const auto& segment = this->Segments[i];
+        const auto closest = ClosestSegmentSegment(p, d, sMax, segment.Start, segment.Direction);
+        if (closest.DistanceSquared < bestDistanceSquared) {
+          bestDistanceSquared = closest.DistanceSquared;
+          hit = this->MakeHit(segment, closest);
+        }
+      }
+      return;
+    }
+
+    // visit the nearer child first so the farther one is more likely to be pruned
+    const double leftBound = this->LowerBoundSquared(this->Nodes[node.Left], p, d, sMax);
+    const double rightBound = this->LowerBoundSquared(this->Nodes[node.Right], p, d, sMax);
+    const bool leftFirst = leftBound <= rightBound;
+    const size_t first = leftFirst ? node.Left : node.Right;
+    const size_t second = leftFirst ? node.Right : node.Left;
+    if (std::min(leftBound, rightBound) < bestDistanceSquared) {
+      this->FindClosest(first, p, d, sMax, bestDistanceSquared, hit);
+    }
+    if (std::max(leftBound, rightBound) < bestDistanceSquared) {
+      this->FindClosest(second, p, d, sMax, bestDistanceSquared, hit);
+    }
+  }
+
+  //----------------------------------------------------------------------
+  void Pick(size_t nodeIndex, const Vec& p, const Vec& d, double margin, bool& found, SpokeHit& hit) const {
+    constexpr auto inf = std::numeric_limits<double>::infinity();
+    const auto& node = this->Nodes[nodeIndex];
+    double entry = 0.0;
+    if (!node.Bounds.Intersect(p, d, inf, margin, entry) || (found && entry > hit.QueryParameter)) {
+      return;
+    }
+    if (this->IsLeaf(node)) {
+      for (size_t i = node.Begin; i < node.End; ++i) {
+        const auto& segment = this->Segments[i];
+        const auto closest = ClosestSegmentSegment(p, d, inf, segment.Start, segment.Direction);
+        if (closest.DistanceSquared > margin * margin) {
+          continue;
+        }
+        const auto candidate = this->MakeHit(segment, closest);
+        if (!found || candidate.QueryParameter < hit.QueryParameter
+          || (candidate.QueryParameter == hit.QueryParameter && candidate.Distance < hit.Distance))
+        {
+          hit = candidate;
+          found = true;
+        }
+      }
+      return;
+    }
+    this->Pick(node.Left, p, d, margin, found, hit);
+    this->Pick(node.Right, p, d, margin, found, hit);
+  }
+
+  //----------------------------------------------------------------------
+  void FindWithin(size_t nodeIndex, const Vec& p, const Vec& d, double sMax, double margin, std::vector<SpokeHit>& hits) const {
+    const auto& node = this->Nodes[nodeIndex];
+    double entry = 0.0;
+    if (!node.Bounds.Intersect(p, d, sMax, margin, entry)) {
+      return;
+    }
+    if (this->IsLeaf(node)) {
+      for (size_t i = node.Begin; i < node.End; ++i) {
+        const auto& segment = this->Segments[i];
+        const auto closest = ClosestSegmentSegment(p, d, sMax, segment.Start, segment.Direction);
+        if (closest.DistanceSquared <= margin * margin) {
+          hits.push_back(this->MakeHit(segment, closest));
+        }
+      }
+      return;
+    }
+    this->FindWithin(node.Left, p, d, sMax, margin, hits);
+    this->FindWithin(node.Right, p, d, sMax, margin, hits);
+  }
+};
+
+//----------------------------------------------------------------------
+vtkStandardNewMacro(vtkSRepSpatialIndex);
+
+//----------------------------------------------------------------------
+vtkSRepSpatialIndex::vtkSRepSpatialIndex()
+  : SRep()
+  , Spokes()
+  , SkeletalPoints()
+  , BuildTime(0)
+  , Built(false)
+{}
+
+//----------------------------------------------------------------------
+vtkSRepSpatialIndex::~vtkSRepSpatialIndex() = default;
+
+//----------------------------------------------------------------------
+void vtkSRepSpatialIndex::PrintSelf(ostream& os, vtkIndent indent) {
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "SRep: " << this->SRep.GetPointer() << std::endl;
+  os << indent << "Built: " << (this->Built ? "true" : "false") << std::endl;
+}
+
+//----------------------------------------------------------------------
+void vtkSRepSpatialIndex::SetSRep(const vtkMeshSRepInterface* srep) {
+  if (srep != this->SRep.GetPointer()) {
+    this->SRep = const_cast<vtkMeshSRepInterface*>(srep);
+    this->Built = false;
+    this->Modified();
+  }
+}
+
+//----------------------------------------------------------------------
+const vtkMeshSRepInterface* vtkSRepSpatialIndex::GetSRep() const {
+  return this->SRep;
+}
+
+//----------------------------------------------------------------------
+void vtkSRepSpatialIndex::BuildIfNeeded() const {
+  if (this->Built && (!this->SRep || this->SRep->GetMTime() <= this->BuildTime)) {
+    return;
+  }
+
+  std::vector<Hierarchy::Segment> spokes;
+  std::vector<Hierarchy::Segment> skeletalPoints;
+  if (this->SRep) {
+    const auto addSpokes = [&](const vtkSRepSpokeMesh* mesh, SpokeOrientation orientation) {
+      for (IndexType i = 0; i < mesh->GetNumberOfSpokes(); ++i) {
+        const auto* spoke = mesh->At(i);
+        const SpokeId id{orientation, i};
+        const auto start = ToVec(spoke->GetSkeletalPoint());
+        spokes.push_back(Hierarchy::Segment{start, ToVec(spoke->GetDirection()), id});
+        if (orientation == vtkSRepSkeletalPoint::UpOrientation) {
+          skeletalPoints.push_back(Hierarchy::Segment{start, Vec{0, 0, 0}, id});
+        }
+      }
+    };
+    addSpokes(this->SRep->GetUpSpokes(), vtkSRepSkeletalPoint::UpOrientation);
+    addSpokes(this->SRep->GetDownSpokes(), vtkSRepSkeletalPoint::DownOrientation);
+    addSpokes(this->SRep->GetCrestSpokes(), vtkSRepSkeletalPoint::CrestOrientation);
+  }
+
+  this->Spokes.reset(new Hierarchy(std::move(spokes)));
+  this->SkeletalPoints.reset(new Hierarchy(std::move(skeletalPoints)));
+  this->BuildTime = this->SRep ? this->SRep->GetMTime() : 0;
+  this->Built = true;
+}
+
+//----------------------------------------------------------------------
+bool vtkSRepSpatialIndex::FindClosestSpoke(const srep::Point3d& point, SpokeHit& hit) const {
+  this->BuildIfNeeded();
+  return this->Spokes->FindClosest(ToVec(point), Vec{0, 0, 0}, 0.0, hit);
+}
+
+//----------------------------------------------------------------------
+bool vtkSRepSpatialIndex::FindClosestSkeletalPoint(const srep::Point3d& point, SpokeHit& hit) const {
+  this->BuildIfNeeded();
+  return this->SkeletalPoints->FindClosest(ToVec(point), Vec{0, 0, 0}, 0.0, hit);
+}
+
+//----------------------------------------------------------------------
+bool vtkSRepSpatialIndex::PickSpoke(const srep::Point3d& origin, const srep::Vector3d& direction, double tolerance, SpokeHit& hit) const {
+  if (direction.GetLength() == 0.0) {
+    throw std::invalid_argument("Cannot pick along a zero length ray direction");
+  }
+  // unit direction so the query parameter is a distance along the ray
+  const auto unit = ToVec(direction.Unit());
+  this->BuildIfNeeded();
+  return this->Spokes->Pick(ToVec(origin), unit, tolerance, hit);
+}
+
+//----------------------------------------------------------------------
+std::vector<vtkSRepSpatialIndex::SpokeHit> vtkSRepSpatialIndex::FindSpokesWithinRadius(const srep::Point3d& point, double radius) const {
+  this->BuildIfNeeded();
+  std::vector<SpokeHit> hits;
+  this->Spokes->FindWithin(ToVec(point), Vec{0, 0, 0}, 0.0, radius, hits);
+  std::sort(hits.begin(), hits.end(), [](const SpokeHit& a, const SpokeHit& b) { return a.Distance < b.Distance; });
+  return hits;
+}
+
+//----------------------------------------------------------------------
+std::vector<vtkSRepSpatialIndex::SpokeHit> vtkSRepSpatialIndex::FindSpokesNearSegment(const srep::Point3d& start, const srep::Point3d& end, double distance) const {
+  this->BuildIfNeeded();
+  const auto p = ToVec(start);
+  std::vector<SpokeHit> hits;
+  this->Spokes->FindWithin(p, Sub(ToVec(end), p), 1.0, distance, hits);
+  std::sort(hits.begin(), hits.end(), [](const SpokeHit& a, const SpokeHit& b) { return a.Distance < b.Distance; });
+  return hits;
+}
@@ -0,0 +1,106 @@
+#ifndef __vtkSRepSpatialIndex_h
+#define __vtkSRepSpatialIndex_h
+
+#include "vtkMeshSRepInterface.h"
+#include "vtkSRepSkeletalPoint.h"
+
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+
+#include <memory>
+#include <vector>
+
+#include "vtkSlicerSRepModuleMRMLExport.h"
+
+/// Bounding volume hierarchy over the spokes and skeletal points of an SRep.
+///
+/// The hierarchy is built the first time it is queried and rebuilt on the first query after
+/// the SRep is modified, so it is safe to hold on to an index while the SRep is being edited.
+class VTK_SLICER_SREP_MODULE_MRML_EXPORT vtkSRepSpatialIndex : public vtkObject {
+public:
+  using IndexType = vtkSRepSpokeMesh::IndexType;
+  using SpokeOrientation = vtkSRepSkeletalPoint::SpokeOrientation;
+
+  /// Identifies a spoke by its orientation and its index into the matching spoke mesh of the SRep
+  /// (GetUpSpokes, GetDownSpokes, or GetCrestSpokes).
+  struct SpokeId {
+    SpokeOrientation Orientation;
+    IndexType Index;
+  };
+
+  /// Result of a query against a spoke.
+  struct SpokeHit {
+    SpokeId Spoke;
+    /// Distance between the spoke and the query.
+    double Distance;
+    /// Location of the closest point on the spoke. 0 is the skeletal point, 1 is the boundary point.
+    double SpokeParameter;
+    /// Location of the closest point on the query. For a ray this is the distance along the ray,
+    /// for a segment 0 is the start and 1 is the end. Always 0 for point queries.
+    double QueryParameter;
+  };
+
+  static vtkSRepSpatialIndex* New();
+  ~vtkSRepSpatialIndex();
+
+  /// Standard methods for a VTK class.
+  vtkTypeMacro(vtkSRepSpatialIndex, vtkObject);
+
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// @{
+  /// Gets/sets the SRep to index. The SRep is never modified by the index.
+  void SetSRep(const vtkMeshSRepInterface* srep);
+  const vtkMeshSRepInterface* GetSRep() const;
+  /// @}
+
+  /// Builds the hierarchy if it is out of date.
+  ///
+  /// Queries call this automatically. Call it before querying from multiple threads at once, the queries
+  /// themselves are safe to run concurrently as long as the SRep is not modified.
+  void BuildIfNeeded() const;
+
+  /// Finds the spoke closest to point.
+  /// \returns false if there are no spokes.
+  bool FindClosestSpoke(const srep::Point3d& point, SpokeHit& hit) const;
+
+  /// Finds the skeletal point closest to point.
+  ///
+  /// Skeletal points are identified by the up spoke that starts at them, so hit.Spoke.Orientation
+  /// will always be UpOrientation and hit.SpokeParameter will always be 0.
+  /// \returns false if there are no skeletal points.
+  bool FindClosestSkeletalPoint(const srep::Point3d& point, SpokeHit& hit) const;
+
+  /// Finds the first spoke along a ray that passes within tolerance of the spoke.
+  ///
+  /// The first spoke is the one whose closest approach to the ray is nearest the ray origin.
+  /// \param direction Direction of the ray. Does not need to be a unit vector.
+  /// \returns false if no spoke is within tolerance of the ray.
+  /// \throws std::invalid_argument if direction is a zero length vector.
+  bool PickSpoke(const srep::Point3d& origin, const srep::Vector3d& direction, double tolerance, SpokeHit& hit) const;
+
+  /// Finds all spokes within radius of point, sorted by distance.
+  std::vector<SpokeHit> FindSpokesWithinRadius(const srep::Point3d& point, double radius) const;
+
+  /// Finds all spokes within distance of the segment from start to end, sorted by distance.
+  std::vector<SpokeHit> FindSpokesNearSegment(const srep::Point3d& start, const srep::Point3d& end, double distance) const;
+
+protected:
+  vtkSRepSpatialIndex();
+  vtkSRepSpatialIndex(const vtkSRepSpatialIndex&) = delete;
+  vtkSRepSpatialIndex(vtkSRepSpatialIndex&&) = delete;
+  vtkSRepSpatialIndex& operator=(const vtkSRepSpatialIndex&) = delete;
+  vtkSRepSpatialIndex& operator=(vtkSRepSpatialIndex&&) = delete;
+
+private:
+  class Hierarchy;
+
+  // the SRep is never modified, the const_cast on the set is only so it can be reference counted
+  vtkSmartPointer<vtkMeshSRepInterface> SRep;
+  mutable std::unique_ptr<Hierarchy> Spokes;
+  mutable std::unique_ptr<Hierarchy> SkeletalPoints;
+  mutable vtkMTimeType BuildTime;
+  mutable bool Built;
+};
+
+#endif
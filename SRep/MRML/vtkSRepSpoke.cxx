@@ -53,6 +53,13 @@ void vtkSRepSpoke::SetDirectionAndMagnitude(const vtkVector3d& direction) {
   this->SetDirectionAndMagnitude(srep::Vector3d(direction));
 }
 
+//----------------------------------------------------------------------
+void vtkSRepSpoke::SetSkeletalPointAndDirection(const srep::Point3d& skeletalPoint, const srep::Vector3d& direction) {
+  this->SkeletalPoint = skeletalPoint;
+  this->Direction = direction;
+  this->Modified();
+}
+
 //----------------------------------------------------------------------
 void vtkSRepSpoke::SetDirectionOnly(const srep::Vector3d& direction) {
   const auto currentRadius = this->GetRadius();
@@ -59,6 +59,9 @@ public:
   /// Sets the direction and radius
   void SetDirectionAndMagnitude(const vtkVector3d& direction);
 
+  /// Sets the skeletal point, direction, and radius with a single Modified.
+  void SetSkeletalPointAndDirection(const srep::Point3d& skeletalPoint, const srep::Vector3d& direction);
+
   /// Gets the point that is at the tip of the spoke.
   /// \note this is obtained by SkeletalPoint + Direction
   srep::Point3d GetBoundaryPoint() const;
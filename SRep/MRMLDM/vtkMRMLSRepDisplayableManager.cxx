@@ -1,9 +1,15 @@
 #include "vtkMRMLSRepDisplayableManager.h"
+#include <vtkSlicerSRepWidgetRepresentation.h>
 #include <vtkEventBroker.h>
+#include <vtkMath.h>
 #include <vtkObjectFactory.h>
 #include <vtkMRMLScene.h>
 #include <vtkMRMLAbstractViewNode.h>
 
+#include <cmath>
+#include <unordered_set>
+#include <utility>
+
 vtkStandardNewMacro(vtkMRMLSRepDisplayableManager);
 
 //---------------------------------------------------------------------------
@@ -18,17 +24,34 @@ vtkMRMLSRepDisplayableManager::vtkMRMLSRepDisplayableManager()
     : vtkMRMLAbstractDisplayableManager()
     , SRepNodes()
     , DisplayNodesToWidgets()
+    , PendingSRepNodes()
+    , PendingDisplayNodes()
+    , DirtyDisplayNodes()
+    , RenderStartCallback(vtkSmartPointer<vtkCallbackCommand>::New())
+    , ObservedRenderer()
+    , RenderStartObserverTag(0)
+    , Population()
+    , PopulationRenderer()
     , ObservedSRepNodeEvents({vtkCommand::ModifiedEvent
                             , vtkMRMLTransformableNode::TransformModifiedEvent
                             , vtkMRMLDisplayableNode::DisplayModifiedEvent
     })
-{}
-vtkMRMLSRepDisplayableManager::~vtkMRMLSRepDisplayableManager() = default;
+{
+  this->RenderStartCallback->SetClientData(this);
+  this->RenderStartCallback->SetCallback(&vtkMRMLSRepDisplayableManager::OnRenderStart);
+}
+vtkMRMLSRepDisplayableManager::~vtkMRMLSRepDisplayableManager() {
+  if (this->ObservedRenderer) {
+    this->ObservedRenderer->RemoveObserver(this->RenderStartObserverTag);
+  }
+  if (this->Population && this->PopulationRenderer) {
+    this->PopulationRenderer->RemoveViewProp(this->Population);
+  }
+}
 
 void vtkMRMLSRepDisplayableManager::ProcessMRMLNodesEvents(vtkObject *caller, unsigned long event, void *callData) {
   vtkMRMLSRepNode * srepNode = vtkMRMLSRepNode::SafeDownCast(caller);
   if (srepNode) {
-    bool renderRequested = false;
     for (int i = 0; i < srepNode->GetNumberOfDisplayNodes(); ++i) {
       vtkMRMLSRepDisplayNode* displayNode = vtkMRMLSRepDisplayNode::SafeDownCast(srepNode->GetNthDisplayNode(i));
       auto wit = this->DisplayNodesToWidgets.find(displayNode);
@@ -40,16 +63,7 @@ void vtkMRMLSRepDisplayableManager::ProcessMRMLNodesEvents(vtkObject *caller, un
           continue;
         }
       }
-      auto& widget = wit->second;
-      widget->UpdateFromMRML(srepNode, event, callData);
-      if (widget->GetNeedToRender()) {
-        renderRequested = true;
-        widget->NeedToRenderOff();
-      }
-    }
-
-    if (renderRequested) {
-      this->BatchSafeRequestRender();
+      this->MarkDirty(displayNode, event);
     }
   } else {
     this->Superclass::ProcessMRMLNodesEvents(caller, event, callData);
@@ -62,12 +76,176 @@ void vtkMRMLSRepDisplayableManager::BatchSafeRequestRender() {
   }
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLSRepDisplayableManager::MarkDirty(vtkMRMLSRepDisplayNode* displayNode, unsigned long event) {
+  this->ObserveRenderer();
+  if (!this->ObservedRenderer) {
+    // nothing will render, so nothing will update the widget later
+    this->DirtyDisplayNodes[displayNode] = event;
+    this->UpdateDirtyWidgets();
+    return;
+  }
+
+  const bool firstDirty = this->DirtyDisplayNodes.empty();
+  this->DirtyDisplayNodes[displayNode] = event;
+  if (firstDirty) {
+    this->BatchSafeRequestRender();
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLSRepDisplayableManager::UpdateDirtyWidgets() {
+  // take the set first, a widget update can end up marking widgets dirty again
+  const auto dirtyDisplayNodes = std::move(this->DirtyDisplayNodes);
+  this->DirtyDisplayNodes.clear();
+
+  for (const auto& dirty : dirtyDisplayNodes) {
+    auto wit = this->DisplayNodesToWidgets.find(dirty.first);
+    if (this->DisplayNodesToWidgets.end() == wit) {
+      continue;
+    }
+    this->UpdateDisplayNode(wit, dirty.second);
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLSRepDisplayableManager::UpdateDisplayNode(DisplayNodesToWidgetsMap::iterator wit, unsigned long event) {
+  vtkMRMLSRepDisplayNode* displayNode = wit->first;
+  auto& entry = wit->second;
+
+  // the display node can be moved in and out of the population at any time
+  if (displayNode->GetPopulationDisplay()) {
+    if (entry.Widget) {
+      entry.Widget->SetRenderer(nullptr);
+      entry.Widget->SetRepresentation(nullptr);
+      entry.Widget = nullptr;
+    }
+    this->UpdatePopulationMember(displayNode, entry.SRepNode);
+    return;
+  }
+
+  if (this->Population) {
+    this->Population->RemoveMember(displayNode);
+  }
+  if (!entry.Widget) {
+    entry.Widget = this->CreateWidget(displayNode);
+    if (!entry.Widget) {
+      vtkErrorMacro("vtkMRMLSRepDisplayableManager: Failed to create widget");
+      return;
+    }
+  }
+  entry.Widget->UpdateFromMRML(displayNode, event);
+  // either we are in the render already or the render is requested by the caller
+  entry.Widget->NeedToRenderOff();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLSRepDisplayableManager::UpdatePopulationMember(vtkMRMLSRepDisplayNode* displayNode, vtkMRMLSRepNode* srepNode) {
+  auto population = this->GetPopulation();
+  if (!population) {
+    return;
+  }
+
+  vtkMRMLAbstractViewNode* viewNode = vtkMRMLAbstractViewNode::SafeDownCast(this->GetMRMLDisplayableNode());
+  if (!vtkSlicerSRepWidgetRepresentation::IsDisplayable(displayNode, viewNode)) {
+    // only hide it, the geometry stays in case it is shown again
+    if (population->HasMember(displayNode)) {
+      population->SetMemberVisibility(displayNode, false);
+    } else {
+      population->SetMember(displayNode, nullptr, *displayNode->SmartGetSRepExportPolyDataProperties(), 0, false);
+    }
+    return;
+  }
+
+  const auto srep = srepNode->GetSRepWorld();
+  double radius = displayNode->GetAbsoluteThickness();
+  if (!displayNode->GetUseAbsoluteThickness()) {
+    double bounds[6];
+    srepNode->GetRASBounds(bounds);
+    const double minPoint[] = {bounds[0], bounds[2], bounds[4]};
+    const double maxPoint[] = {bounds[1], bounds[3], bounds[5]};
+    radius = std::sqrt(vtkMath::Distance2BetweenPoints(minPoint, maxPoint)) * displayNode->GetRelativeThickness();
+  }
+  population->SetMember(displayNode, srep, *displayNode->SmartGetSRepExportPolyDataProperties(), radius, true);
+}
+
+//---------------------------------------------------------------------------
+vtkSlicerSRepPopulationRepresentation* vtkMRMLSRepDisplayableManager::GetPopulation() {
+  vtkRenderer* renderer = this->GetRenderer();
+  if (!renderer) {
+    return nullptr;
+  }
+  if (!this->Population) {
+    this->Population = vtkSmartPointer<vtkSlicerSRepPopulationRepresentation>::New();
+  }
+  if (this->PopulationRenderer != renderer) {
+    if (this->PopulationRenderer) {
+      this->PopulationRenderer->RemoveViewProp(this->Population);
+    }
+    renderer->AddViewProp(this->Population);
+    this->PopulationRenderer = renderer;
+  }
+  return this->Population;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLSRepDisplayableManager::ObserveRenderer() {
+  vtkRenderer* renderer = this->GetRenderer();
+  if (renderer == this->ObservedRenderer) {
+    return;
+  }
+  if (this->ObservedRenderer) {
+    this->ObservedRenderer->RemoveObserver(this->RenderStartObserverTag);
+  }
+  this->ObservedRenderer = renderer;
+  if (renderer) {
+    this->RenderStartObserverTag = renderer->AddObserver(vtkCommand::StartEvent, this->RenderStartCallback);
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLSRepDisplayableManager::OnRenderStart(vtkObject*, unsigned long, void* clientData, void*) {
+  auto self = static_cast<vtkMRMLSRepDisplayableManager*>(clientData);
+  if (!self->DirtyDisplayNodes.empty()) {
+    self->UpdateDirtyWidgets();
+  }
+}
+
 void vtkMRMLSRepDisplayableManager::UpdateFromMRMLScene() {
-  if (this->GetMRMLDisplayableNode()) {
-     this->UpdateFromMRML();
+  if (!this->GetMRMLDisplayableNode() || !this->GetMRMLScene()) {
+    return;
+  }
+
+  // Full resync with the scene. This only happens for scene level events, everything else
+  // is kept up to date incrementally from the node added/removed events.
+  std::vector<vtkMRMLNode*> srepNodesInScene;
+  this->GetMRMLScene()->GetNodesByClass("vtkMRMLSRepNode", srepNodesInScene);
+  const std::unordered_set<vtkMRMLNode*> srepNodesInSceneSet(srepNodesInScene.begin(), srepNodesInScene.end());
+
+  // remove any srep nodes that have been removed from the mrml scene
+  for (auto it = this->SRepNodes.begin(); it != this->SRepNodes.end();) {
+    if (!srepNodesInSceneSet.count(it->first.Get())) {
+      it = this->RemoveSRepNode(it);
+    } else {
+      ++it;
+    }
+  }
+
+  // queue everything else, already tracked nodes are skipped when the queue is processed
+  for (const auto node : srepNodesInScene) {
+    this->PendingSRepNodes.emplace_back(vtkMRMLSRepNode::SafeDownCast(node));
+  }
+  std::vector<vtkMRMLNode*> srepDisplayNodesInScene;
+  this->GetMRMLScene()->GetNodesByClass("vtkMRMLSRepDisplayNode", srepDisplayNodesInScene);
+  for (const auto node : srepDisplayNodesInScene) {
+    this->PendingDisplayNodes.emplace_back(vtkMRMLSRepDisplayNode::SafeDownCast(node));
   }
+
+  this->UpdateFromMRML();
 }
 void vtkMRMLSRepDisplayableManager::OnMRMLSceneEndClose() {
+  this->PendingSRepNodes.clear();
+  this->PendingDisplayNodes.clear();
   for (auto it = SRepNodes.begin(); it != SRepNodes.end();) {
     it = this->RemoveSRepNode(it);
   }
@@ -79,9 +257,17 @@ void vtkMRMLSRepDisplayableManager::OnMRMLSceneEndImport() {
   this->UpdateFromMRMLScene();
   this->RequestRender();
 }
+void vtkMRMLSRepDisplayableManager::OnMRMLSceneEndBatchProcess() {
+  this->Superclass::OnMRMLSceneEndBatchProcess();
+  // widgets marked dirty during batch processing couldn't request a render
+  if (!this->DirtyDisplayNodes.empty()) {
+    this->RequestRender();
+  }
+}
 
 void vtkMRMLSRepDisplayableManager::UpdateFromMRML() {
-  // this gets called from RequestRender, so make sure to jump out quickly if possible
+  // this gets called from RequestRender, so make sure to jump out quickly if possible.
+  // Only the nodes that came in while the scene was batch processing are looked at, never the whole scene.
   if (!this->GetMRMLScene()) {
     return;
   }
@@ -91,34 +277,36 @@ void vtkMRMLSRepDisplayableManager::UpdateFromMRML() {
   // from mrml again
   this->SetUpdateFromMRMLRequested(false);
 
-  // add any new srep nodes
-  std::vector<vtkMRMLNode*> srepNodesInScene;
-  this->GetMRMLScene()->GetNodesByClass("vtkMRMLSRepNode", srepNodesInScene);
-  for (const auto node : srepNodesInScene) {
-    auto srepNode = vtkMRMLSRepNode::SafeDownCast(node);
-    if (srepNode && !this->SRepNodes.count(srepNode)) {
+  this->AddPendingNodes();
+}
+
+void vtkMRMLSRepDisplayableManager::AddPendingNodes() {
+  // take the queues first, adding a node can request a render which can come back here
+  const auto pendingSRepNodes = std::move(this->PendingSRepNodes);
+  const auto pendingDisplayNodes = std::move(this->PendingDisplayNodes);
+  this->PendingSRepNodes.clear();
+  this->PendingDisplayNodes.clear();
+
+  // nodes that were removed from the scene again before we got to them are skipped
+  for (const auto& srepNode : pendingSRepNodes) {
+    if (srepNode
+      && srepNode->GetScene() == this->GetMRMLScene()
+      && !this->SRepNodes.count(srepNode.GetPointer()))
+    {
       this->AddSRepNode(srepNode);
     }
   }
 
-  // add any new srep display nodes
-  std::vector<vtkMRMLNode*> srepDisplayNodesInScene;
-  this->GetMRMLScene()->GetNodesByClass("vtkMRMLSRepDisplayNode", srepDisplayNodesInScene);
-  for (const auto node : srepDisplayNodesInScene) {
-    auto srepDisplayNode = vtkMRMLSRepDisplayNode::SafeDownCast(node);
-    if (srepDisplayNode && !this->DisplayNodesToWidgets.count(srepDisplayNode)) {
+  // display nodes whose srep node isn't tracked will be added when it is
+  for (const auto& srepDisplayNode : pendingDisplayNodes) {
+    if (srepDisplayNode
+      && srepDisplayNode->GetScene() == this->GetMRMLScene()
+      && this->SRepNodes.count(srepDisplayNode->GetSRepNode())
+      && !this->DisplayNodesToWidgets.count(srepDisplayNode.GetPointer()))
+    {
       this->AddDisplayNode(srepDisplayNode);
     }
   }
-
-  // remove any srep nodes that have been removed from the mrml scene
-  for (auto it = this->SRepNodes.begin(); it != this->SRepNodes.end();) {
-    if (srepNodesInScene.end() == std::find(srepNodesInScene.begin(), srepNodesInScene.end(), it->Get())) {
-      it = this->RemoveSRepNode(it);
-    } else {
-      ++it;
-    }
-  }
 }
 
 void vtkMRMLSRepDisplayableManager::OnMRMLSceneNodeAdded(vtkMRMLNode* node) {
@@ -126,9 +314,15 @@ void vtkMRMLSRepDisplayableManager::OnMRMLSceneNodeAdded(vtkMRMLNode* node) {
       return;
   }
 
-    // if the scene is still updating, jump out
+  // if the scene is still updating, remember the node for the next UpdateFromMRML
   if (this->GetMRMLScene()->IsBatchProcessing()) {
-    this->SetUpdateFromMRMLRequested(true);
+    if (auto srepNode = vtkMRMLSRepNode::SafeDownCast(node)) {
+      this->PendingSRepNodes.emplace_back(srepNode);
+      this->SetUpdateFromMRMLRequested(true);
+    } else if (auto srepDisplayNode = vtkMRMLSRepDisplayNode::SafeDownCast(node)) {
+      this->PendingDisplayNodes.emplace_back(srepDisplayNode);
+      this->SetUpdateFromMRMLRequested(true);
+    }
     return;
   }
 
@@ -171,7 +365,7 @@ void vtkMRMLSRepDisplayableManager::AddSRepNode(vtkMRMLSRepNode* node) {
   }
 
   this->AddObservations(node);
-  this->SRepNodes.insert(node);
+  this->SRepNodes.emplace(node, SRepNodesMap::mapped_type());
 
   // Add Display Nodes
   const int numDisplayNodes = node->GetNumberOfDisplayNodes();
@@ -196,18 +390,14 @@ void vtkMRMLSRepDisplayableManager::RemoveSRepNode(vtkMRMLSRepNode* node) {
   this->RemoveSRepNode(this->SRepNodes.find(node));
 }
 
-vtkMRMLSRepDisplayableManager::SRepNodesSet::iterator
-vtkMRMLSRepDisplayableManager::RemoveSRepNode(SRepNodesSet::iterator it) {
+vtkMRMLSRepDisplayableManager::SRepNodesMap::iterator
+vtkMRMLSRepDisplayableManager::RemoveSRepNode(SRepNodesMap::iterator it) {
   if (this->SRepNodes.end() != it) {
-    auto node = *it;
-    // Remove associated display nodes
-    for (auto wit = this->DisplayNodesToWidgets.begin(); wit != this->DisplayNodesToWidgets.end();) {
-      auto& displayNode = wit->first;
-      if (displayNode->GetDisplayableNode() == node.Get()) {
-        wit = this->RemoveDisplayNode(wit);
-      } else {
-        ++wit;
-      }
+    auto node = it->first;
+    // Remove associated display nodes. Copy because removing a display node removes it from the set.
+    const auto displayNodes = it->second;
+    for (auto displayNode : displayNodes) {
+      this->RemoveDisplayNode(displayNode);
     }
 
     this->RemoveObservations(node);
@@ -219,9 +409,19 @@ vtkMRMLSRepDisplayableManager::RemoveSRepNode(SRepNodesSet::iterator it) {
 vtkMRMLSRepDisplayableManager::DisplayNodesToWidgetsMap::iterator
 vtkMRMLSRepDisplayableManager::RemoveDisplayNode(DisplayNodesToWidgetsMap::iterator wit) {
   if (wit != this->DisplayNodesToWidgets.end()) {
-    auto& widget = wit->second;
-    widget->SetRenderer(nullptr);
-    widget->SetRepresentation(nullptr);
+    this->DirtyDisplayNodes.erase(wit->first.Get());
+    auto sit = this->SRepNodes.find(wit->second.SRepNode);
+    if (sit != this->SRepNodes.end()) {
+      sit->second.erase(wit->first.Get());
+    }
+    auto& widget = wit->second.Widget;
+    if (widget) {
+      widget->SetRenderer(nullptr);
+      widget->SetRepresentation(nullptr);
+    }
+    if (this->Population) {
+      this->Population->RemoveMember(wit->first);
+    }
     return this->DisplayNodesToWidgets.erase(wit);
   }
   return wit;
@@ -244,19 +444,21 @@ void vtkMRMLSRepDisplayableManager::AddDisplayNode(vtkMRMLSRepDisplayNode* displ
     return;
   }
 
-  auto newWidget = this->CreateWidget(displayNode);
-  if (!newWidget) {
-    vtkErrorMacro("vtkMRMLSRepDisplayableManager: Failed to create widget");
+  auto sit = this->SRepNodes.find(displayNode->GetSRepNode());
+  if (this->SRepNodes.end() == sit) {
+    vtkErrorMacro("vtkMRMLSRepDisplayableManager: Error adding display node for untracked srep node");
     return;
   }
 
-  const auto ret = this->DisplayNodesToWidgets.insert(std::make_pair(displayNode, newWidget));
+  // the widget, or the population member, is made by the first update
+  const auto ret = this->DisplayNodesToWidgets.insert(std::make_pair(displayNode, DisplayNodeWidget{nullptr, sit->first}));
   if (!ret.second) {
     vtkErrorMacro("vtkMRMLSRepDisplayableManager: Error adding widget to map");
     return;
   }
+  sit->second.insert(displayNode);
 
-  newWidget->UpdateFromMRML(displayNode, 0);
+  this->UpdateDisplayNode(ret.first, 0);
 
   this->BatchSafeRequestRender();
 }
@@ -5,11 +5,22 @@
 #include "vtkSlicerSRepModuleMRMLDisplayableManagerExport.h"
 #include <vtkMRMLSRepNode.h>
 #include <vtkMRMLSRepDisplayNode.h>
+#include <vtkSlicerSRepPopulationRepresentation.h>
 #include <vtkSlicerSRepWidget.h>
 
 // MRMLDisplayableManager includes
 #include <vtkMRMLAbstractDisplayableManager.h>
 
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkRenderer.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 class VTK_SLICER_SREP_MODULE_MRMLDISPLAYABLEMANAGER_EXPORT vtkMRMLSRepDisplayableManager
     : public vtkMRMLAbstractDisplayableManager
 {
@@ -31,28 +42,80 @@ protected:
   void UpdateFromMRMLScene() override;
   void OnMRMLSceneEndClose() override;
   void OnMRMLSceneEndImport() override;
+  void OnMRMLSceneEndBatchProcess() override;
 
 private:
-  using SRepNodesSet = std::set<vtkSmartPointer<vtkMRMLSRepNode>>;
+  /// Hashes smart pointers by the object they point to.
+  struct SmartPointerHash {
+    template <class T>
+    size_t operator()(const vtkSmartPointer<T>& p) const {
+      return std::hash<T*>()(p.Get());
+    }
+  };
+
+  /// The display nodes being shown for each srep node, so removing an srep node doesn't need to look at
+  /// every widget.
+  using SRepNodesMap =
+    std::unordered_map<vtkSmartPointer<vtkMRMLSRepNode>, std::unordered_set<vtkMRMLSRepDisplayNode*>, SmartPointerHash>;
+
+  struct DisplayNodeWidget {
+    /// nullptr while the display node is drawn as part of the population.
+    vtkSmartPointer<vtkSlicerSRepWidget> Widget;
+    /// The srep node the widget was added under.
+    vtkMRMLSRepNode* SRepNode;
+  };
   using DisplayNodesToWidgetsMap =
-    std::map<vtkSmartPointer<vtkMRMLSRepDisplayNode>, vtkSmartPointer<vtkSlicerSRepWidget>>;
+    std::unordered_map<vtkSmartPointer<vtkMRMLSRepDisplayNode>, DisplayNodeWidget, SmartPointerHash>;
 
   void AddSRepNode(vtkMRMLSRepNode* node);
   void RemoveSRepNode(vtkMRMLSRepNode* node);
-  SRepNodesSet::iterator RemoveSRepNode(SRepNodesSet::iterator it);
+  SRepNodesMap::iterator RemoveSRepNode(SRepNodesMap::iterator it);
 
   void AddDisplayNode(vtkMRMLSRepDisplayNode* displayNode);
   void RemoveDisplayNode(vtkMRMLSRepDisplayNode* displayNode);
   DisplayNodesToWidgetsMap::iterator RemoveDisplayNode(DisplayNodesToWidgetsMap::iterator wit);
 
+  /// Adds the nodes added to the scene since the last call, e.g. during batch processing.
+  void AddPendingNodes();
+
+  /// Marks the widget of displayNode as needing an update and schedules a render.
+  ///
+  /// The update itself is deferred until the next render starts, so any number of node events
+  /// between two renders cost one widget update each and a single render. Renders requested
+  /// through the displayable manager are already coalesced and capped at the view's maximum
+  /// update rate, so the updates are too.
+  void MarkDirty(vtkMRMLSRepDisplayNode* displayNode, unsigned long event);
+  /// Updates every widget marked dirty since the last call.
+  void UpdateDirtyWidgets();
+  /// Updates the widget of a display node, or its population member if it has population display on.
+  void UpdateDisplayNode(DisplayNodesToWidgetsMap::iterator wit, unsigned long event);
+  void UpdatePopulationMember(vtkMRMLSRepDisplayNode* displayNode, vtkMRMLSRepNode* srepNode);
+  /// The representation shared by every display node with population display on. Created and added to
+  /// the renderer on first use. nullptr if there is no renderer.
+  vtkSlicerSRepPopulationRepresentation* GetPopulation();
+  /// Makes sure the current renderer is observed for render starts.
+  void ObserveRenderer();
+  static void OnRenderStart(vtkObject* caller, unsigned long event, void* clientData, void* callData);
+
   void AddObservations(vtkMRMLSRepNode* node);
   void RemoveObservations(vtkMRMLSRepNode* node);
 
   vtkSmartPointer<vtkSlicerSRepWidget> CreateWidget(vtkMRMLSRepDisplayNode* node);
 
   //Members
-  SRepNodesSet SRepNodes;
+  SRepNodesMap SRepNodes;
   DisplayNodesToWidgetsMap DisplayNodesToWidgets;
+  /// Nodes added to the scene that haven't been added to the manager yet. Weak so that nodes
+  /// deleted in the meantime drop out on their own.
+  std::vector<vtkWeakPointer<vtkMRMLSRepNode>> PendingSRepNodes;
+  std::vector<vtkWeakPointer<vtkMRMLSRepDisplayNode>> PendingDisplayNodes;
+  /// Display nodes whose widget needs an update, with the last event seen for each.
+  std::unordered_map<vtkMRMLSRepDisplayNode*, unsigned long> DirtyDisplayNodes;
+  vtkSmartPointer<vtkCallbackCommand> RenderStartCallback;
+  vtkWeakPointer<vtkRenderer> ObservedRenderer;
+  unsigned long RenderStartObserverTag;
+  vtkSmartPointer<vtkSlicerSRepPopulationRepresentation> Population;
+  vtkWeakPointer<vtkRenderer> PopulationRenderer;
   std::vector<unsigned long> ObservedSRepNodeEvents;
 };
 
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <vtkEllipticalSRep.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMRMLEllipticalSRepNode.h>
+#include <vtkMRMLLinearTransformNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkNew.h>
+#include <vtkSlicerSRepLogic.h>
+
+#include "SRepUnitTestHelpers.h"
+
+using namespace srepUnitTestHelpers;
+
+namespace {
+
+void SetTranslation(vtkMRMLLinearTransformNode* transformNode, double x, double y, double z) {
+  vtkNew<vtkMatrix4x4> matrix;
+  matrix->SetElement(0, 3, x);
+  matrix->SetElement(1, 3, y);
+  matrix->SetElement(2, 3, z);
+  transformNode->SetMatrixTransformToParent(matrix);
+}
+
+void ExpectTranslated(const vtkEllipticalSRep* srep, const vtkEllipticalSRep* translated, double x, double y, double z) {
+  ASSERT_NE(nullptr, srep);
+  ASSERT_NE(nullptr, translated);
+  ASSERT_EQ(srep->GetNumberOfLines(), translated->GetNumberOfLines());
+  ASSERT_EQ(srep->GetNumberOfSteps(), translated->GetNumberOfSteps());
+  for (vtkEllipticalSRep::IndexType l = 0; l < srep->GetNumberOfLines(); ++l) {
+    for (vtkEllipticalSRep::IndexType s = 0; s < srep->GetNumberOfSteps(); ++s) {
+      const auto* spoke = srep->GetSkeletalPoint(l, s)->GetUpSpoke();
+      const auto* translatedSpoke = translated->GetSkeletalPoint(l, s)->GetUpSpoke();
+      EXPECT_NEAR(spoke->GetSkeletalPoint().GetX() + x, translatedSpoke->GetSkeletalPoint().GetX(), 1e-12);
+      EXPECT_NEAR(spoke->GetSkeletalPoint().GetY() + y, translatedSpoke->GetSkeletalPoint().GetY(), 1e-12);
+      EXPECT_NEAR(spoke->GetSkeletalPoint().GetZ() + z, translatedSpoke->GetSkeletalPoint().GetZ(), 1e-12);
+      EXPECT_NEAR(spoke->GetRadius(), translatedSpoke->GetRadius(), 1e-12);
+    }
+  }
+}
+
+} // namespace
+
+TEST(EllipticalSRepNodeTest, SRepWorldSharedWithoutTransform) {
+  vtkNew<vtkMRMLEllipticalSRepNode> node;
+  EXPECT_EQ(nullptr, node->GetEllipticalSRepWorld());
+
+  node->SetEllipticalSRep(MakeEllipsoidSRep(8, 4));
+  EXPECT_EQ(node->GetEllipticalSRep(), node->GetEllipticalSRepWorld());
+  EXPECT_EQ(node->GetSRep(), node->GetSRepWorld());
+
+  // still shared after the srep is modified or replaced
+  node->GetEllipticalSRep()->GetSkeletalPoint(0, 0)->GetUpSpoke()->SetDirectionAndMagnitude(srep::Vector3d(0, 0, 2));
+  EXPECT_EQ(node->GetEllipticalSRep(), node->GetEllipticalSRepWorld());
+  node->SetEllipticalSRep(MakeEllipsoidSRep(6, 3));
+  EXPECT_EQ(node->GetEllipticalSRep(), node->GetEllipticalSRepWorld());
+}
+
+TEST(EllipticalSRepNodeTest, SRepWorldRebuiltOnTransformChange) {
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLEllipticalSRepNode> node;
+  vtkNew<vtkMRMLLinearTransformNode> transformNode;
+  scene->AddNode(node);
+  scene->AddNode(transformNode);
+  node->SetEllipticalSRep(MakeEllipsoidSRep(8, 4));
+  const auto* local = node->GetEllipticalSRep();
+
+  SetTranslation(transformNode, 1, 2, 3);
+  node->SetAndObserveTransformNodeID(transformNode->GetID());
+  const auto* world = node->GetEllipticalSRepWorld();
+  EXPECT_NE(local, world);
+  ExpectTranslated(local, world, 1, 2, 3);
+  // not rebuilt if nothing changed
+  EXPECT_EQ(world, node->GetEllipticalSRepWorld());
+
+  SetTranslation(transformNode, 0, 0, 5);
+  ExpectTranslated(local, node->GetEllipticalSRepWorld(), 0, 0, 5);
+
+  // modifying the srep in place also rebuilds it
+  node->GetEllipticalSRep()->GetSkeletalPoint(0, 0)->GetUpSpoke()->SetSkeletalPoint(srep::Point3d(1, 1, 1));
+  ExpectTranslated(local, node->GetEllipticalSRepWorld(), 0, 0, 5);
+
+  // an identity transform shares again
+  SetTranslation(transformNode, 0, 0, 0);
+  EXPECT_EQ(local, node->GetEllipticalSRepWorld());
+
+  SetTranslation(transformNode, -1, 0, 0);
+  ExpectTranslated(local, node->GetEllipticalSRepWorld(), -1, 0, 0);
+  node->SetAndObserveTransformNodeID(nullptr);
+  EXPECT_EQ(local, node->GetEllipticalSRepWorld());
+}
+
+TEST(EllipticalSRepNodeTest, SRepWorldInvalidTransform) {
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLEllipticalSRepNode> node;
+  vtkNew<vtkMRMLLinearTransformNode> transformNode;
+  scene->AddNode(node);
+  scene->AddNode(transformNode);
+  node->SetEllipticalSRep(MakeEllipsoidSRep(8, 4));
+
+  // a zero homogeneous coordinate sends every point to infinity
+  vtkNew<vtkMatrix4x4> matrix;
+  matrix->SetElement(3, 3, 0.0);
+  transformNode->SetMatrixTransformToParent(matrix);
+  node->SetAndObserveTransformNodeID(transformNode->GetID());
+  EXPECT_EQ(nullptr, node->GetEllipticalSRepWorld());
+
+  // recovers once the transform is fixed
+  SetTranslation(transformNode, 1, 2, 3);
+  ExpectTranslated(node->GetEllipticalSRep(), node->GetEllipticalSRepWorld(), 1, 2, 3);
+}
+
+TEST(EllipticalSRepNodeTest, InterpolatedSRepCache) {
+  vtkNew<vtkMRMLEllipticalSRepNode> node;
+  vtkNew<vtkSlicerSRepLogic> logic;
+  EXPECT_EQ(nullptr, node->GetCachedInterpolatedSRep(1));
+  EXPECT_EQ(nullptr, logic->GetInterpolatedSRep(node, 1));
+
+  node->SetEllipticalSRep(MakeEllipsoidSRep(8, 4));
+  EXPECT_EQ(node->GetEllipticalSRep(), logic->GetInterpolatedSRep(node, 0));
+
+  const auto* interpolated = logic->GetInterpolatedSRep(node, 1);
+  ASSERT_NE(nullptr, interpolated);
+  EXPECT_EQ(16, interpolated->GetNumberOfLines());
+  EXPECT_EQ(7, interpolated->GetNumberOfSteps());
+  EXPECT_EQ(interpolated, node->GetCachedInterpolatedSRep(1));
+  EXPECT_EQ(nullptr, node->GetCachedInterpolatedSRep(2));
+  // asking again doesn't interpolate again
+  EXPECT_EQ(interpolated, logic->GetInterpolatedSRep(node, 1));
+}
+
+TEST(EllipticalSRepNodeTest, InterpolatedSRepCacheInvalidatedOnModify) {
+  vtkNew<vtkMRMLEllipticalSRepNode> node;
+  vtkNew<vtkSlicerSRepLogic> logic;
+  node->SetEllipticalSRep(MakeEllipsoidSRep(8, 4));
+
+  const auto* before = logic->GetInterpolatedSRep(node, 1);
+  ASSERT_NE(nullptr, before);
+  const auto beforeUp = before->GetSkeletalPoint(0, 0)->GetUpSpoke()->GetDirection();
+
+  // modifying a spoke in place modifies the srep, which must drop the cache
+  node->GetEllipticalSRep()->GetSkeletalPoint(0, 0)->GetUpSpoke()->SetDirectionAndMagnitude(srep::Vector3d(0, 0, 2));
+  EXPECT_EQ(nullptr, node->GetCachedInterpolatedSRep(1));
+
+  const auto* after = logic->GetInterpolatedSRep(node, 1);
+  ASSERT_NE(nullptr, after);
+  EXPECT_EQ(after, node->GetCachedInterpolatedSRep(1));
+  EXPECT_EQ(srep::Vector3d(0, 0, 2), after->GetSkeletalPoint(0, 0)->GetUpSpoke()->GetDirection());
+  EXPECT_NE(beforeUp, after->GetSkeletalPoint(0, 0)->GetUpSpoke()->GetDirection());
+}
+
+TEST(EllipticalSRepNodeTest, InterpolatedSRepCacheInvalidatedOnReplace) {
+  vtkNew<vtkMRMLEllipticalSRepNode> node;
+  vtkNew<vtkSlicerSRepLogic> logic;
+  node->SetEllipticalSRep(MakeEllipsoidSRep(8, 4));
+  ASSERT_NE(nullptr, logic->GetInterpolatedSRep(node, 1));
+
+  node->SetEllipticalSRep(MakeEllipsoidSRep(6, 3));
+  EXPECT_EQ(nullptr, node->GetCachedInterpolatedSRep(1));
+  const auto* interpolated = logic->GetInterpolatedSRep(node, 1);
+  ASSERT_NE(nullptr, interpolated);
+  EXPECT_EQ(12, interpolated->GetNumberOfLines());
+  EXPECT_EQ(5, interpolated->GetNumberOfSteps());
+
+  node->SetEllipticalSRep(nullptr);
+  EXPECT_EQ(nullptr, node->GetCachedInterpolatedSRep(1));
+}
+
+TEST(EllipticalSRepNodeTest, InterpolateSRepIntoDestination) {
+  vtkNew<vtkMRMLEllipticalSRepNode> node;
+  vtkNew<vtkMRMLEllipticalSRepNode> destination;
+  vtkNew<vtkSlicerSRepLogic> logic;
+  node->SetEllipticalSRep(MakeEllipsoidSRep(8, 4));
+
+  ASSERT_TRUE(logic->InterpolateSRep(node, 1, destination));
+  const auto* cached = node->GetCachedInterpolatedSRep(1);
+  ASSERT_NE(nullptr, cached);
+  // the destination gets its own copy, so modifying it leaves the cache alone
+  ASSERT_NE(cached, destination->GetEllipticalSRep());
+  ExpectSRepEqual(cached, destination->GetEllipticalSRep());
+  destination->GetEllipticalSRep()->GetSkeletalPoint(0, 0)->GetUpSpoke()->SetDirectionAndMagnitude(srep::Vector3d(0, 0, 2));
+  EXPECT_EQ(cached, node->GetCachedInterpolatedSRep(1));
+}
@@ -0,0 +1,284 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vtkEllipticalSRep.h>
+#include <srepUtil.h>
+#include <vtkCommand.h>
+
+#include "SRepUnitTestHelpers.h"
+
+using namespace srepUnitTestHelpers;
+
+namespace {
+
+vtkSmartPointer<vtkSRepSkeletalPoint> MakeSkeletalPoint(double x, double y, bool crest) {
+  const srep::Point3d pt(x, y, 0);
+  auto up = vtkSRepSpoke::SmartCreate(pt, srep::Vector3d(0, 0, 1 + x));
+  auto down = vtkSRepSpoke::SmartCreate(pt, srep::Vector3d(0, 0, -1 - y));
+  if (crest) {
+    return vtkSRepSkeletalPoint::SmartCreate(up, down, vtkSRepSpoke::SmartCreate(pt, srep::Vector3d(x, y, 0)));
+  }
+  return vtkSRepSkeletalPoint::SmartCreate(up, down);
+}
+
+vtkEllipticalSRep::UnrolledEllipticalGrid MakeSkeleton(vtkEllipticalSRep::IndexType lines, vtkEllipticalSRep::IndexType steps) {
+  vtkEllipticalSRep::UnrolledEllipticalGrid skeleton(lines);
+  for (vtkEllipticalSRep::IndexType l = 0; l < lines; ++l) {
+    for (vtkEllipticalSRep::IndexType s = 0; s < steps; ++s) {
+      skeleton[l].push_back(MakeSkeletalPoint(l, s, s == steps - 1));
+    }
+  }
+  return skeleton;
+}
+
+}
+
+TEST(EllipticalSRepTest, SmartCreate) {
+  const auto skeleton = MakeSkeleton(6, 3);
+  const auto srep = vtkEllipticalSRep::SmartCreate(skeleton);
+  ASSERT_EQ(6, srep->GetNumberOfLines());
+  ASSERT_EQ(3, srep->GetNumberOfSteps());
+  for (vtkEllipticalSRep::IndexType l = 0; l < 6; ++l) {
+    for (vtkEllipticalSRep::IndexType s = 0; s < 3; ++s) {
+      // shallow copy
+      EXPECT_EQ(skeleton[l][s], srep->GetSkeletalPoint(l, s));
+    }
+  }
+
+  // (6 / 2 + 1) spine points + 6 lines * 2 non-spine steps
+  EXPECT_EQ(4 + 12, srep->GetUpSpokes()->GetNumberOfSpokes());
+  EXPECT_EQ(4 + 12, srep->GetDownSpokes()->GetNumberOfSpokes());
+  EXPECT_EQ(6, srep->GetCrestSpokes()->GetNumberOfSpokes());
+  EXPECT_EQ(6u, srep->GetCrestToUpSpokeConnections().size());
+  EXPECT_EQ(4u, srep->GetUpSpine().size());
+
+  const auto raw = vtkEllipticalSRep::Create(skeleton);
+  auto fin = srep::util::finally([raw](){ raw->Delete(); });
+  EXPECT_EQ(6, raw->GetNumberOfLines());
+  EXPECT_EQ(3, raw->GetNumberOfSteps());
+}
+
+TEST(EllipticalSRepTest, SetSkeleton) {
+  const auto srep = vtkSmartPointer<vtkEllipticalSRep>::New();
+  TestObserver observer;
+  srep->AddObserver(vtkCommand::ModifiedEvent, &observer, &TestObserver::callback);
+
+  srep->SetSkeleton(MakeSkeleton(8, 4));
+  EXPECT_EQ(1u, observer.numCalls());
+  EXPECT_EQ(8, srep->GetNumberOfLines());
+  EXPECT_EQ(4, srep->GetNumberOfSteps());
+
+  // srep observes the new points
+  srep->GetSkeletalPoint(3, 2)->GetUpSpoke()->SetRadius(10);
+  EXPECT_EQ(2u, observer.numCalls());
+
+  // and not the old ones
+  auto oldPoint = srep->GetSkeletalPoint(0, 0);
+  oldPoint->Register(nullptr);
+  auto fin = srep::util::finally([oldPoint](){ oldPoint->UnRegister(nullptr); });
+  srep->SetSkeleton(MakeSkeleton(4, 2));
+  EXPECT_EQ(3u, observer.numCalls());
+  oldPoint->GetUpSpoke()->SetRadius(10);
+  EXPECT_EQ(3u, observer.numCalls());
+
+  srep->SetSkeleton(vtkEllipticalSRep::UnrolledEllipticalGrid());
+  EXPECT_TRUE(srep->IsEmpty());
+  EXPECT_EQ(4u, observer.numCalls());
+}
+
+TEST(EllipticalSRepTest, SetSkeletonInvalid) {
+  const auto srep = vtkEllipticalSRep::SmartCreate(MakeSkeleton(4, 3));
+  const auto* original = srep->GetSkeletalPoint(1, 1);
+
+  auto ragged = MakeSkeleton(4, 3);
+  ragged[2].pop_back();
+  EXPECT_THROW(srep->SetSkeleton(ragged), std::invalid_argument);
+
+  auto withNull = MakeSkeleton(4, 3);
+  withNull[1][1] = nullptr;
+  EXPECT_THROW(srep->SetSkeleton(withNull), std::invalid_argument);
+
+  auto crestInMiddle = MakeSkeleton(4, 3);
+  crestInMiddle[0][1] = MakeSkeletalPoint(0, 1, true);
+  EXPECT_THROW(srep->SetSkeleton(crestInMiddle), std::invalid_argument);
+
+  auto noCrest = MakeSkeleton(4, 3);
+  noCrest[3][2] = MakeSkeletalPoint(3, 2, false);
+  EXPECT_THROW(srep->SetSkeleton(noCrest), std::invalid_argument);
+
+  // unchanged
+  EXPECT_EQ(4, srep->GetNumberOfLines());
+  EXPECT_EQ(3, srep->GetNumberOfSteps());
+  EXPECT_EQ(original, srep->GetSkeletalPoint(1, 1));
+}
+
+TEST(EllipticalSRepTest, Clone) {
+  const auto srep = vtkEllipticalSRep::SmartCreate(MakeSkeleton(6, 3));
+  const auto clone = srep->SmartClone();
+  ASSERT_EQ(srep->GetNumberOfLines(), clone->GetNumberOfLines());
+  ASSERT_EQ(srep->GetNumberOfSteps(), clone->GetNumberOfSteps());
+  for (vtkEllipticalSRep::IndexType l = 0; l < srep->GetNumberOfLines(); ++l) {
+    for (vtkEllipticalSRep::IndexType s = 0; s < srep->GetNumberOfSteps(); ++s) {
+      EXPECT_NE(srep->GetSkeletalPoint(l, s), clone->GetSkeletalPoint(l, s));
+      EXPECT_SKELETAL_POINT_EQ(srep->GetSkeletalPoint(l, s), clone->GetSkeletalPoint(l, s));
+    }
+  }
+
+  // make sure clones are not related to the original
+  clone->GetSkeletalPoint(2, 1)->GetUpSpoke()->SetRadius(1234);
+  EXPECT_NE(clone->GetSkeletalPoint(2, 1)->GetUpSpoke()->GetRadius(), srep->GetSkeletalPoint(2, 1)->GetUpSpoke()->GetRadius());
+}
+
+TEST(EllipticalSRepTest, CloneSharingSpokes) {
+  const auto srep = vtkEllipticalSRep::SmartCreate(MakeSkeleton(6, 3));
+  const auto clone = srep->SmartCloneSharingSpokes();
+  ASSERT_EQ(srep->GetNumberOfLines(), clone->GetNumberOfLines());
+  ASSERT_EQ(srep->GetNumberOfSteps(), clone->GetNumberOfSteps());
+  for (vtkEllipticalSRep::IndexType l = 0; l < srep->GetNumberOfLines(); ++l) {
+    for (vtkEllipticalSRep::IndexType s = 0; s < srep->GetNumberOfSteps(); ++s) {
+      EXPECT_NE(srep->GetSkeletalPoint(l, s), clone->GetSkeletalPoint(l, s));
+      EXPECT_EQ(srep->GetSkeletalPoint(l, s)->GetUpSpoke(), clone->GetSkeletalPoint(l, s)->GetUpSpoke());
+      EXPECT_EQ(srep->GetSkeletalPoint(l, s)->GetDownSpoke(), clone->GetSkeletalPoint(l, s)->GetDownSpoke());
+      EXPECT_EQ(srep->GetSkeletalPoint(l, s)->GetCrestSpoke(), clone->GetSkeletalPoint(l, s)->GetCrestSpoke());
+    }
+  }
+
+  TestObserver observer;
+  clone->AddObserver(vtkCommand::ModifiedEvent, &observer, &TestObserver::callback);
+  clone->DetachSpokes(vtkSRepSkeletalPoint::UpOrientation);
+  EXPECT_EQ(1u, observer.numCalls());
+  for (vtkEllipticalSRep::IndexType l = 0; l < srep->GetNumberOfLines(); ++l) {
+    for (vtkEllipticalSRep::IndexType s = 0; s < srep->GetNumberOfSteps(); ++s) {
+      EXPECT_NE(srep->GetSkeletalPoint(l, s)->GetUpSpoke(), clone->GetSkeletalPoint(l, s)->GetUpSpoke());
+      EXPECT_EQ(srep->GetSkeletalPoint(l, s)->GetDownSpoke(), clone->GetSkeletalPoint(l, s)->GetDownSpoke());
+      EXPECT_SKELETAL_POINT_EQ(srep->GetSkeletalPoint(l, s), clone->GetSkeletalPoint(l, s));
+    }
+  }
+  // the mesh sees the detached spokes
+  EXPECT_EQ(clone->GetSkeletalPoint(0, 0)->GetUpSpoke(), clone->GetUpSpokes()->At(0));
+
+  // writing to detached spokes doesn't affect the original
+  clone->GetSkeletalPoint(2, 1)->GetUpSpoke()->SetRadius(1234);
+  EXPECT_NE(clone->GetSkeletalPoint(2, 1)->GetUpSpoke()->GetRadius(), srep->GetSkeletalPoint(2, 1)->GetUpSpoke()->GetRadius());
+  EXPECT_EQ(2u, observer.numCalls());
+}
+
+TEST(EllipticalSRepTest, GetSpokeArrays) {
+  const auto srep = vtkEllipticalSRep::SmartCreate(MakeSkeleton(4, 3));
+  EXPECT_EQ(12, srep->GetNumberOfSpokes(vtkSRepSkeletalPoint::UpOrientation));
+  EXPECT_EQ(12, srep->GetNumberOfSpokes(vtkSRepSkeletalPoint::DownOrientation));
+  EXPECT_EQ(4, srep->GetNumberOfSpokes(vtkSRepSkeletalPoint::CrestOrientation));
+
+  const auto up = srep->GetSpokeArrays(vtkSRepSkeletalPoint::UpOrientation);
+  ASSERT_EQ(36u, up.SkeletalPoints.size());
+  ASSERT_EQ(36u, up.Directions.size());
+  ASSERT_EQ(12u, up.Radii.size());
+  for (vtkEllipticalSRep::IndexType l = 0; l < 4; ++l) {
+    for (vtkEllipticalSRep::IndexType s = 0; s < 3; ++s) {
+      const auto i = l * 3 + s;
+      const auto* spoke = srep->GetSkeletalPoint(l, s)->GetUpSpoke();
+      EXPECT_EQ(spoke->GetSkeletalPoint(), srep::Point3d(&up.SkeletalPoints[3 * i]));
+      EXPECT_EQ(spoke->GetDirection().Unit(), srep::Vector3d(&up.Directions[3 * i]));
+      EXPECT_EQ(spoke->GetRadius(), up.Radii[i]);
+    }
+  }
+
+  const auto crest = srep->GetSpokeArrays(vtkSRepSkeletalPoint::CrestOrientation);
+  ASSERT_EQ(4u, crest.Radii.size());
+  for (vtkEllipticalSRep::IndexType l = 0; l < 4; ++l) {
+    const auto* spoke = srep->GetSkeletalPoint(l, 2)->GetCrestSpoke();
+    EXPECT_EQ(spoke->GetSkeletalPoint(), srep::Point3d(&crest.SkeletalPoints[3 * l]));
+    EXPECT_EQ(spoke->GetRadius(), crest.Radii[l]);
+  }
+
+  // zero radius spokes have a zero direction
+  srep->GetSkeletalPoint(1, 1)->GetDownSpoke()->SetDirectionAndMagnitude(srep::Vector3d(0, 0, 0));
+  const auto down = srep->GetSpokeArrays(vtkSRepSkeletalPoint::DownOrientation);
+  EXPECT_EQ(srep::Vector3d(0, 0, 0), srep::Vector3d(&down.Directions[3 * 4]));
+  EXPECT_EQ(0.0, down.Radii[4]);
+
+  const auto empty = vtkSmartPointer<vtkEllipticalSRep>::New();
+  EXPECT_TRUE(empty->GetSpokeArrays(vtkSRepSkeletalPoint::UpOrientation).Radii.empty());
+}
+
+TEST(EllipticalSRepTest, SetSpokeArrays) {
+  const auto srep = vtkEllipticalSRep::SmartCreate(MakeSkeleton(4, 3));
+  TestObserver observer;
+  srep->AddObserver(vtkCommand::ModifiedEvent, &observer, &TestObserver::callback);
+
+  auto arrays = srep->GetSpokeArrays(vtkSRepSkeletalPoint::DownOrientation);
+  for (size_t i = 0; i < arrays.Radii.size(); ++i) {
+    arrays.SkeletalPoints[3 * i + 2] = 5;
+    // directions don't need to be unit
+    arrays.Directions[3 * i] = 2;
+    arrays.Directions[3 * i + 1] = 0;
+    arrays.Directions[3 * i + 2] = 0;
+    arrays.Radii[i] = static_cast<double>(i);
+  }
+  srep->SetSpokeArrays(vtkSRepSkeletalPoint::DownOrientation, arrays);
+  EXPECT_EQ(1u, observer.numCalls());
+
+  for (vtkEllipticalSRep::IndexType l = 0; l < 4; ++l) {
+    for (vtkEllipticalSRep::IndexType s = 0; s < 3; ++s) {
+      const auto i = l * 3 + s;
+      const auto* spoke = srep->GetSkeletalPoint(l, s)->GetDownSpoke();
+      EXPECT_EQ(srep::Point3d(l, s, 5), spoke->GetSkeletalPoint());
+      EXPECT_EQ(srep::Vector3d(i, 0, 0), spoke->GetDirection());
+      // up spokes are untouched
+      EXPECT_EQ(srep::Point3d(l, s, 0), srep->GetSkeletalPoint(l, s)->GetUpSpoke()->GetSkeletalPoint());
+    }
+  }
+
+  // the spoke meshes see the same spokes
+  EXPECT_EQ(srep::Point3d(0, 0, 5), srep->GetDownSpokes()->At(0)->GetSkeletalPoint());
+
+  auto crest = srep->GetSpokeArrays(vtkSRepSkeletalPoint::CrestOrientation);
+  crest.Radii.assign(crest.Radii.size(), 3);
+  srep->SetSpokeArrays(vtkSRepSkeletalPoint::CrestOrientation, crest);
+  EXPECT_EQ(2u, observer.numCalls());
+  EXPECT_DOUBLE_EQ(3, srep->GetSkeletalPoint(2, 2)->GetCrestSpoke()->GetRadius());
+}
+
+TEST(EllipticalSRepTest, SetSpokeArraysInvalid) {
+  const auto srep = vtkEllipticalSRep::SmartCreate(MakeSkeleton(4, 3));
+  TestObserver observer;
+  srep->AddObserver(vtkCommand::ModifiedEvent, &observer, &TestObserver::callback);
+  const auto original = srep->GetSpokeArrays(vtkSRepSkeletalPoint::UpOrientation);
+
+  auto wrongSize = original;
+  wrongSize.Radii.pop_back();
+  EXPECT_THROW(srep->SetSpokeArrays(vtkSRepSkeletalPoint::UpOrientation, wrongSize), std::invalid_argument);
+  EXPECT_THROW(srep->SetSpokeArrays(vtkSRepSkeletalPoint::CrestOrientation, original), std::invalid_argument);
+
+  auto negativeRadius = original;
+  negativeRadius.SkeletalPoints[0] = 100;
+  negativeRadius.Radii.back() = -1;
+  EXPECT_THROW(srep->SetSpokeArrays(vtkSRepSkeletalPoint::UpOrientation, negativeRadius), std::invalid_argument);
+
+  auto nanPoint = original;
+  nanPoint.SkeletalPoints.back() = std::nan("");
+  EXPECT_THROW(srep->SetSpokeArrays(vtkSRepSkeletalPoint::UpOrientation, nanPoint), std::invalid_argument);
+  nanPoint = original;
+  nanPoint.SkeletalPoints[1] = std::nan("");
+  EXPECT_THROW(srep->SetSpokeArrays(vtkSRepSkeletalPoint::UpOrientation, nanPoint), std::invalid_argument);
+
+  // every direction component is checked, even for spokes whose radius means the direction isn't used
+  auto nanDirection = original;
+  nanDirection.Directions.back() = std::nan("");
+  EXPECT_THROW(srep->SetSpokeArrays(vtkSRepSkeletalPoint::UpOrientation, nanDirection), std::invalid_argument);
+  nanDirection = original;
+  nanDirection.Directions[4] = std::nan("");
+  nanDirection.Radii[1] = 0.0;
+  EXPECT_THROW(srep->SetSpokeArrays(vtkSRepSkeletalPoint::UpOrientation, nanDirection), std::invalid_argument);
+
+  auto zeroDirection = original;
+  std::fill(zeroDirection.Directions.begin() + 3, zeroDirection.Directions.begin() + 6, 0.0);
+  EXPECT_THROW(srep->SetSpokeArrays(vtkSRepSkeletalPoint::UpOrientation, zeroDirection), std::invalid_argument);
+
+  // unchanged
+  EXPECT_EQ(0u, observer.numCalls());
+  const auto after = srep->GetSpokeArrays(vtkSRepSkeletalPoint::UpOrientation);
+  EXPECT_EQ(original.SkeletalPoints, after.SkeletalPoints);
+  EXPECT_EQ(original.Directions, after.Directions);
+  EXPECT_EQ(original.Radii, after.Radii);
+}
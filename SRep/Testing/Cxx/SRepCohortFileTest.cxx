@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+#include <vtkEllipticalSRep.h>
+#include <vtkMRMLStorageNode.h>
+#include <vtkNew.h>
+#include <vtkSRepCohortFile.h>
+
+#include "SRepUnitTestHelpers.h"
+
+using namespace srepUnitTestHelpers;
+
+namespace {
+
+class SRepCohortFileTest : public TempFileTest {};
+
+}
+
+TEST_F(SRepCohortFileTest, CreateAppendAndReopen) {
+  const auto path = this->AddTempFile("cohort.srepc");
+  const auto first = MakeSRep(4, 3, 0.5);
+  const auto second = MakeSRep(6, 2, 1.5);
+  {
+    vtkNew<vtkSRepCohortFile> cohort;
+    ASSERT_TRUE(cohort->Create(path));
+    EXPECT_TRUE(cohort->IsOpen());
+    EXPECT_EQ(0, cohort->GetNumberOfSReps());
+    ASSERT_TRUE(cohort->AppendSRep("first", *first));
+    cohort->SetCoordinateSystemWrite(vtkMRMLStorageNode::CoordinateSystemRAS);
+    ASSERT_TRUE(cohort->AppendSRep("second", *second));
+    EXPECT_EQ(2, cohort->GetNumberOfSReps());
+    ExpectSRepEqual(first, cohort->ReadSRep("first"));
+    ExpectSRepEqual(second, cohort->ReadSRep("second"));
+  }
+
+  vtkNew<vtkSRepCohortFile> cohort;
+  ASSERT_TRUE(cohort->Open(path));
+  EXPECT_EQ((std::vector<std::string>{"first", "second"}), cohort->GetSRepNames());
+  EXPECT_TRUE(cohort->HasSRep("second"));
+  EXPECT_FALSE(cohort->HasSRep("third"));
+  ExpectSRepEqual(second, cohort->ReadSRep("second"));
+  ExpectSRepEqual(first, cohort->ReadSRep("first"));
+  EXPECT_EQ(nullptr, cohort->ReadSRep("third"));
+
+  // appending after reopening keeps what was there
+  const auto third = MakeSRep(3, 3, 2.5);
+  ASSERT_TRUE(cohort->AppendSRep("third", *third));
+  cohort->Close();
+  EXPECT_FALSE(cohort->IsOpen());
+  ASSERT_TRUE(cohort->Open(path));
+  EXPECT_EQ((std::vector<std::string>{"first", "second", "third"}), cohort->GetSRepNames());
+  ExpectSRepEqual(first, cohort->ReadSRep("first"));
+  ExpectSRepEqual(second, cohort->ReadSRep("second"));
+  ExpectSRepEqual(third, cohort->ReadSRep("third"));
+}
+
+TEST_F(SRepCohortFileTest, RandomAccess) {
+  const auto path = this->AddTempFile("many.srepc");
+  std::vector<std::pair<std::string, vtkSmartPointer<vtkEllipticalSRep>>> sreps;
+  for (int i = 0; i < 50; ++i) {
+    sreps.emplace_back("subject" + std::to_string(i), MakeSRep(4 + i % 3, 2 + i % 4, i / 10.0));
+  }
+  {
+    vtkNew<vtkSRepCohortFile> cohort;
+    ASSERT_TRUE(cohort->Create(path));
+    ASSERT_TRUE(cohort->AppendSReps(std::vector<std::pair<std::string, vtkSmartPointer<vtkEllipticalSRep>>>(sreps.begin(), sreps.begin() + 20)));
+    for (auto it = sreps.begin() + 20; it != sreps.end(); ++it) {
+      ASSERT_TRUE(cohort->AppendSRep(it->first, *it->second));
+    }
+  }
+
+  vtkNew<vtkSRepCohortFile> cohort;
+  ASSERT_TRUE(cohort->Open(path));
+  ASSERT_EQ(50, cohort->GetNumberOfSReps());
+  for (const int i : {37, 0, 49, 12, 20}) {
+    ExpectSRepEqual(sreps[i].second, cohort->ReadSRep(sreps[i].first));
+  }
+}
+
+TEST_F(SRepCohortFileTest, BadAppendsChangeNothing) {
+  const auto path = this->AddTempFile("bad.srepc");
+  vtkNew<vtkSRepCohortFile> cohort;
+  EXPECT_FALSE(cohort->AppendSRep("closed", *MakeSRep(2, 2, 0)));
+  ASSERT_TRUE(cohort->Create(path));
+  ASSERT_TRUE(cohort->AppendSRep("a", *MakeSRep(2, 2, 0)));
+
+  EXPECT_FALSE(cohort->AppendSRep("a", *MakeSRep(2, 2, 1)));
+  EXPECT_FALSE(cohort->AppendSRep("", *MakeSRep(2, 2, 1)));
+  EXPECT_FALSE(cohort->AppendSReps({{"b", MakeSRep(2, 2, 1)}, {"b", MakeSRep(2, 2, 2)}}));
+  EXPECT_FALSE(cohort->AppendSReps({{"c", MakeSRep(2, 2, 1)}, {"d", nullptr}}));
+  EXPECT_EQ(1, cohort->GetNumberOfSReps());
+
+  ASSERT_TRUE(cohort->Open(path));
+  EXPECT_EQ((std::vector<std::string>{"a"}), cohort->GetSRepNames());
+}
+
+TEST_F(SRepCohortFileTest, InterruptedAppendKeepsOldContents) {
+  const auto path = this->AddTempFile("interrupted.srepc");
+  const auto first = MakeSRep(4, 3, 0.5);
+  vtkNew<vtkSRepCohortFile> cohort;
+  ASSERT_TRUE(cohort->Create(path));
+  ASSERT_TRUE(cohort->AppendSRep("first", *first));
+  std::string oldHeader;
+  {
+    std::ifstream in(path, std::ios::binary);
+    oldHeader.assign(32, '\0');
+    in.read(&oldHeader[0], 32);
+  }
+  ASSERT_TRUE(cohort->AppendSReps({{"second", MakeSRep(6, 2, 1.5)}, {"third", MakeSRep(3, 3, 2.5)}}));
+  cohort->Close();
+
+  // an append interrupted just before the header is rewritten leaves everything but the header written
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.write(oldHeader.data(), oldHeader.size());
+  }
+  ASSERT_TRUE(cohort->Open(path));
+  EXPECT_EQ((std::vector<std::string>{"first"}), cohort->GetSRepNames());
+  ExpectSRepEqual(first, cohort->ReadSRep("first"));
+
+  // and the next append still works
+  const auto fourth = MakeSRep(5, 2, 3.5);
+  ASSERT_TRUE(cohort->AppendSRep("fourth", *fourth));
+  ASSERT_TRUE(cohort->Open(path));
+  EXPECT_EQ((std::vector<std::string>{"first", "fourth"}), cohort->GetSRepNames());
+  ExpectSRepEqual(first, cohort->ReadSRep("first"));
+  ExpectSRepEqual(fourth, cohort->ReadSRep("fourth"));
+}
+
+TEST_F(SRepCohortFileTest, CorruptFilesFailToOpen) {
+  const auto path = this->AddTempFile("corrupt.srepc");
+  {
+    vtkNew<vtkSRepCohortFile> cohort;
+    ASSERT_TRUE(cohort->Create(path));
+    ASSERT_TRUE(cohort->AppendSRep("a", *MakeSRep(3, 3, 0)));
+    ASSERT_TRUE(cohort->AppendSRep("b", *MakeSRep(3, 3, 1)));
+  }
+  std::string contents;
+  {
+    std::ifstream in(path, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+
+  const auto writeAndOpen = [&path](const std::string& data) {
+    {
+      std::ofstream out(path, std::ios::binary | std::ios::trunc);
+      out << data;
+    }
+    vtkNew<vtkSRepCohortFile> cohort;
+    const bool opened = cohort->Open(path);
+    EXPECT_EQ(opened, cohort->IsOpen());
+    return opened;
+  };
+
+  EXPECT_TRUE(writeAndOpen(contents));
+  EXPECT_FALSE(writeAndOpen(contents.substr(0, contents.size() - 1)));
+  EXPECT_FALSE(writeAndOpen(contents.substr(0, 20)));
+  EXPECT_FALSE(writeAndOpen("SREPBIN" + contents.substr(7)));
+  // first srep reaching into the table of contents
+  std::string oversized = contents;
+  const auto tableOfContents = static_cast<unsigned char>(oversized[16]) | (static_cast<unsigned char>(oversized[17]) << 8);
+  oversized[tableOfContents + 12] = 1;
+  EXPECT_FALSE(writeAndOpen(oversized));
+  EXPECT_FALSE(writeAndOpen(""));
+}
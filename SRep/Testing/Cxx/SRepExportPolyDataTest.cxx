@@ -0,0 +1,275 @@
+#include <gtest/gtest.h>
+#include <SRepInterpolation.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkIdList.h>
+#include <vtkIntArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSlicerSRepLogic.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "SRepUnitTestHelpers.h"
+
+using namespace srepUnitTestHelpers;
+
+namespace {
+
+using IndexType = vtkMeshSRepInterface::IndexType;
+using Properties = vtkSRepExportPolyDataProperties;
+
+struct SpokeIds {
+  vtkIdType boundaryId;
+  vtkIdType skeletonId;
+};
+
+/// The original one point and one line at a time exporter, kept as the reference for the
+/// output of vtkSlicerSRepLogic::SmartExportSRepToPolyData.
+vtkSmartPointer<vtkPolyData> ReferenceExport(const vtkMeshSRepInterface& srep, const Properties& properties) {
+  auto polyData = vtkSmartPointer<vtkPolyData>::New();
+  vtkNew<vtkPoints> points;
+  polyData->SetPoints(points);
+  vtkNew<vtkCellArray> lines;
+  polyData->SetLines(lines);
+
+  auto srepArray = properties.GetSRepDataArray();
+  vtkSmartPointer<vtkDataArray> pointDataArray;
+  vtkSmartPointer<vtkDataArray> lineDataArray;
+  if (srepArray) {
+    pointDataArray = vtkSmartPointer<vtkDataArray>::Take(srepArray->NewInstance());
+    pointDataArray->SetNumberOfComponents(srepArray->GetNumberOfComponents());
+    pointDataArray->SetName(properties.GetPointTypeArrayName().c_str());
+    polyData->GetPointData()->SetScalars(pointDataArray);
+
+    lineDataArray = vtkSmartPointer<vtkDataArray>::Take(srepArray->NewInstance());
+    lineDataArray->SetNumberOfComponents(srepArray->GetNumberOfComponents());
+    lineDataArray->SetName(properties.GetLineTypeArrayName().c_str());
+    polyData->GetCellData()->SetScalars(lineDataArray);
+  }
+
+  const auto insertNextPoint = [&](const srep::Point3d& point, int pointType) {
+    const auto id = points->InsertNextPoint(point.AsArray().data());
+    if (srepArray) {
+      pointDataArray->InsertNextTuple(pointType, srepArray);
+    }
+    return id;
+  };
+  const auto insertNextLine = [&](vtkIdType start, vtkIdType end, int lineType) {
+    lines->InsertNextCell(2);
+    lines->InsertCellPoint(start);
+    lines->InsertCellPoint(end);
+    if (srepArray) {
+      lineDataArray->InsertNextTuple(lineType, srepArray);
+    }
+  };
+
+  const auto addSpokeMesh = [&](
+    const vtkSRepSpokeMesh& mesh,
+    int skeletonPointType,
+    int boundaryPointType,
+    bool addSpokes,
+    int spokeType,
+    bool addConnections,
+    int connectionType,
+    const std::vector<IndexType>& spine,
+    const std::function<bool(IndexType)>& forceAddSkeletalPoint)
+  {
+    std::vector<SpokeIds> ids(mesh.GetNumberOfSpokes());
+    for (IndexType i = 0; i < mesh.GetNumberOfSpokes(); ++i) {
+      const bool isSpine = std::find(spine.begin(), spine.end(), i) != spine.end();
+      ids[i].skeletonId = (addSpokes || addConnections || isSpine || forceAddSkeletalPoint(i))
+        ? insertNextPoint(mesh[i]->GetSkeletalPoint(), skeletonPointType)
+        : -1;
+      ids[i].boundaryId = -1;
+      if (addSpokes) {
+        ids[i].boundaryId = insertNextPoint(mesh[i]->GetBoundaryPoint(), boundaryPointType);
+        insertNextLine(ids[i].skeletonId, ids[i].boundaryId, spokeType);
+      }
+    }
+
+    std::set<std::pair<vtkIdType, vtkIdType>> spineConnections;
+    for (size_t i = 1; i < spine.size(); ++i) {
+      spineConnections.insert(std::minmax(ids[spine[i - 1]].skeletonId, ids[spine[i]].skeletonId));
+    }
+    for (const auto& connection : spineConnections) {
+      insertNextLine(connection.first, connection.second, Properties::SpineLineType);
+    }
+
+    if (addConnections) {
+      std::set<std::pair<vtkIdType, vtkIdType>> connections;
+      for (IndexType i = 0; i < mesh.GetNumberOfSpokes(); ++i) {
+        for (const auto neighbor : mesh.GetNeighbors(i)) {
+          connections.insert(std::minmax(ids[i].skeletonId, ids[neighbor].skeletonId));
+        }
+      }
+      std::set<std::pair<vtkIdType, vtkIdType>> spinelessConnections;
+      std::set_difference(
+        connections.begin(), connections.end(),
+        spineConnections.begin(), spineConnections.end(),
+        std::inserter(spinelessConnections, spinelessConnections.begin()));
+      for (const auto& connection : spinelessConnections) {
+        insertNextLine(connection.first, connection.second, connectionType);
+      }
+    }
+    return ids;
+  };
+
+  const auto noSpine = std::vector<IndexType>{};
+  const auto isCrestConnected = [&](const std::vector<IndexType>& crestConnections, IndexType i) {
+    return properties.GetIncludeSkeletonToCrestConnection()
+      && std::find(crestConnections.begin(), crestConnections.end(), i) != crestConnections.end();
+  };
+
+  const auto upIds = addSpokeMesh(
+    *srep.GetUpSpokes(),
+    Properties::UpSkeletalPointType, Properties::UpBoundaryPointType,
+    properties.GetIncludeUpSpokes(), Properties::UpSpokeLineType,
+    properties.GetIncludeSkeletalSheet(), Properties::SkeletalSheetLineType,
+    properties.GetIncludeSpine() ? srep.GetUpSpine() : noSpine,
+    [&](IndexType i) { return isCrestConnected(srep.GetCrestToUpSpokeConnections(), i); });
+
+  const auto downIds = addSpokeMesh(
+    *srep.GetDownSpokes(),
+    Properties::DownSkeletalPointType, Properties::DownBoundaryPointType,
+    properties.GetIncludeDownSpokes(), Properties::DownSpokeLineType,
+    properties.GetIncludeSkeletalSheet(), Properties::SkeletalSheetLineType,
+    properties.GetIncludeSpine() ? srep.GetDownSpine() : noSpine,
+    [&](IndexType i) { return isCrestConnected(srep.GetCrestToDownSpokeConnections(), i); });
+
+  const auto crestIds = addSpokeMesh(
+    *srep.GetCrestSpokes(),
+    Properties::CrestSkeletalPointType, Properties::CrestBoundaryPointType,
+    properties.GetIncludeCrestSpokes(), Properties::CrestSpokeLineType,
+    properties.GetIncludeCrestCurve(), Properties::CrestCurveLineType,
+    noSpine,
+    [&](IndexType) { return properties.GetIncludeSkeletonToCrestConnection(); });
+
+  if (properties.GetIncludeSkeletonToCrestConnection()) {
+    const auto& toUp = srep.GetCrestToUpSpokeConnections();
+    for (size_t crestIndex = 0; crestIndex < toUp.size(); ++crestIndex) {
+      insertNextLine(crestIds[crestIndex].skeletonId, upIds[toUp[crestIndex]].skeletonId,
+        Properties::SkeletonToCrestConnectionLineType);
+    }
+    const auto& toDown = srep.GetCrestToDownSpokeConnections();
+    for (size_t crestIndex = 0; crestIndex < toDown.size(); ++crestIndex) {
+      insertNextLine(crestIds[crestIndex].skeletonId, downIds[toDown[crestIndex]].skeletonId,
+        Properties::SkeletonToCrestConnectionLineType);
+    }
+  }
+
+  return polyData;
+}
+
+void ExpectArrayEqual(vtkDataArray* expected, vtkDataArray* actual) {
+  ASSERT_EQ(expected == nullptr, actual == nullptr);
+  if (!expected) {
+    return;
+  }
+  EXPECT_EQ(std::string(expected->GetName()), std::string(actual->GetName()));
+  ASSERT_EQ(expected->GetNumberOfComponents(), actual->GetNumberOfComponents());
+  ASSERT_EQ(expected->GetNumberOfTuples(), actual->GetNumberOfTuples());
+  for (vtkIdType t = 0; t < expected->GetNumberOfTuples(); ++t) {
+    for (int c = 0; c < expected->GetNumberOfComponents(); ++c) {
+      EXPECT_EQ(expected->GetComponent(t, c), actual->GetComponent(t, c)) << "tuple " << t;
+    }
+  }
+}
+
+/// Same points in the same order, same lines in the same order, and the same type arrays.
+void ExpectPolyDataEqual(vtkPolyData* expected, vtkPolyData* actual) {
+  ASSERT_NE(nullptr, expected);
+  ASSERT_NE(nullptr, actual);
+
+  ASSERT_EQ(expected->GetNumberOfPoints(), actual->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < expected->GetNumberOfPoints(); ++i) {
+    double e[3];
+    double a[3];
+    expected->GetPoint(i, e);
+    actual->GetPoint(i, a);
+    EXPECT_EQ(e[0], a[0]) << "point " << i;
+    EXPECT_EQ(e[1], a[1]) << "point " << i;
+    EXPECT_EQ(e[2], a[2]) << "point " << i;
+  }
+
+  ASSERT_EQ(expected->GetNumberOfLines(), actual->GetNumberOfLines());
+  vtkNew<vtkIdList> expectedIds;
+  vtkNew<vtkIdList> actualIds;
+  for (vtkIdType i = 0; i < expected->GetNumberOfLines(); ++i) {
+    expected->GetLines()->GetCellAtId(i, expectedIds);
+    actual->GetLines()->GetCellAtId(i, actualIds);
+    ASSERT_EQ(2, expectedIds->GetNumberOfIds());
+    ASSERT_EQ(2, actualIds->GetNumberOfIds());
+    EXPECT_EQ(expectedIds->GetId(0), actualIds->GetId(0)) << "line " << i;
+    EXPECT_EQ(expectedIds->GetId(1), actualIds->GetId(1)) << "line " << i;
+  }
+
+  ExpectArrayEqual(expected->GetPointData()->GetScalars(), actual->GetPointData()->GetScalars());
+  ExpectArrayEqual(expected->GetCellData()->GetScalars(), actual->GetCellData()->GetScalars());
+}
+
+} // namespace
+
+TEST(SRepExportPolyData, MatchesReferenceExport) {
+  vtkNew<vtkSlicerSRepLogic> logic;
+  vtkNew<vtkIntArray> types;
+  types->SetNumberOfComponents(1);
+  types->SetNumberOfTuples(Properties::NumberOfTypes);
+  for (int i = 0; i < Properties::NumberOfTypes; ++i) {
+    types->SetValue(i, 100 + i);
+  }
+
+  const auto srep = MakeEllipsoidSRep(8, 4);
+  for (const auto& toExport : {srep, sreplogic::SmartInterpolateSRep(1, *srep)}) {
+    // every combination of the include flags, with and without the type arrays
+    for (int mask = 0; mask < 256; ++mask) {
+      SCOPED_TRACE("mask " + std::to_string(mask));
+      vtkNew<Properties> properties;
+      properties->SetIncludeUpSpokes(mask & 1);
+      properties->SetIncludeDownSpokes(mask & 2);
+      properties->SetIncludeCrestSpokes(mask & 4);
+      properties->SetIncludeCrestCurve(mask & 8);
+      properties->SetIncludeSkeletalSheet(mask & 16);
+      properties->SetIncludeSkeletonToCrestConnection(mask & 32);
+      properties->SetIncludeSpine(mask & 64);
+      properties->SetSRepDataArray((mask & 128) ? types.GetPointer() : nullptr);
+
+      const auto expected = ReferenceExport(*toExport, *properties);
+      const auto actual = logic->SmartExportSRepToPolyData(*toExport, *properties);
+      ExpectPolyDataEqual(expected, actual);
+    }
+  }
+}
+
+TEST(SRepExportPolyData, FullExportCounts) {
+  vtkNew<vtkSlicerSRepLogic> logic;
+  const auto srep = MakeEllipsoidSRep(8, 4);
+  vtkNew<Properties> properties;
+  properties->SetIncludeUpSpokes(true);
+  properties->SetIncludeDownSpokes(true);
+  properties->SetIncludeCrestSpokes(true);
+  properties->SetIncludeCrestCurve(true);
+  properties->SetIncludeSkeletalSheet(true);
+  properties->SetIncludeSkeletonToCrestConnection(true);
+  properties->SetIncludeSpine(true);
+
+  const auto polyData = logic->SmartExportSRepToPolyData(*srep, *properties);
+  ASSERT_NE(nullptr, polyData);
+  // a skeletal and a boundary point for each spoke. Lines that meet at the spine share spokes there.
+  const auto numberOfSpokes = srep->GetUpSpokes()->GetNumberOfSpokes()
+    + srep->GetDownSpokes()->GetNumberOfSpokes()
+    + srep->GetCrestSpokes()->GetNumberOfSpokes();
+  EXPECT_EQ(29 + 29 + 8, numberOfSpokes);
+  EXPECT_EQ(2 * numberOfSpokes, polyData->GetNumberOfPoints());
+  // at least one line per spoke, plus the connections between them
+  EXPECT_GT(polyData->GetNumberOfLines(), numberOfSpokes);
+  EXPECT_EQ(nullptr, polyData->GetPointData()->GetScalars());
+}
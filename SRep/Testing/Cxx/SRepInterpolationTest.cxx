@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+#include <SRepInterpolation.h>
+
+#include <cmath>
+#include <stdexcept>
+
+#include "SRepUnitTestHelpers.h"
+
+using namespace srepUnitTestHelpers;
+using sreplogic::SRepEvaluator;
+
+namespace {
+
+using SpokeType = SRepEvaluator::SpokeType;
+constexpr double Tolerance = 1e-9;
+
+#define EXPECT_POINT3D_NEAR(P1, P2, TOL) \
+  do { \
+    EXPECT_NEAR((P1).GetX(), (P2).GetX(), TOL); \
+    EXPECT_NEAR((P1).GetY(), (P2).GetY(), TOL); \
+    EXPECT_NEAR((P1).GetZ(), (P2).GetZ(), TOL); \
+  } while(false)
+
+double Distance(const srep::Point3d& a, const srep::Point3d& b) {
+  return srep::Vector3d(a, b).GetLength();
+}
+
+double Distance(const srep::Vector3d& a, const srep::Vector3d& b) {
+  return (a - b).GetLength();
+}
+
+void ExpectSpokeNear(const vtkSRepSpoke* expected, const SRepEvaluator::SpokeValue& actual, double tolerance) {
+  ASSERT_NE(nullptr, expected);
+  EXPECT_POINT3D_NEAR(expected->GetSkeletalPoint(), actual.skeletalPoint, tolerance);
+  EXPECT_POINT3D_NEAR(expected->GetDirection(), actual.direction, tolerance);
+}
+
+void ExpectSpokeNear(const vtkSRepSpoke* expected, const vtkSRepSpoke* actual, double tolerance) {
+  ASSERT_NE(nullptr, expected);
+  ASSERT_NE(nullptr, actual);
+  EXPECT_POINT3D_NEAR(expected->GetSkeletalPoint(), actual->GetSkeletalPoint(), tolerance);
+  EXPECT_POINT3D_NEAR(expected->GetDirection(), actual->GetDirection(), tolerance);
+}
+
+/// Walks the evaluator along the given line (or around the given step, if alongLine is false) in
+/// increments much smaller than a cell of the max subdivision level, and checks that no increment
+/// jumps by more than maxJump.
+void ExpectContinuous(
+  const SRepEvaluator& evaluator,
+  double fixed,
+  bool alongLine,
+  double begin,
+  double end,
+  SpokeType spokeType,
+  double maxJump)
+{
+  const int incrementsPerUnit = 2000;
+  const int increments = static_cast<int>((end - begin) * incrementsPerUnit);
+  auto evaluate = [&](double t) {
+    return alongLine ? evaluator.EvaluateSpoke(fixed, t, spokeType) : evaluator.EvaluateSpoke(t, fixed, spokeType);
+  };
+  auto previous = evaluate(begin);
+  for (int i = 1; i <= increments; ++i) {
+    const double t = begin + (end - begin) * i / increments;
+    const auto current = evaluate(t);
+    EXPECT_LT(Distance(previous.skeletalPoint, current.skeletalPoint), maxJump) << "at " << t;
+    EXPECT_LT(Distance(previous.direction, current.direction), maxJump) << "at " << t;
+    previous = current;
+  }
+}
+
+} // namespace
+
+TEST(SRepInterpolation, InterpolateKeepsOriginalSpokes) {
+  const auto srep = MakeEllipsoidSRep(8, 4);
+  for (size_t level = 1; level <= 3; ++level) {
+    const auto interpolated = sreplogic::SmartInterpolateSRep(level, *srep);
+    const auto density = static_cast<vtkEllipticalSRep::IndexType>(1) << level;
+    ASSERT_EQ(srep->GetNumberOfLines() * density, interpolated->GetNumberOfLines());
+    ASSERT_EQ((srep->GetNumberOfSteps() - 1) * density + 1, interpolated->GetNumberOfSteps());
+
+    for (vtkEllipticalSRep::IndexType l = 0; l < srep->GetNumberOfLines(); ++l) {
+      for (vtkEllipticalSRep::IndexType s = 0; s < srep->GetNumberOfSteps(); ++s) {
+        const auto* original = srep->GetSkeletalPoint(l, s);
+        const auto* node = interpolated->GetSkeletalPoint(l * density, s * density);
+        ExpectSpokeNear(original->GetUpSpoke(), node->GetUpSpoke(), Tolerance);
+        ExpectSpokeNear(original->GetDownSpoke(), node->GetDownSpoke(), Tolerance);
+        ASSERT_EQ(original->IsCrest(), node->IsCrest());
+        if (original->IsCrest()) {
+          ExpectSpokeNear(original->GetCrestSpoke(), node->GetCrestSpoke(), Tolerance);
+        }
+      }
+    }
+  }
+}
+
+TEST(SRepEvaluator, Basic) {
+  const auto srep = MakeEllipsoidSRep(8, 4);
+  const SRepEvaluator evaluator(*srep, 3);
+  EXPECT_EQ(8, evaluator.GetNumberOfLines());
+  EXPECT_EQ(4, evaluator.GetNumberOfSteps());
+  EXPECT_EQ(3u, evaluator.GetMaxSubdivisionLevel());
+  EXPECT_FALSE(evaluator.IsCrestStep(0));
+  EXPECT_FALSE(evaluator.IsCrestStep(2.5));
+  EXPECT_TRUE(evaluator.IsCrestStep(3));
+}
+
+TEST(SRepEvaluator, Invalid) {
+  const auto empty = vtkSmartPointer<vtkEllipticalSRep>::New();
+  EXPECT_THROW(SRepEvaluator{*empty}, std::invalid_argument);
+  EXPECT_THROW(SRepEvaluator{*MakeEllipsoidSRep(8, 1)}, std::invalid_argument);
+
+  const SRepEvaluator evaluator(*MakeEllipsoidSRep(8, 4));
+  EXPECT_THROW(evaluator.EvaluateSpoke(0, -0.1, SpokeType::UpOrientation), std::out_of_range);
+  EXPECT_THROW(evaluator.EvaluateSpoke(0, 3.1, SpokeType::DownOrientation), std::out_of_range);
+  EXPECT_THROW(evaluator.EvaluateSpoke(0, 2.5, SpokeType::CrestOrientation), std::invalid_argument);
+  EXPECT_THROW(evaluator.EvaluateSpoke(std::nan(""), 1, SpokeType::UpOrientation), std::invalid_argument);
+  EXPECT_THROW(evaluator.SmartEvaluateSkeletalPoint(0, 4), std::out_of_range);
+  EXPECT_THROW(evaluator.SmartSample(0, 4), std::invalid_argument);
+  EXPECT_THROW(evaluator.SmartSample(8, 1), std::invalid_argument);
+}
+
+TEST(SRepEvaluator, GridNodesMatchStoredSpokes) {
+  const auto srep = MakeSRep(6, 4);
+  const SRepEvaluator evaluator(*srep);
+  for (vtkEllipticalSRep::IndexType l = 0; l < srep->GetNumberOfLines(); ++l) {
+    for (vtkEllipticalSRep::IndexType s = 0; s < srep->GetNumberOfSteps(); ++s) {
+      const auto* original = srep->GetSkeletalPoint(l, s);
+      ExpectSpokeNear(original->GetUpSpoke(), evaluator.EvaluateSpoke(l, s, SpokeType::UpOrientation), Tolerance);
+      ExpectSpokeNear(original->GetDownSpoke(), evaluator.EvaluateSpoke(l, s, SpokeType::DownOrientation), Tolerance);
+      if (original->IsCrest()) {
+        ExpectSpokeNear(original->GetCrestSpoke(), evaluator.EvaluateSpoke(l, s, SpokeType::CrestOrientation), Tolerance);
+      }
+    }
+  }
+}
+
+TEST(SRepEvaluator, LinesWrapAround) {
+  const auto srep = MakeSRep(6, 4);
+  const SRepEvaluator evaluator(*srep);
+  for (const double step : {0.0, 1.5, 3.0}) {
+    const auto a = evaluator.EvaluateSpoke(1.25, step, SpokeType::UpOrientation);
+    const auto b = evaluator.EvaluateSpoke(1.25 + 6, step, SpokeType::UpOrientation);
+    const auto c = evaluator.EvaluateSpoke(1.25 - 6, step, SpokeType::UpOrientation);
+    EXPECT_POINT3D_NEAR(a.skeletalPoint, b.skeletalPoint, Tolerance);
+    EXPECT_POINT3D_NEAR(a.direction, b.direction, Tolerance);
+    EXPECT_POINT3D_NEAR(a.skeletalPoint, c.skeletalPoint, Tolerance);
+    EXPECT_POINT3D_NEAR(a.direction, c.direction, Tolerance);
+  }
+}
+
+TEST(SRepEvaluator, MatchesInterpolateSRep) {
+  const auto srep = MakeEllipsoidSRep(8, 4);
+  const size_t level = 2;
+  const auto interpolated = sreplogic::SmartInterpolateSRep(level, *srep);
+  const SRepEvaluator evaluator(*srep, level);
+  const double density = 1 << level;
+  for (vtkEllipticalSRep::IndexType l = 0; l < interpolated->GetNumberOfLines(); ++l) {
+    for (vtkEllipticalSRep::IndexType s = 0; s < interpolated->GetNumberOfSteps(); ++s) {
+      const auto* expected = interpolated->GetSkeletalPoint(l, s);
+      ExpectSpokeNear(expected->GetUpSpoke(), evaluator.EvaluateSpoke(l / density, s / density, SpokeType::UpOrientation), 1e-6);
+      ExpectSpokeNear(expected->GetDownSpoke(), evaluator.EvaluateSpoke(l / density, s / density, SpokeType::DownOrientation), 1e-6);
+    }
+  }
+}
+
+TEST(SRepEvaluator, InterpolatedSpokesAreContinuous) {
+  const auto srep = MakeEllipsoidSRep(8, 4);
+  const SRepEvaluator evaluator(*srep);
+
+  // Neighboring original spokes differ by less than 1, so an increment of 1/2000 of a quad
+  // moving anything by more than 0.01 is a jump, not a smooth change.
+  const double maxJump = 0.01;
+  for (const auto spokeType : {SpokeType::UpOrientation, SpokeType::DownOrientation}) {
+    // along steps, over every quad boundary from the spine to the crest
+    for (const double line : {0.0, 1.0, 2.5, 7.75}) {
+      ExpectContinuous(evaluator, line, true, 0.0, 3.0, spokeType, maxJump);
+    }
+    // around every line, including the wrap from the last line back to the first
+    for (const double step : {0.0, 1.0, 1.5, 3.0}) {
+      ExpectContinuous(evaluator, step, false, 0.0, 8.0, spokeType, maxJump);
+    }
+  }
+  ExpectContinuous(evaluator, 3.0, false, 0.0, 8.0, SpokeType::CrestOrientation, maxJump);
+}
+
+TEST(SRepEvaluator, EvaluateSkeletalPoint) {
+  const auto srep = MakeEllipsoidSRep(8, 4);
+  const SRepEvaluator evaluator(*srep);
+
+  const auto inside = evaluator.SmartEvaluateSkeletalPoint(2.5, 1.5);
+  ASSERT_NE(nullptr, inside);
+  EXPECT_FALSE(inside->IsCrest());
+  ExpectSpokeNear(inside->GetUpSpoke(), evaluator.EvaluateSpoke(2.5, 1.5, SpokeType::UpOrientation), Tolerance);
+  ExpectSpokeNear(inside->GetDownSpoke(), evaluator.EvaluateSpoke(2.5, 1.5, SpokeType::DownOrientation), Tolerance);
+
+  const auto crest = evaluator.SmartEvaluateSkeletalPoint(2.5, 3);
+  ASSERT_NE(nullptr, crest);
+  ASSERT_TRUE(crest->IsCrest());
+  ExpectSpokeNear(crest->GetCrestSpoke(), evaluator.EvaluateSpoke(2.5, 3, SpokeType::CrestOrientation), Tolerance);
+}
+
+TEST(SRepEvaluator, EvaluateSpokesMatchesEvaluateSpoke) {
+  const auto srep = MakeEllipsoidSRep(8, 4);
+  const SRepEvaluator evaluator(*srep);
+  const std::vector<SRepEvaluator::Location> locations{{0, 0}, {0.3, 0.7}, {7.9, 2.2}, {4, 3}};
+  const auto spokes = evaluator.EvaluateSpokes(locations, SpokeType::UpOrientation);
+  ASSERT_EQ(locations.size(), spokes.size());
+  for (size_t i = 0; i < locations.size(); ++i) {
+    const auto expected = evaluator.EvaluateSpoke(locations[i].line, locations[i].step, SpokeType::UpOrientation);
+    EXPECT_POINT3D_NEAR(expected.skeletalPoint, spokes[i].skeletalPoint, Tolerance);
+    EXPECT_POINT3D_NEAR(expected.direction, spokes[i].direction, Tolerance);
+  }
+}
+
+TEST(SRepEvaluator, SampleAtOriginalSizeReproducesSRep) {
+  const auto srep = MakeEllipsoidSRep(8, 4);
+  const SRepEvaluator evaluator(*srep);
+  const auto sampled = evaluator.SmartSample(8, 4);
+  ASSERT_NE(nullptr, sampled);
+  ASSERT_EQ(8, sampled->GetNumberOfLines());
+  ASSERT_EQ(4, sampled->GetNumberOfSteps());
+  for (vtkEllipticalSRep::IndexType l = 0; l < srep->GetNumberOfLines(); ++l) {
+    for (vtkEllipticalSRep::IndexType s = 0; s < srep->GetNumberOfSteps(); ++s) {
+      const auto* original = srep->GetSkeletalPoint(l, s);
+      const auto* sample = sampled->GetSkeletalPoint(l, s);
+      ExpectSpokeNear(original->GetUpSpoke(), sample->GetUpSpoke(), Tolerance);
+      ExpectSpokeNear(original->GetDownSpoke(), sample->GetDownSpoke(), Tolerance);
+      ASSERT_EQ(original->IsCrest(), sample->IsCrest());
+      if (original->IsCrest()) {
+        ExpectSpokeNear(original->GetCrestSpoke(), sample->GetCrestSpoke(), Tolerance);
+      }
+    }
+  }
+
+  const auto denser = evaluator.SmartSample(12, 7);
+  ASSERT_NE(nullptr, denser);
+  EXPECT_EQ(12, denser->GetNumberOfLines());
+  EXPECT_EQ(7, denser->GetNumberOfSteps());
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include <SRepInterpolation.h>
+#include <SRepLegality.h>
+#include <vtkMRMLEllipticalSRepNode.h>
+#include <vtkNew.h>
+#include <vtkSlicerSRepLogic.h>
+
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+#include "SRepUnitTestHelpers.h"
+
+using namespace srepUnitTestHelpers;
+using sreplogic::CheckSRepLegality;
+using sreplogic::SRepLegalityReport;
+
+namespace {
+
+constexpr double CrossingTolerance = 1e-6;
+
+/// \returns the crossing between spokes a and b in the report, nullptr if there isn't one.
+const SRepLegalityReport::SpokeCrossing* FindCrossing(
+  const vtkEllipticalSRep& srep,
+  const SRepLegalityReport& report,
+  const vtkSRepSpoke* a,
+  const vtkSRepSpoke* b)
+{
+  const std::array<const vtkSRepSpokeMesh*, 3> meshes{srep.GetUpSpokes(), srep.GetDownSpokes(), srep.GetCrestSpokes()};
+  for (const auto& crossing : report.crossings) {
+    const auto* first = meshes[crossing.first.Orientation]->At(crossing.first.Index);
+    const auto* second = meshes[crossing.second.Orientation]->At(crossing.second.Index);
+    if ((first == a && second == b) || (first == b && second == a)) {
+      return &crossing;
+    }
+  }
+  return nullptr;
+}
+
+/// Points every up spoke at focalPoint, fraction of the way there.
+void PointUpSpokesAt(vtkEllipticalSRep& srep, const srep::Point3d& focalPoint, double fraction) {
+  for (vtkEllipticalSRep::IndexType l = 0; l < srep.GetNumberOfLines(); ++l) {
+    for (vtkEllipticalSRep::IndexType s = 0; s < srep.GetNumberOfSteps(); ++s) {
+      auto* spoke = srep.GetSkeletalPoint(l, s)->GetUpSpoke();
+      spoke->SetDirectionAndMagnitude(srep::Vector3d(spoke->GetSkeletalPoint(), focalPoint) * fraction);
+    }
+  }
+}
+
+} // namespace
+
+TEST(SRepLegality, Empty) {
+  const auto srep = vtkSmartPointer<vtkEllipticalSRep>::New();
+  EXPECT_TRUE(CheckSRepLegality(*srep, CrossingTolerance).IsLegal());
+}
+
+TEST(SRepLegality, Invalid) {
+  const auto srep = MakeEllipsoidSRep(8, 4);
+  EXPECT_THROW(CheckSRepLegality(*srep, -1.0), std::invalid_argument);
+  EXPECT_THROW(CheckSRepLegality(*srep, std::nan("")), std::invalid_argument);
+  EXPECT_THROW(CheckSRepLegality(*srep, CrossingTolerance, std::nan("")), std::invalid_argument);
+}
+
+TEST(SRepLegality, LegalEllipsoid) {
+  const auto srep = MakeEllipsoidSRep(8, 4);
+  const auto report = CheckSRepLegality(*srep, CrossingTolerance);
+  EXPECT_TRUE(report.crossings.empty());
+  EXPECT_TRUE(report.rSradViolations.empty());
+  EXPECT_TRUE(report.IsLegal());
+  // some spokes can't be checked for rSrad, but not most of them
+  EXPECT_LT(report.rSradSkipped, static_cast<size_t>(2 * 8 * 4 / 2));
+
+  // still legal with the boundary between the spokes filled in
+  const auto interpolated = sreplogic::SmartInterpolateSRep(2, *srep);
+  EXPECT_TRUE(CheckSRepLegality(*interpolated, CrossingTolerance).IsLegal());
+}
+
+TEST(SRepLegality, CrossedSpokes) {
+  const auto srep = MakeEllipsoidSRep(8, 4);
+  auto* a = srep->GetSkeletalPoint(2, 1)->GetUpSpoke();
+  auto* b = srep->GetSkeletalPoint(2, 2)->GetUpSpoke();
+  const auto pa = a->GetSkeletalPoint();
+  const auto pb = b->GetSkeletalPoint();
+
+  // each spoke leans over to end above the other's skeletal point, so they form an X
+  const srep::Vector3d up(0, 0, 1);
+  a->SetDirectionAndMagnitude(srep::Vector3d(pa, pb) + up);
+  b->SetDirectionAndMagnitude(srep::Vector3d(pb, pa) + up);
+
+  const auto report = CheckSRepLegality(*srep, CrossingTolerance);
+  EXPECT_FALSE(report.IsLegal());
+  const auto* crossing = FindCrossing(*srep, report, a, b);
+  ASSERT_NE(nullptr, crossing);
+  EXPECT_LE(crossing->distance, CrossingTolerance);
+  // the X crosses halfway along both spokes
+  EXPECT_NEAR(0.5, crossing->firstParameter, 1e-6);
+  EXPECT_NEAR(0.5, crossing->secondParameter, 1e-6);
+}
+
+TEST(SRepLegality, OverlongSpokes) {
+  // With every up spoke pointing at the same focal point above the skeleton, the rSrad eigenvalue is the
+  // fraction of the way to the focal point. Short of it the spokes are fine, past it they all cross.
+  const auto srep = MakeEllipsoidSRep(8, 4);
+  const srep::Point3d focalPoint(0, 0, 2);
+
+  PointUpSpokesAt(*srep, focalPoint, 0.9);
+  EXPECT_TRUE(CheckSRepLegality(*srep, CrossingTolerance).IsLegal());
+
+  PointUpSpokesAt(*srep, focalPoint, 1.5);
+  const auto report = CheckSRepLegality(*srep, CrossingTolerance);
+  EXPECT_FALSE(report.IsLegal());
+  EXPECT_FALSE(report.crossings.empty());
+  ASSERT_FALSE(report.rSradViolations.empty());
+  for (const auto& violation : report.rSradViolations) {
+    // the down spokes weren't touched
+    EXPECT_EQ(vtkSRepSkeletalPoint::UpOrientation, violation.spokeType);
+    EXPECT_NEAR(1.5, violation.maxEigenvalue, 1e-6);
+  }
+
+  // a high enough threshold allows them
+  EXPECT_TRUE(CheckSRepLegality(*srep, CrossingTolerance, 2.0).rSradViolations.empty());
+}
+
+TEST(SRepLegality, NodeThreshold) {
+  vtkNew<vtkMRMLEllipticalSRepNode> node;
+  vtkNew<vtkSlicerSRepLogic> logic;
+  node->SetEllipticalSRep(MakeEllipsoidSRep(8, 4));
+  PointUpSpokesAt(*node->GetEllipticalSRep(), srep::Point3d(0, 0, 2), 1.5);
+
+  SRepLegalityReport report;
+  ASSERT_TRUE(logic->CheckSRepLegality(node, 0, CrossingTolerance, 1.0, report));
+  EXPECT_FALSE(report.rSradViolations.empty());
+  ASSERT_TRUE(logic->CheckSRepLegality(node, 0, CrossingTolerance, 2.0, report));
+  EXPECT_TRUE(report.rSradViolations.empty());
+
+  // errors leave the report alone
+  report.rSradSkipped = 12345;
+  EXPECT_FALSE(logic->CheckSRepLegality(node, 0, CrossingTolerance, std::nan(""), report));
+  EXPECT_EQ(12345u, report.rSradSkipped);
+}
@@ -0,0 +1,531 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <vtkEllipticalSRep.h>
+#include <vtkMRMLEllipticalSRepNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSRepDisplayNode.h>
+#include <vtkMRMLSRepStorageNode.h>
+#include <vtkNew.h>
+
+#include "SRepUnitTestHelpers.h"
+
+using namespace srepUnitTestHelpers;
+
+namespace {
+
+class SRepStorageNodeTest : public TempFileTest {
+protected:
+  void SetUp() override {
+    this->Scene->RegisterNodeClass(vtkNew<vtkMRMLSRepDisplayNode>());
+    this->Scene->RegisterNodeClass(vtkNew<vtkMRMLEllipticalSRepNode>());
+  }
+
+  vtkMRMLSRepStorageNode* AddStorageNode(const std::string& fileName) {
+    const auto path = this->AddTempFile(fileName);
+    vtkNew<vtkMRMLSRepStorageNode> storageNode;
+    this->Scene->AddNode(storageNode);
+    storageNode->SetFileName(path.c_str());
+    return storageNode;
+  }
+
+  vtkMRMLEllipticalSRepNode* AddSRepNode(vtkEllipticalSRep* srep = nullptr) {
+    vtkNew<vtkMRMLEllipticalSRepNode> node;
+    this->Scene->AddNode(node);
+    if (srep) {
+      node->SetEllipticalSRep(srep);
+    }
+    return node;
+  }
+
+  const vtkEllipticalSRep* WriteAndRead(vtkEllipticalSRep* srep, const std::string& fileName, int coordinateSystem) {
+    auto* storageNode = this->AddStorageNode(fileName);
+    storageNode->SetCoordinateSystemWrite(coordinateSystem);
+    EXPECT_TRUE(storageNode->WriteData(this->AddSRepNode(srep)));
+
+    auto* readNode = this->AddSRepNode();
+    EXPECT_TRUE(storageNode->ReadData(readNode));
+    return readNode->GetEllipticalSRep();
+  }
+
+  vtkNew<vtkMRMLScene> Scene;
+};
+
+void ExpectArrayNear(const std::array<double, 3>& expected, const std::array<double, 3>& actual, double tolerance) {
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_NEAR(expected[i], actual[i], tolerance);
+  }
+}
+
+void ExpectSpokeNear(const vtkSRepSpoke* expected, const vtkSRepSpoke* actual, double tolerance) {
+  ASSERT_EQ(expected == nullptr, actual == nullptr);
+  if (expected) {
+    ExpectArrayNear(expected->GetSkeletalPoint().AsArray(), actual->GetSkeletalPoint().AsArray(), tolerance);
+    ExpectArrayNear(expected->GetDirection().AsArray(), actual->GetDirection().AsArray(), tolerance);
+  }
+}
+
+// tolerance of 0 means bit for bit the same
+void ExpectSRepNear(const vtkEllipticalSRep* expected, const vtkEllipticalSRep* actual, double tolerance) {
+  ASSERT_NE(nullptr, expected);
+  ASSERT_NE(nullptr, actual);
+  ASSERT_EQ(expected->GetNumberOfLines(), actual->GetNumberOfLines());
+  ASSERT_EQ(expected->GetNumberOfSteps(), actual->GetNumberOfSteps());
+  for (vtkEllipticalSRep::IndexType l = 0; l < expected->GetNumberOfLines(); ++l) {
+    for (vtkEllipticalSRep::IndexType s = 0; s < expected->GetNumberOfSteps(); ++s) {
+      const auto* expectedPoint = expected->GetSkeletalPoint(l, s);
+      const auto* actualPoint = actual->GetSkeletalPoint(l, s);
+      ExpectSpokeNear(expectedPoint->GetUpSpoke(), actualPoint->GetUpSpoke(), tolerance);
+      ExpectSpokeNear(expectedPoint->GetDownSpoke(), actualPoint->GetDownSpoke(), tolerance);
+      ExpectSpokeNear(expectedPoint->GetCrestSpoke(), actualPoint->GetCrestSpoke(), tolerance);
+    }
+  }
+}
+
+}
+
+TEST_F(SRepStorageNodeTest, BinaryRoundTripMatchesJson) {
+  const auto srep = MakeSRep(8, 4);
+  for (const int coordinateSystem : {vtkMRMLStorageNode::CoordinateSystemLPS, vtkMRMLStorageNode::CoordinateSystemRAS}) {
+    const auto* fromJson = this->WriteAndRead(srep, "roundtrip" + std::to_string(coordinateSystem) + ".srep.json", coordinateSystem);
+    const auto* fromBinary = this->WriteAndRead(srep, "roundtrip" + std::to_string(coordinateSystem) + ".srep.bin", coordinateSystem);
+    // rapidjson's default parsing can be off in the last bit, the binary format is exact
+    ExpectSRepNear(srep, fromJson, 1e-12);
+    ExpectSRepNear(srep, fromBinary, 0);
+    ExpectSRepNear(fromJson, fromBinary, 1e-12);
+  }
+}
+
+TEST_F(SRepStorageNodeTest, BinaryFileSize) {
+  const auto srep = MakeSRep(6, 3);
+  auto* storageNode = this->AddStorageNode("size.srep.bin");
+  ASSERT_TRUE(storageNode->WriteData(this->AddSRepNode(srep)));
+
+  std::ifstream file(storageNode->GetFileName(), std::ios::binary | std::ios::ate);
+  // 32 byte header, then 6 doubles per spoke: 6 * 3 up, 6 * 3 down, 6 crest
+  EXPECT_EQ(32 + 6 * 8 * (18 + 18 + 6), static_cast<int>(file.tellg()));
+}
+
+TEST_F(SRepStorageNodeTest, BinaryGetSRepType) {
+  auto* storageNode = this->AddStorageNode("type.srep.bin");
+  ASSERT_TRUE(storageNode->WriteData(this->AddSRepNode(MakeSRep(4, 2))));
+  EXPECT_EQ("vtkMRMLEllipticalSRepNode", storageNode->GetSRepType());
+}
+
+TEST_F(SRepStorageNodeTest, BinaryDetectedByContent) {
+  const auto srep = MakeSRep(4, 3);
+  auto* writer = this->AddStorageNode("content.srep.bin");
+  ASSERT_TRUE(writer->WriteData(this->AddSRepNode(srep)));
+
+  // copy the binary file to a name with the JSON extension, it should still read as binary
+  auto* reader = this->AddStorageNode("content.srep.json");
+  {
+    std::ifstream in(writer->GetFileName(), std::ios::binary);
+    std::ofstream out(reader->GetFileName(), std::ios::binary);
+    out << in.rdbuf();
+  }
+  auto* readNode = this->AddSRepNode();
+  ASSERT_TRUE(reader->ReadData(readNode));
+  ExpectSRepNear(srep, readNode->GetEllipticalSRep(), 0);
+}
+
+TEST_F(SRepStorageNodeTest, BinaryTruncatedFails) {
+  auto* storageNode = this->AddStorageNode("truncated.srep.bin");
+  ASSERT_TRUE(storageNode->WriteData(this->AddSRepNode(MakeSRep(4, 3))));
+
+  std::string contents;
+  {
+    std::ifstream in(storageNode->GetFileName(), std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream out(storageNode->GetFileName(), std::ios::binary | std::ios::trunc);
+    out.write(contents.data(), contents.size() - 8);
+  }
+
+  EXPECT_FALSE(storageNode->ReadData(this->AddSRepNode()));
+}
+
+TEST_F(SRepStorageNodeTest, JsonDisplayRoundTrip) {
+  auto* writeNode = this->AddSRepNode(MakeSRep(4, 3));
+  writeNode->CreateDefaultDisplayNodes();
+  ASSERT_NE(nullptr, writeNode->GetSRepDisplayNode());
+  writeNode->GetSRepDisplayNode()->SetOpacity(0.25);
+  writeNode->GetSRepDisplayNode()->SetUpSpokeColor(vtkColor3ub(1, 2, 3));
+  writeNode->GetSRepDisplayNode()->SetCrestCurveVisibility(false);
+
+  auto* storageNode = this->AddStorageNode("display.srep.json");
+  ASSERT_TRUE(storageNode->WriteData(writeNode));
+  auto* readNode = this->AddSRepNode();
+  ASSERT_TRUE(storageNode->ReadData(readNode));
+
+  auto* displayNode = readNode->GetSRepDisplayNode();
+  ASSERT_NE(nullptr, displayNode);
+  EXPECT_EQ(0.25, displayNode->GetOpacity());
+  EXPECT_EQ(vtkColor3ub(1, 2, 3), displayNode->GetUpSpokeColor());
+  EXPECT_FALSE(displayNode->GetCrestCurveVisibility());
+  ExpectSRepNear(writeNode->GetEllipticalSRep(), readNode->GetEllipticalSRep(), 1e-12);
+}
+
+TEST_F(SRepStorageNodeTest, JsonMemberOrderAndUnknownMembers) {
+  // Skeleton before its sizes, integer coordinates, and members this reader doesn't know about
+  const auto spoke = [](const char* system, int x) {
+    const std::string value = std::string(R"({"CoordinateSystem": ")") + system + R"(", "Value": [)" + std::to_string(x) + ", 2, 3]}";
+    return R"({"Unknown": [1, {"a": null}], "SkeletalPoint": )" + value + R"(, "Direction": )" + value + "}";
+  };
+  std::string skeleton;
+  for (int l = 0; l < 2; ++l) {
+    skeleton += l == 0 ? "[" : ", [";
+    skeleton += R"({"UpSpoke": )" + spoke("RAS", l) + R"(, "DownSpoke": )" + spoke("LPS", l) + "}, ";
+    skeleton += R"({"UpSpoke": )" + spoke("RAS", l) + R"(, "DownSpoke": )" + spoke("LPS", l)
+      + R"(, "CrestSpoke": )" + spoke("RAS", 10 + l) + "}]";
+  }
+
+  auto* storageNode = this->AddStorageNode("order.srep.json");
+  {
+    std::ofstream out(storageNode->GetFileName());
+    out << R"({"Other": {"x": [true, false]}, "EllipticalSRep": {"Skeleton": [)" << skeleton
+        << R"(], "Extra": "value", "Steps": 1, "CrestPoints": 2}})";
+  }
+  auto* readNode = this->AddSRepNode();
+  ASSERT_TRUE(storageNode->ReadData(readNode));
+  EXPECT_EQ(nullptr, readNode->GetSRepDisplayNode());
+
+  const auto* srep = readNode->GetEllipticalSRep();
+  ASSERT_NE(nullptr, srep);
+  ASSERT_EQ(2, srep->GetNumberOfLines());
+  ASSERT_EQ(2, srep->GetNumberOfSteps());
+  EXPECT_EQ(srep::Point3d(1, 2, 3), srep->GetSkeletalPoint(1, 0)->GetUpSpoke()->GetSkeletalPoint());
+  EXPECT_EQ(srep::Point3d(-1, -2, 3), srep->GetSkeletalPoint(1, 0)->GetDownSpoke()->GetSkeletalPoint());
+  ASSERT_TRUE(srep->GetSkeletalPoint(1, 1)->IsCrest());
+  EXPECT_EQ(srep::Point3d(11, 2, 3), srep->GetSkeletalPoint(1, 1)->GetCrestSpoke()->GetSkeletalPoint());
+}
+
+TEST_F(SRepStorageNodeTest, JsonMismatchedSizeFails) {
+  auto* storageNode = this->AddStorageNode("mismatch.srep.json");
+  storageNode->SetJsonFormatVersionWrite(1);
+  ASSERT_TRUE(storageNode->WriteData(this->AddSRepNode(MakeSRep(4, 3))));
+
+  std::string contents;
+  {
+    std::ifstream in(storageNode->GetFileName());
+    contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  const auto stepsPos = contents.find(R"("Steps": 2)");
+  ASSERT_NE(std::string::npos, stepsPos);
+  contents.replace(stepsPos, 10, R"("Steps": 3)");
+  {
+    std::ofstream out(storageNode->GetFileName(), std::ios::trunc);
+    out << contents;
+  }
+
+  EXPECT_FALSE(storageNode->ReadData(this->AddSRepNode()));
+}
+
+TEST_F(SRepStorageNodeTest, JsonFileInfo) {
+  auto* writeNode = this->AddSRepNode(MakeSRep(6, 4));
+  writeNode->CreateDefaultDisplayNodes();
+  writeNode->GetSRepDisplayNode()->SetCrestSpokeColor(vtkColor3ub(4, 5, 6));
+  auto* storageNode = this->AddStorageNode("info.srep.json");
+  storageNode->CoordinateSystemWriteRASOn();
+  ASSERT_TRUE(storageNode->WriteData(writeNode));
+
+  vtkMRMLSRepStorageNode::SRepFileInfo info;
+  ASSERT_TRUE(storageNode->ReadSRepFileInfo(info));
+  EXPECT_EQ("vtkMRMLEllipticalSRepNode", info.SRepType);
+  EXPECT_FALSE(info.Binary);
+  EXPECT_EQ(2, info.FormatVersion);
+  EXPECT_EQ(6, info.NumberOfLines);
+  EXPECT_EQ(4, info.NumberOfSteps);
+  EXPECT_EQ(vtkMRMLStorageNode::CoordinateSystemRAS, info.CoordinateSystem);
+  EXPECT_EQ(nullptr, info.Display);
+
+  ASSERT_TRUE(storageNode->ReadSRepFileInfo(info, true));
+  EXPECT_EQ(6, info.NumberOfLines);
+  ASSERT_NE(nullptr, info.Display);
+  EXPECT_EQ(vtkColor3ub(4, 5, 6), info.Display->GetCrestSpokeColor());
+}
+
+TEST_F(SRepStorageNodeTest, BinaryFileInfo) {
+  auto* storageNode = this->AddStorageNode("info.srep.bin");
+  ASSERT_TRUE(storageNode->WriteData(this->AddSRepNode(MakeSRep(6, 4))));
+
+  vtkMRMLSRepStorageNode::SRepFileInfo info;
+  ASSERT_TRUE(storageNode->ReadSRepFileInfo(info, true));
+  EXPECT_EQ("vtkMRMLEllipticalSRepNode", info.SRepType);
+  EXPECT_TRUE(info.Binary);
+  EXPECT_EQ(1, info.FormatVersion);
+  EXPECT_EQ(6, info.NumberOfLines);
+  EXPECT_EQ(4, info.NumberOfSteps);
+  EXPECT_EQ(vtkMRMLStorageNode::CoordinateSystemLPS, info.CoordinateSystem);
+  EXPECT_EQ(nullptr, info.Display);
+}
+
+TEST_F(SRepStorageNodeTest, JsonFileInfoStopsAtHeader) {
+  // cut each format off right after the sizes, only a full read should notice
+  const std::array<std::pair<int, std::string>, 2> cuts{{{1, R"("LPS")"}, {2, R"("UpSpokes")"}}};
+  for (const auto& cut : cuts) {
+    auto* storageNode = this->AddStorageNode("header" + std::to_string(cut.first) + ".srep.json");
+    storageNode->SetJsonFormatVersionWrite(cut.first);
+    ASSERT_TRUE(storageNode->WriteData(this->AddSRepNode(MakeSRep(4, 3))));
+
+    std::string contents;
+    {
+      std::ifstream in(storageNode->GetFileName());
+      contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    const auto cutPos = contents.find(cut.second);
+    ASSERT_NE(std::string::npos, cutPos);
+    {
+      std::ofstream out(storageNode->GetFileName(), std::ios::trunc);
+      out << contents.substr(0, cutPos + cut.second.size());
+    }
+
+    vtkMRMLSRepStorageNode::SRepFileInfo info;
+    ASSERT_TRUE(storageNode->ReadSRepFileInfo(info));
+    EXPECT_EQ(cut.first, info.FormatVersion);
+    EXPECT_EQ(4, info.NumberOfLines);
+    EXPECT_EQ(3, info.NumberOfSteps);
+    EXPECT_EQ(vtkMRMLStorageNode::CoordinateSystemLPS, info.CoordinateSystem);
+    EXPECT_EQ("vtkMRMLEllipticalSRepNode", storageNode->GetSRepType());
+    EXPECT_FALSE(storageNode->ReadData(this->AddSRepNode()));
+  }
+}
+
+TEST_F(SRepStorageNodeTest, JsonVersionsRoundTrip) {
+  const auto srep = MakeSRep(5, 4);
+  for (const int coordinateSystem : {vtkMRMLStorageNode::CoordinateSystemLPS, vtkMRMLStorageNode::CoordinateSystemRAS}) {
+    for (const int version : {1, 2}) {
+      const auto fileName = "version" + std::to_string(version) + "_" + std::to_string(coordinateSystem) + ".srep.json";
+      auto* storageNode = this->AddStorageNode(fileName);
+      storageNode->SetJsonFormatVersionWrite(version);
+      storageNode->SetCoordinateSystemWrite(coordinateSystem);
+      ASSERT_TRUE(storageNode->WriteData(this->AddSRepNode(srep)));
+
+      vtkMRMLSRepStorageNode::SRepFileInfo info;
+      ASSERT_TRUE(storageNode->ReadSRepFileInfo(info));
+      EXPECT_EQ(version, info.FormatVersion);
+      EXPECT_EQ(coordinateSystem, info.CoordinateSystem);
+
+      auto* readNode = this->AddSRepNode();
+      ASSERT_TRUE(storageNode->ReadData(readNode));
+      ExpectSRepNear(srep, readNode->GetEllipticalSRep(), 1e-12);
+    }
+  }
+}
+
+TEST_F(SRepStorageNodeTest, JsonVersion2IsSmaller) {
+  const auto srep = MakeSRep(10, 5);
+  auto* version1 = this->AddStorageNode("size1.srep.json");
+  version1->SetJsonFormatVersionWrite(1);
+  ASSERT_TRUE(version1->WriteData(this->AddSRepNode(srep)));
+  auto* version2 = this->AddStorageNode("size2.srep.json");
+  ASSERT_TRUE(version2->WriteData(this->AddSRepNode(srep)));
+
+  std::ifstream in1(version1->GetFileName(), std::ios::binary | std::ios::ate);
+  std::ifstream in2(version2->GetFileName(), std::ios::binary | std::ios::ate);
+  EXPECT_LT(2 * static_cast<long long>(in2.tellg()), static_cast<long long>(in1.tellg()));
+}
+
+TEST_F(SRepStorageNodeTest, JsonVersion2HandWritten) {
+  auto* storageNode = this->AddStorageNode("handwritten2.srep.json");
+  {
+    // 2 lines of 2 steps, in LPS
+    std::ofstream out(storageNode->GetFileName());
+    out << R"({"FormatVersion": 2, "CoordinateSystem": "LPS", "EllipticalSRep": {"CrestPoints": 2, "Steps": 1,)"
+        << R"( "UpSpokes": {"SkeletalPoints": [1,2,3, 4,5,6, 7,8,9, 10,11,12],)"
+        << R"( "Directions": [0,0,1, 0,0,1, 0,0,1, 0,0,1], "Radii": [1, 2, 3, 4]},)"
+        << R"( "DownSpokes": {"SkeletalPoints": [1,2,3, 4,5,6, 7,8,9, 10,11,12],)"
+        << R"( "Directions": [0,0,-1, 0,0,-1, 0,0,-1, 0,0,-1], "Radii": [1, 1, 1, 1]},)"
+        << R"( "CrestSpokes": {"SkeletalPoints": [4,5,6, 10,11,12], "Directions": [1,0,0, 0,1,0], "Radii": [2, 3]}}})";
+  }
+
+  auto* readNode = this->AddSRepNode();
+  ASSERT_TRUE(storageNode->ReadData(readNode));
+  const auto* srep = readNode->GetEllipticalSRep();
+  ASSERT_NE(nullptr, srep);
+  ASSERT_EQ(2, srep->GetNumberOfLines());
+  ASSERT_EQ(2, srep->GetNumberOfSteps());
+  const auto* up = srep->GetSkeletalPoint(1, 1)->GetUpSpoke();
+  EXPECT_EQ(srep::Point3d(-10, -11, 12), up->GetSkeletalPoint());
+  EXPECT_EQ(srep::Vector3d(0, 0, 4), up->GetDirection());
+  ASSERT_TRUE(srep->GetSkeletalPoint(0, 1)->IsCrest());
+  EXPECT_EQ(srep::Vector3d(-2, 0, 0), srep->GetSkeletalPoint(0, 1)->GetCrestSpoke()->GetDirection());
+}
+
+TEST_F(SRepStorageNodeTest, JsonUnsupportedVersionFails) {
+  auto* storageNode = this->AddStorageNode("version3.srep.json");
+  {
+    std::ofstream out(storageNode->GetFileName());
+    out << R"({"FormatVersion": 3, "CoordinateSystem": "LPS", "EllipticalSRep": {"CrestPoints": 0, "Steps": 0}})";
+  }
+  EXPECT_FALSE(storageNode->ReadData(this->AddSRepNode()));
+
+  storageNode->SetJsonFormatVersionWrite(3);
+  EXPECT_EQ(2, storageNode->GetJsonFormatVersionWrite());
+}
+
+TEST_F(SRepStorageNodeTest, ReadSRepFileWithoutScene) {
+  auto* writeNode = this->AddSRepNode(MakeSRep(5, 3));
+  writeNode->CreateDefaultDisplayNodes();
+  writeNode->GetSRepDisplayNode()->SetOpacity(0.25);
+  auto* jsonNode = this->AddStorageNode("detached.srep.json");
+  ASSERT_TRUE(jsonNode->WriteData(writeNode));
+  auto* binaryNode = this->AddStorageNode("detached.srep.bin");
+  ASSERT_TRUE(binaryNode->WriteData(writeNode));
+
+  vtkMRMLSRepStorageNode::SRepFileData data;
+  std::string errorMessage;
+  ASSERT_TRUE(vtkMRMLSRepStorageNode::ReadSRepFile(jsonNode->GetFileName(), data, errorMessage));
+  ExpectSRepNear(writeNode->GetEllipticalSRep(), data.EllipticalSRep, 1e-12);
+  ASSERT_NE(nullptr, data.Display);
+  EXPECT_EQ(nullptr, data.Display->GetScene());
+  EXPECT_DOUBLE_EQ(0.25, data.Display->GetOpacity());
+
+  ASSERT_TRUE(vtkMRMLSRepStorageNode::ReadSRepFile(binaryNode->GetFileName(), data, errorMessage));
+  ExpectSRepNear(writeNode->GetEllipticalSRep(), data.EllipticalSRep, 0);
+  EXPECT_EQ(nullptr, data.Display);
+
+  EXPECT_FALSE(vtkMRMLSRepStorageNode::ReadSRepFile(this->AddTempFile("missing.srep.json"), data, errorMessage));
+  EXPECT_EQ(nullptr, data.EllipticalSRep);
+  EXPECT_FALSE(errorMessage.empty());
+}
+
+TEST_F(SRepStorageNodeTest, ReadSRepFileConcurrently) {
+  std::vector<std::string> fileNames;
+  std::vector<vtkSmartPointer<vtkEllipticalSRep>> sreps;
+  for (int i = 0; i < 8; ++i) {
+    sreps.push_back(MakeSRep(3 + i, 2 + i % 3));
+    auto* storageNode = this->AddStorageNode("concurrent" + std::to_string(i) + (i % 2 ? ".srep.bin" : ".srep.json"));
+    ASSERT_TRUE(storageNode->WriteData(this->AddSRepNode(sreps.back())));
+    fileNames.push_back(storageNode->GetFileName());
+  }
+
+  std::vector<vtkMRMLSRepStorageNode::SRepFileData> data(fileNames.size());
+  std::vector<std::string> errorMessages(fileNames.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < fileNames.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      vtkMRMLSRepStorageNode::ReadSRepFile(fileNames[i], data[i], errorMessages[i]);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (size_t i = 0; i < fileNames.size(); ++i) {
+    EXPECT_TRUE(errorMessages[i].empty()) << errorMessages[i];
+    ExpectSRepNear(sreps[i], data[i].EllipticalSRep, 1e-12);
+  }
+}
+
+TEST_F(SRepStorageNodeTest, CreateSRepNodeFromFileData) {
+  auto* writeNode = this->AddSRepNode(MakeSRep(4, 4));
+  writeNode->CreateDefaultDisplayNodes();
+  writeNode->GetSRepDisplayNode()->SetUpSpokeColor(vtkColor3ub(7, 8, 9));
+  auto* storageNode = this->AddStorageNode("preloaded.srep.json");
+  ASSERT_TRUE(storageNode->WriteData(writeNode));
+
+  vtkMRMLSRepStorageNode::SRepFileData data;
+  std::string errorMessage;
+  ASSERT_TRUE(vtkMRMLSRepStorageNode::ReadSRepFile(storageNode->GetFileName(), data, errorMessage));
+  // the file can't be read any more, so the node can only have come from data
+  {
+    std::ofstream out(storageNode->GetFileName(), std::ios::trunc);
+    out << "not an srep";
+  }
+
+  auto* srepNode = vtkMRMLEllipticalSRepNode::SafeDownCast(storageNode->CreateSRepNode("preloaded", data));
+  ASSERT_NE(nullptr, srepNode);
+  EXPECT_STREQ("preloaded", srepNode->GetName());
+  EXPECT_EQ(data.EllipticalSRep, srepNode->GetEllipticalSRep());
+  ASSERT_NE(nullptr, srepNode->GetSRepDisplayNode());
+  EXPECT_NE(data.Display, srepNode->GetSRepDisplayNode());
+  EXPECT_EQ(vtkColor3ub(7, 8, 9), srepNode->GetSRepDisplayNode()->GetUpSpokeColor());
+
+  EXPECT_EQ(nullptr, storageNode->CreateSRepNode("empty", vtkMRMLSRepStorageNode::SRepFileData()));
+}
+
+TEST_F(SRepStorageNodeTest, MemoryRoundTrip) {
+  const auto srep = MakeSRep(5, 4);
+  vtkNew<vtkMRMLSRepDisplayNode> display;
+  display->SetOpacity(0.25);
+  display->SetDownSpokeColor(vtkColor3ub(4, 5, 6));
+
+  // no scene needed to write either
+  vtkNew<vtkMRMLSRepStorageNode> storageNode;
+  vtkMRMLSRepStorageNode::SRepFileData data;
+  std::string buffer;
+  std::string errorMessage;
+  for (const int version : {1, 2}) {
+    storageNode->SetJsonFormatVersionWrite(version);
+    ASSERT_TRUE(storageNode->WriteSRepToMemory(*srep, display, vtkMRMLSRepStorageNode::SRepFileFormatJson, buffer));
+    ASSERT_TRUE(vtkMRMLSRepStorageNode::ReadSRepFromMemory(buffer.data(), buffer.size(), data, errorMessage)) << errorMessage;
+    ExpectSRepNear(srep, data.EllipticalSRep, 1e-12);
+    ASSERT_NE(nullptr, data.Display);
+    EXPECT_DOUBLE_EQ(0.25, data.Display->GetOpacity());
+    EXPECT_EQ(vtkColor3ub(4, 5, 6), data.Display->GetDownSpokeColor());
+  }
+
+  ASSERT_TRUE(storageNode->WriteSRepToMemory(*srep, display, vtkMRMLSRepStorageNode::SRepFileFormatBinary, buffer));
+  ASSERT_TRUE(vtkMRMLSRepStorageNode::ReadSRepFromMemory(buffer.data(), buffer.size(), data, errorMessage)) << errorMessage;
+  ExpectSRepNear(srep, data.EllipticalSRep, 0);
+  EXPECT_EQ(nullptr, data.Display);
+}
+
+TEST_F(SRepStorageNodeTest, StreamRoundTrip) {
+  const auto srep = MakeSRep(6, 3);
+  vtkNew<vtkMRMLSRepStorageNode> storageNode;
+  storageNode->CoordinateSystemWriteRASOn();
+  vtkMRMLSRepStorageNode::SRepFileData data;
+  std::string errorMessage;
+  for (const auto format : {vtkMRMLSRepStorageNode::SRepFileFormatJson, vtkMRMLSRepStorageNode::SRepFileFormatBinary}) {
+    std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+    ASSERT_TRUE(storageNode->WriteSRepToStream(*srep, nullptr, format, stream));
+    ASSERT_TRUE(vtkMRMLSRepStorageNode::ReadSRepFromStream(stream, data, errorMessage)) << errorMessage;
+    ExpectSRepNear(srep, data.EllipticalSRep, format == vtkMRMLSRepStorageNode::SRepFileFormatBinary ? 0 : 1e-12);
+    EXPECT_EQ(nullptr, data.Display);
+  }
+}
+
+TEST_F(SRepStorageNodeTest, MemoryMatchesFile) {
+  auto* writeNode = this->AddSRepNode(MakeSRep(4, 4));
+  writeNode->CreateDefaultDisplayNodes();
+  for (const auto& fileName : {"memory.srep.json", "memory.srep.bin"}) {
+    auto* storageNode = this->AddStorageNode(fileName);
+    ASSERT_TRUE(storageNode->WriteData(writeNode));
+    std::ifstream in(storageNode->GetFileName(), std::ios::binary);
+    const std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    const auto format = std::string(fileName).find(".bin") != std::string::npos
+      ? vtkMRMLSRepStorageNode::SRepFileFormatBinary : vtkMRMLSRepStorageNode::SRepFileFormatJson;
+    std::string buffer;
+    ASSERT_TRUE(storageNode->WriteSRepToMemory(*writeNode->GetEllipticalSRep(), writeNode->GetSRepDisplayNode(), format, buffer));
+    EXPECT_EQ(contents, buffer);
+  }
+}
+
+TEST_F(SRepStorageNodeTest, BadMemoryFails) {
+  vtkNew<vtkMRMLSRepStorageNode> storageNode;
+  std::string binary;
+  std::string json;
+  ASSERT_TRUE(storageNode->WriteSRepToMemory(*MakeSRep(3, 3), nullptr, vtkMRMLSRepStorageNode::SRepFileFormatBinary, binary));
+  ASSERT_TRUE(storageNode->WriteSRepToMemory(*MakeSRep(3, 3), nullptr, vtkMRMLSRepStorageNode::SRepFileFormatJson, json));
+
+  for (const auto& bad : {std::string(), std::string("not an srep"), binary.substr(0, binary.size() - 1),
+    binary.substr(0, 12), json.substr(0, json.size() / 2), std::string("{}")})
+  {
+    vtkMRMLSRepStorageNode::SRepFileData data;
+    data.EllipticalSRep = MakeSRep(2, 2);
+    std::string errorMessage;
+    EXPECT_FALSE(vtkMRMLSRepStorageNode::ReadSRepFromMemory(bad.data(), bad.size(), data, errorMessage));
+    EXPECT_EQ(nullptr, data.EllipticalSRep);
+    EXPECT_FALSE(errorMessage.empty());
+  }
+}
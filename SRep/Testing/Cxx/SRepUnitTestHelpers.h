@@ -1,7 +1,14 @@
 #ifndef srepModuleUnitTestHelpers_h
 #define srepModuleUnitTestHelpers_h
 
+#include <gtest/gtest.h>
+#include <vtkEllipticalSRep.h>
 #include <vtkObject.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <string>
 #include <vector>
 
 #define EXPECT_SPOKE_EQ(S1, S2) \
@@ -50,6 +57,98 @@ void PrintSelfTest(T& t) {
   EXPECT_GT(ss.str().length(), superSS.str().length());
 }
 
+/// An elliptical srep whose values aren't exactly representable, so any rounding in a round trip shows up.
+/// Different seeds give different sreps of the same size.
+inline vtkSmartPointer<vtkEllipticalSRep> MakeSRep(
+  vtkEllipticalSRep::IndexType lines,
+  vtkEllipticalSRep::IndexType steps,
+  double seed = 0.0)
+{
+  vtkEllipticalSRep::UnrolledEllipticalGrid skeleton(lines);
+  for (vtkEllipticalSRep::IndexType l = 0; l < lines; ++l) {
+    for (vtkEllipticalSRep::IndexType s = 0; s < steps; ++s) {
+      const srep::Point3d pt(l * 1.1 - 2.3 - seed, s * -0.7 + 0.1, l * s / 3.0 + seed);
+      auto up = vtkSRepSpoke::SmartCreate(pt, srep::Vector3d(0.1, -0.2, 1.3 + l / 7.0));
+      auto down = vtkSRepSpoke::SmartCreate(pt, srep::Vector3d(-0.3, 0.2 + seed, -1.1 - s / 9.0));
+      vtkSmartPointer<vtkSRepSpoke> crest;
+      if (s == steps - 1) {
+        crest = vtkSRepSpoke::SmartCreate(pt, srep::Vector3d(l / 3.0, -s / 7.0, 0.01));
+      }
+      skeleton[l].push_back(vtkSRepSkeletalPoint::SmartCreate(up, down, crest));
+    }
+  }
+  return vtkEllipticalSRep::SmartCreate(skeleton);
+}
+
+/// The medial s-rep of the ellipsoid x^2/a^2 + y^2/b^2 + z^2/c^2 = 1 with a > b > c.
+/// Every spoke ends exactly on the ellipsoid and the spokes of a line never cross.
+inline vtkSmartPointer<vtkEllipticalSRep> MakeEllipsoidSRep(
+  vtkEllipticalSRep::IndexType lines,
+  vtkEllipticalSRep::IndexType steps,
+  double a = 3.0,
+  double b = 2.0,
+  double c = 1.0)
+{
+  const double pi = std::acos(-1.0);
+  // radii of the medial ellipse in the z = 0 plane
+  const double mra = (a * a - c * c) / a;
+  const double mrb = (b * b - c * c) / b;
+
+  vtkEllipticalSRep::UnrolledEllipticalGrid skeleton(lines);
+  for (vtkEllipticalSRep::IndexType l = 0; l < lines; ++l) {
+    const double theta = pi - 2.0 * pi * l / lines;
+    const double spineX = (mra * mra - mrb * mrb) * std::cos(theta) / mra;
+    const double edgeX = mra * std::cos(theta);
+    const double edgeY = mrb * std::sin(theta);
+    for (vtkEllipticalSRep::IndexType s = 0; s < steps; ++s) {
+      const double t = static_cast<double>(s) / (steps - 1);
+      const srep::Point3d pt(spineX + t * (edgeX - spineX), t * edgeY, 0.0);
+      const double u = pt.GetX() / mra;
+      const double v = pt.GetY() / mrb;
+      const double w = std::sqrt(std::max(0.0, 1.0 - u * u - v * v));
+      auto up = vtkSRepSpoke::SmartCreate(pt, srep::Vector3d(c * c * u / a, c * c * v / b, c * w));
+      auto down = vtkSRepSpoke::SmartCreate(pt, srep::Vector3d(c * c * u / a, c * c * v / b, -c * w));
+      vtkSmartPointer<vtkSRepSpoke> crest;
+      if (s == steps - 1) {
+        crest = vtkSRepSpoke::SmartCreate(pt, srep::Vector3d(c * c * u / a, c * c * v / b, 0.0));
+      }
+      skeleton[l].push_back(vtkSRepSkeletalPoint::SmartCreate(up, down, crest));
+    }
+  }
+  return vtkEllipticalSRep::SmartCreate(skeleton);
+}
+
+/// Expects every spoke of the two sreps to be exactly the same.
+inline void ExpectSRepEqual(const vtkEllipticalSRep* expected, const vtkEllipticalSRep* actual) {
+  ASSERT_NE(nullptr, expected);
+  ASSERT_NE(nullptr, actual);
+  ASSERT_EQ(expected->GetNumberOfLines(), actual->GetNumberOfLines());
+  ASSERT_EQ(expected->GetNumberOfSteps(), actual->GetNumberOfSteps());
+  for (vtkEllipticalSRep::IndexType l = 0; l < expected->GetNumberOfLines(); ++l) {
+    for (vtkEllipticalSRep::IndexType s = 0; s < expected->GetNumberOfSteps(); ++s) {
+      EXPECT_SKELETAL_POINT_EQ(expected->GetSkeletalPoint(l, s), actual->GetSkeletalPoint(l, s));
+    }
+  }
+}
+
+/// Fixture for tests that write files. Every path from AddTempFile is deleted after the test.
+class TempFileTest : public ::testing::Test {
+protected:
+  std::string AddTempFile(const std::string& name) {
+    const auto path = testing::TempDir() + name;
+    this->TempFiles.push_back(path);
+    return path;
+  }
+
+  void TearDown() override {
+    for (const auto& path : this->TempFiles) {
+      std::remove(path.c_str());
+    }
+  }
+
+  std::vector<std::string> TempFiles;
+};
+
 }
 
 #endif
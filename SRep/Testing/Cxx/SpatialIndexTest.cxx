@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include <vtkSRepSpatialIndex.h>
+#include <vtkEllipticalSRep.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "SRepUnitTestHelpers.h"
+
+namespace {
+
+using SpokeHit = vtkSRepSpatialIndex::SpokeHit;
+
+// deterministic values in [-1, 1] so the tests are repeatable
+class Lcg {
+public:
+  double Next() {
+    this->State = this->State * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<double>(this->State >> 11) / static_cast<double>(1ull << 53) * 2.0 - 1.0;
+  }
+private:
+  unsigned long long State = 12345;
+};
+
+vtkSmartPointer<vtkEllipticalSRep> MakeSRep(vtkEllipticalSRep::IndexType lines, vtkEllipticalSRep::IndexType steps) {
+  Lcg random;
+  auto srep = vtkSmartPointer<vtkEllipticalSRep>::New();
+  srep->Resize(lines, steps);
+  for (vtkEllipticalSRep::IndexType l = 0; l < lines; ++l) {
+    for (vtkEllipticalSRep::IndexType s = 0; s < steps; ++s) {
+      const srep::Point3d point(10 * random.Next(), 10 * random.Next(), random.Next());
+      auto* skeletalPoint = srep->GetSkeletalPoint(l, s);
+      skeletalPoint->GetUpSpoke()->SetSkeletalPointAndDirection(point, srep::Vector3d(random.Next(), random.Next(), 3));
+      skeletalPoint->GetDownSpoke()->SetSkeletalPointAndDirection(point, srep::Vector3d(random.Next(), random.Next(), -3));
+      if (skeletalPoint->IsCrest()) {
+        skeletalPoint->GetCrestSpoke()->SetSkeletalPointAndDirection(point, srep::Vector3d(2 * random.Next(), 2 * random.Next(), 0));
+      }
+    }
+  }
+  return srep;
+}
+
+const vtkSRepSpokeMesh* GetMesh(const vtkMeshSRepInterface& srep, vtkSRepSkeletalPoint::SpokeOrientation orientation) {
+  if (orientation == vtkSRepSkeletalPoint::UpOrientation) {
+    return srep.GetUpSpokes();
+  } else if (orientation == vtkSRepSkeletalPoint::DownOrientation) {
+    return srep.GetDownSpokes();
+  }
+  return srep.GetCrestSpokes();
+}
+
+double DistanceToSpoke(const srep::Point3d& point, const vtkSRepSpoke& spoke) {
+  const srep::Vector3d d = spoke.GetDirection();
+  const srep::Vector3d r(spoke.GetSkeletalPoint(), point);
+  const double lengthSquared = d.GetLength() * d.GetLength();
+  const double t = lengthSquared == 0 ? 0 : std::max(0.0, std::min(1.0, (r[0] * d[0] + r[1] * d[1] + r[2] * d[2]) / lengthSquared));
+  return srep::Vector3d(spoke.GetSkeletalPoint() + d * t, point).GetLength();
+}
+
+// every spoke in the SRep with its distance to point
+std::vector<SpokeHit> BruteForce(const vtkMeshSRepInterface& srep, const srep::Point3d& point) {
+  std::vector<SpokeHit> all;
+  for (const auto orientation : {vtkSRepSkeletalPoint::UpOrientation, vtkSRepSkeletalPoint::DownOrientation, vtkSRepSkeletalPoint::CrestOrientation}) {
+    const auto* mesh = GetMesh(srep, orientation);
+    for (vtkSRepSpokeMesh::IndexType i = 0; i < mesh->GetNumberOfSpokes(); ++i) {
+      all.push_back(SpokeHit{{orientation, i}, DistanceToSpoke(point, *mesh->At(i)), 0, 0});
+    }
+  }
+  std::sort(all.begin(), all.end(), [](const SpokeHit& a, const SpokeHit& b) { return a.Distance < b.Distance; });
+  return all;
+}
+
+}
+
+TEST(SpatialIndexTest, Empty) {
+  vtkNew<vtkSRepSpatialIndex> index;
+  SpokeHit hit;
+  EXPECT_FALSE(index->FindClosestSpoke(srep::Point3d(0, 0, 0), hit));
+  EXPECT_FALSE(index->FindClosestSkeletalPoint(srep::Point3d(0, 0, 0), hit));
+  EXPECT_FALSE(index->PickSpoke(srep::Point3d(0, 0, 0), srep::Vector3d(1, 0, 0), 1, hit));
+  EXPECT_TRUE(index->FindSpokesWithinRadius(srep::Point3d(0, 0, 0), 100).empty());
+
+  auto srep = vtkSmartPointer<vtkEllipticalSRep>::New();
+  index->SetSRep(srep);
+  EXPECT_FALSE(index->FindClosestSpoke(srep::Point3d(0, 0, 0), hit));
+  EXPECT_THROW(index->PickSpoke(srep::Point3d(0, 0, 0), srep::Vector3d(0, 0, 0), 1, hit), std::invalid_argument);
+}
+
+TEST(SpatialIndexTest, PointQueriesMatchBruteForce) {
+  const auto srep = MakeSRep(24, 6);
+  vtkNew<vtkSRepSpatialIndex> index;
+  index->SetSRep(srep);
+
+  Lcg random;
+  for (int q = 0; q < 50; ++q) {
+    const srep::Point3d point(12 * random.Next(), 12 * random.Next(), 4 * random.Next());
+    const auto expected = BruteForce(*srep, point);
+
+    SpokeHit hit;
+    ASSERT_TRUE(index->FindClosestSpoke(point, hit));
+    EXPECT_NEAR(expected.front().Distance, hit.Distance, 1e-9);
+    const auto* spoke = GetMesh(*srep, hit.Spoke.Orientation)->At(hit.Spoke.Index);
+    EXPECT_NEAR(hit.Distance, DistanceToSpoke(point, *spoke), 1e-9);
+    EXPECT_NEAR(hit.Distance, srep::Vector3d(spoke->GetSkeletalPoint() + spoke->GetDirection() * hit.SpokeParameter, point).GetLength(), 1e-9);
+
+    const double radius = 2.5;
+    const auto within = index->FindSpokesWithinRadius(point, radius);
+    const auto expectedCount = std::count_if(expected.begin(), expected.end(), [&](const SpokeHit& h) { return h.Distance <= radius; });
+    ASSERT_EQ(static_cast<size_t>(expectedCount), within.size());
+    for (size_t i = 0; i < within.size(); ++i) {
+      EXPECT_NEAR(expected[i].Distance, within[i].Distance, 1e-9);
+    }
+
+    ASSERT_TRUE(index->FindClosestSkeletalPoint(point, hit));
+    EXPECT_EQ(vtkSRepSkeletalPoint::UpOrientation, hit.Spoke.Orientation);
+    double closestSkeletalPoint = std::numeric_limits<double>::infinity();
+    for (vtkSRepSpokeMesh::IndexType i = 0; i < srep->GetUpSpokes()->GetNumberOfSpokes(); ++i) {
+      closestSkeletalPoint = std::min(closestSkeletalPoint, srep::Vector3d(srep->GetUpSpokes()->At(i)->GetSkeletalPoint(), point).GetLength());
+    }
+    EXPECT_NEAR(closestSkeletalPoint, hit.Distance, 1e-9);
+  }
+}
+
+TEST(SpatialIndexTest, RayAndSegmentQueries) {
+  auto srep = vtkSmartPointer<vtkEllipticalSRep>::New();
+  srep->Resize(4, 2);
+  // up spokes of the crest step are vertical segments at x = 0, 1, 2, 3 on the y = 0 plane.
+  // Using the crest step because some of the spine points are duplicates that aren't in the mesh.
+  for (vtkEllipticalSRep::IndexType l = 0; l < 4; ++l) {
+    for (vtkEllipticalSRep::IndexType s = 0; s < 2; ++s) {
+      auto* point = srep->GetSkeletalPoint(l, s);
+      const srep::Point3d base(l, 10 * (1 - s), 0);
+      point->GetUpSpoke()->SetSkeletalPointAndDirection(base, srep::Vector3d(0, 0, 1));
+      point->GetDownSpoke()->SetSkeletalPointAndDirection(base, srep::Vector3d(0, 0, -1));
+      if (point->IsCrest()) {
+        point->GetCrestSpoke()->SetSkeletalPointAndDirection(base, srep::Vector3d(0, 1, 0));
+      }
+    }
+  }
+  vtkNew<vtkSRepSpatialIndex> index;
+  index->SetSRep(srep);
+
+  // ray along x at z = 0.5 hits the spoke at x = 0 first
+  SpokeHit hit;
+  ASSERT_TRUE(index->PickSpoke(srep::Point3d(-5, 0, 0.5), srep::Vector3d(2, 0, 0), 0.1, hit));
+  EXPECT_EQ(vtkSRepSkeletalPoint::UpOrientation, hit.Spoke.Orientation);
+  EXPECT_EQ(srep::Point3d(0, 0, 0), srep->GetUpSpokes()->At(hit.Spoke.Index)->GetSkeletalPoint());
+  EXPECT_NEAR(5, hit.QueryParameter, 1e-9);
+  EXPECT_NEAR(0.5, hit.SpokeParameter, 1e-9);
+  EXPECT_NEAR(0, hit.Distance, 1e-9);
+
+  // same ray going the other way hits x = 3 first
+  ASSERT_TRUE(index->PickSpoke(srep::Point3d(5, 0, 0.5), srep::Vector3d(-1, 0, 0), 0.1, hit));
+  EXPECT_EQ(srep::Point3d(3, 0, 0), srep->GetUpSpokes()->At(hit.Spoke.Index)->GetSkeletalPoint());
+  EXPECT_NEAR(2, hit.QueryParameter, 1e-9);
+
+  // pointing away or passing outside of tolerance misses
+  EXPECT_FALSE(index->PickSpoke(srep::Point3d(5, 0, 0.5), srep::Vector3d(1, 0, 0), 0.1, hit));
+  EXPECT_FALSE(index->PickSpoke(srep::Point3d(-5, 0, 1.5), srep::Vector3d(1, 0, 0), 0.1, hit));
+
+  // segment across x = 0.5 .. 2.5 at z = 0.5 is within 0.6 of the up spokes at x = 1 and 2, and within 0.6
+  // of the spokes at 0 and 3 only at its ends
+  const auto near = index->FindSpokesNearSegment(srep::Point3d(0.5, 0, 0.5), srep::Point3d(2.5, 0, 0.5), 0.6);
+  std::vector<double> upXs;
+  for (const auto& h : near) {
+    if (h.Spoke.Orientation == vtkSRepSkeletalPoint::UpOrientation) {
+      upXs.push_back(srep->GetUpSpokes()->At(h.Spoke.Index)->GetSkeletalPoint().GetX());
+    }
+  }
+  std::sort(upXs.begin(), upXs.end());
+  EXPECT_EQ(std::vector<double>({0, 1, 2, 3}), upXs);
+  EXPECT_NEAR(0, near.front().Distance, 1e-9);
+
+  const auto tight = index->FindSpokesNearSegment(srep::Point3d(0.5, 0, 0.5), srep::Point3d(2.5, 0, 0.5), 0.1);
+  for (const auto& h : tight) {
+    EXPECT_EQ(vtkSRepSkeletalPoint::UpOrientation, h.Spoke.Orientation);
+  }
+  EXPECT_EQ(2u, tight.size());
+}
+
+TEST(SpatialIndexTest, RebuildsOnModified) {
+  const auto srep = MakeSRep(8, 3);
+  vtkNew<vtkSRepSpatialIndex> index;
+  index->SetSRep(srep);
+
+  const srep::Point3d farAway(100, 100, 100);
+  SpokeHit hit;
+  ASSERT_TRUE(index->FindClosestSpoke(farAway, hit));
+  EXPECT_GT(hit.Distance, 50);
+
+  srep->GetSkeletalPoint(3, 1)->GetDownSpoke()->SetSkeletalPointAndDirection(srep::Point3d(99, 99, 99), srep::Vector3d(1, 1, 1));
+  ASSERT_TRUE(index->FindClosestSpoke(farAway, hit));
+  EXPECT_NEAR(0, hit.Distance, 1e-9);
+  EXPECT_EQ(vtkSRepSkeletalPoint::DownOrientation, hit.Spoke.Orientation);
+  EXPECT_NEAR(1, hit.SpokeParameter, 1e-9);
+
+  index->SetSRep(MakeSRep(8, 3));
+  ASSERT_TRUE(index->FindClosestSpoke(farAway, hit));
+  EXPECT_GT(hit.Distance, 50);
+}
@@ -119,6 +119,10 @@ TEST(SpokeTest, SetGetSRepClasses) {
   const auto expectedDirection = srep::Vector3d(7, 8, 9).Unit() * srep::Vector3d(-1, -2, -3).GetLength();
   EXPECT_EQ(expectedDirection, spoke->GetDirection());
   EXPECT_EQ(srep::Point3d(1,2,3) + expectedDirection, spoke->GetBoundaryPoint());
+
+  spoke->SetSkeletalPointAndDirection(srep::Point3d(4,5,6), srep::Vector3d(1, 1, 1));
+  EXPECT_EQ(srep::Point3d(4,5,6), spoke->GetSkeletalPoint());
+  EXPECT_EQ(srep::Vector3d(1, 1, 1), spoke->GetDirection());
 }
 
 TEST(SpokeTest, SetGetVTKVector3d) {
@@ -172,6 +176,8 @@ TEST(SpokeTest, Observation) {
   EXPECT_EQ(6, obs.numCalls());
   spoke->SetDirectionAndMagnitude(vtkVector3d(6,6,7));
   EXPECT_EQ(7, obs.numCalls());
+  spoke->SetSkeletalPointAndDirection(srep::Point3d(1,2,3), srep::Vector3d(5,5,5));
+  EXPECT_EQ(8, obs.numCalls());
 
   // these shouldn't cause the modified
   spoke->GetRadius();
@@ -192,7 +198,7 @@ TEST(SpokeTest, Observation) {
   auto smartClone = spoke->SmartClone();
   EXPECT_NE(spoke, smartClone);
 
-  EXPECT_EQ(7, obs.numCalls());
+  EXPECT_EQ(8, obs.numCalls());
 }
 
 TEST(SpokeTest, PrintSelf) {
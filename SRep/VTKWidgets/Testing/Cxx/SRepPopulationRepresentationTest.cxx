@@ -0,0 +1,274 @@
+#include <gtest/gtest.h>
+#include <vtkCellData.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkSlicerSRepPopulationRepresentation.h>
+#include <vtkSRepExportPolyDataProperties.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkWindowToImageFilter.h>
+
+#include <array>
+
+#include "SRepUnitTestHelpers.h"
+
+using namespace srepUnitTestHelpers;
+using Properties = vtkSRepExportPolyDataProperties;
+
+namespace {
+
+/// Export properties that draw everything in one color.
+vtkSmartPointer<Properties> MakeProperties(unsigned char r, unsigned char g, unsigned char b) {
+  vtkNew<vtkUnsignedCharArray> colors;
+  colors->SetNumberOfComponents(3);
+  colors->SetNumberOfTuples(Properties::NumberOfTypes);
+  for (int i = 0; i < Properties::NumberOfTypes; ++i) {
+    colors->SetTypedTuple(i, std::array<unsigned char, 3>{{r, g, b}}.data());
+  }
+  auto properties = vtkSmartPointer<Properties>::New();
+  properties->SetSRepDataArray(colors);
+  return properties;
+}
+
+/// Expects every point and line of polyData to be the given color.
+void ExpectColor(vtkPolyData* polyData, unsigned char r, unsigned char g, unsigned char b) {
+  ASSERT_NE(nullptr, polyData);
+  for (auto* colors : {polyData->GetPointData()->GetScalars(), polyData->GetCellData()->GetScalars()}) {
+    ASSERT_NE(nullptr, colors);
+    ASSERT_EQ(3, colors->GetNumberOfComponents());
+    for (vtkIdType i = 0; i < colors->GetNumberOfTuples(); ++i) {
+      EXPECT_EQ(r, colors->GetComponent(i, 0));
+      EXPECT_EQ(g, colors->GetComponent(i, 1));
+      EXPECT_EQ(b, colors->GetComponent(i, 2));
+    }
+  }
+}
+
+/// Expects every point of polyData to be drawn with the given radius.
+void ExpectRadius(vtkPolyData* polyData, double radius) {
+  ASSERT_NE(nullptr, polyData);
+  auto* radii = polyData->GetPointData()->GetArray("SRepPopulationRadius");
+  ASSERT_NE(nullptr, radii);
+  ASSERT_EQ(polyData->GetNumberOfPoints(), radii->GetNumberOfTuples());
+  for (vtkIdType i = 0; i < radii->GetNumberOfTuples(); ++i) {
+    EXPECT_FLOAT_EQ(radius, radii->GetComponent(i, 0));
+  }
+}
+
+/// Number of pixels of each color, everything else is background.
+struct PixelCounts {
+  int red = 0;
+  int green = 0;
+  int other = 0;
+};
+
+/// Draws a representation in an offscreen window on a black background.
+class OffscreenView {
+public:
+  OffscreenView() {
+    this->Window->SetOffScreenRendering(1);
+    this->Window->SetMultiSamples(0);
+    this->Window->SetSize(200, 200);
+    this->Window->AddRenderer(this->Renderer);
+    this->Renderer->SetBackground(0, 0, 0);
+    this->Renderer->AddViewProp(this->Representation);
+  }
+
+  PixelCounts Render() {
+    vtkNew<vtkWindowToImageFilter> capture;
+    capture->SetInput(this->Window);
+    capture->ReadFrontBufferOff();
+    capture->Update();
+    auto* pixels = capture->GetOutput()->GetPointData()->GetScalars();
+
+    // the points are shaded, but shading never mixes in another color
+    PixelCounts counts;
+    for (vtkIdType i = 0; i < pixels->GetNumberOfTuples(); ++i) {
+      const auto r = pixels->GetComponent(i, 0);
+      const auto g = pixels->GetComponent(i, 1);
+      const auto b = pixels->GetComponent(i, 2);
+      if (r > 0 && g == 0 && b == 0) {
+        ++counts.red;
+      } else if (g > 0 && r == 0 && b == 0) {
+        ++counts.green;
+      } else if (r > 0 || g > 0 || b > 0) {
+        ++counts.other;
+      }
+    }
+    return counts;
+  }
+
+  vtkNew<vtkSlicerSRepPopulationRepresentation> Representation;
+  vtkNew<vtkRenderer> Renderer;
+  vtkNew<vtkRenderWindow> Window;
+};
+
+} // namespace
+
+TEST(SRepPopulationRepresentation, Members) {
+  vtkNew<vtkSlicerSRepPopulationRepresentation> representation;
+  vtkNew<vtkObject> a;
+  vtkNew<vtkObject> b;
+  const auto srep = MakeEllipsoidSRep(8, 4);
+  const auto properties = MakeProperties(255, 0, 0);
+
+  representation->SetMember(a, srep, *properties, 0.1, true);
+  representation->SetMember(b, nullptr, *properties, 0.1, true);
+  EXPECT_EQ(2u, representation->GetNumberOfMembers());
+  EXPECT_TRUE(representation->HasMember(a));
+  EXPECT_NE(nullptr, representation->GetMemberPolyData(a));
+  // nothing to draw
+  EXPECT_TRUE(representation->HasMember(b));
+  EXPECT_EQ(nullptr, representation->GetMemberPolyData(b));
+
+  representation->RemoveMember(a);
+  EXPECT_FALSE(representation->HasMember(a));
+  EXPECT_EQ(nullptr, representation->GetMemberPolyData(a));
+  EXPECT_FALSE(representation->GetMemberVisibility(a));
+  EXPECT_EQ(1u, representation->GetNumberOfMembers());
+
+  representation->RemoveAllMembers();
+  EXPECT_EQ(0u, representation->GetNumberOfMembers());
+  EXPECT_EQ(nullptr, representation->GetBounds());
+}
+
+TEST(SRepPopulationRepresentation, MemberVisibility) {
+  OffscreenView view;
+  auto* representation = view.Representation.GetPointer();
+  vtkNew<vtkObject> red;
+  vtkNew<vtkObject> green;
+  const auto smallSRep = MakeEllipsoidSRep(8, 4);
+  const auto largeSRep = MakeEllipsoidSRep(8, 4, 6.0, 4.0, 2.0);
+  representation->SetMember(red, smallSRep, *MakeProperties(255, 0, 0), 0.1, true);
+  representation->SetMember(green, largeSRep, *MakeProperties(0, 255, 0), 0.1, true);
+  view.Renderer->ResetCamera();
+
+  auto counts = view.Render();
+  EXPECT_GT(counts.red, 0);
+  EXPECT_GT(counts.green, 0);
+
+  representation->SetMemberVisibility(red, false);
+  EXPECT_FALSE(representation->GetMemberVisibility(red));
+  EXPECT_TRUE(representation->GetMemberVisibility(green));
+  counts = view.Render();
+  EXPECT_EQ(0, counts.red);
+  EXPECT_GT(counts.green, 0);
+
+  representation->SetMemberVisibility(red, true);
+  representation->SetMemberVisibility(green, false);
+  counts = view.Render();
+  EXPECT_GT(counts.red, 0);
+  EXPECT_EQ(0, counts.green);
+
+  // SetMember sets the visibility too
+  representation->SetMember(red, smallSRep, *MakeProperties(255, 0, 0), 0.1, false);
+  counts = view.Render();
+  EXPECT_EQ(0, counts.red + counts.green + counts.other);
+
+  // nothing visible, nothing to fit the camera to
+  EXPECT_EQ(nullptr, representation->GetBounds());
+}
+
+TEST(SRepPopulationRepresentation, MemberColor) {
+  OffscreenView view;
+  auto* representation = view.Representation.GetPointer();
+  vtkNew<vtkObject> member;
+  const auto srep = MakeEllipsoidSRep(8, 4);
+
+  representation->SetMember(member, srep, *MakeProperties(255, 0, 0), 0.1, true);
+  ExpectColor(representation->GetMemberPolyData(member), 255, 0, 0);
+  view.Renderer->ResetCamera();
+  auto counts = view.Render();
+  EXPECT_GT(counts.red, 0);
+  EXPECT_EQ(0, counts.green);
+
+  // a new color exports again, even with the same srep
+  representation->SetMember(member, srep, *MakeProperties(0, 255, 0), 0.1, true);
+  ExpectColor(representation->GetMemberPolyData(member), 0, 255, 0);
+  counts = view.Render();
+  EXPECT_EQ(0, counts.red);
+  EXPECT_GT(counts.green, 0);
+}
+
+TEST(SRepPopulationRepresentation, MemberRadius) {
+  OffscreenView view;
+  auto* representation = view.Representation.GetPointer();
+  vtkNew<vtkObject> member;
+  const auto srep = MakeEllipsoidSRep(8, 4);
+  const auto properties = MakeProperties(255, 0, 0);
+
+  representation->SetMember(member, srep, *properties, 0.05, true);
+  const vtkSmartPointer<vtkPolyData> exported = representation->GetMemberPolyData(member);
+  ExpectRadius(exported, 0.05);
+  view.Renderer->ResetCamera();
+  const auto smallCounts = view.Render();
+
+  // the radius is only an array on the same poly data, and the points are drawn bigger
+  representation->SetMember(member, srep, *properties, 0.2, true);
+  EXPECT_EQ(exported.GetPointer(), representation->GetMemberPolyData(member));
+  ExpectRadius(exported, 0.2);
+  const auto largeCounts = view.Render();
+  EXPECT_GT(largeCounts.red, smallCounts.red);
+
+  // the bounds include the radius
+  double srepBounds[6];
+  exported->GetBounds(srepBounds);
+  const double* bounds = representation->GetBounds();
+  ASSERT_NE(nullptr, bounds);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NEAR(srepBounds[2 * i] - 0.2, bounds[2 * i], 1e-6);
+    EXPECT_NEAR(srepBounds[2 * i + 1] + 0.2, bounds[2 * i + 1], 1e-6);
+  }
+}
+
+TEST(SRepPopulationRepresentation, UnchangedMemberNotExportedAgain) {
+  OffscreenView view;
+  auto* representation = view.Representation.GetPointer();
+  vtkNew<vtkObject> a;
+  vtkNew<vtkObject> b;
+  const auto srepA = MakeEllipsoidSRep(8, 4);
+  const auto srepB = MakeEllipsoidSRep(8, 4, 6.0, 4.0, 2.0);
+  const auto properties = MakeProperties(255, 0, 0);
+
+  representation->SetMember(a, srepA, *properties, 0.1, true);
+  representation->SetMember(b, srepB, *properties, 0.1, true);
+  view.Renderer->ResetCamera();
+  view.Render();
+
+  // held on to so a new export can't reuse the address
+  const vtkSmartPointer<vtkPolyData> exportedA = representation->GetMemberPolyData(a);
+  const vtkSmartPointer<vtkPolyData> exportedB = representation->GetMemberPolyData(b);
+  ASSERT_NE(nullptr, exportedA.GetPointer());
+  ASSERT_NE(nullptr, exportedB.GetPointer());
+  const auto mtimeA = exportedA->GetMTime();
+
+  // the same arguments again, including equal but different properties
+  representation->SetMember(a, srepA, *properties, 0.1, true);
+  representation->SetMember(a, srepA, *MakeProperties(255, 0, 0), 0.1, true);
+  EXPECT_EQ(exportedA.GetPointer(), representation->GetMemberPolyData(a));
+  EXPECT_EQ(mtimeA, exportedA->GetMTime());
+
+  // changing or hiding another member leaves this one alone
+  representation->SetMember(b, srepB, *MakeProperties(0, 255, 0), 0.3, true);
+  representation->SetMemberVisibility(b, false);
+  view.Render();
+  EXPECT_NE(exportedB.GetPointer(), representation->GetMemberPolyData(b));
+  EXPECT_EQ(exportedA.GetPointer(), representation->GetMemberPolyData(a));
+  EXPECT_EQ(mtimeA, exportedA->GetMTime());
+
+  // hiding and showing this one doesn't touch its geometry
+  representation->SetMemberVisibility(a, false);
+  representation->SetMemberVisibility(a, true);
+  EXPECT_EQ(exportedA.GetPointer(), representation->GetMemberPolyData(a));
+  EXPECT_EQ(mtimeA, exportedA->GetMTime());
+
+  // modifying the srep in place exports again
+  srepA->GetSkeletalPoint(0, 0)->GetUpSpoke()->SetDirectionAndMagnitude(srep::Vector3d(0, 0, 2));
+  representation->SetMember(a, srepA, *properties, 0.1, true);
+  EXPECT_NE(exportedA.GetPointer(), representation->GetMemberPolyData(a));
+  ExpectColor(representation->GetMemberPolyData(a), 255, 0, 0);
+  ExpectRadius(representation->GetMemberPolyData(a), 0.1);
+}
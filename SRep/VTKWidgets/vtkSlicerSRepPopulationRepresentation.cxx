@@ -0,0 +1,350 @@
+#include "vtkSlicerSRepPopulationRepresentation.h"
+#include "vtkSlicerSRepLogic.h"
+
+#include <vtkActor.h>
+#include <vtkCompositeDataDisplayAttributes.h>
+#include <vtkCompositePolyDataMapper2.h>
+#include <vtkFloatArray.h>
+#include <vtkGlyph3DMapper.h>
+#include <vtkMath.h>
+#include <vtkMultiBlockDataSet.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkProperty.h>
+#include <vtkSphereSource.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+  // per point radius of each member, used as the glyph scale
+  const char* const RadiusArrayName = "SRepPopulationRadius";
+}
+
+vtkStandardNewMacro(vtkSlicerSRepPopulationRepresentation);
+
+//----------------------------------------------------------------------
+vtkSlicerSRepPopulationRepresentation::ExportKey::ExportKey()
+  : Includes{}
+  , Colors()
+{}
+
+//----------------------------------------------------------------------
+vtkSlicerSRepPopulationRepresentation::ExportKey::ExportKey(const vtkSRepExportPolyDataProperties& properties)
+  : Includes{{
+      properties.GetIncludeUpSpokes(),
+      properties.GetIncludeDownSpokes(),
+      properties.GetIncludeCrestSpokes(),
+      properties.GetIncludeCrestCurve(),
+      properties.GetIncludeSkeletalSheet(),
+      properties.GetIncludeSkeletonToCrestConnection(),
+      properties.GetIncludeSpine()}}
+  , Colors()
+{
+  const auto colors = properties.GetSRepDataArray();
+  if (colors) {
+    const auto numberOfValues = colors->GetNumberOfTuples() * colors->GetNumberOfComponents();
+    this->Colors.reserve(numberOfValues);
+    for (vtkIdType i = 0; i < colors->GetNumberOfTuples(); ++i) {
+      for (int c = 0; c < colors->GetNumberOfComponents(); ++c) {
+        this->Colors.push_back(colors->GetComponent(i, c));
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------
+bool vtkSlicerSRepPopulationRepresentation::ExportKey::operator==(const ExportKey& other) const {
+  return this->Includes == other.Includes && this->Colors == other.Colors;
+}
+
+//----------------------------------------------------------------------
+bool vtkSlicerSRepPopulationRepresentation::ExportKey::operator!=(const ExportKey& other) const {
+  return !(*this == other);
+}
+
+//----------------------------------------------------------------------
+vtkSlicerSRepPopulationRepresentation::vtkSlicerSRepPopulationRepresentation()
+  : Logic(vtkSmartPointer<vtkSlicerSRepLogic>::New())
+  , Blocks(vtkSmartPointer<vtkMultiBlockDataSet>::New())
+  , BlockAttributes(vtkSmartPointer<vtkCompositeDataDisplayAttributes>::New())
+  , GlyphSourceSphere(vtkSmartPointer<vtkSphereSource>::New())
+  , PointsMapper(vtkSmartPointer<vtkGlyph3DMapper>::New())
+  , PointsActor(vtkSmartPointer<vtkActor>::New())
+  , LinesMapper(vtkSmartPointer<vtkCompositePolyDataMapper2>::New())
+  , LinesActor(vtkSmartPointer<vtkActor>::New())
+  , Property(vtkSmartPointer<vtkProperty>::New())
+  , Members()
+  , FreeBlocks()
+{
+  vtkMath::UninitializeBounds(this->Bounds);
+
+  // radius 1 so the glyph scale is the radius. Low resolution, there can be a lot of these.
+  this->GlyphSourceSphere->SetRadius(1.0);
+  this->GlyphSourceSphere->SetThetaResolution(8);
+  this->GlyphSourceSphere->SetPhiResolution(6);
+
+  this->Property->SetRepresentationToSurface();
+  this->Property->SetAmbient(0.0);
+  this->Property->SetDiffuse(1.0);
+  this->Property->SetSpecular(0.0);
+  this->Property->SetShading(true);
+  this->Property->SetSpecularPower(1.0);
+  this->Property->SetLineWidth(1.0);
+  this->Property->SetOpacity(1.);
+
+  // the exported point and line scalars are the colors of each member
+  this->PointsMapper->SetInputDataObject(0, this->Blocks);
+  this->PointsMapper->SetSourceConnection(this->GlyphSourceSphere->GetOutputPort());
+  this->PointsMapper->SetBlockAttributes(this->BlockAttributes);
+  this->PointsMapper->OrientOff();
+  this->PointsMapper->ScalingOn();
+  this->PointsMapper->SetScaleModeToScaleByMagnitude();
+  this->PointsMapper->SetScaleArray(RadiusArrayName);
+  this->PointsMapper->ScalarVisibilityOn();
+  this->PointsMapper->SetScalarModeToUsePointData();
+  this->PointsMapper->SetColorModeToDirectScalars();
+
+  this->PointsActor->SetMapper(this->PointsMapper);
+  this->PointsActor->SetProperty(this->Property);
+
+  this->LinesMapper->SetInputDataObject(0, this->Blocks);
+  this->LinesMapper->SetCompositeDataDisplayAttributes(this->BlockAttributes);
+  this->LinesMapper->ScalarVisibilityOn();
+  this->LinesMapper->SetScalarModeToUseCellData();
+  this->LinesMapper->SetColorModeToDirectScalars();
+
+  this->LinesActor->SetMapper(this->LinesMapper);
+  this->LinesActor->SetProperty(this->Property);
+}
+
+//----------------------------------------------------------------------
+vtkSlicerSRepPopulationRepresentation::~vtkSlicerSRepPopulationRepresentation() = default;
+
+//----------------------------------------------------------------------
+void vtkSlicerSRepPopulationRepresentation::PrintSelf(ostream& os, vtkIndent indent) {
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfMembers: " << this->Members.size() << std::endl;
+}
+
+//----------------------------------------------------------------------
+void vtkSlicerSRepPopulationRepresentation::SetMember(
+  vtkObject* member,
+  const vtkMeshSRepInterface* srep,
+  const vtkSRepExportPolyDataProperties& properties,
+  double radius,
+  bool visible)
+{
+  if (!member) {
+    vtkErrorMacro("Can't add a null member");
+    return;
+  }
+
+  auto it = this->Members.find(member);
+  if (this->Members.end() == it) {
+    Member newMember{};
+    if (!this->FreeBlocks.empty()) {
+      newMember.Block = this->FreeBlocks.back();
+      this->FreeBlocks.pop_back();
+    } else {
+      newMember.Block = this->Blocks->GetNumberOfBlocks();
+      this->Blocks->SetNumberOfBlocks(newMember.Block + 1);
+    }
+    newMember.Radius = -1;
+    it = this->Members.emplace(member, std::move(newMember)).first;
+  }
+  auto& m = it->second;
+
+  bool changed = false;
+  const auto srepMTime = srep ? const_cast<vtkMeshSRepInterface*>(srep)->GetMTime() : 0;
+  ExportKey exportKey(properties);
+  if (m.SRep != srep || m.SRepMTime != srepMTime || m.Export != exportKey) {
+    if (m.PolyData) {
+      this->BlockAttributes->RemoveBlockVisibility(m.PolyData);
+    }
+    m.PolyData = (srep && !srep->IsEmpty()) ? this->Logic->SmartExportSRepToPolyData(*srep, properties) : nullptr;
+    m.SRep = const_cast<vtkMeshSRepInterface*>(srep);
+    m.SRepMTime = srepMTime;
+    m.Export = std::move(exportKey);
+    m.Radius = -1;
+    this->Blocks->SetBlock(m.Block, m.PolyData);
+    changed = true;
+  }
+
+  if (m.PolyData && m.Radius != radius) {
+    auto radii = vtkFloatArray::SafeDownCast(m.PolyData->GetPointData()->GetArray(RadiusArrayName));
+    if (!radii) {
+      auto newRadii = vtkSmartPointer<vtkFloatArray>::New();
+      newRadii->SetName(RadiusArrayName);
+      newRadii->SetNumberOfComponents(1);
+      m.PolyData->GetPointData()->AddArray(newRadii);
+      radii = newRadii;
+    }
+    radii->SetNumberOfTuples(m.PolyData->GetNumberOfPoints());
+    radii->Fill(radius);
+    radii->Modified();
+    changed = true;
+  }
+  m.Radius = radius;
+
+  if (changed) {
+    this->Blocks->Modified();
+    this->Modified();
+  }
+
+  m.Visible = visible;
+  this->UpdateBlockVisibility(m);
+}
+
+//----------------------------------------------------------------------
+void vtkSlicerSRepPopulationRepresentation::SetMemberVisibility(vtkObject* member, bool visible) {
+  auto it = this->Members.find(member);
+  if (this->Members.end() == it || it->second.Visible == visible) {
+    return;
+  }
+  it->second.Visible = visible;
+  this->UpdateBlockVisibility(it->second);
+}
+
+//----------------------------------------------------------------------
+void vtkSlicerSRepPopulationRepresentation::UpdateBlockVisibility(const Member& member) {
+  if (!member.PolyData) {
+    return;
+  }
+  if (this->BlockAttributes->HasBlockVisibility(member.PolyData)
+    && this->BlockAttributes->GetBlockVisibility(member.PolyData) == member.Visible)
+  {
+    return;
+  }
+  // only the attributes change, the mappers draw the same buffers with different ranges
+  this->BlockAttributes->SetBlockVisibility(member.PolyData, member.Visible);
+  this->BlockAttributes->Modified();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------
+void vtkSlicerSRepPopulationRepresentation::RemoveMember(vtkObject* member) {
+  auto it = this->Members.find(member);
+  if (this->Members.end() == it) {
+    return;
+  }
+  if (it->second.PolyData) {
+    this->BlockAttributes->RemoveBlockVisibility(it->second.PolyData);
+  }
+  this->Blocks->SetBlock(it->second.Block, nullptr);
+  this->FreeBlocks.push_back(it->second.Block);
+  this->Members.erase(it);
+  this->Blocks->Modified();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------
+bool vtkSlicerSRepPopulationRepresentation::HasMember(vtkObject* member) const {
+  return this->Members.count(member) > 0;
+}
+
+//----------------------------------------------------------------------
+vtkPolyData* vtkSlicerSRepPopulationRepresentation::GetMemberPolyData(vtkObject* member) const {
+  const auto it = this->Members.find(member);
+  return this->Members.end() == it ? nullptr : it->second.PolyData.GetPointer();
+}
+
+//----------------------------------------------------------------------
+bool vtkSlicerSRepPopulationRepresentation::GetMemberVisibility(vtkObject* member) const {
+  const auto it = this->Members.find(member);
+  return this->Members.end() != it && it->second.Visible;
+}
+
+//----------------------------------------------------------------------
+size_t vtkSlicerSRepPopulationRepresentation::GetNumberOfMembers() const {
+  return this->Members.size();
+}
+
+//----------------------------------------------------------------------
+void vtkSlicerSRepPopulationRepresentation::RemoveAllMembers() {
+  if (this->Members.empty() && this->FreeBlocks.empty()) {
+    return;
+  }
+  this->Members.clear();
+  this->FreeBlocks.clear();
+  this->BlockAttributes->RemoveBlockVisibilities();
+  this->Blocks->SetNumberOfBlocks(0);
+  this->Blocks->Modified();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------
+void vtkSlicerSRepPopulationRepresentation::SetLineWidth(double width) {
+  this->Property->SetLineWidth(width);
+}
+
+//----------------------------------------------------------------------
+double vtkSlicerSRepPopulationRepresentation::GetLineWidth() const {
+  return this->Property->GetLineWidth();
+}
+
+//----------------------------------------------------------------------
+void vtkSlicerSRepPopulationRepresentation::GetActors(vtkPropCollection* pc) {
+  this->PointsActor->GetActors(pc);
+  this->LinesActor->GetActors(pc);
+}
+void vtkSlicerSRepPopulationRepresentation::ReleaseGraphicsResources(vtkWindow* window) {
+  this->PointsActor->ReleaseGraphicsResources(window);
+  this->LinesActor->ReleaseGraphicsResources(window);
+}
+int vtkSlicerSRepPopulationRepresentation::RenderOverlay(vtkViewport* viewport) {
+  if (!this->GetVisibility() || this->Members.empty()) {
+    return 0;
+  }
+  return this->PointsActor->RenderOverlay(viewport) + this->LinesActor->RenderOverlay(viewport);
+}
+int vtkSlicerSRepPopulationRepresentation::RenderOpaqueGeometry(vtkViewport* viewport) {
+  if (!this->GetVisibility() || this->Members.empty()) {
+    return 0;
+  }
+  return this->PointsActor->RenderOpaqueGeometry(viewport) + this->LinesActor->RenderOpaqueGeometry(viewport);
+}
+int vtkSlicerSRepPopulationRepresentation::RenderTranslucentPolygonalGeometry(vtkViewport* viewport) {
+  if (!this->GetVisibility() || this->Members.empty()) {
+    return 0;
+  }
+
+  // The internal actors need to share property keys.
+  // This ensures the mapper state is consistent and allows depth peeling to work as expected.
+  this->PointsActor->SetPropertyKeys(this->GetPropertyKeys());
+  this->LinesActor->SetPropertyKeys(this->GetPropertyKeys());
+
+  return this->PointsActor->RenderTranslucentPolygonalGeometry(viewport)
+    + this->LinesActor->RenderTranslucentPolygonalGeometry(viewport);
+}
+vtkTypeBool vtkSlicerSRepPopulationRepresentation::HasTranslucentPolygonalGeometry() {
+  return this->PointsActor->HasTranslucentPolygonalGeometry() || this->LinesActor->HasTranslucentPolygonalGeometry();
+}
+
+//----------------------------------------------------------------------
+double *vtkSlicerSRepPopulationRepresentation::GetBounds() {
+  vtkMath::UninitializeBounds(this->Bounds);
+  bool initialized = false;
+  for (const auto& member : this->Members) {
+    const auto& m = member.second;
+    if (!m.Visible || !m.PolyData || m.PolyData->GetNumberOfPoints() == 0) {
+      continue;
+    }
+    double bounds[6];
+    m.PolyData->GetBounds(bounds);
+    for (int i = 0; i < 3; ++i) {
+      bounds[2 * i] -= m.Radius;
+      bounds[2 * i + 1] += m.Radius;
+      if (!initialized) {
+        this->Bounds[2 * i] = bounds[2 * i];
+        this->Bounds[2 * i + 1] = bounds[2 * i + 1];
+      } else {
+        this->Bounds[2 * i] = std::min(this->Bounds[2 * i], bounds[2 * i]);
+        this->Bounds[2 * i + 1] = std::max(this->Bounds[2 * i + 1], bounds[2 * i + 1]);
+      }
+    }
+    initialized = true;
+  }
+  return initialized ? this->Bounds : nullptr;
+}
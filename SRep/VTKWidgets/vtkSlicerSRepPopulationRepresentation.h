@@ -0,0 +1,129 @@
+#ifndef vtkSlicerSRepPopulationRepresentation_h
+#define vtkSlicerSRepPopulationRepresentation_h
+
+#include "vtkSlicerSRepModuleVTKWidgetsExport.h"
+
+#include "vtkMeshSRepInterface.h"
+#include "vtkSRepExportPolyDataProperties.h"
+
+#include <vtkProp.h>
+#include <vtkSmartPointer.h>
+
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+class vtkActor;
+class vtkCompositeDataDisplayAttributes;
+class vtkCompositePolyDataMapper2;
+class vtkGlyph3DMapper;
+class vtkMultiBlockDataSet;
+class vtkPolyData;
+class vtkProperty;
+class vtkSlicerSRepLogic;
+class vtkSphereSource;
+
+/// Draws many SReps at once, e.g. a cohort overlaid in one view.
+///
+/// Every member is exported to a block of one multiblock data set. All the points are drawn by a single
+/// vtkGlyph3DMapper and all the lines by a single vtkCompositePolyDataMapper2, so there are two actors no matter
+/// how many members there are. Each member keeps its own colors and point radius in its block's arrays, and its
+/// visibility in the shared block attributes, so changing one member never exports the others again and hiding or
+/// showing one doesn't touch any geometry at all. Lines are drawn as plain lines, there are no tubes.
+///
+/// This is a plain vtkProp, it can be added to any renderer, including an offscreen one.
+class VTK_SLICER_SREP_MODULE_VTKWIDGETS_EXPORT vtkSlicerSRepPopulationRepresentation
+  : public vtkProp
+{
+public:
+  static vtkSlicerSRepPopulationRepresentation *New();
+
+  /// Standard methods for instances of this class.
+  vtkTypeMacro(vtkSlicerSRepPopulationRepresentation, vtkProp);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Adds member, or updates it if it is already there.
+  ///
+  /// @param member Identifies the member, usually its display node. Not referenced.
+  /// @param srep The SRep to draw. Only exported again if it (or its modified time) changed since the last call.
+  /// @param properties What to export and the color of each type, as for vtkSlicerSRepLogic::SmartExportSRepToPolyData.
+  /// @param radius Radius of the points.
+  /// @param visible Whether to draw the member.
+  void SetMember(vtkObject* member, const vtkMeshSRepInterface* srep, const vtkSRepExportPolyDataProperties& properties, double radius, bool visible);
+  /// Shows or hides member without looking at its geometry.
+  void SetMemberVisibility(vtkObject* member, bool visible);
+  void RemoveMember(vtkObject* member);
+  bool HasMember(vtkObject* member) const;
+  /// The poly data member was last exported to, nullptr if member isn't here or has nothing to draw.
+  /// Owned by this representation and must not be modified.
+  vtkPolyData* GetMemberPolyData(vtkObject* member) const;
+  /// \returns false if member isn't here.
+  bool GetMemberVisibility(vtkObject* member) const;
+  size_t GetNumberOfMembers() const;
+  void RemoveAllMembers();
+
+  /// Width of the lines, in pixels.
+  void SetLineWidth(double width);
+  double GetLineWidth() const;
+
+  /// Methods to make this class behave as a vtkProp.
+  void GetActors(vtkPropCollection*) override;
+  void ReleaseGraphicsResources(vtkWindow*) override;
+  int RenderOverlay(vtkViewport* viewport) override;
+  int RenderOpaqueGeometry(vtkViewport* viewport) override;
+  int RenderTranslucentPolygonalGeometry(vtkViewport* viewport) override;
+  vtkTypeBool HasTranslucentPolygonalGeometry() override;
+  double *GetBounds() override;
+
+protected:
+  vtkSlicerSRepPopulationRepresentation();
+  ~vtkSlicerSRepPopulationRepresentation() override;
+
+private:
+  vtkSlicerSRepPopulationRepresentation(const vtkSlicerSRepPopulationRepresentation&) = delete;
+  vtkSlicerSRepPopulationRepresentation& operator=(const vtkSlicerSRepPopulationRepresentation&) = delete;
+  vtkSlicerSRepPopulationRepresentation(vtkSlicerSRepPopulationRepresentation&&) = delete;
+  vtkSlicerSRepPopulationRepresentation& operator=(vtkSlicerSRepPopulationRepresentation&&) = delete;
+
+  /// Everything from the export properties that changes the exported poly data.
+  struct ExportKey {
+    std::array<bool, 7> Includes;
+    std::vector<double> Colors;
+
+    ExportKey();
+    explicit ExportKey(const vtkSRepExportPolyDataProperties& properties);
+    bool operator==(const ExportKey& other) const;
+    bool operator!=(const ExportKey& other) const;
+  };
+
+  struct Member {
+    unsigned int Block;
+    vtkSmartPointer<vtkPolyData> PolyData;
+    // What PolyData was last exported from
+    vtkSmartPointer<vtkMeshSRepInterface> SRep; // never modified, the const_cast is only so it can be reference counted
+    vtkMTimeType SRepMTime;
+    ExportKey Export;
+    double Radius;
+    bool Visible;
+  };
+
+  /// Sets the visibility of a member's block in the shared attributes. An empty block is never visible.
+  void UpdateBlockVisibility(const Member& member);
+
+  vtkSmartPointer<vtkSlicerSRepLogic>                 Logic;
+  vtkSmartPointer<vtkMultiBlockDataSet>               Blocks;
+  vtkSmartPointer<vtkCompositeDataDisplayAttributes>  BlockAttributes;
+  vtkSmartPointer<vtkSphereSource>                    GlyphSourceSphere;
+  vtkSmartPointer<vtkGlyph3DMapper>                   PointsMapper;
+  vtkSmartPointer<vtkActor>                           PointsActor;
+  vtkSmartPointer<vtkCompositePolyDataMapper2>        LinesMapper;
+  vtkSmartPointer<vtkActor>                           LinesActor;
+  vtkSmartPointer<vtkProperty>                        Property;
+
+  std::unordered_map<vtkObject*, Member> Members;
+  /// Blocks of removed members, reused before the multiblock grows.
+  std::vector<unsigned int> FreeBlocks;
+  double Bounds[6];
+};
+
+#endif
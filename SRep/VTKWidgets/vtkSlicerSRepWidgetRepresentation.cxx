@@ -6,6 +6,7 @@
 #include <vtkCellData.h>
 #include <vtkDoubleArray.h>
 #include <vtkGlyph3D.h>
+#include <vtkLookupTable.h>
 #include <vtkNamedColors.h>
 #include <vtkNew.h>
 #include <vtkPointData.h>
@@ -14,16 +15,21 @@
 #include <vtkPolyDataMapper.h>
 #include <vtkPolyLine.h>
 #include <vtkProperty.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
 #include <vtkSphereSource.h>
 #include <vtkTubeFilter.h>
 #include <vtkType.h>
 #include <vtkUnsignedCharArray.h>
+#include <vtkViewport.h>
 
 #include <vtkMRMLFolderDisplayNode.h>
 
 #include <algorithm>
 #include <functional>
 #include <iterator>
+#include <numeric>
+#include <utility>
 
 vtkStandardNewMacro(vtkSlicerSRepWidgetRepresentation);
 
@@ -37,7 +43,32 @@ vtkSlicerSRepWidgetRepresentation::PointsRep::PointsRep()
   , TubeFilter(vtkSmartPointer<vtkTubeFilter>::New())
   , TubeMapper(vtkSmartPointer<vtkPolyDataMapper>::New())
   , TubeActor(vtkSmartPointer<vtkActor>::New())
+  , LowDetailLinesMapper(vtkSmartPointer<vtkPolyDataMapper>::New())
+  , LowDetailLinesActor(vtkSmartPointer<vtkActor>::New())
+  , LowDetailPointsProperty(vtkSmartPointer<vtkProperty>::New())
+  , LowDetailPointsMapper(vtkSmartPointer<vtkPolyDataMapper>::New())
+  , LowDetailPointsActor(vtkSmartPointer<vtkActor>::New())
+  , TypeScalars(vtkSmartPointer<vtkUnsignedCharArray>::New())
+  , Colors(vtkSmartPointer<vtkLookupTable>::New())
+  , Logic(vtkSmartPointer<vtkSlicerSRepLogic>::New())
+  , SRep(nullptr)
+  , SRepMTime(0)
+  , Topology()
+  , Diagonal(0)
 {
+  this->TypeScalars->SetNumberOfComponents(1);
+  this->TypeScalars->SetNumberOfTuples(vtkSRepExportPolyDataProperties::NumberOfTypes);
+  for (int i = 0; i < vtkSRepExportPolyDataProperties::NumberOfTypes; ++i) {
+    this->TypeScalars->SetValue(i, static_cast<unsigned char>(i));
+  }
+
+  // one table value per type, with the range set so type i maps exactly to table value i
+  this->Colors->SetNumberOfTableValues(vtkSRepExportPolyDataProperties::NumberOfTypes);
+  this->Colors->SetTableRange(-0.5, vtkSRepExportPolyDataProperties::NumberOfTypes - 0.5);
+  for (int i = 0; i < vtkSRepExportPolyDataProperties::NumberOfTypes; ++i) {
+    this->Colors->SetTableValue(i, 1, 1, 1, 1);
+  }
+
   this->GlyphSourceSphere->SetRadius(0.5);
 
   this->Glypher->SetInputData(this->PointsPolyData);
@@ -63,7 +94,9 @@ vtkSlicerSRepWidgetRepresentation::PointsRep::PointsRep()
   this->Mapper->SetInputConnection(this->Glypher->GetOutputPort());
   this->Mapper->ScalarVisibilityOn();
   this->Mapper->SetScalarModeToUsePointData();
-  this->Mapper->SetColorModeToDirectScalars();
+  this->Mapper->SetColorModeToMapScalars();
+  this->Mapper->SetLookupTable(this->Colors);
+  this->Mapper->UseLookupTableScalarRangeOn();
 
   this->Actor->SetMapper(this->Mapper);
   this->Actor->SetProperty(this->Property);
@@ -76,10 +109,39 @@ vtkSlicerSRepWidgetRepresentation::PointsRep::PointsRep()
   this->TubeMapper->SetInputConnection(this->TubeFilter->GetOutputPort());
   this->TubeMapper->ScalarVisibilityOn();
   this->TubeMapper->SetScalarModeToUseCellData();
-  this->TubeMapper->SetColorModeToDirectScalars();
+  this->TubeMapper->SetColorModeToMapScalars();
+  this->TubeMapper->SetLookupTable(this->Colors);
+  this->TubeMapper->UseLookupTableScalarRangeOn();
 
   this->TubeActor->SetMapper(this->TubeMapper);
   this->TubeActor->SetProperty(this->Property);
+
+  this->LowDetailLinesMapper->SetInputData(this->PointsPolyData);
+  this->LowDetailLinesMapper->ScalarVisibilityOn();
+  this->LowDetailLinesMapper->SetScalarModeToUseCellData();
+  this->LowDetailLinesMapper->SetColorModeToMapScalars();
+  this->LowDetailLinesMapper->SetLookupTable(this->Colors);
+  this->LowDetailLinesMapper->UseLookupTableScalarRangeOn();
+
+  this->LowDetailLinesActor->SetMapper(this->LowDetailLinesMapper);
+  this->LowDetailLinesActor->SetProperty(this->Property);
+
+  // every exported point is on a line, so drawing the line vertices draws all the points
+  this->LowDetailPointsProperty->DeepCopy(this->Property);
+  this->LowDetailPointsProperty->SetRepresentationToPoints();
+  this->LowDetailPointsProperty->SetPointSize(5.0);
+
+  this->LowDetailPointsMapper->SetInputData(this->PointsPolyData);
+  this->LowDetailPointsMapper->ScalarVisibilityOn();
+  this->LowDetailPointsMapper->SetScalarModeToUsePointData();
+  this->LowDetailPointsMapper->SetColorModeToMapScalars();
+  this->LowDetailPointsMapper->SetLookupTable(this->Colors);
+  this->LowDetailPointsMapper->UseLookupTableScalarRangeOn();
+
+  this->LowDetailPointsActor->SetMapper(this->LowDetailPointsMapper);
+  this->LowDetailPointsActor->SetProperty(this->LowDetailPointsProperty);
+
+  this->SetLowDetail(false);
 }
 
 vtkSlicerSRepWidgetRepresentation::PointsRep::~PointsRep() = default;
@@ -88,6 +150,109 @@ void vtkSlicerSRepWidgetRepresentation::PointsRep::SetPolyData(vtkSmartPointer<v
   this->PointsPolyData = polyData;
   this->Glypher->SetInputData(this->PointsPolyData);
   this->TubeFilter->SetInputData(this->PointsPolyData);
+  this->LowDetailLinesMapper->SetInputData(this->PointsPolyData);
+  this->LowDetailPointsMapper->SetInputData(this->PointsPolyData);
+}
+
+void vtkSlicerSRepWidgetRepresentation::PointsRep::SetLowDetail(bool lowDetail) {
+  this->Actor->SetVisibility(!lowDetail);
+  this->TubeActor->SetVisibility(!lowDetail);
+  this->LowDetailLinesActor->SetVisibility(lowDetail);
+  this->LowDetailPointsActor->SetVisibility(lowDetail);
+}
+
+vtkIdType vtkSlicerSRepWidgetRepresentation::PointsRep::GetNumberOfSpokes() const {
+  return std::accumulate(this->Topology.NumberOfSpokes.begin(), this->Topology.NumberOfSpokes.end(), vtkIdType(0));
+}
+
+template <class F>
+void vtkSlicerSRepWidgetRepresentation::PointsRep::ForEachActor(F&& f) const {
+  f(this->Actor.Get());
+  f(this->TubeActor.Get());
+  f(this->LowDetailLinesActor.Get());
+  f(this->LowDetailPointsActor.Get());
+}
+
+void vtkSlicerSRepWidgetRepresentation::PointsRep::UpdateColors(vtkDataArray* colors) {
+  if (!colors || colors->GetNumberOfComponents() < 3) {
+    return;
+  }
+  const auto numberOfColors = std::min<vtkIdType>(colors->GetNumberOfTuples(), vtkSRepExportPolyDataProperties::NumberOfTypes);
+  for (vtkIdType i = 0; i < numberOfColors; ++i) {
+    double color[3];
+    for (int c = 0; c < 3; ++c) {
+      color[c] = colors->GetComponent(i, c) / 255.0;
+    }
+    double current[4];
+    this->Colors->GetTableValue(i, current);
+    if (current[0] != color[0] || current[1] != color[1] || current[2] != color[2]) {
+      this->Colors->SetTableValue(i, color[0], color[1], color[2], 1);
+    }
+  }
+}
+
+bool vtkSlicerSRepWidgetRepresentation::PointsRep::UpdateGeometry(const vtkMeshSRepInterface& srep, const vtkSRepExportPolyDataProperties& properties) {
+  const auto srepMTime = const_cast<vtkMeshSRepInterface&>(srep).GetMTime();
+  ExportTopology topology(srep, properties);
+  if (this->SRep == &srep && this->SRepMTime == srepMTime && this->Topology == topology) {
+    return false;
+  }
+
+  const bool updatedInPlace = this->Topology == topology
+    && this->PointsPolyData->GetNumberOfPoints() > 0
+    && this->Logic->UpdateExportedSRepPoints(srep, properties, *this->PointsPolyData);
+  if (!updatedInPlace) {
+    this->SetPolyData(this->Logic->SmartExportSRepToPolyData(srep, properties));
+  }
+
+  this->SRep = const_cast<vtkMeshSRepInterface*>(&srep);
+  this->SRepMTime = srepMTime;
+  this->Topology = std::move(topology);
+
+  this->PointsPolyData->ComputeBounds();
+  double bounds[6];
+  this->PointsPolyData->GetBounds(bounds);
+  const double minPoint[] = {bounds[0], bounds[2], bounds[4]};
+  const double maxPoint[] = {bounds[1], bounds[3], bounds[5]};
+  this->Diagonal = sqrt(vtkMath::Distance2BetweenPoints(minPoint, maxPoint));
+  return true;
+}
+
+vtkSlicerSRepWidgetRepresentation::ExportTopology::ExportTopology()
+  : Includes{}
+  , NumberOfSpokes{}
+{}
+
+vtkSlicerSRepWidgetRepresentation::ExportTopology::ExportTopology(const vtkMeshSRepInterface& srep, const vtkSRepExportPolyDataProperties& properties)
+  : Includes{{
+      properties.GetIncludeUpSpokes(),
+      properties.GetIncludeDownSpokes(),
+      properties.GetIncludeCrestSpokes(),
+      properties.GetIncludeCrestCurve(),
+      properties.GetIncludeSkeletalSheet(),
+      properties.GetIncludeSkeletonToCrestConnection(),
+      properties.GetIncludeSpine()}}
+  , NumberOfSpokes{{
+      srep.GetUpSpokes()->GetNumberOfSpokes(),
+      srep.GetDownSpokes()->GetNumberOfSpokes(),
+      srep.GetCrestSpokes()->GetNumberOfSpokes()}}
+  , UpSpine(srep.GetUpSpine())
+  , DownSpine(srep.GetDownSpine())
+  , CrestToUpSpokeConnections(srep.GetCrestToUpSpokeConnections())
+  , CrestToDownSpokeConnections(srep.GetCrestToDownSpokeConnections())
+{}
+
+bool vtkSlicerSRepWidgetRepresentation::ExportTopology::operator==(const ExportTopology& other) const {
+  return this->Includes == other.Includes
+    && this->NumberOfSpokes == other.NumberOfSpokes
+    && this->UpSpine == other.UpSpine
+    && this->DownSpine == other.DownSpine
+    && this->CrestToUpSpokeConnections == other.CrestToUpSpokeConnections
+    && this->CrestToDownSpokeConnections == other.CrestToDownSpokeConnections;
+}
+
+bool vtkSlicerSRepWidgetRepresentation::ExportTopology::operator!=(const ExportTopology& other) const {
+  return !(*this == other);
 }
 
 vtkSlicerSRepWidgetRepresentation::vtkSlicerSRepWidgetRepresentation()
@@ -102,31 +267,30 @@ void vtkSlicerSRepWidgetRepresentation::PrintSelf(ostream& os, vtkIndent indent)
 }
 
 void vtkSlicerSRepWidgetRepresentation::GetActors(vtkPropCollection* pc) {
-  this->Skeleton.Actor->GetActors(pc);
-  this->Skeleton.TubeActor->GetActors(pc);
+  this->Skeleton.ForEachActor([pc](vtkActor* actor) { actor->GetActors(pc); });
 }
 void vtkSlicerSRepWidgetRepresentation::ReleaseGraphicsResources(vtkWindow* window) {
-  this->Skeleton.Actor->ReleaseGraphicsResources(window);
-  this->Skeleton.TubeActor->ReleaseGraphicsResources(window);
+  this->Skeleton.ForEachActor([window](vtkActor* actor) { actor->ReleaseGraphicsResources(window); });
 }
 int vtkSlicerSRepWidgetRepresentation::RenderOverlay(vtkViewport* viewport) {
   int count = 0;
-  if (this->Skeleton.Actor->GetVisibility()) {
-    count += this->Skeleton.Actor->RenderOverlay(viewport);
-  }
-  if (this->Skeleton.TubeActor->GetVisibility()) {
-    count += this->Skeleton.TubeActor->RenderOverlay(viewport);
-  }
+  this->Skeleton.ForEachActor([viewport, &count](vtkActor* actor) {
+    if (actor->GetVisibility()) {
+      count += actor->RenderOverlay(viewport);
+    }
+  });
   return count;
 }
 int vtkSlicerSRepWidgetRepresentation::RenderOpaqueGeometry(vtkViewport* viewport) {
+  // the opaque pass comes first in every frame, so the level of detail picked here holds for the whole frame
+  this->UpdateLevelOfDetail(viewport);
+
   int count = 0;
-  if (this->Skeleton.Actor->GetVisibility()) {
-    count += this->Skeleton.Actor->RenderOpaqueGeometry(viewport);
-  }
-  if (this->Skeleton.TubeActor->GetVisibility()) {
-    count += this->Skeleton.TubeActor->RenderOpaqueGeometry(viewport);
-  }
+  this->Skeleton.ForEachActor([viewport, &count](vtkActor* actor) {
+    if (actor->GetVisibility()) {
+      count += actor->RenderOpaqueGeometry(viewport);
+    }
+  });
   return count;
 }
 int vtkSlicerSRepWidgetRepresentation::RenderTranslucentPolygonalGeometry(vtkViewport* viewport) {
@@ -134,25 +298,37 @@ int vtkSlicerSRepWidgetRepresentation::RenderTranslucentPolygonalGeometry(vtkVie
 
   // The internal actor needs to share property keys.
   // This ensures the mapper state is consistent and allows depth peeling to work as expected.
-  this->Skeleton.Actor->SetPropertyKeys(this->GetPropertyKeys());
-  this->Skeleton.TubeActor->SetPropertyKeys(this->GetPropertyKeys());
-
-  if (this->Skeleton.Actor->GetVisibility()) {
-    count += this->Skeleton.Actor->RenderTranslucentPolygonalGeometry(viewport);
-  }
-  if (this->Skeleton.TubeActor->GetVisibility()) {
-    count += this->Skeleton.TubeActor->RenderTranslucentPolygonalGeometry(viewport);
-  }
+  vtkInformation* propertyKeys = this->GetPropertyKeys();
+  this->Skeleton.ForEachActor([viewport, propertyKeys, &count](vtkActor* actor) {
+    actor->SetPropertyKeys(propertyKeys);
+    if (actor->GetVisibility()) {
+      count += actor->RenderTranslucentPolygonalGeometry(viewport);
+    }
+  });
   return count;
 }
 vtkTypeBool vtkSlicerSRepWidgetRepresentation::HasTranslucentPolygonalGeometry() {
-  if ((this->Skeleton.Actor->GetVisibility() && this->Skeleton.Actor->HasTranslucentPolygonalGeometry())
-    || (this->Skeleton.TubeActor->GetVisibility() && this->Skeleton.TubeActor->HasTranslucentPolygonalGeometry())
-  )
-  {
-    return true;
+  bool translucent = false;
+  this->Skeleton.ForEachActor([&translucent](vtkActor* actor) {
+    translucent = translucent || (actor->GetVisibility() && actor->HasTranslucentPolygonalGeometry());
+  });
+  return translucent;
+}
+
+void vtkSlicerSRepWidgetRepresentation::UpdateLevelOfDetail(vtkViewport* viewport) {
+  auto displayNode = this->GetSRepDisplayNode();
+  if (!displayNode) {
+    return;
   }
-  return false;
+
+  bool lowDetail = this->Skeleton.GetNumberOfSpokes() > displayNode->GetLowDetailSpokeThreshold();
+  if (!lowDetail && displayNode->GetLowDetailWhileInteracting()) {
+    // the interactor style raises the desired update rate of the window for as long as an interaction lasts
+    auto renderWindow = vtkRenderWindow::SafeDownCast(viewport ? viewport->GetVTKWindow() : nullptr);
+    auto interactor = renderWindow ? renderWindow->GetInteractor() : nullptr;
+    lowDetail = interactor && renderWindow->GetDesiredUpdateRate() > interactor->GetStillUpdateRate();
+  }
+  this->Skeleton.SetLowDetail(lowDetail);
 }
 
 double *vtkSlicerSRepWidgetRepresentation::GetBounds() {
@@ -191,28 +367,28 @@ void vtkSlicerSRepWidgetRepresentation::UpdateFromMRML(vtkMRMLNode* caller, unsi
 
   this->VisibilityOn();
 
-  auto logic = vtkSmartPointer<vtkSlicerSRepLogic>::New();
-  this->Skeleton.SetPolyData(logic->SmartExportSRepToPolyData(*srep, *displayNode->SmartGetSRepExportPolyDataProperties()));
+  // Each kind of change only touches what it has to: colors only change the lookup table, thickness only the
+  // glyph and tube radius (VTK setters ignore unchanged values), and opacity only the property. The
+  // geometry is only updated if the SRep or the visible parts changed.
+  auto properties = displayNode->SmartGetSRepExportPolyDataProperties();
+  this->Skeleton.UpdateColors(properties->GetSRepDataArray());
+  properties->SetSRepDataArray(this->Skeleton.TypeScalars);
+  this->Skeleton.UpdateGeometry(*srep, *properties);
 
   // set point size
-  double radius = 0;
-  if (displayNode->GetUseAbsoluteThickness()) {
-    radius = displayNode->GetAbsoluteThickness();
-  } else {
-    this->Skeleton.PointsPolyData->ComputeBounds();
-    double bounds[6];
-    this->Skeleton.PointsPolyData->GetBounds(bounds);
-
-    const double minPoint[] = {bounds[0], bounds[2], bounds[4]};
-    const double maxPoint[] = {bounds[1], bounds[3], bounds[5]};
-    const double dist = sqrt(vtkMath::Distance2BetweenPoints(minPoint, maxPoint));
-    radius = dist * displayNode->GetRelativeThickness();
-  }
+  const double radius = displayNode->GetUseAbsoluteThickness()
+    ? displayNode->GetAbsoluteThickness()
+    : this->Skeleton.Diagonal * displayNode->GetRelativeThickness();
 
   this->Skeleton.GlyphSourceSphere->SetRadius(radius);
   this->Skeleton.TubeFilter->SetRadius(radius);
 
+  this->Skeleton.GlyphSourceSphere->SetThetaResolution(displayNode->GetSphereResolution());
+  this->Skeleton.GlyphSourceSphere->SetPhiResolution(displayNode->GetSphereResolution());
+  this->Skeleton.TubeFilter->SetNumberOfSides(displayNode->GetTubeResolution());
+
   this->Skeleton.Property->SetOpacity(displayNode->GetOpacity());
+  this->Skeleton.LowDetailPointsProperty->SetOpacity(displayNode->GetOpacity());
 }
 
 void vtkSlicerSRepWidgetRepresentation::SetSRepDisplayNode(vtkMRMLSRepDisplayNode* srepDisplayNode) {
@@ -230,17 +406,22 @@ vtkMRMLSRepNode* vtkSlicerSRepWidgetRepresentation::GetSRepNode() {
 
 bool vtkSlicerSRepWidgetRepresentation::IsDisplayable()
 {
-  if (!this->SRepDisplayNode
-    || !this->ViewNode
-    || !this->SRepDisplayNode->GetVisibility()
-    || !this->SRepDisplayNode->IsDisplayableInView(this->ViewNode->GetID()))
+  return IsDisplayable(this->SRepDisplayNode, this->ViewNode);
+}
+
+bool vtkSlicerSRepWidgetRepresentation::IsDisplayable(vtkMRMLSRepDisplayNode* srepDisplayNode, vtkMRMLAbstractViewNode* viewNode)
+{
+  if (!srepDisplayNode
+    || !viewNode
+    || !srepDisplayNode->GetVisibility()
+    || !srepDisplayNode->IsDisplayableInView(viewNode->GetID()))
   {
     return false;
   }
 
   // If parent folder visibility is set to false then the srep is not visible
-  if (this->SRepDisplayNode->GetFolderDisplayOverrideAllowed()) {
-    vtkMRMLDisplayableNode* displayableNode = this->SRepDisplayNode->GetDisplayableNode();
+  if (srepDisplayNode->GetFolderDisplayOverrideAllowed()) {
+    vtkMRMLDisplayableNode* displayableNode = srepDisplayNode->GetDisplayableNode();
     // Visibility is applied regardless the fact whether there is override or not.
     // Visibility of items defined by hierarchy is off if any of the ancestors is explicitly hidden.
     // However, this does not apply on display nodes that do not allow overrides (FolderDisplayOverrideAllowed)
@@ -248,5 +429,5 @@ bool vtkSlicerSRepWidgetRepresentation::IsDisplayable()
       return false;
     }
   }
-  return this->SRepDisplayNode->GetVisibility3D();
+  return srepDisplayNode->GetVisibility3D();
 }
@@ -9,13 +9,19 @@
 
 #include <vtkSmartPointer.h>
 
+#include <array>
+#include <vector>
+
 class vtkActor;
 class vtkCellArray;
+class vtkDataArray;
 class vtkGlyph3D;
+class vtkLookupTable;
 class vtkPoints;
 class vtkPolyData;
 class vtkPolyDataMapper;
 class vtkProperty;
+class vtkSlicerSRepLogic;
 class vtkSphereSource;
 class vtkTubeFilter;
 class vtkUnsignedCharArray;
@@ -35,6 +41,8 @@ public:
   vtkMRMLSRepNode* GetSRepNode();
 
   bool IsDisplayable();
+  /// Whether srepDisplayNode should be drawn in viewNode, taking folder visibility into account.
+  static bool IsDisplayable(vtkMRMLSRepDisplayNode* srepDisplayNode, vtkMRMLAbstractViewNode* viewNode);
 
   /// Update the representation from srep node
   void UpdateFromMRML(vtkMRMLNode* caller, unsigned long event, void *callData = nullptr) override;
@@ -53,6 +61,22 @@ protected:
   ~vtkSlicerSRepWidgetRepresentation();
 
 private:
+  /// Everything that decides which points and lines get exported from an SRep. If this is
+  /// unchanged between two SReps, only the point coordinates of the exported poly data differ.
+  struct ExportTopology {
+      std::array<bool, 7> Includes;
+      std::array<vtkMeshSRepInterface::IndexType, 3> NumberOfSpokes;
+      std::vector<vtkMeshSRepInterface::IndexType> UpSpine;
+      std::vector<vtkMeshSRepInterface::IndexType> DownSpine;
+      std::vector<vtkMeshSRepInterface::IndexType> CrestToUpSpokeConnections;
+      std::vector<vtkMeshSRepInterface::IndexType> CrestToDownSpokeConnections;
+
+      ExportTopology();
+      ExportTopology(const vtkMeshSRepInterface& srep, const vtkSRepExportPolyDataProperties& properties);
+      bool operator==(const ExportTopology& other) const;
+      bool operator!=(const ExportTopology& other) const;
+  };
+
   struct PointsRep {
       vtkSmartPointer<vtkSphereSource>      GlyphSourceSphere;
       vtkSmartPointer<vtkGlyph3D>           Glypher;
@@ -65,11 +89,51 @@ private:
       vtkSmartPointer<vtkPolyDataMapper> TubeMapper;
       vtkSmartPointer<vtkActor>          TubeActor;
 
+      // Low detail: PointsPolyData drawn directly, once as lines and once as points
+      vtkSmartPointer<vtkPolyDataMapper> LowDetailLinesMapper;
+      vtkSmartPointer<vtkActor>          LowDetailLinesActor;
+      vtkSmartPointer<vtkProperty>       LowDetailPointsProperty;
+      vtkSmartPointer<vtkPolyDataMapper> LowDetailPointsMapper;
+      vtkSmartPointer<vtkActor>          LowDetailPointsActor;
+
+      // The poly data is exported with the type of each point/line as its scalars and the colors
+      // live in the lookup table, so a color change doesn't need a new export.
+      vtkSmartPointer<vtkUnsignedCharArray> TypeScalars;
+      vtkSmartPointer<vtkLookupTable>       Colors;
+
+      // What PointsPolyData was last exported from
+      vtkSmartPointer<vtkSlicerSRepLogic>   Logic;
+      vtkSmartPointer<vtkMeshSRepInterface> SRep; // never modified, the const_cast is only so it can be reference counted
+      vtkMTimeType                          SRepMTime;
+      ExportTopology                        Topology;
+      double                                Diagonal;
+
       PointsRep();
       ~PointsRep();
       void SetPolyData(vtkSmartPointer<vtkPolyData> polyData);
+
+      /// Sets the lookup table colors from a color per type. Only touches the table if a color changed.
+      void UpdateColors(vtkDataArray* colors);
+
+      /// Brings PointsPolyData up to date with srep, doing the least amount of work possible.
+      ///
+      /// Nothing happens if srep is unchanged since the last update, the points are rewritten in place
+      /// if only the spokes moved, and the poly data is only exported again if the topology changed.
+      /// \returns true if PointsPolyData changed.
+      bool UpdateGeometry(const vtkMeshSRepInterface& srep, const vtkSRepExportPolyDataProperties& properties);
+
+      /// Shows either the low detail actors or the glyph and tube actors.
+      void SetLowDetail(bool lowDetail);
+      /// Number of spokes in the SRep last passed to UpdateGeometry.
+      vtkIdType GetNumberOfSpokes() const;
+      /// Calls f on each actor.
+      template <class F>
+      void ForEachActor(F&& f) const;
   };
 
+  /// Picks the level of detail for the frame being rendered in viewport.
+  void UpdateLevelOfDetail(vtkViewport* viewport);
+
   PointsRep Skeleton;
   vtkMRMLSRepDisplayNode* SRepDisplayNode;
 };
@@ -88,7 +88,7 @@ qSlicerIO::IOFileType qSlicerSRepReader::fileType()const
 //-----------------------------------------------------------------------------
 QStringList qSlicerSRepReader::extensions()const
 {
-  return QStringList() << "SRep (*.srep.json)";
+  return QStringList() << "SRep (*.srep.json *.srep.bin)";
 }
 
 //-----------------------------------------------------------------------------
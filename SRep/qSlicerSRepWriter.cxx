@@ -49,7 +49,7 @@ qSlicerSRepWriter::~qSlicerSRepWriter() = default;
 //----------------------------------------------------------------------------
 QStringList qSlicerSRepWriter::extensions(vtkObject* vtkNotUsed(object))const
 {
-  return QStringList() << "SRep (*.srep.json)";
+  return QStringList() << "SRep (*.srep.json)" << "SRep Binary (*.srep.bin)";
 }
 
 //----------------------------------------------------------------------------
@@ -0,0 +1,141 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "FlowHistory.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr std::array<char, 8> Magic{{'S', 'R', 'E', 'P', 'F', 'L', 'W', '\0'}};
+constexpr uint32_t Version = 1;
+constexpr std::streamoff HeaderSize = 24;
+
+template <class T>
+void writeValue(std::fstream& file, const T& value) {
+  file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+}
+
+namespace srepcreator {
+
+//---------------------------------------------------------------------------
+FlowHistory::~FlowHistory() {
+  this->Clear();
+}
+
+//---------------------------------------------------------------------------
+void FlowHistory::Reset(std::vector<vtkIdType> pointIds, const std::string& spillFilePath) {
+  this->Clear();
+  this->PointIds = std::move(pointIds);
+  if (spillFilePath.empty()) {
+    return;
+  }
+
+  this->SpillFile.open(spillFilePath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!this->SpillFile) {
+    this->Clear();
+    throw std::runtime_error("Error creating flow history file: " + spillFilePath);
+  }
+  this->SpillFilePath = spillFilePath;
+  this->SpillFile.write(Magic.data(), Magic.size());
+  writeValue(this->SpillFile, Version);
+  writeValue(this->SpillFile, uint32_t{0});
+  writeValue(this->SpillFile, static_cast<uint64_t>(this->PointIds.size()));
+  if (!this->SpillFile) {
+    this->Clear();
+    throw std::runtime_error("Error writing flow history file: " + spillFilePath);
+  }
+}
+
+//---------------------------------------------------------------------------
+void FlowHistory::Clear() {
+  if (this->SpillFile.is_open()) {
+    this->SpillFile.close();
+  }
+  this->SpillFile.clear();
+  if (!this->SpillFilePath.empty()) {
+    std::remove(this->SpillFilePath.c_str());
+    this->SpillFilePath.clear();
+  }
+  this->PointIds.clear();
+  this->NumberOfIterations = 0;
+  this->Coordinates.clear();
+  this->Coordinates.shrink_to_fit();
+}
+
+//---------------------------------------------------------------------------
+void FlowHistory::AppendIteration(vtkPoints& points) {
+  const auto floatsPerIteration = 3 * this->PointIds.size();
+  const auto begin = this->IsSpilling() ? 0 : this->NumberOfIterations * floatsPerIteration;
+  this->Coordinates.resize(begin + floatsPerIteration);
+
+  float* out = this->Coordinates.data() + begin;
+  double p[3];
+  for (const auto id : this->PointIds) {
+    if (id < 0 || id >= points.GetNumberOfPoints()) {
+      this->Coordinates.resize(begin);
+      throw std::invalid_argument("Flow history point id " + std::to_string(id) + " is not in the mesh");
+    }
+    points.GetPoint(id, p);
+    *out++ = static_cast<float>(p[0]);
+    *out++ = static_cast<float>(p[1]);
+    *out++ = static_cast<float>(p[2]);
+  }
+
+  if (this->IsSpilling()) {
+    // always appending, even after reading earlier iterations back
+    this->SpillFile.seekp(0, std::ios::end);
+    this->SpillFile.write(reinterpret_cast<const char*>(this->Coordinates.data()),
+      static_cast<std::streamsize>(floatsPerIteration * sizeof(float)));
+    if (!this->SpillFile) {
+      throw std::runtime_error("Error writing flow history file: " + this->SpillFilePath);
+    }
+  }
+  ++this->NumberOfIterations;
+}
+
+//---------------------------------------------------------------------------
+void FlowHistory::GetIteration(const size_t iteration, std::vector<float>& coordinates) {
+  if (iteration >= this->NumberOfIterations) {
+    throw std::out_of_range("Flow history has no iteration " + std::to_string(iteration));
+  }
+  const auto floatsPerIteration = 3 * this->PointIds.size();
+  coordinates.resize(floatsPerIteration);
+
+  if (!this->IsSpilling()) {
+    const auto begin = this->Coordinates.begin() + iteration * floatsPerIteration;
+    std::copy(begin, begin + floatsPerIteration, coordinates.begin());
+    return;
+  }
+
+  const auto bytesPerIteration = static_cast<std::streamoff>(floatsPerIteration * sizeof(float));
+  this->SpillFile.seekg(HeaderSize + static_cast<std::streamoff>(iteration) * bytesPerIteration);
+  this->SpillFile.read(reinterpret_cast<char*>(coordinates.data()), bytesPerIteration);
+  if (!this->SpillFile) {
+    this->SpillFile.clear();
+    throw std::runtime_error("Error reading flow history file: " + this->SpillFilePath);
+  }
+}
+
+}
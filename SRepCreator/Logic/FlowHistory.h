@@ -0,0 +1,92 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkSlicerSRepCreatorLogic_FlowHistory_h
+#define __vtkSlicerSRepCreatorLogic_FlowHistory_h
+
+#include <vtkPoints.h>
+#include <vtkType.h>
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "vtkSlicerSRepCreatorModuleLogicExport.h"
+
+namespace srepcreator {
+
+/// Where the same subset of mesh points was after every iteration of a flow.
+///
+/// Positions are stored as float32 x, y, z, iteration by iteration, so iteration i is the contiguous block
+/// of 3 * GetNumberOfPoints() floats starting at i * 3 * GetNumberOfPoints(). By default everything is kept
+/// in that one buffer. If a spill file is given the buffer is written there instead and only one iteration
+/// is in memory at a time, for flows too long or meshes too big to keep. The spill file is:
+///
+///   char[8]  magic, "SREPFLW\0"
+///   uint32   format version
+///   uint32   reserved, 0
+///   uint64   number of points per iteration
+///   float32  the buffer above
+///
+/// in native byte order. It is scratch space for this object only and is deleted by Clear and the destructor.
+class VTK_SLICER_SREPCREATOR_MODULE_LOGIC_EXPORT FlowHistory {
+public:
+  FlowHistory() = default;
+  ~FlowHistory();
+  FlowHistory(const FlowHistory&) = delete;
+  FlowHistory(FlowHistory&&) = delete;
+  FlowHistory& operator=(const FlowHistory&) = delete;
+  FlowHistory& operator=(FlowHistory&&) = delete;
+
+  /// Starts an empty history recording the points with the given ids, dropping any previous history.
+  ///
+  /// \param spillFilePath If not empty, iterations are stored in this file, replacing anything already
+  ///        there, instead of in memory.
+  /// \throws std::runtime_error if the spill file can't be created
+  void Reset(std::vector<vtkIdType> pointIds, const std::string& spillFilePath = "");
+
+  /// Drops the history and deletes the spill file, if any.
+  void Clear();
+
+  /// Records where the points are now as the next iteration.
+  /// \throws std::invalid_argument if points doesn't have every recorded id
+  /// \throws std::runtime_error if the spill file can't be written
+  void AppendIteration(vtkPoints& points);
+
+  size_t GetNumberOfIterations() const { return this->NumberOfIterations; }
+  size_t GetNumberOfPoints() const { return this->PointIds.size(); }
+  bool IsSpilling() const { return !this->SpillFilePath.empty(); }
+
+  /// Copies the x, y, z of every recorded point at iteration (0 is the first appended) into coordinates,
+  /// resizing it to 3 * GetNumberOfPoints().
+  /// \throws std::out_of_range if there is no such iteration
+  /// \throws std::runtime_error if the spill file can't be read
+  void GetIteration(size_t iteration, std::vector<float>& coordinates);
+
+private:
+  std::vector<vtkIdType> PointIds;
+  size_t NumberOfIterations = 0;
+  /// Every iteration when in memory, the last appended iteration when spilling.
+  std::vector<float> Coordinates;
+  std::string SpillFilePath;
+  std::fstream SpillFile;
+};
+
+}
+
+#endif
@@ -0,0 +1,402 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "MeanCurvatureFlow.h"
+
+#include <vtkCellArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkIdList.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkSMPTools.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+using Vec = std::array<double, 3>;
+
+//---------------------------------------------------------------------------
+Vec get(const double* positions, vtkIdType id) {
+  return Vec{positions[3 * id], positions[3 * id + 1], positions[3 * id + 2]};
+}
+
+//---------------------------------------------------------------------------
+Vec sub(const Vec& a, const Vec& b) {
+  return Vec{a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+//---------------------------------------------------------------------------
+double dot(const Vec& a, const Vec& b) {
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+//---------------------------------------------------------------------------
+Vec cross(const Vec& a, const Vec& b) {
+  return Vec{a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+}
+
+//---------------------------------------------------------------------------
+double* positionsOf(vtkPoints& points) {
+  return vtkDoubleArray::SafeDownCast(points.GetData())->GetPointer(0);
+}
+
+//---------------------------------------------------------------------------
+// Turns per point lists of ids into offsets and one flat array of values.
+void buildCompressed(
+  const std::vector<std::vector<vtkIdType>>& lists,
+  std::vector<vtkIdType>& offsets,
+  std::vector<vtkIdType>& values)
+{
+  offsets.assign(1, 0);
+  offsets.reserve(lists.size() + 1);
+  values.clear();
+  for (const auto& list : lists) {
+    values.insert(values.end(), list.begin(), list.end());
+    offsets.push_back(static_cast<vtkIdType>(values.size()));
+  }
+}
+
+} // namespace {}
+
+namespace srepcreator {
+
+//---------------------------------------------------------------------------
+MeanCurvatureFlow::MeanCurvatureFlow(vtkPolyData& mesh) {
+  const vtkIdType numberOfPoints = mesh.GetNumberOfPoints();
+  if (numberOfPoints == 0) {
+    throw std::invalid_argument("Cannot flow a mesh without points");
+  }
+
+  vtkNew<vtkIdList> cell;
+  if (auto* polys = mesh.GetPolys()) {
+    for (polys->InitTraversal(); polys->GetNextCell(cell);) {
+      for (vtkIdType i = 2; i < cell->GetNumberOfIds(); ++i) {
+        this->Triangles.insert(this->Triangles.end(), {cell->GetId(0), cell->GetId(i - 1), cell->GetId(i)});
+      }
+    }
+  }
+  if (auto* strips = mesh.GetStrips()) {
+    for (strips->InitTraversal(); strips->GetNextCell(cell);) {
+      for (vtkIdType i = 2; i < cell->GetNumberOfIds(); ++i) {
+        // every other triangle of a strip is wound the other way
+        if (i % 2 == 0) {
+          this->Triangles.insert(this->Triangles.end(), {cell->GetId(i - 2), cell->GetId(i - 1), cell->GetId(i)});
+        } else {
+          this->Triangles.insert(this->Triangles.end(), {cell->GetId(i - 1), cell->GetId(i - 2), cell->GetId(i)});
+        }
+      }
+    }
+  }
+  if (this->Triangles.empty()) {
+    throw std::invalid_argument("Cannot flow a mesh without triangles");
+  }
+
+  std::vector<std::vector<vtkIdType>> pointTriangles(numberOfPoints);
+  std::vector<std::vector<vtkIdType>> neighbors(numberOfPoints);
+  for (vtkIdType t = 0; t < static_cast<vtkIdType>(this->Triangles.size() / 3); ++t) {
+    for (int c = 0; c < 3; ++c) {
+      const auto id = this->Triangles[3 * t + c];
+      pointTriangles[id].push_back(t);
+      neighbors[id].push_back(this->Triangles[3 * t + (c + 1) % 3]);
+      neighbors[id].push_back(this->Triangles[3 * t + (c + 2) % 3]);
+    }
+  }
+  for (auto& n : neighbors) {
+    std::sort(n.begin(), n.end());
+    n.erase(std::unique(n.begin(), n.end()), n.end());
+  }
+  buildCompressed(pointTriangles, this->PointTriangleOffsets, this->PointTriangles);
+  buildCompressed(neighbors, this->NeighborOffsets, this->Neighbors);
+
+  // an edge only one triangle uses is on the boundary
+  std::vector<std::pair<vtkIdType, vtkIdType>> edges;
+  edges.reserve(this->Triangles.size());
+  for (size_t t = 0; t < this->Triangles.size(); t += 3) {
+    for (int c = 0; c < 3; ++c) {
+      edges.push_back(std::minmax(this->Triangles[t + c], this->Triangles[t + (c + 1) % 3]));
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  this->BoundaryPoints.assign(numberOfPoints, false);
+  for (size_t e = 0; e < edges.size();) {
+    size_t uses = 1;
+    while (e + uses < edges.size() && edges[e + uses] == edges[e]) {
+      ++uses;
+    }
+    if (uses == 1) {
+      this->BoundaryPoints[edges[e].first] = true;
+      this->BoundaryPoints[edges[e].second] = true;
+    }
+    e += uses;
+  }
+
+  // always double, whatever the mesh has, so the kernels can work on the raw array
+  this->Points = vtkSmartPointer<vtkPoints>::New();
+  this->Points->SetDataTypeToDouble();
+  this->Points->SetNumberOfPoints(numberOfPoints);
+  double p[3];
+  for (vtkIdType i = 0; i < numberOfPoints; ++i) {
+    mesh.GetPoint(i, p);
+    this->Points->SetPoint(i, p);
+  }
+  this->NextPositions.resize(3 * numberOfPoints);
+}
+
+//---------------------------------------------------------------------------
+vtkPoints* MeanCurvatureFlow::GetPoints() const {
+  return this->Points;
+}
+
+//---------------------------------------------------------------------------
+void MeanCurvatureFlow::Step(const double dt, const double smoothAmount) {
+  if (smoothAmount > 0) {
+    this->Smooth(smoothAmount);
+  }
+
+  const double* positions = positionsOf(*this->Points);
+  double* next = this->NextPositions.data();
+  const vtkIdType numberOfPoints = this->Points->GetNumberOfPoints();
+
+  // Each point gathers from its own triangles, so no two threads ever write the same point.
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType i = begin; i < end; ++i) {
+      Vec laplacian{0, 0, 0};
+      Vec normal{0, 0, 0};
+      double area = 0;
+      const auto x = get(positions, i);
+      for (auto t = this->PointTriangleOffsets[i]; t < this->PointTriangleOffsets[i + 1]; ++t) {
+        const auto* triangle = &this->Triangles[3 * this->PointTriangles[t]];
+        // j and k are the other two corners, in winding order after i
+        const int corner = triangle[0] == i ? 0 : (triangle[1] == i ? 1 : 2);
+        const auto xj = get(positions, triangle[(corner + 1) % 3]);
+        const auto xk = get(positions, triangle[(corner + 2) % 3]);
+
+        const auto ij = sub(xj, x);
+        const auto ik = sub(xk, x);
+        const auto faceNormal = cross(ij, ik); // length is twice the area
+        const double doubleArea = std::sqrt(dot(faceNormal, faceNormal));
+        if (doubleArea < 1e-300) {
+          continue;
+        }
+        normal = Vec{normal[0] + faceNormal[0], normal[1] + faceNormal[1], normal[2] + faceNormal[2]};
+        area += doubleArea / 6; // barycentric share
+
+        // cot of the angle at k weighs edge ij, cot of the angle at j weighs edge ik
+        const auto kj = sub(xj, xk);
+        const auto jk = sub(xk, xj);
+        const double cotK = dot(sub(x, xk), kj) / doubleArea;
+        const double cotJ = dot(sub(x, xj), jk) / doubleArea;
+        for (int d = 0; d < 3; ++d) {
+          laplacian[d] += cotK * ij[d] + cotJ * ik[d];
+        }
+      }
+
+      const double normalLength = std::sqrt(dot(normal, normal));
+      if (area <= 0 || normalLength <= 0) {
+        std::copy(positions + 3 * i, positions + 3 * i + 3, next + 3 * i);
+        continue;
+      }
+      // laplacian / 2A is 2Hn. The sign of H follows the normal, so H*n doesn't depend on winding.
+      const double meanCurvature = -dot(laplacian, normal) / (4 * area * normalLength);
+      for (int d = 0; d < 3; ++d) {
+        next[3 * i + d] = x[d] - dt * meanCurvature * normal[d] / normalLength;
+      }
+    }
+  });
+
+  std::copy(this->NextPositions.begin(), this->NextPositions.end(), positionsOf(*this->Points));
+  this->Points->Modified();
+}
+
+//---------------------------------------------------------------------------
+void MeanCurvatureFlow::StepSemiImplicit(const double dt, const double smoothAmount) {
+  if (smoothAmount > 0) {
+    this->Smooth(smoothAmount);
+  }
+  if (this->EdgeEntries.empty()) {
+    this->InitializeSemiImplicit();
+  }
+
+  double* positions = positionsOf(*this->Points);
+  const vtkIdType numberOfPoints = this->Points->GetNumberOfPoints();
+  double* values = this->System.valuePtr();
+  std::fill(values, values + this->System.nonZeros(), 0.0);
+
+  // first the edge weights, cot(alpha) / 2 + cot(beta) / 2, and the barycentric areas
+  std::vector<double> mass(numberOfPoints, 0.0);
+  for (size_t t = 0; t < this->Triangles.size() / 3; ++t) {
+    const auto* triangle = &this->Triangles[3 * t];
+    const std::array<Vec, 3> x{{get(positions, triangle[0]), get(positions, triangle[1]), get(positions, triangle[2])}};
+    const auto faceNormal = cross(sub(x[1], x[0]), sub(x[2], x[0]));
+    const double doubleArea = std::sqrt(dot(faceNormal, faceNormal));
+    if (doubleArea < 1e-300) {
+      continue;
+    }
+    for (int c = 0; c < 3; ++c) {
+      const double cot = dot(sub(x[(c + 1) % 3], x[c]), sub(x[(c + 2) % 3], x[c])) / doubleArea;
+      values[this->EdgeEntries[6 * t + 2 * c]] += cot / 2;
+      values[this->EdgeEntries[6 * t + 2 * c + 1]] += cot / 2;
+      mass[triangle[c]] += doubleArea / 6;
+    }
+  }
+
+  // then the weights become M - dt/2 L. Each column only touches its own entries.
+  const double halfDt = dt / 2;
+  const auto* outer = this->System.outerIndexPtr();
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType i = begin; i < end; ++i) {
+      double weightSum = 0;
+      for (auto k = outer[i]; k < outer[i + 1]; ++k) {
+        if (k != this->DiagonalEntries[i]) {
+          const double weight = std::max(values[k], 0.0);
+          weightSum += weight;
+          values[k] = -halfDt * weight;
+        }
+      }
+      // points not in any triangle have no mass, their row is just x' = x
+      values[this->DiagonalEntries[i]] = (mass[i] > 0 ? mass[i] : 1.0) + halfDt * weightSum;
+    }
+  });
+
+  this->Solver.factorize(this->System);
+  if (this->Solver.info() != Eigen::Success) {
+    throw std::runtime_error("Unable to factor the semi-implicit mean curvature flow system");
+  }
+
+  using Positions = Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>;
+  Positions massPositions(numberOfPoints, 3);
+  for (vtkIdType i = 0; i < numberOfPoints; ++i) {
+    for (int d = 0; d < 3; ++d) {
+      massPositions(i, d) = (mass[i] > 0 ? mass[i] : 1.0) * positions[3 * i + d];
+    }
+  }
+
+  const Positions next = this->Solver.solve(massPositions);
+  std::copy(next.data(), next.data() + next.size(), positions);
+  this->Points->Modified();
+}
+
+//---------------------------------------------------------------------------
+void MeanCurvatureFlow::InitializeSemiImplicit() {
+  const vtkIdType numberOfPoints = this->Points->GetNumberOfPoints();
+  std::vector<Eigen::Triplet<double>> entries;
+  entries.reserve(numberOfPoints + this->Neighbors.size());
+  for (vtkIdType i = 0; i < numberOfPoints; ++i) {
+    entries.emplace_back(i, i, 0.0);
+    for (auto n = this->NeighborOffsets[i]; n < this->NeighborOffsets[i + 1]; ++n) {
+      entries.emplace_back(this->Neighbors[n], i, 0.0);
+    }
+  }
+  this->System.resize(numberOfPoints, numberOfPoints);
+  this->System.setFromTriplets(entries.begin(), entries.end());
+  this->System.makeCompressed();
+
+  const auto* outer = this->System.outerIndexPtr();
+  const auto* inner = this->System.innerIndexPtr();
+  const auto entry = [&](const vtkIdType row, const vtkIdType column) {
+    return static_cast<Eigen::Index>(std::lower_bound(inner + outer[column], inner + outer[column + 1], row) - inner);
+  };
+  this->DiagonalEntries.resize(numberOfPoints);
+  for (vtkIdType i = 0; i < numberOfPoints; ++i) {
+    this->DiagonalEntries[i] = entry(i, i);
+  }
+  this->EdgeEntries.resize(2 * this->Triangles.size());
+  for (size_t t = 0; t < this->Triangles.size() / 3; ++t) {
+    const auto* triangle = &this->Triangles[3 * t];
+    for (int c = 0; c < 3; ++c) {
+      const auto a = triangle[(c + 1) % 3];
+      const auto b = triangle[(c + 2) % 3];
+      this->EdgeEntries[6 * t + 2 * c] = entry(a, b);
+      this->EdgeEntries[6 * t + 2 * c + 1] = entry(b, a);
+    }
+  }
+
+  this->Solver.analyzePattern(this->System);
+}
+
+//---------------------------------------------------------------------------
+void MeanCurvatureFlow::Smooth(const double smoothAmount) {
+  // Same filter as vtkWindowedSincPolyDataFilter with 20 iterations: a Hamming windowed sinc low pass of the
+  // umbrella operator, evaluated with the Chebyshev recurrence x[n+1] = 2 x[n] + L x[n] - x[n-1].
+  constexpr int numberOfIterations = 20;
+  const double thetaPassBand = std::acos(1.0 - 0.5 * std::min(smoothAmount, 2.0));
+  std::array<double, numberOfIterations + 1> weights;
+  double sum = 0;
+  for (int i = 0; i <= numberOfIterations; ++i) {
+    const double window = 0.54 + 0.46 * std::cos(i * vtkMath::Pi() / (numberOfIterations + 1));
+    const double sinc = i == 0 ? thetaPassBand / vtkMath::Pi() : 2 * std::sin(i * thetaPassBand) / (i * vtkMath::Pi());
+    weights[i] = window * sinc;
+    sum += weights[i];
+  }
+  // points that are all the same stay where they are
+  for (auto& w : weights) {
+    w /= sum;
+  }
+
+  const vtkIdType numberOfPoints = this->Points->GetNumberOfPoints();
+  const auto size = static_cast<size_t>(3 * numberOfPoints);
+  double* result = positionsOf(*this->Points);
+  std::vector<double> previous(result, result + size);
+  std::vector<double> current(size);
+  double* next = this->NextPositions.data();
+
+  // next = a * current + b * L(current) - c * previous, then result += weight * next
+  const auto iterate = [&](const double a, const double b, const double c, const double weight) {
+    vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+      for (vtkIdType i = begin; i < end; ++i) {
+        const auto first = this->NeighborOffsets[i];
+        const auto last = this->NeighborOffsets[i + 1];
+        Vec laplacian{0, 0, 0};
+        // boundary points get no laplacian, so every term of the filter is the point itself and it stays put
+        if (first != last && !this->BoundaryPoints[i]) {
+          for (auto n = first; n < last; ++n) {
+            const auto p = get(current.data(), this->Neighbors[n]);
+            laplacian = Vec{laplacian[0] + p[0], laplacian[1] + p[1], laplacian[2] + p[2]};
+          }
+          for (int d = 0; d < 3; ++d) {
+            laplacian[d] = laplacian[d] / (last - first) - current[3 * i + d];
+          }
+        }
+        for (int d = 0; d < 3; ++d) {
+          next[3 * i + d] = a * current[3 * i + d] + b * laplacian[d] - c * previous[3 * i + d];
+          result[3 * i + d] += weight * next[3 * i + d];
+        }
+      }
+    });
+  };
+
+  // x[0] is the points and x[1] = x[0] + L x[0] / 2
+  std::copy(previous.begin(), previous.end(), current.begin());
+  for (size_t i = 0; i < size; ++i) {
+    result[i] *= weights[0];
+  }
+  iterate(1.0, 0.5, 0.0, weights[1]);
+  std::copy(next, next + size, current.begin());
+  for (int n = 2; n <= numberOfIterations; ++n) {
+    iterate(2.0, 1.0, 1.0, weights[n]);
+    std::swap(previous, current);
+    std::copy(next, next + size, current.begin());
+  }
+  this->Points->Modified();
+}
+
+}
@@ -0,0 +1,111 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Portions (c) Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkSlicerSRepCreatorLogic_MeanCurvatureFlow_h
+#define __vtkSlicerSRepCreatorLogic_MeanCurvatureFlow_h
+
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+#include <vtk_eigen.h>
+#include VTK_EIGEN(Sparse)
+#include VTK_EIGEN(SparseCholesky)
+
+#include <vector>
+
+#include "vtkSlicerSRepCreatorModuleLogicExport.h"
+
+namespace srepcreator {
+
+/// Mean curvature flow of a surface mesh.
+///
+/// The mesh connectivity is read once, on construction. Each Step is then one parallel pass over the points
+/// that, for each point, computes the cotangent Laplacian and area weighted normal from the triangles around
+/// it and moves the point along the normal by -dt * mean curvature. Polygons are fanned into triangles and
+/// strips are split, points not in any triangle never move.
+///
+/// Explicit steps are only stable while dt is small next to the square of the shortest edge. StepSemiImplicit
+/// instead solves (M - dt/2 L) x' = M x for the new positions x', with L the cotangent Laplacian and M the
+/// barycentric areas of the current mesh (Desbrun et al. 1999). That is stable for any dt, but only follows
+/// the flow closely while dt is small next to the square of the object's size. Far bigger steps collapse the
+/// mesh towards a line along its longest axis and then towards a point.
+///
+/// Steps can smooth first. That is the same windowed sinc filter as vtkWindowedSincPolyDataFilter, run over
+/// the mesh edges, so it needs no filter or new mesh either. As with BoundarySmoothingOff, points on an edge
+/// only one triangle uses are held where they are while smoothing. The flow itself still moves them.
+class VTK_SLICER_SREPCREATOR_MODULE_LOGIC_EXPORT MeanCurvatureFlow {
+public:
+  /// \throws std::invalid_argument if mesh has no points or no triangles
+  explicit MeanCurvatureFlow(vtkPolyData& mesh);
+  MeanCurvatureFlow(const MeanCurvatureFlow&) = delete;
+  MeanCurvatureFlow(MeanCurvatureFlow&&) = delete;
+  MeanCurvatureFlow& operator=(const MeanCurvatureFlow&) = delete;
+  MeanCurvatureFlow& operator=(MeanCurvatureFlow&&) = delete;
+  ~MeanCurvatureFlow() = default;
+
+  /// Flows every point one step.
+  ///
+  /// \param dt Step size.
+  /// \param smoothAmount Pass band of the smoothing done before flowing, between 0.0 and 2.0. 0 or less is
+  ///        no smoothing.
+  void Step(double dt, double smoothAmount = 0.0);
+
+  /// Flows every point one semi-implicit step.
+  ///
+  /// The sparse system has the same pattern every step, so it is only analyzed on the first call and just
+  /// refactored after. Edges whose cotangent weight is negative, from obtuse triangles, get no weight so the
+  /// system stays positive definite.
+  ///
+  /// \param dt Step size, in the same units as for Step.
+  /// \param smoothAmount As for Step.
+  /// \throws std::runtime_error if the system can't be factored
+  void StepSemiImplicit(double dt, double smoothAmount = 0.0);
+
+  /// Where the points are now, with the same ids as the mesh given on construction. The same object for the
+  /// life of the flow, so it can be set as the points of a vtkPolyData.
+  vtkPoints* GetPoints() const;
+
+private:
+  void Smooth(double smoothAmount);
+  void InitializeSemiImplicit();
+
+  /// 3 point ids per triangle
+  std::vector<vtkIdType> Triangles;
+  /// The triangles around point i are PointTriangles[PointTriangleOffsets[i], PointTriangleOffsets[i+1])
+  std::vector<vtkIdType> PointTriangleOffsets;
+  std::vector<vtkIdType> PointTriangles;
+  /// The points sharing an edge with point i are Neighbors[NeighborOffsets[i], NeighborOffsets[i+1])
+  std::vector<vtkIdType> NeighborOffsets;
+  std::vector<vtkIdType> Neighbors;
+  /// Whether point i is on an edge used by only one triangle, so smoothing leaves it alone.
+  std::vector<bool> BoundaryPoints;
+  vtkSmartPointer<vtkPoints> Points;
+  /// Scratch positions the next step is written to before being copied into Points.
+  std::vector<double> NextPositions;
+
+  /// M - dt/2 L, with every edge and diagonal entry stored even when 0 so its pattern never changes.
+  Eigen::SparseMatrix<double> System;
+  Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> Solver;
+  /// Per triangle corner, where the weight of the opposite edge is in System's values, both ways round
+  std::vector<Eigen::Index> EdgeEntries;
+  std::vector<Eigen::Index> DiagonalEntries;
+};
+
+}
+
+#endif
@@ -18,6 +18,7 @@
 // Logic includes
 #include "vtkSlicerSRepCreatorLogic.h"
 #include "vtkSlicerSRepLogic.h"
+#include "MeanCurvatureFlow.h"
 
 // MRML includes
 #include <vtkMRMLScene.h>
@@ -25,9 +26,7 @@
 
 // VTK includes
 #include <vtkCellLocator.h>
-#include <vtkCurvatures.h>
 #include <vtkDecimatePro.h>
-#include <vtkDoubleArray.h>
 #include <vtkGenericCell.h>
 #include <vtkIntArray.h>
 #include <vtkMassProperties.h>
@@ -35,11 +34,6 @@
 #include <vtkObjectFactory.h>
 #include <vtkParametricEllipsoid.h>
 #include <vtkParametricFunctionSource.h>
-#include <vtkPointData.h>
-#include <vtkPolyDataNormals.h>
-#include <vtkPolyDataReader.h>
-#include <vtkPolyDataWriter.h>
-#include <vtkWindowedSincPolyDataFilter.h>
 
 #include <vtksys/SystemTools.hxx>
 
@@ -50,10 +44,13 @@
 #include <srepUtil.h>
 
 // STD includes
+#include <array>
 #include <cassert>
+#include <functional>
 #include <numeric>
 #include <random>
 #include <sstream>
+#include <unordered_map>
 
 namespace {
   //---------------------------------------------------------------------------
@@ -120,6 +117,18 @@ namespace {
     }
   }
 
+  //---------------------------------------------------------------------------
+  // Exact, so only for points that were copied rather than computed.
+  struct PointHash {
+    size_t operator()(const std::array<double, 3>& p) const {
+      const std::hash<double> hash;
+      size_t seed = hash(p[0]);
+      seed ^= hash(p[1]) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+      seed ^= hash(p[2]) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+      return seed;
+    }
+  };
+
 } // namespace {}
 
 //---------------------------------------------------------------------------
@@ -146,7 +155,9 @@ vtkStandardNewMacro(vtkSlicerSRepCreatorLogic);
 
 //----------------------------------------------------------------------------
 vtkSlicerSRepCreatorLogic::vtkSlicerSRepCreatorLogic()
-  : ActualForwardIterations(0)
+  : ForwardFlowHistory()
+  , KeepFlowHistoryInMemory(true)
+  , UseSemiImplicitFlow(false)
   , SRepNodeId()
   , ModelName()
   , ProgressTracker(*this)
@@ -187,20 +198,11 @@ std::string vtkSlicerSRepCreatorLogic::TempFolder() {
 }
 
 //---------------------------------------------------------------------------
-void vtkSlicerSRepCreatorLogic::WriteIteration(vtkPolyData* mesh, const size_t iteration) {
-  vtkNew<vtkPoints> points;
-  double p[3];
-  for (const auto id : this->IdsToWrite) {
-    mesh->GetPoint(id, p);
-    points->InsertNextPoint(p);
+void vtkSlicerSRepCreatorLogic::RecordIteration(vtkPolyData& mesh) {
+  if (!mesh.GetPoints()) {
+    throw std::invalid_argument("Flowed mesh has no points");
   }
-  vtkNew<vtkPolyData> polydata;
-  polydata->SetPoints(points);
-
-  vtkNew<vtkPolyDataWriter> writer;
-  writer->SetFileName(this->ForwardIterationFilename(iteration).c_str());
-  writer->SetInputData(polydata);
-  writer->Update();
+  this->ForwardFlowHistory.AppendIteration(*mesh.GetPoints());
 }
 
 //---------------------------------------------------------------------------
@@ -219,8 +221,7 @@ vtkSlicerSRepCreatorLogic::EllipsoidParameters vtkSlicerSRepCreatorLogic::FlowSu
   const auto ellipsoidParameters = CalculateBestFitEllipsoid(*flowedMesh);
   auto ellipsoidalMesh = this->SnapFlowedMeshToEllipsoid(*flowedMesh, ellipsoidParameters);
 
-  this->WriteIteration(ellipsoidalMesh, maxIterations+1);
-  ++this->ActualForwardIterations;
+  this->RecordIteration(*ellipsoidalMesh);
 
   if (outputEveryNumIterations != 0) {
     this->MakeModelNode(ellipsoidalMesh,
@@ -254,8 +255,8 @@ vtkSmartPointer<vtkPolyData> vtkSlicerSRepCreatorLogic::FlowSurfaceMesh(
 
   { // get the subset of points we will save and use for backflow
     // Get ~10% of the points that are distributed semi-nicely across the shape
-    this->IdsToWrite.clear();
-    this->IdsToWrite.reserve(mesh->GetNumberOfPoints() / 10);
+    std::vector<vtkIdType> idsToRecord;
+    idsToRecord.reserve(mesh->GetNumberOfPoints() / 10);
 
     vtkNew<vtkDecimatePro> decimate;
     decimate->SetTargetReduction(0.9);
@@ -263,26 +264,35 @@ vtkSmartPointer<vtkPolyData> vtkSlicerSRepCreatorLogic::FlowSurfaceMesh(
     decimate->Update();
     vtkSmartPointer<vtkPolyData> decimatedMesh = decimate->GetOutput();
 
+    // decimation only ever removes points, so each one left is an exact copy of one in the mesh.
+    // If points are repeated in the mesh the first one is used.
+    std::unordered_map<std::array<double, 3>, vtkIdType, PointHash> meshPointIds;
+    meshPointIds.reserve(mesh->GetNumberOfPoints());
     std::array<double, 3> pt;
-    std::array<double, 3> dpt;
-    for (int d = 0; d < decimatedMesh->GetNumberOfPoints(); ++d) {
-      decimatedMesh->GetPoint(d, dpt.data());
-      for (int o = 0; o < mesh->GetNumberOfPoints(); ++o) {
-        mesh->GetPoint(o, pt.data());
-        if (pt == dpt) {
-          this->IdsToWrite.push_back(o);
-          break;
-        }
+    for (vtkIdType o = 0; o < mesh->GetNumberOfPoints(); ++o) {
+      mesh->GetPoint(o, pt.data());
+      meshPointIds.emplace(pt, o);
+    }
+    for (vtkIdType d = 0; d < decimatedMesh->GetNumberOfPoints(); ++d) {
+      decimatedMesh->GetPoint(d, pt.data());
+      const auto found = meshPointIds.find(pt);
+      if (found != meshPointIds.end()) {
+        idsToRecord.push_back(found->second);
       }
     }
 
-    std::sort(this->IdsToWrite.begin(), this->IdsToWrite.end());
-  }
+    std::sort(idsToRecord.begin(), idsToRecord.end());
 
-  //create a temp folder to store stuff for backwards flow in
-  const auto tempFolder = this->TempFolder();
-  if (tempFolder.empty()) {
-    return nullptr;
+    // the history for backwards flow only goes to disk if asked to
+    std::string spillFilePath;
+    if (!this->KeepFlowHistoryInMemory) {
+      const auto tempFolder = this->TempFolder();
+      if (tempFolder.empty()) {
+        return nullptr;
+      }
+      spillFilePath = tempFolder + "/forward-flow.bin";
+    }
+    this->ForwardFlowHistory.Reset(std::move(idsToRecord), spillFilePath);
   }
 
   //TODO: delete if don't need volume
@@ -292,72 +302,31 @@ vtkSmartPointer<vtkPolyData> vtkSlicerSRepCreatorLogic::FlowSurfaceMesh(
 
   // const double originalVolume = massFilter->GetVolume();
 
-  const bool smoothing = smoothAmount > 0;
-
-  vtkNew<vtkPolyDataNormals> normalFilter;
-  normalFilter->SplittingOff();
-  normalFilter->ComputeCellNormalsOff();
-  normalFilter->ComputePointNormalsOn();
-  if (!smoothing) {
-    normalFilter->SetInputData(mesh); //mesh only changes if we are smoothing
-  }
-
-  vtkNew<vtkCurvatures> curvatureFilter;
-  curvatureFilter->SetInputConnection(normalFilter->GetOutputPort());
-  curvatureFilter->SetCurvatureTypeToMean();
+  // connectivity is read once here, every iteration after is one pass over the points
+  srepcreator::MeanCurvatureFlow flow(*mesh);
+  mesh->SetPoints(flow.GetPoints());
 
   for (size_t i = 0; i < maxIterations; ++i) {
     this->ProgressTracker.SetForwardProgress(static_cast<double>(i) / maxIterations);
 
-    vtkSmartPointer<vtkWindowedSincPolyDataFilter> smoothFilter;
-    if (smoothing) {
-      //there is something weird about this filter where it doesn't work
-      //if you don't make it new every time
-      smoothFilter = vtkSmartPointer<vtkWindowedSincPolyDataFilter>::New();
-      smoothFilter->SetPassBand(smoothAmount);
-      smoothFilter->NonManifoldSmoothingOn();
-      smoothFilter->NormalizeCoordinatesOn();
-      smoothFilter->SetNumberOfIterations(20);
-      smoothFilter->FeatureEdgeSmoothingOff();
-      smoothFilter->BoundarySmoothingOff();
-
-      smoothFilter->SetInputData(mesh);
-      normalFilter->SetInputConnection(smoothFilter->GetOutputPort());
-    }
-    curvatureFilter->Update();
-    if (smoothing) {
-      mesh = smoothFilter->GetOutput();
+    if (this->UseSemiImplicitFlow) {
+      flow.StepSemiImplicit(dt, smoothAmount);
+    } else {
+      flow.Step(dt, smoothAmount);
     }
+    mesh->Modified();
 
-    auto curvature = vtkDoubleArray::SafeDownCast(curvatureFilter->GetOutput()->GetPointData()->GetArray("Mean_Curvature"));
-    auto normals = normalFilter->GetOutput()->GetPointData()->GetNormals();
-    if (!curvature || !normals) {
-      return nullptr;
-    }
-
-    // perform the flow
-    auto points = mesh->GetPoints();
-    for (int i = 0; i < points->GetNumberOfPoints(); ++i) {
-      double p[3];
-      points->GetPoint(i, p);
-      const double* n = normals->GetTuple(i);
-      const auto h = curvature->GetValue(i);
-      for (int j = 0; j < 3; ++j) {
-        p[j] -= dt * h * n[j];
-      }
-      points->SetPoint(i, p);
-    }
-    points->Modified();
-
-    this->WriteIteration(mesh, i+1);
+    this->RecordIteration(*mesh);
 
     if (outputEveryNumIterations != 0 && i % outputEveryNumIterations == 0) {
-      this->MakeModelNode(mesh,
+      // the flow keeps moving mesh's points, so the model needs its own copy
+      vtkNew<vtkPolyData> snapshot;
+      snapshot->DeepCopy(mesh);
+      this->MakeModelNode(snapshot,
         model->GetName() + std::string("-forwardflow-") + std::to_string(i),
         true, model->GetDisplayNode()->GetColor());
     }
   }
-  this->ActualForwardIterations = maxIterations;
 
   if (outputEveryNumIterations != 0) {
     this->MakeModelNode(mesh,
@@ -368,11 +337,6 @@ vtkSmartPointer<vtkPolyData> vtkSlicerSRepCreatorLogic::FlowSurfaceMesh(
   return mesh;
 }
 
-//---------------------------------------------------------------------------
-std::string vtkSlicerSRepCreatorLogic::ForwardIterationFilename(const long iteration) {
-  return this->TempFolder() + "/" + std::to_string(iteration) + ".vtk";
-}
-
 //---------------------------------------------------------------------------
 vtkSmartPointer<vtkPolyData> vtkSlicerSRepCreatorLogic::SnapFlowedMeshToEllipsoid(vtkPolyData& alreadyFlowedMesh, const EllipsoidParameters& ellipsoid) {
   auto ellipsoidPolyData = vtkSlicerSRepCreatorLogic::MakeEllipsoidPolyData(ellipsoid);
@@ -723,11 +687,31 @@ vtkSmartPointer<vtkEllipticalSRep> vtkSlicerSRepCreatorLogic::GenerateSRep(
 
 //---------------------------------------------------------------------------
 void vtkSlicerSRepCreatorLogic::Reset() {
-  this->ActualForwardIterations = 0;
+  this->ForwardFlowHistory.Clear();
   this->SRepNodeId.clear();
   this->ModelName.clear();
 }
 
+//---------------------------------------------------------------------------
+void vtkSlicerSRepCreatorLogic::SetKeepFlowHistoryInMemory(const bool inMemory) {
+  this->KeepFlowHistoryInMemory = inMemory;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerSRepCreatorLogic::GetKeepFlowHistoryInMemory() const {
+  return this->KeepFlowHistoryInMemory;
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerSRepCreatorLogic::SetUseSemiImplicitFlow(const bool semiImplicit) {
+  this->UseSemiImplicitFlow = semiImplicit;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerSRepCreatorLogic::GetUseSemiImplicitFlow() const {
+  return this->UseSemiImplicitFlow;
+}
+
 //---------------------------------------------------------------------------
 vtkMRMLEllipticalSRepNode* vtkSlicerSRepCreatorLogic::RunForward(
   vtkMRMLModelNode* model,
@@ -780,14 +764,17 @@ vtkMRMLEllipticalSRepNode* vtkSlicerSRepCreatorLogic::RunBackward(const size_t o
     using PointSetType = TransformType::PointSetType;
     using PointIdType = PointSetType::PointIdentifier;
 
-    const auto polyDataPointToPointType = [](vtkPolyData& poly, unsigned int index) {
-      PointType pt;
-      double p[3];
-      poly.GetPoint(index, p);
-      pt[0] = p[0];
-      pt[1] = p[1];
-      pt[2] = p[2];
-      return pt;
+    const auto makeLandMarks = [](const std::vector<float>& coordinates) {
+      PointSetType::Pointer landMarks = PointSetType::New();
+      PointSetType::PointsContainer::Pointer landMarkContainer = landMarks->GetPoints();
+      for (PointIdType i = 0; i < coordinates.size() / 3; ++i) {
+        PointType pt;
+        pt[0] = coordinates[3 * i];
+        pt[1] = coordinates[3 * i + 1];
+        pt[2] = coordinates[3 * i + 2];
+        landMarkContainer->InsertElement(i, pt);
+      }
+      return landMarks;
     };
 
     auto mrmlScene = this->GetMRMLScene();
@@ -809,41 +796,22 @@ vtkMRMLEllipticalSRepNode* vtkSlicerSRepCreatorLogic::RunBackward(const size_t o
     //copy the srep
     auto backflowedSRep = srep->SmartClone();
 
-    vtkNew<vtkPolyDataReader> reader1;
-    vtkNew<vtkPolyDataReader> reader2;
-
-    vtkPolyDataReader* sourceSurfaceReader = reader1;
-    vtkPolyDataReader* targetSurfaceReader = reader2;
-
-    sourceSurfaceReader->SetFileName(this->ForwardIterationFilename(this->ActualForwardIterations).c_str());
-    sourceSurfaceReader->Update();
+    // iteration i of the forward flow is at i-1 in the history
+    const long forwardIterations = static_cast<long>(this->ForwardFlowHistory.GetNumberOfIterations());
+    std::vector<float> sourceCoordinates;
+    std::vector<float> targetCoordinates;
+    if (forwardIterations > 0) {
+      this->ForwardFlowHistory.GetIteration(forwardIterations - 1, sourceCoordinates);
+    }
 
-    for (long iteration = this->ActualForwardIterations; iteration > 1; --iteration) {
-      this->ProgressTracker.SetBackwardProgress(static_cast<double>(this->ActualForwardIterations - iteration) / this->ActualForwardIterations);
+    for (long iteration = forwardIterations; iteration > 1; --iteration) {
+      this->ProgressTracker.SetBackwardProgress(static_cast<double>(forwardIterations - iteration) / forwardIterations);
 
       //swap source and target at bottom because target becomes source
-      targetSurfaceReader->SetFileName(this->ForwardIterationFilename(iteration - 1).c_str());
-      targetSurfaceReader->Update();
-
-      vtkSmartPointer<vtkPolyData> polyData_source = sourceSurfaceReader->GetOutput();
-      vtkSmartPointer<vtkPolyData> polyData_target = targetSurfaceReader->GetOutput();
-
-      PointSetType::Pointer sourceLandMarks = PointSetType::New();
-      PointSetType::Pointer targetLandMarks = PointSetType::New();
-      PointSetType::PointsContainer::Pointer sourceLandMarkContainer
-                  = sourceLandMarks->GetPoints();
-      PointSetType::PointsContainer::Pointer targetLandMarkContainer
-                  = targetLandMarks->GetPoints();
-
-      // Read in the source points set
-      for(unsigned int i = 0; i < polyData_source->GetNumberOfPoints(); ++i) {
-          sourceLandMarkContainer->InsertElement(i, polyDataPointToPointType(*polyData_source, i));
-      }
+      this->ForwardFlowHistory.GetIteration(iteration - 2, targetCoordinates);
 
-      // Read in the target points set
-      for(unsigned int i = 0; i < polyData_target->GetNumberOfPoints(); ++i) {
-          targetLandMarkContainer->InsertElement(i, polyDataPointToPointType(*polyData_target, i));
-      }
+      PointSetType::Pointer sourceLandMarks = makeLandMarks(sourceCoordinates);
+      PointSetType::Pointer targetLandMarks = makeLandMarks(targetCoordinates);
 
       TransformType::Pointer tps = TransformType::New();
       tps->SetSourceLandmarks(sourceLandMarks);
@@ -857,7 +825,7 @@ vtkMRMLEllipticalSRepNode* vtkSlicerSRepCreatorLogic::RunBackward(const size_t o
         this->MakeEllipticalSRepNode(backflowedSRep->SmartClone(), this->ModelName + "-backflow-srep-" + std::to_string(iteration));
       }
 
-      std::swap(sourceSurfaceReader, targetSurfaceReader);
+      std::swap(sourceCoordinates, targetCoordinates);
     }
 
     auto transformedSRepNode = this->MakeEllipticalSRepNode(backflowedSRep, this->ModelName + "-srep");
@@ -34,6 +34,7 @@
 #include VTK_EIGEN(Eigenvalues)
 
 #include "vtkSlicerSRepCreatorModuleLogicExport.h"
+#include "FlowHistory.h"
 #include <vtkEllipticalSRep.h>
 
 
@@ -89,6 +90,26 @@ public:
   /// Resets the state of the logic's srep creating facilities.
   void Reset();
 
+  /// @{
+  /// Get set whether RunForward keeps the flow history for RunBackward in memory.
+  ///
+  /// If false the history is written to a file in the application's temporary folder instead, which uses
+  /// less memory for very long flows of big meshes but is slower. Default is true. Takes effect on the
+  /// next RunForward.
+  void SetKeepFlowHistoryInMemory(bool inMemory);
+  bool GetKeepFlowHistoryInMemory() const;
+  /// @}
+
+  /// @{
+  /// Get set whether RunForward flows the mesh with semi-implicit steps instead of explicit ones.
+  ///
+  /// Semi-implicit steps solve a sparse linear system each, but stay stable for much larger dt, so far fewer
+  /// iterations reach an ellipsoid-like shape and RunBackward has fewer steps to undo. The mesh shrinks as it
+  /// flows, as with explicit steps. Default is false. Takes effect on the next RunForward.
+  void SetUseSemiImplicitFlow(bool semiImplicit);
+  bool GetUseSemiImplicitFlow() const;
+  /// @}
+
 protected:
   vtkSlicerSRepCreatorLogic();
   virtual ~vtkSlicerSRepCreatorLogic();
@@ -235,16 +256,16 @@ private:
     const std::string& name,
     bool visible = true);
 
-  std::string ForwardIterationFilename(long iteration);
-
   static vtkSmartPointer<vtkPolyData> SnapFlowedMeshToEllipsoid(
     vtkPolyData& alreadyFlowedMesh,
     const EllipsoidParameters& ellipsoid);
 
-  void WriteIteration(vtkPolyData* mesh, const size_t iteration);
+  // Records where the history's points are in mesh as the next forward iteration
+  void RecordIteration(vtkPolyData& mesh);
 
-  std::vector<vtkIdType> IdsToWrite;
-  size_t ActualForwardIterations;
+  srepcreator::FlowHistory ForwardFlowHistory;
+  bool KeepFlowHistoryInMemory;
+  bool UseSemiImplicitFlow;
   std::string SRepNodeId;
   std::string ModelName;
   ProgressTrackerType ProgressTracker;
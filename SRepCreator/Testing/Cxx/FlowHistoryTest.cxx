@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include <FlowHistory.h>
+#include <vtkPoints.h>
+#include <vtkSmartPointer.h>
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "SRepUnitTestHelpers.h"
+
+using srepcreator::FlowHistory;
+using srepUnitTestHelpers::TempFileTest;
+
+namespace {
+
+/// numberOfPoints points, where coordinate c of point i at the given iteration is 100 * iteration + 3 * i + c.
+vtkSmartPointer<vtkPoints> MakePoints(vtkIdType numberOfPoints, int iteration) {
+  auto points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(numberOfPoints);
+  for (vtkIdType i = 0; i < numberOfPoints; ++i) {
+    const double p[3] = {100.0 * iteration + 3 * i, 100.0 * iteration + 3 * i + 1, 100.0 * iteration + 3 * i + 2};
+    points->SetPoint(i, p);
+  }
+  return points;
+}
+
+/// Expects coordinates to be the recorded points of MakePoints at iteration.
+void ExpectIteration(const std::vector<vtkIdType>& pointIds, int iteration, const std::vector<float>& coordinates) {
+  ASSERT_EQ(3 * pointIds.size(), coordinates.size());
+  for (size_t i = 0; i < pointIds.size(); ++i) {
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_EQ(static_cast<float>(100.0 * iteration + 3 * pointIds[i] + c), coordinates[3 * i + c]);
+    }
+  }
+}
+
+bool FileExists(const std::string& path) {
+  return std::ifstream(path).good();
+}
+
+} // namespace
+
+class FlowHistoryTest : public TempFileTest {
+protected:
+  /// Runs the same checks with and without a spill file.
+  std::vector<std::string> SpillFilePaths() {
+    return {"", this->AddTempFile("flow.history")};
+  }
+};
+
+TEST_F(FlowHistoryTest, Empty) {
+  FlowHistory history;
+  EXPECT_EQ(0u, history.GetNumberOfIterations());
+  EXPECT_EQ(0u, history.GetNumberOfPoints());
+  EXPECT_FALSE(history.IsSpilling());
+  std::vector<float> coordinates;
+  EXPECT_THROW(history.GetIteration(0, coordinates), std::out_of_range);
+}
+
+TEST_F(FlowHistoryTest, RoundTrip) {
+  // not every point, and not in order
+  const std::vector<vtkIdType> pointIds{7, 0, 3, 9, 4};
+  for (const auto& spillFilePath : this->SpillFilePaths()) {
+    SCOPED_TRACE("spill file '" + spillFilePath + "'");
+    FlowHistory history;
+    history.Reset(pointIds, spillFilePath);
+    EXPECT_EQ(!spillFilePath.empty(), history.IsSpilling());
+    EXPECT_EQ(pointIds.size(), history.GetNumberOfPoints());
+
+    for (int iteration = 0; iteration < 6; ++iteration) {
+      history.AppendIteration(*MakePoints(10, iteration));
+    }
+    ASSERT_EQ(6u, history.GetNumberOfIterations());
+
+    // read back in any order, including appending between reads
+    std::vector<float> coordinates;
+    for (const int iteration : {5, 0, 3, 3, 1}) {
+      history.GetIteration(iteration, coordinates);
+      ExpectIteration(pointIds, iteration, coordinates);
+    }
+    history.AppendIteration(*MakePoints(10, 6));
+    history.GetIteration(6, coordinates);
+    ExpectIteration(pointIds, 6, coordinates);
+    history.GetIteration(2, coordinates);
+    ExpectIteration(pointIds, 2, coordinates);
+  }
+}
+
+TEST_F(FlowHistoryTest, SpillMatchesMemory) {
+  const std::vector<vtkIdType> pointIds{1, 2, 5};
+  FlowHistory inMemory;
+  FlowHistory spilled;
+  inMemory.Reset(pointIds);
+  spilled.Reset(pointIds, this->AddTempFile("spilled.history"));
+  for (int iteration = 0; iteration < 4; ++iteration) {
+    const auto points = MakePoints(6, iteration);
+    inMemory.AppendIteration(*points);
+    spilled.AppendIteration(*points);
+  }
+
+  ASSERT_EQ(inMemory.GetNumberOfIterations(), spilled.GetNumberOfIterations());
+  std::vector<float> expected;
+  std::vector<float> actual;
+  for (size_t iteration = 0; iteration < inMemory.GetNumberOfIterations(); ++iteration) {
+    inMemory.GetIteration(iteration, expected);
+    spilled.GetIteration(iteration, actual);
+    EXPECT_EQ(expected, actual);
+  }
+}
+
+TEST_F(FlowHistoryTest, IterationOutOfRange) {
+  for (const auto& spillFilePath : this->SpillFilePaths()) {
+    SCOPED_TRACE("spill file '" + spillFilePath + "'");
+    FlowHistory history;
+    history.Reset({0, 1}, spillFilePath);
+    std::vector<float> coordinates;
+    EXPECT_THROW(history.GetIteration(0, coordinates), std::out_of_range);
+
+    history.AppendIteration(*MakePoints(2, 0));
+    history.AppendIteration(*MakePoints(2, 1));
+    EXPECT_THROW(history.GetIteration(2, coordinates), std::out_of_range);
+    EXPECT_THROW(history.GetIteration(static_cast<size_t>(-1), coordinates), std::out_of_range);
+
+    // still readable after the errors
+    history.GetIteration(1, coordinates);
+    ExpectIteration({0, 1}, 1, coordinates);
+  }
+}
+
+TEST_F(FlowHistoryTest, InvalidPointIdRollsBack) {
+  const std::vector<vtkIdType> pointIds{0, 4, 2};
+  for (const auto& spillFilePath : this->SpillFilePaths()) {
+    SCOPED_TRACE("spill file '" + spillFilePath + "'");
+    FlowHistory history;
+    history.Reset(pointIds, spillFilePath);
+    history.AppendIteration(*MakePoints(5, 0));
+
+    // point 4 is missing, so nothing of this iteration is kept
+    EXPECT_THROW(history.AppendIteration(*MakePoints(4, 1)), std::invalid_argument);
+    EXPECT_EQ(1u, history.GetNumberOfIterations());
+    std::vector<float> coordinates;
+    EXPECT_THROW(history.GetIteration(1, coordinates), std::out_of_range);
+
+    // and the next one goes where it would have
+    history.AppendIteration(*MakePoints(5, 2));
+    ASSERT_EQ(2u, history.GetNumberOfIterations());
+    history.GetIteration(0, coordinates);
+    ExpectIteration(pointIds, 0, coordinates);
+    history.GetIteration(1, coordinates);
+    ExpectIteration(pointIds, 2, coordinates);
+  }
+
+  FlowHistory negative;
+  negative.Reset({-1});
+  EXPECT_THROW(negative.AppendIteration(*MakePoints(5, 0)), std::invalid_argument);
+  EXPECT_EQ(0u, negative.GetNumberOfIterations());
+}
+
+TEST_F(FlowHistoryTest, ClearDeletesSpillFile) {
+  const auto path = this->AddTempFile("cleared.history");
+  FlowHistory history;
+  history.Reset({0, 1}, path);
+  history.AppendIteration(*MakePoints(2, 0));
+  EXPECT_TRUE(FileExists(path));
+
+  history.Clear();
+  EXPECT_FALSE(FileExists(path));
+  EXPECT_FALSE(history.IsSpilling());
+  EXPECT_EQ(0u, history.GetNumberOfIterations());
+  EXPECT_EQ(0u, history.GetNumberOfPoints());
+
+  // Reset drops the old file too, even when the new history is in memory
+  history.Reset({0, 1}, path);
+  EXPECT_TRUE(FileExists(path));
+  history.Reset({0, 1});
+  EXPECT_FALSE(FileExists(path));
+  EXPECT_FALSE(history.IsSpilling());
+}
+
+TEST_F(FlowHistoryTest, DestructorDeletesSpillFile) {
+  const auto path = this->AddTempFile("destroyed.history");
+  {
+    FlowHistory history;
+    history.Reset({0, 1}, path);
+    history.AppendIteration(*MakePoints(2, 0));
+    EXPECT_TRUE(FileExists(path));
+  }
+  EXPECT_FALSE(FileExists(path));
+}
+
+TEST_F(FlowHistoryTest, SpillFileNotCreated) {
+  FlowHistory history;
+  EXPECT_THROW(history.Reset({0, 1}, this->AddTempFile("missing/directory/flow.history")), std::runtime_error);
+  EXPECT_FALSE(history.IsSpilling());
+  EXPECT_EQ(0u, history.GetNumberOfPoints());
+}
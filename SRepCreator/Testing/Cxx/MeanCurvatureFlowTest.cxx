@@ -0,0 +1,294 @@
+#include <gtest/gtest.h>
+#include <MeanCurvatureFlow.h>
+#include <vtkCellArray.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using srepcreator::MeanCurvatureFlow;
+
+namespace {
+
+using Triangle = std::array<vtkIdType, 3>;
+
+vtkSmartPointer<vtkPolyData> MakeMesh(const std::vector<std::array<double, 3>>& points, const std::vector<Triangle>& triangles) {
+  vtkNew<vtkPoints> meshPoints;
+  for (const auto& p : points) {
+    meshPoints->InsertNextPoint(p.data());
+  }
+  vtkNew<vtkCellArray> polys;
+  for (const auto& t : triangles) {
+    polys->InsertNextCell(3, t.data());
+  }
+  auto mesh = vtkSmartPointer<vtkPolyData>::New();
+  mesh->SetPoints(meshPoints);
+  mesh->SetPolys(polys);
+  return mesh;
+}
+
+/// An icosahedron subdivided levels times and projected onto the sphere of the given radius about the origin.
+/// Wound with outward normals, or inward if flip.
+vtkSmartPointer<vtkPolyData> MakeSphere(int levels, double radius, bool flip) {
+  const double t = (1 + std::sqrt(5.0)) / 2;
+  std::vector<std::array<double, 3>> points{
+    {{-1, t, 0}}, {{1, t, 0}}, {{-1, -t, 0}}, {{1, -t, 0}},
+    {{0, -1, t}}, {{0, 1, t}}, {{0, -1, -t}}, {{0, 1, -t}},
+    {{t, 0, -1}}, {{t, 0, 1}}, {{-t, 0, -1}}, {{-t, 0, 1}}};
+  std::vector<Triangle> triangles{
+    {{0, 11, 5}}, {{0, 5, 1}}, {{0, 1, 7}}, {{0, 7, 10}}, {{0, 10, 11}},
+    {{1, 5, 9}}, {{5, 11, 4}}, {{11, 10, 2}}, {{10, 7, 6}}, {{7, 1, 8}},
+    {{3, 9, 4}}, {{3, 4, 2}}, {{3, 2, 6}}, {{3, 6, 8}}, {{3, 8, 9}},
+    {{4, 9, 5}}, {{2, 4, 11}}, {{6, 2, 10}}, {{8, 6, 7}}, {{9, 8, 1}}};
+  const auto project = [radius](std::array<double, 3> p) {
+    const double length = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+    for (auto& x : p) {
+      x *= radius / length;
+    }
+    return p;
+  };
+  std::transform(points.begin(), points.end(), points.begin(), project);
+
+  for (int level = 0; level < levels; ++level) {
+    std::map<std::pair<vtkIdType, vtkIdType>, vtkIdType> midpoints;
+    const auto midpoint = [&](vtkIdType a, vtkIdType b) {
+      const auto key = std::minmax(a, b);
+      const auto it = midpoints.find(key);
+      if (it != midpoints.end()) {
+        return it->second;
+      }
+      points.push_back(project({{
+        (points[a][0] + points[b][0]) / 2, (points[a][1] + points[b][1]) / 2, (points[a][2] + points[b][2]) / 2}}));
+      return midpoints[key] = static_cast<vtkIdType>(points.size() - 1);
+    };
+    std::vector<Triangle> subdivided;
+    for (const auto& tr : triangles) {
+      const auto a = midpoint(tr[0], tr[1]);
+      const auto b = midpoint(tr[1], tr[2]);
+      const auto c = midpoint(tr[2], tr[0]);
+      subdivided.insert(subdivided.end(), {{{tr[0], a, c}}, {{tr[1], b, a}}, {{tr[2], c, b}}, {{a, b, c}}});
+    }
+    triangles = std::move(subdivided);
+  }
+
+  if (flip) {
+    for (auto& tr : triangles) {
+      std::swap(tr[1], tr[2]);
+    }
+  }
+  return MakeMesh(points, triangles);
+}
+
+/// A size x size grid of unit squares in the z = 0 plane, split into triangles.
+vtkSmartPointer<vtkPolyData> MakeGrid(vtkIdType size) {
+  std::vector<std::array<double, 3>> points;
+  for (vtkIdType y = 0; y <= size; ++y) {
+    for (vtkIdType x = 0; x <= size; ++x) {
+      points.push_back({{static_cast<double>(x), static_cast<double>(y), 0.0}});
+    }
+  }
+  std::vector<Triangle> triangles;
+  for (vtkIdType y = 0; y < size; ++y) {
+    for (vtkIdType x = 0; x < size; ++x) {
+      const vtkIdType corner = y * (size + 1) + x;
+      triangles.push_back({{corner, corner + 1, corner + size + 2}});
+      triangles.push_back({{corner, corner + size + 2, corner + size + 1}});
+    }
+  }
+  return MakeMesh(points, triangles);
+}
+
+/// Moves every point of mesh by a random amount up to noise along each axis.
+void AddNoise(vtkPolyData& mesh, double noise) {
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> distribution(-noise, noise);
+  auto* points = mesh.GetPoints();
+  for (vtkIdType i = 0; i < points->GetNumberOfPoints(); ++i) {
+    double p[3];
+    points->GetPoint(i, p);
+    for (auto& x : p) {
+      x += distribution(generator);
+    }
+    points->SetPoint(i, p);
+  }
+}
+
+/// Mean and standard deviation of the distance of the points from the origin.
+std::pair<double, double> RadiusStatistics(vtkPoints* points) {
+  double sum = 0;
+  double sumOfSquares = 0;
+  const auto n = points->GetNumberOfPoints();
+  for (vtkIdType i = 0; i < n; ++i) {
+    double p[3];
+    points->GetPoint(i, p);
+    const double r = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+    sum += r;
+    sumOfSquares += r * r;
+  }
+  const double mean = sum / n;
+  return {mean, std::sqrt(std::max(0.0, sumOfSquares / n - mean * mean))};
+}
+
+/// Largest distance of the points from the origin along each axis.
+std::array<double, 3> HalfExtents(vtkPoints* points) {
+  std::array<double, 3> extents{{0, 0, 0}};
+  for (vtkIdType i = 0; i < points->GetNumberOfPoints(); ++i) {
+    double p[3];
+    points->GetPoint(i, p);
+    for (int d = 0; d < 3; ++d) {
+      extents[d] = std::max(extents[d], std::abs(p[d]));
+    }
+  }
+  return extents;
+}
+
+} // namespace
+
+TEST(MeanCurvatureFlow, Invalid) {
+  vtkNew<vtkPolyData> empty;
+  EXPECT_THROW(MeanCurvatureFlow{*empty}, std::invalid_argument);
+
+  auto noTriangles = MakeMesh({{{0, 0, 0}}, {{1, 0, 0}}}, {});
+  EXPECT_THROW(MeanCurvatureFlow{*noTriangles}, std::invalid_argument);
+}
+
+TEST(MeanCurvatureFlow, SphereShrinks) {
+  // a sphere of radius R has mean curvature 1/R, so each step shrinks it by dt/R whichever way it is wound
+  const double radius = 2.0;
+  const double dt = 0.01;
+  for (const bool flip : {false, true}) {
+    SCOPED_TRACE(flip ? "inward normals" : "outward normals");
+    auto sphere = MakeSphere(4, radius, flip);
+    MeanCurvatureFlow flow(*sphere);
+    EXPECT_NEAR(radius, RadiusStatistics(flow.GetPoints()).first, 1e-12);
+
+    double expected = radius;
+    for (int i = 0; i < 5; ++i) {
+      flow.Step(dt);
+      expected -= dt / expected;
+      const auto statistics = RadiusStatistics(flow.GetPoints());
+      EXPECT_NEAR(expected, statistics.first, 0.01 * dt / radius * (i + 1));
+      // and stays a sphere
+      EXPECT_LT(statistics.second, 1e-3);
+    }
+  }
+}
+
+TEST(MeanCurvatureFlow, SmoothingDampsNoise) {
+  auto sphere = MakeSphere(4, 2.0, false);
+  AddNoise(*sphere, 0.05);
+  const auto before = RadiusStatistics(sphere->GetPoints());
+
+  MeanCurvatureFlow flow(*sphere);
+  flow.Step(0.0, 0.1);
+  const auto after = RadiusStatistics(flow.GetPoints());
+  EXPECT_LT(after.second, before.second / 4);
+  // smoothing alone barely shrinks the sphere
+  EXPECT_NEAR(before.first, after.first, 0.05);
+}
+
+TEST(MeanCurvatureFlow, SmoothingHoldsBoundary) {
+  const vtkIdType size = 10;
+  auto grid = MakeGrid(size);
+  AddNoise(*grid, 0.1);
+  vtkNew<vtkPoints> original;
+  original->DeepCopy(grid->GetPoints());
+
+  MeanCurvatureFlow flow(*grid);
+  flow.Step(0.0, 0.1);
+
+  double interiorBefore = 0;
+  double interiorAfter = 0;
+  for (vtkIdType y = 0; y <= size; ++y) {
+    for (vtkIdType x = 0; x <= size; ++x) {
+      const vtkIdType id = y * (size + 1) + x;
+      double before[3];
+      double after[3];
+      original->GetPoint(id, before);
+      flow.GetPoints()->GetPoint(id, after);
+      if (x == 0 || y == 0 || x == size || y == size) {
+        for (int d = 0; d < 3; ++d) {
+          EXPECT_NEAR(before[d], after[d], 1e-12);
+        }
+      } else {
+        interiorBefore += before[2] * before[2];
+        interiorAfter += after[2] * after[2];
+      }
+    }
+  }
+  // the inside is still smoothed flat
+  EXPECT_LT(interiorAfter, interiorBefore / 4);
+}
+
+TEST(MeanCurvatureFlow, SemiImplicitTracksExplicit) {
+  // an ellipsoid, so the flow changes its shape and not just its size
+  const auto makeEllipsoid = []() {
+    auto mesh = MakeSphere(3, 1.0, false);
+    auto* points = mesh->GetPoints();
+    for (vtkIdType i = 0; i < points->GetNumberOfPoints(); ++i) {
+      double p[3];
+      points->GetPoint(i, p);
+      p[0] *= 2.0;
+      p[1] *= 1.5;
+      points->SetPoint(i, p);
+    }
+    return mesh;
+  };
+  auto explicitMesh = makeEllipsoid();
+  auto semiImplicitMesh = makeEllipsoid();
+
+  MeanCurvatureFlow explicitFlow(*explicitMesh);
+  MeanCurvatureFlow semiImplicitFlow(*semiImplicitMesh);
+  const double dt = 0.0005;
+  for (int i = 0; i < 200; ++i) {
+    explicitFlow.Step(dt);
+    semiImplicitFlow.StepSemiImplicit(dt);
+  }
+
+  // The semi-implicit step also slides points along the surface, so compare the shapes rather than the points
+  const std::array<double, 3> start{{2.0, 1.5, 1.0}};
+  const auto explicitExtents = HalfExtents(explicitFlow.GetPoints());
+  const auto semiImplicitExtents = HalfExtents(semiImplicitFlow.GetPoints());
+  for (int d = 0; d < 3; ++d) {
+    const double shrink = start[d] - explicitExtents[d];
+    EXPECT_GT(shrink, 0.03);
+    EXPECT_NEAR(explicitExtents[d], semiImplicitExtents[d], 0.1 * shrink);
+  }
+}
+
+TEST(MeanCurvatureFlow, SemiImplicitStableWhereExplicitIsNot) {
+  // the edges are about 0.13 long, so dt is far bigger than their square
+  const double radius = 2.0;
+  const double dt = 0.05;
+  const int steps = 20;
+  // the same noise on both
+  auto explicitMesh = MakeSphere(4, radius, false);
+  AddNoise(*explicitMesh, 0.01);
+  auto semiImplicitMesh = MakeSphere(4, radius, false);
+  AddNoise(*semiImplicitMesh, 0.01);
+
+  MeanCurvatureFlow explicitFlow(*explicitMesh);
+  MeanCurvatureFlow semiImplicitFlow(*semiImplicitMesh);
+  for (int i = 0; i < steps; ++i) {
+    explicitFlow.Step(dt);
+    semiImplicitFlow.StepSemiImplicit(dt);
+  }
+
+  // explicit steps this big grow the noise into a crumpled surface instead of damping it
+  const auto explicitStatistics = RadiusStatistics(explicitFlow.GetPoints());
+  EXPECT_FALSE(explicitStatistics.second < 0.05);
+
+  // a sphere flowing for time T has radius sqrt(R^2 - 2T), and stays round
+  const auto semiImplicitStatistics = RadiusStatistics(semiImplicitFlow.GetPoints());
+  EXPECT_NEAR(std::sqrt(radius * radius - 2 * dt * steps), semiImplicitStatistics.first, 0.05);
+  EXPECT_LT(semiImplicitStatistics.second, 0.01);
+}
@@ -124,6 +124,7 @@ void qSlicerSRepCreatorModuleWidget::onRunForward() {
   d->progressBar->show();
   const auto fin = srep::util::finally([&d](){ d->progressBar->hide(); });
   SRepProgressHelper<QProgressBar> progressManager(*(d->logic()), d->progressBar);
+  d->logic()->SetUseSemiImplicitFlow(d->semiImplicitFlowCheckbox->isChecked());
   auto srepNode = d->logic()->RunForward(model, numFoldPoints, numStepsToFold, dt, smoothAmount, maxIterations,
     outputEllipsoidModel, outputEveryNumIterations);
   if (!srepNode) {
@@ -164,6 +165,7 @@ void qSlicerSRepCreatorModuleWidget::onRun() {
   d->progressBar->show();
   const auto fin = srep::util::finally([&d](){ d->progressBar->hide(); });
   SRepProgressHelper<QProgressBar> progressManager(*(d->logic()), d->progressBar);
+  d->logic()->SetUseSemiImplicitFlow(d->semiImplicitFlowCheckbox->isChecked());
   auto srepNode = d->logic()->Run(model, numFoldPoints, numStepsToFold, dt, smoothAmount, maxIterations,
     outputEllipsoidModel, forwardOutputEveryNumIterations, backwardOutputEveryNumIterations);
   if (!srepNode) {
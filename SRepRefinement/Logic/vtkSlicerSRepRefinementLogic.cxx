@@ -590,8 +590,10 @@ private:
   vtkSmartPointer<vtkEllipticalSRep> Refine(vtkEllipticalSRep& srep, double* coeff, SpokeType spokeType) {
     constexpr double tolerance = 1e-13;
 
-    auto clone = srep.SmartClone();
+    // only the spokes being refined need to be copied, the rest can be shared with the original
+    auto clone = srep.SmartCloneSharingSpokes();
     if (spokeType == SpokeType::UpOrientation || spokeType == SpokeType::DownOrientation) {
+      clone->DetachSpokes(spokeType);
       size_t c = 0; //coeff index
       for (IndexType l = 0; l < clone->GetNumberOfLines(); ++l) {
         for (IndexType s = 0; s < clone->GetNumberOfSteps(); ++s) {